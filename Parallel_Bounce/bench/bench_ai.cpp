@@ -0,0 +1,105 @@
+// Micro-benchmark for the predictive AI: decisions/sec (one per tick, replanning on bounces)
+// and plans/sec (intercept solve forced every call), with the old follower as a baseline.
+//
+// Usage: bench_ai [--states N] [--repeat R]
+
+#include "pong_ai.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Keep results alive so the compiler can't drop the timed loops
+static volatile int sink;
+
+int main(int argc, char** argv) {
+    int stateCount = 200000;
+    int repeat = 20;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--states") == 0 && hasValue) stateCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--states N] [--repeat R]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Record the states of real AI vs AI play so bounces happen at a realistic rate
+    PongConfig config;
+    PongSim sim(config);
+    PongAI playerAI(AI_NORMAL, true, 1);
+    PongAI opponentAI(AI_NORMAL, false, 2);
+    vector<PongState> states;
+    states.reserve(stateCount);
+    while ((int)states.size() < stateCount) {
+        if (sim.isOver()) sim.reset(sim.state().rng);
+        states.push_back(sim.state());
+        PongInputs inputs = { playerAI.decide(sim.state(), config), opponentAI.decide(sim.state(), config) };
+        sim.step(inputs);
+    }
+
+    const double calls = (double)stateCount * repeat;
+    printf("%-16s %16s %14s %10s\n", "ai", "decisions/sec", "ns/decision", "plans");
+
+    // Baseline: the reactive follower StartGame used before
+    {
+        int total = 0;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++) {
+            for (const PongState& state : states) total += FollowBallInput(state, state.opponentPaddle);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        sink = total;
+        printf("%-16s %16.0f %14.2f %10s\n", "follower", calls / seconds, 1e9 * seconds / calls, "-");
+    }
+
+    const AiDifficulty difficulties[] = { AI_EASY, AI_NORMAL, AI_HARD };
+    for (AiDifficulty difficulty : difficulties) {
+        PongAI ai(difficulty, false, 7);
+        int total = 0;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++) {
+            for (const PongState& state : states) total += ai.decide(state, config);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        sink = total;
+        printf("%-16s %16.0f %14.2f %10llu\n", AiDifficultyName(difficulty), calls / seconds, 1e9 * seconds / calls,
+            (unsigned long long)ai.plans);
+    }
+
+    // Worst case: solve the intercept on every call
+    for (AiDifficulty difficulty : difficulties) {
+        PongAI ai(difficulty, false, 7);
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++) {
+            for (const PongState& state : states) ai.plan(state, config);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        sink = (int)ai.plans;
+        char name[32];
+        snprintf(name, sizeof(name), "%s (plan)", AiDifficultyName(difficulty));
+        printf("%-16s %16.0f %14.2f %10llu\n", name, calls / seconds, 1e9 * seconds / calls, (unsigned long long)ai.plans);
+    }
+
+    // Same, with the per-decision budget timer switched on
+    {
+        AiSettings settings = AiSettingsFor(AI_HARD);
+        settings.budgetMicros = 5.0f;
+        PongAI ai(settings, false, 7);
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++) {
+            for (const PongState& state : states) ai.plan(state, config);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%-16s %16.0f %14.2f %10llu  (over budget: %llu, max %llu ns)\n", "hard (timed)", calls / seconds,
+            1e9 * seconds / calls, (unsigned long long)ai.plans, (unsigned long long)ai.overBudget,
+            (unsigned long long)ai.maxPlanNanos);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Benchmark for the multi-ball stress arena: balls*steps/sec for every supported kernel.
+// Each vector kernel is also checked against the scalar result after the run.
+//
+// Usage: bench_arena [--balls N[,N...]] [--steps S]
+
+#include "ball_arena.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    vector<size_t> ballCounts = { 10000, 100000, 1000000 };
+    int steps = 200;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--balls") == 0 && hasValue) {
+            ballCounts.clear();
+            string list = argv[++i];
+            size_t start = 0;
+            while (start < list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == string::npos) comma = list.size();
+                ballCounts.push_back((size_t)strtoull(list.substr(start, comma - start).c_str(), nullptr, 10));
+                start = comma + 1;
+            }
+        }
+        else if (strcmp(argv[i], "--steps") == 0 && hasValue) steps = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--balls N[,N...]] [--steps S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const ArenaKernel kernels[] = { ARENA_KERNEL_SCALAR, ARENA_KERNEL_SSE, ARENA_KERNEL_AVX2 };
+    const float dt = 1.0f / 60.0f;
+    bool allMatch = true;
+
+    printf("%10s %8s %10s %18s %9s %8s\n", "balls", "kernel", "time (s)", "balls*steps/sec", "speedup", "result");
+
+    for (size_t balls : ballCounts) {
+        BallArena reference;
+        reference.spawn(balls, 1234);
+        double scalarRate = 0.0;
+
+        for (ArenaKernel kernel : kernels) {
+            if (!ArenaKernelSupported(kernel)) {
+                printf("%10zu %8s %10s\n", balls, ArenaKernelName(kernel), "n/a");
+                continue;
+            }
+
+            BallArena arena;
+            arena.spawn(balls, 1234);
+
+            auto start = chrono::steady_clock::now();
+            for (int s = 0; s < steps; s++) arena.step(dt, kernel);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            if (kernel == ARENA_KERNEL_SCALAR) reference = arena;
+            bool match = arena.x == reference.x && arena.y == reference.y && arena.vx == reference.vx &&
+                arena.vy == reference.vy && arena.leftExits == reference.leftExits && arena.rightExits == reference.rightExits;
+            allMatch = allMatch && match;
+
+            double rate = (double)balls * steps / seconds;
+            if (kernel == ARENA_KERNEL_SCALAR) scalarRate = rate;
+            printf("%10zu %8s %10.3f %18.0f %8.2fx %8s\n", balls, ArenaKernelName(kernel), seconds, rate,
+                rate / scalarRate, match ? "ok" : "MISMATCH");
+        }
+    }
+
+    return allMatch ? 0 : 1;
+}
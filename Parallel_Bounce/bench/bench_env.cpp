@@ -0,0 +1,122 @@
+// Benchmark for the training environment: env-steps/sec of PongVecEnv with 1 to T threads,
+// through the C ABI, and with the game's AI as the policy (the baseline a trained agent has to
+// beat), plus how each policy does against the AI opponent.
+//
+// Usage: bench_env [--envs N] [--steps S] [--threads T]
+
+#include "pong_env.h"
+#include "pong_env_c.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Random actions, made up front so the policy costs nothing in the timed loop
+static vector<int8_t> RandomActions(size_t count, uint32_t seed) {
+    vector<int8_t> actions(count);
+    uint32_t x = seed;
+    for (int8_t& action : actions) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        action = (int8_t)(x % 3) - 1;
+    }
+    return actions;
+}
+
+static void PrintPolicy(const char* name, double stepsPerSecond, const PongEnvStats& stats) {
+    uint64_t decided = stats.agentWins + stats.opponentWins;
+    printf("%-22s %12.1f %10llu %9.1f%% %12.3f\n", name, stepsPerSecond / 1e6, (unsigned long long)stats.episodes,
+        decided ? 100.0 * stats.agentWins / decided : 0.0, stats.episodes ? stats.totalReward / stats.episodes : 0.0);
+}
+
+// Function to get the next thread count to measure: doubling, and ending on maxThreads
+static int NextThreadCount(int threads, int maxThreads) {
+    return threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2;
+}
+
+int main(int argc, char** argv) {
+    size_t envCount = 4096;
+    int steps = 2000;
+    int maxThreads = (int)thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--envs") == 0 && hasValue) envCount = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--steps") == 0 && hasValue) steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) maxThreads = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--envs N] [--steps S] [--threads T]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (envCount == 0) envCount = 1;
+    if (maxThreads < 1) maxThreads = 1;
+
+    // A few different action rows, so each step doesn't repeat the last one
+    const int rows = 64;
+    vector<int8_t> random = RandomActions(envCount * rows, 1);
+
+    printf("%zu envs, %d steps per run, %u cores\n", envCount, steps, thread::hardware_concurrency());
+    printf("%-22s %12s\n", "random policy", "M steps/sec");
+    for (int threads = 1; threads <= maxThreads; threads = NextThreadCount(threads, maxThreads)) {
+        PongEnvSettings settings;
+        settings.threads = threads;
+        PongVecEnv env(envCount, settings);
+        auto start = chrono::steady_clock::now();
+        for (int s = 0; s < steps; s++) env.step(&random[(s % rows) * envCount]);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        char name[32];
+        snprintf(name, sizeof(name), "%d thread%s", env.threadCount(), env.threadCount() == 1 ? "" : "s");
+        printf("%-22s %12.1f\n", name, (double)envCount * steps / seconds / 1e6);
+    }
+
+    // The same through the C ABI, as a Python binding would call it
+    {
+        PongEnvHandle* env = PongEnvCreate(envCount, AI_NORMAL, 1, maxThreads);
+        if (!env) {
+            fprintf(stderr, "Error: PongEnvCreate failed\n");
+            return 1;
+        }
+        auto start = chrono::steady_clock::now();
+        double rewardSum = 0.0;
+        for (int s = 0; s < steps; s++) {
+            PongEnvStep(env, &random[(s % rows) * envCount]);
+            rewardSum += PongEnvRewards(env)[s % envCount];
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%-22s %12.1f\n", "C ABI", (double)envCount * steps / seconds / 1e6);
+        PongEnvDestroy(env);
+        if (rewardSum > 1e30) printf("\n");
+    }
+
+    // How the policies do against the AI: long enough runs for several thousand episodes
+    printf("\n%-22s %12s %10s %10s %12s\n", "policy vs normal AI", "M steps/sec", "episodes", "wins", "reward/ep");
+    int evaluationSteps = steps * 10;
+    {
+        PongEnvSettings settings;
+        settings.threads = maxThreads;
+        PongVecEnv env(envCount, settings);
+        auto start = chrono::steady_clock::now();
+        for (int s = 0; s < evaluationSteps; s++) env.step(&random[(s % rows) * envCount]);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        PrintPolicy("random", (double)envCount * evaluationSteps / seconds, env.stats());
+    }
+    {
+        PongEnvSettings settings;
+        settings.threads = maxThreads;
+        PongVecEnv env(envCount, settings);
+        vector<int8_t> actions(envCount);
+        auto start = chrono::steady_clock::now();
+        for (int s = 0; s < evaluationSteps; s++) {
+            env.baselineActions(actions.data());
+            env.step(actions.data());
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        PrintPolicy("baseline (normal AI)", (double)envCount * evaluationSteps / seconds, env.stats());
+    }
+    return 0;
+}
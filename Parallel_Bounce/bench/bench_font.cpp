@@ -0,0 +1,116 @@
+// Benchmark for font startup: what LoadFont does on the CPU (read the TTF, rasterize 95
+// glyphs at 32 px, pack the atlas) against mapping the file baked by font_bake and building
+// the glyph tables from it. The texture upload, the same in both cases apart from the bytes,
+// needs a window and isn't measured. Needs raylib; build with make bench_font.
+//
+// Usage: bench_font [--ttf PATH] [--sdff PATH] [--runs N]
+
+#include "raylib.h"
+#include "sdf_font.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Millis(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+static void Report(const char* name, vector<double>& millis, size_t textureBytes) {
+    sort(millis.begin(), millis.end());
+    printf("%-34s median %8.3f ms  min %8.3f ms  texture %6.0f KB\n", name, millis[millis.size() / 2], millis[0],
+        textureBytes / 1024.0);
+}
+
+int main(int argc, char** argv) {
+    const char* ttfPath = "assets/fonts/Roboto-Regular.ttf";
+    const char* sdfPath = "assets/fonts/Roboto-Regular.sdff";
+    int runs = 20;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--ttf") == 0 && hasValue) ttfPath = argv[++i];
+        else if (strcmp(argv[i], "--sdff") == 0 && hasValue) sdfPath = argv[++i];
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) runs = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--ttf PATH] [--sdff PATH] [--runs N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (runs < 1) runs = 1;
+    SetTraceLogLevel(LOG_WARNING);
+
+    // LoadFont's CPU work: the whole TTF path, every start
+    vector<double> ttfMillis;
+    size_t ttfBytes = 0;
+    for (int run = 0; run < runs; run++) {
+        Clock::time_point start = Clock::now();
+        int fileSize = 0;
+        unsigned char* fileData = LoadFileData(ttfPath, &fileSize);
+        if (!fileData) {
+            fprintf(stderr, "Error: Could not read %s\n", ttfPath);
+            return 1;
+        }
+        GlyphInfo* glyphs = LoadFontData(fileData, fileSize, 32, nullptr, 95, FONT_DEFAULT);
+        Rectangle* recs = nullptr;
+        Image atlas = GenImageFontAtlas(glyphs, &recs, 95, 32, 4, 0);
+        ttfMillis.push_back(Millis(start));
+
+        ttfBytes = (size_t)atlas.width * atlas.height * 2;     // Gray + alpha
+        UnloadImage(atlas);
+        MemFree(recs);
+        UnloadFontData(glyphs, 95);
+        UnloadFileData(fileData);
+    }
+
+    // The baked file: one mapping, a check of the header and the glyph table, no rasterizing
+    vector<double> sdfMillis;
+    size_t sdfBytes = 0;
+    int sdfGlyphs = 0;
+    vector<GlyphInfo> glyphs;
+    vector<Rectangle> recs;
+    for (int run = 0; run < runs; run++) {
+        Clock::time_point start = Clock::now();
+        SdfFontFile file;
+        if (!file.open(sdfPath)) {
+            fprintf(stderr, "Error: Could not open %s as a baked font (run 'make fonts')\n", sdfPath);
+            return 1;
+        }
+        const SdfFontHeader& header = file.header();
+        glyphs.resize(header.glyphCount);
+        recs.resize(header.glyphCount);
+        for (uint32_t i = 0; i < header.glyphCount; i++) {
+            const SdfGlyphRecord& record = file.glyphs()[i];
+            glyphs[i].value = record.codepoint;
+            glyphs[i].offsetX = record.offsetX;
+            glyphs[i].offsetY = record.offsetY;
+            glyphs[i].advanceX = record.advanceX;
+            glyphs[i].image = Image{};
+            recs[i] = { (float)record.x, (float)record.y, (float)record.width, (float)record.height };
+        }
+        // Touch every page of the atlas, as the upload would
+        unsigned checksum = 0;
+        const size_t atlasBytes = (size_t)header.atlasWidth * header.atlasHeight;
+        for (size_t i = 0; i < atlasBytes; i += 4096) checksum += file.pixels()[i];
+        sdfMillis.push_back(Millis(start));
+
+        sdfBytes = atlasBytes;
+        sdfGlyphs = (int)header.glyphCount;
+        if (checksum == 0xFFFFFFFF) printf(" ");   // Keeps the reads
+    }
+
+    printf("%d runs\n", runs);
+    Report("TTF (LoadFont, 95 glyphs, 32 px)", ttfMillis, ttfBytes);
+    char sdfName[64];
+    snprintf(sdfName, sizeof(sdfName), "Baked SDF (%d glyphs, any size)", sdfGlyphs);
+    Report(sdfName, sdfMillis, sdfBytes);
+    printf("speedup %.0fx\n", ttfMillis[ttfMillis.size() / 2] / max(sdfMillis[sdfMillis.size() / 2], 1e-6));
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Benchmark for ball-ball collisions in the multi-ball arena: uniform grid vs testing every pair.
+// Both run the same simulation steps from the same start and must find the same contacts.
+//
+// Usage: bench_grid [--balls N[,N...]] [--steps S] [--radius PX]
+// Without --radius the ball size is chosen so the balls cover about 20% of the field.
+
+#include "ball_grid.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct GridRun {
+    double seconds;
+    int steps;
+    size_t firstStepContacts;
+};
+
+// Function to step the arena and resolve ball-ball contacts with the grid or brute force
+static GridRun Run(const BallArena& start, int steps, bool useGrid) {
+    BallArena arena = start;
+    const PongConfig& config = arena.config();
+    BallGrid grid((float)config.screenWidth, (float)config.screenHeight, config.ballRadius);
+    GridRun run = { 0.0, steps, 0 };
+
+    auto begin = chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        arena.step(config.dt, BestArenaKernel());
+        size_t contacts;
+        if (useGrid) {
+            grid.build(arena);
+            contacts = grid.collide(arena);
+        }
+        else {
+            contacts = CollideBallsBruteForce(arena);
+        }
+        if (s == 0) run.firstStepContacts = contacts;
+    }
+    run.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return run;
+}
+
+int main(int argc, char** argv) {
+    vector<size_t> ballCounts = { 1000, 10000, 100000 };
+    int steps = 100;
+    float radius = 0.0f;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--balls") == 0 && hasValue) {
+            ballCounts.clear();
+            string list = argv[++i];
+            size_t start = 0;
+            while (start < list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == string::npos) comma = list.size();
+                ballCounts.push_back((size_t)strtoull(list.substr(start, comma - start).c_str(), nullptr, 10));
+                start = comma + 1;
+            }
+        }
+        else if (strcmp(argv[i], "--steps") == 0 && hasValue) steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--radius") == 0 && hasValue) radius = (float)atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--balls N[,N...]] [--steps S] [--radius PX]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bool allMatch = true;
+    printf("%8s %7s %7s %14s %14s %9s %10s\n", "balls", "radius", "method", "ms/step", "contacts", "speedup", "result");
+
+    for (size_t balls : ballCounts) {
+        PongConfig config;
+        config.ballRadius = radius > 0 ? radius
+            : sqrtf(0.2f * config.screenWidth * config.screenHeight / (3.14159265f * (float)balls));
+
+        BallArena start(config);
+        start.spawn(balls, 42);
+
+        // Brute force is O(n^2): cap it at about 2e9 pair tests per size
+        double pairs = (double)balls * balls / 2.0;
+        int bruteSteps = (int)fmin((double)steps, fmax(1.0, 2e9 / pairs));
+
+        GridRun brute = Run(start, bruteSteps, false);
+        GridRun grid = Run(start, steps, true);
+        bool match = brute.firstStepContacts == grid.firstStepContacts;
+        allMatch = allMatch && match;
+
+        double bruteMs = 1000.0 * brute.seconds / brute.steps;
+        double gridMs = 1000.0 * grid.seconds / grid.steps;
+        printf("%8zu %7.2f %7s %14.3f %14zu %9s %10s\n", balls, config.ballRadius, "brute", bruteMs, brute.firstStepContacts, "1.00x", "");
+        printf("%8zu %7.2f %7s %14.3f %14zu %8.1fx %10s\n", balls, config.ballRadius, "grid", gridMs, grid.firstStepContacts,
+            bruteMs / gridMs, match ? "ok" : "MISMATCH");
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Benchmark for the HUD text layout: per frame, what the match HUD used to do (MeasureTextEx for
+// every line, and DrawTextEx's glyph lookups, which are the same walk) against HudText, which
+// lays a line out only when it changes, and against the HudBatch fill that replaces the draw
+// calls. The font is rasterized on the CPU from the TTF; the GPU submission needs a window and
+// isn't measured. Needs raylib; build with make bench_hud.
+//
+// Usage: bench_hud [--ttf PATH] [--frames N] [--change-every K]
+
+#include "hud_text.h"
+#include "raylib.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// The match HUD: two heart counters that change on a point, and the frame stats overlay
+static const int HUD_LINES = 3;
+
+static void FormatLine(char* buffer, size_t size, int line, int frame, int changeEvery) {
+    int value = frame / changeEvery;
+    if (line == 0) snprintf(buffer, size, "%s's Hearts: %d", "Player 1", 5 - value % 6);
+    else if (line == 1) snprintf(buffer, size, "%s's Hearts: %d", "Player 2", 5 - (value / 2) % 6);
+    else snprintf(buffer, size, "work %d us (avg %d)  allocs %d (%d B)  layouts %d  glyphs %d  particles %d",
+        900 + value % 50, 850 + value % 20, value, value * 48, value * 2, 120 + value % 7, 4000 + value % 100);
+}
+
+static double NanosPerFrame(Clock::time_point start, int frames) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / frames;
+}
+
+int main(int argc, char** argv) {
+    const char* ttfPath = "assets/fonts/Roboto-Regular.ttf";
+    int frames = 200000;
+    int changeEvery = 60;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--ttf") == 0 && hasValue) ttfPath = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue) frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--change-every") == 0 && hasValue) changeEvery = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--ttf PATH] [--frames N] [--change-every K]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames < 1) frames = 1;
+    if (changeEvery < 1) changeEvery = 1;
+    SetTraceLogLevel(LOG_WARNING);
+
+    // The font LoadFont would make, without the texture upload; the layout only needs an id
+    int fileSize = 0;
+    unsigned char* fileData = LoadFileData(ttfPath, &fileSize);
+    if (!fileData) {
+        fprintf(stderr, "Error: Could not read %s\n", ttfPath);
+        return 1;
+    }
+    Font font = {};
+    font.baseSize = 32;
+    font.glyphCount = 95;
+    font.glyphPadding = 4;
+    font.glyphs = LoadFontData(fileData, fileSize, font.baseSize, nullptr, font.glyphCount, FONT_DEFAULT);
+    Image atlas = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font.baseSize, font.glyphPadding, 0);
+    font.texture.id = 1;
+    font.texture.width = atlas.width;
+    font.texture.height = atlas.height;
+    UnloadImage(atlas);
+    UnloadFileData(fileData);
+
+    const float fontSize = 20.0f;
+    char line[256];
+    volatile float sink = 0.0f;
+
+    // Before: every line measured (and walked again to draw) every frame
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < HUD_LINES; i++) {
+            FormatLine(line, sizeof(line), i, frame, changeEvery);
+            sink = sink + MeasureTextEx(font, line, fontSize, 1.0f).x;
+        }
+    }
+    double measureNanos = NanosPerFrame(start, frames);
+
+    // HudText: the same formatting, a compare, and a layout only when the text changed
+    vector<HudText> texts(HUD_LINES, HudText(font, fontSize));
+    uint64_t layoutsBefore = HudText::layoutCount();
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < HUD_LINES; i++) {
+            FormatLine(line, sizeof(line), i, frame, changeEvery);
+            texts[i].set(line);
+            sink = sink + texts[i].size().x;
+        }
+    }
+    double cachedNanos = NanosPerFrame(start, frames);
+    uint64_t layouts = HudText::layoutCount() - layoutsBefore;
+
+    // HudText laying out every frame: the cost of one layout, what a change costs
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < HUD_LINES; i++) {
+            FormatLine(line, sizeof(line), i, frame, changeEvery);
+            texts[i].setFont(font, frame % 2 ? fontSize : fontSize + 1.0f);
+            texts[i].set(line);
+            sink = sink + texts[i].size().x;
+        }
+    }
+    double layoutNanos = NanosPerFrame(start, frames);
+
+    // Filling the batch the HUD draws from, shadows included
+    HudBatch batch;
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        batch.clear();
+        for (int i = 0; i < HUD_LINES; i++) {
+            batch.addShadowed(texts[i], { 10.0f, 10.0f + 30.0f * i }, WHITE, BLACK);
+        }
+        sink = sink + (float)batch.quadCount();
+    }
+    double batchNanos = NanosPerFrame(start, frames);
+
+    printf("%d frames, %d HUD lines, text changes every %d frames (%llu layouts)\n", frames, HUD_LINES, changeEvery,
+        (unsigned long long)layouts);
+    printf("MeasureTextEx every frame      %8.0f ns/frame\n", measureNanos);
+    printf("HudText, layout on change      %8.0f ns/frame (%.1fx)\n", cachedNanos, measureNanos / cachedNanos);
+    printf("HudText, layout every frame    %8.0f ns/frame\n", layoutNanos);
+    printf("HudBatch fill (%zu quads)       %8.0f ns/frame\n", batch.quadCount(), batchNanos);
+
+    UnloadFontData(font.glyphs, font.glyphCount);
+    MemFree(font.recs);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Benchmark for the search AI: rollouts/sec with 1 to T threads for tree parallelism (shared
+// tree, virtual loss) and root parallelism (a tree per thread), how long decisions take at the
+// game's budget, and how it does against the predictive AI.
+//
+// Usage: bench_mcts [--threads T] [--rollouts R] [--matches N] [--budget US]
+
+#include "mcts_ai.h"
+#include "sim_thread.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+// Function to get a position in the middle of a rally, the ball heading for the left paddle
+static PongState RallyState(const PongConfig& config) {
+    PongSim sim(config);
+    PongAI player(AI_NORMAL, true, 3);
+    PongAI opponent(AI_NORMAL, false, 4);
+    do {
+        PongInputs inputs = { player.decide(sim.state(), config), opponent.decide(sim.state(), config) };
+        sim.step(inputs);
+    } while (sim.state().rally < 2 || sim.state().ballSpeedVector.x > 0);
+    return sim.state();
+}
+
+// Function to play matches of the search AI (left paddle) against the predictive AI
+static void PlayAgainst(AiDifficulty difficulty, int matches, const MctsSettings& settings) {
+    PongConfig config;
+    int wins = 0, draws = 0;
+    uint64_t points = 0, pointsWon = 0;
+    LatencySamples decisions;
+    uint64_t maxNanos = 0;
+    for (int m = 0; m < matches; m++) {
+        config.seed = 100 + m;
+        config.serveJitter = 0.3f;
+        PongSim sim(config);
+        PongAI player(difficulty, true, 1000 + m);
+        MctsAI search(settings, false, 2000 + m);
+        while (!sim.isOver() && sim.state().tick < 60 * 60 * 3) {   // Three minutes, then a draw
+            uint64_t before = search.stats().totalNanos;
+            uint64_t decided = search.stats().decisions;
+            PongInputs inputs = { player.decide(sim.state(), config), search.decide(sim.state(), config) };
+            if (search.stats().decisions != decided) decisions.add((search.stats().totalNanos - before) / 1000.0);
+            uint32_t events = sim.step(inputs);
+            if (events & (PONG_EVENT_PLAYER_SCORED | PONG_EVENT_OPPONENT_SCORED)) points++;
+            if (events & PONG_EVENT_OPPONENT_SCORED) pointsWon++;
+        }
+        if (!sim.isOver()) draws++;
+        else if (!sim.playerWon()) wins++;
+        maxNanos = max(maxNanos, search.stats().maxNanos);
+    }
+    printf("%-12s %8d %9.1f%% %9.1f%% %9.1f%% %10.0f %10.0f %10.0f\n", AiDifficultyName(difficulty), matches,
+        100.0 * wins / matches, 100.0 * draws / matches, points ? 100.0 * pointsWon / points : 0.0,
+        decisions.percentile(50), decisions.percentile(99), maxNanos / 1000.0);
+}
+
+// Function to get the next thread count to measure: doubling, and ending on maxThreads
+static int NextThreadCount(int threads, int maxThreads) {
+    return threads < maxThreads && threads * 2 > maxThreads ? maxThreads : threads * 2;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = (int)thread::hardware_concurrency();
+    uint32_t rolloutsPerSearch = 4000;
+    int matches = 10;
+    float budget = 2000.0f;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--threads") == 0 && hasValue) maxThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rollouts") == 0 && hasValue) rolloutsPerSearch = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--matches") == 0 && hasValue) matches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--budget") == 0 && hasValue) budget = (float)atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--threads T] [--rollouts R] [--matches N] [--budget US]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (maxThreads < 1) maxThreads = 1;
+    if (rolloutsPerSearch < 1) rolloutsPerSearch = 1;
+
+    PongConfig config;
+    PongState state = RallyState(config);
+    printf("%u rollouts per search, %u cores\n", rolloutsPerSearch, thread::hardware_concurrency());
+    printf("%-12s %8s %14s %10s %10s\n", "parallelism", "threads", "rollouts/sec", "speedup", "nodes");
+    const MctsParallelism modes[2] = { MCTS_TREE, MCTS_ROOT };
+    for (MctsParallelism mode : modes) {
+        double single = 0.0;
+        for (int threads = 1; threads <= maxThreads; threads = NextThreadCount(threads, maxThreads)) {
+            MctsSettings settings;
+            settings.budgetMicros = 0.0f;
+            settings.maxRollouts = rolloutsPerSearch;
+            settings.parallelism = mode;
+            settings.threads = threads;
+            MctsAI search(settings, false, 1);
+            const int searches = 10;
+            auto start = chrono::steady_clock::now();
+            for (int s = 0; s < searches; s++) search.search(state, config);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            double rate = (double)search.stats().rollouts / seconds;
+            if (threads == 1) single = rate;
+            printf("%-12s %8d %14.0f %9.2fx %10u\n", mode == MCTS_TREE ? "tree" : "root", threads, rate, rate / single,
+                search.stats().lastNodes);
+        }
+    }
+
+    // Whole matches at 60 Hz with the time budget, as the game plays them
+    if (matches < 1) return 0;
+    MctsSettings settings;
+    settings.budgetMicros = budget;
+    settings.threads = maxThreads;
+    printf("\nsearch AI (%.0f us budget, %d threads) vs\n", budget, maxThreads);
+    printf("%-12s %8s %10s %10s %10s %10s %10s %10s\n", "opponent", "matches", "wins", "draws", "points won", "p50 us", "p99 us", "max us");
+    PlayAgainst(AI_NORMAL, matches, settings);
+    PlayAgainst(AI_HARD, matches, settings);
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Benchmark for the metrics: cost of a counter add and a histogram observe on one thread and on
+// several threads hitting the same metric, against the same loop without one; time to format a
+// registry the size of the game's as Prometheus text and JSON; and scrapes of the HTTP endpoint.
+//
+// Usage: bench_metrics [--updates N] [--threads T] [--port P] [--scrapes S]
+
+#include "metrics.h"
+#include "metrics_server.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+enum BenchOp {
+    OP_NONE,
+    OP_COUNTER,
+    OP_HISTOGRAM
+};
+
+// Some work for each update to go with, so the compiler can't drop the loop
+static volatile uint64_t sink = 0;
+
+static inline void Work(uint64_t& state) {
+    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+}
+
+static double LoopNanos(uint64_t updates, BenchOp op, MetricCounter& counter, MetricHistogram& histogram) {
+    uint64_t state = 88172645463325252ULL;
+    Clock::time_point start = Clock::now();
+    for (uint64_t i = 0; i < updates; i++) {
+        Work(state);
+        if (op == OP_COUNTER) counter.add();
+        // Frame-time-like values, spread over the buckets
+        else if (op == OP_HISTOGRAM) histogram.observe((state & 0xffff) * 1e-6);
+    }
+    sink = sink + state;
+    return chrono::duration<double, nano>(Clock::now() - start).count() / updates;
+}
+
+static double ThreadedNanos(uint64_t updates, BenchOp op, int threadCount, MetricCounter& counter, MetricHistogram& histogram) {
+    vector<double> perThread(threadCount);
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t]() { perThread[t] = LoopNanos(updates, op, counter, histogram); });
+    }
+    for (thread& worker : threads) worker.join();
+    double nanos = 0.0;
+    for (double value : perThread) nanos += value / threadCount;
+    return nanos;
+}
+
+// Function to fetch path from 127.0.0.1:port; returns the whole response, empty on failure
+static string HttpGet(uint16_t port, const char* path) {
+    intptr_t handle = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    remote.sin_port = htons(port);
+    string response;
+    if (connect(handle, (const sockaddr*)&remote, sizeof(remote)) == 0) {
+        string request = string("GET ") + path + " HTTP/1.0\r\n\r\n";
+        send(handle, request.data(), (int)request.size(), 0);
+        char buffer[4096];
+        int received;
+        while ((received = (int)recv(handle, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, received);
+    }
+#ifdef _WIN32
+    closesocket((SOCKET)handle);
+#else
+    ::close((int)handle);
+#endif
+    return response;
+}
+
+int main(int argc, char** argv) {
+    uint64_t updates = 20000000;
+    int threadCount = 4;
+    uint16_t port = 19105;
+    int scrapes = 200;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--updates") == 0 && hasValue) updates = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--port") == 0 && hasValue) port = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scrapes") == 0 && hasValue) scrapes = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--updates N] [--threads T] [--port P] [--scrapes S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (updates == 0) updates = 1;
+    if (threadCount < 1) threadCount = 1;
+    if (scrapes < 1) scrapes = 1;
+
+    MetricsRegistry registry;
+    MetricCounter& counter = registry.counter("bench_updates_total", "Counter the bench adds to");
+    MetricHistogram& histogram = registry.histogram("bench_frame_seconds", "Histogram the bench observes into",
+        MetricSecondsBuckets());
+
+    double baseline = LoopNanos(updates, OP_NONE, counter, histogram);
+    double added = LoopNanos(updates, OP_COUNTER, counter, histogram);
+    double observed = LoopNanos(updates, OP_HISTOGRAM, counter, histogram);
+    // All threads on one metric: the worst case, the game's threads mostly have their own
+    double addedThreaded = ThreadedNanos(updates, OP_COUNTER, threadCount, counter, histogram);
+    double observedThreaded = ThreadedNanos(updates, OP_HISTOGRAM, threadCount, counter, histogram);
+
+    printf("%llu updates per run\n", (unsigned long long)updates);
+    printf("no update              %6.2f ns/iteration\n", baseline);
+    printf("counter add            %6.2f ns/iteration (+%.2f)\n", added, added - baseline);
+    printf("histogram observe      %6.2f ns/iteration (+%.2f)\n", observed, observed - baseline);
+    printf("counter, %d threads     %6.2f ns/iteration (+%.2f)\n", threadCount, addedThreaded, addedThreaded - baseline);
+    printf("histogram, %d threads   %6.2f ns/iteration (+%.2f)\n", threadCount, observedThreaded, observedThreaded - baseline);
+
+    // About as many series as the game registers
+    registry.gauge("bench_ready_seconds", "Gauge").set(1.25);
+    for (const char* mode : { "local", "ai", "online", "search_ai" }) {
+        registry.counter("bench_matches_total", "Counter with a label", "mode", mode).add(3);
+    }
+    for (int i = 0; i < 5; i++) {
+        char name[48];
+        snprintf(name, sizeof(name), "bench_histogram_%d_seconds", i);
+        registry.histogram(name, "Another histogram", MetricSecondsBuckets()).observe(0.004 * (i + 1));
+    }
+
+    const int formats = 2000;
+    size_t textSize = 0;
+    size_t jsonSize = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < formats; i++) textSize = registry.prometheusText().size();
+    double textMicros = chrono::duration<double, micro>(Clock::now() - start).count() / formats;
+    start = Clock::now();
+    for (int i = 0; i < formats; i++) jsonSize = registry.json().size();
+    double jsonMicros = chrono::duration<double, micro>(Clock::now() - start).count() / formats;
+    printf("prometheus text        %6.1f us (%zu bytes)\n", textMicros, textSize);
+    printf("json                   %6.1f us (%zu bytes)\n", jsonMicros, jsonSize);
+
+    MetricsExporter exporter(registry);
+    MetricsExportSettings settings;
+    settings.port = port;
+    if (!exporter.start(settings)) return 1;
+
+    string response = HttpGet(port, "/metrics");
+    if (response.compare(0, 15, "HTTP/1.0 200 OK") != 0 || response.find("\nbench_updates_total ") == string::npos) {
+        fprintf(stderr, "Error: Unexpected response from /metrics:\n%s\n", response.c_str());
+        return 1;
+    }
+    if (HttpGet(port, "/other").compare(0, 12, "HTTP/1.0 404") != 0) {
+        fprintf(stderr, "Error: /other should be a 404\n");
+        return 1;
+    }
+
+    vector<double> millis;
+    for (int i = 0; i < scrapes; i++) {
+        start = Clock::now();
+        if (HttpGet(port, "/metrics").empty()) {
+            fprintf(stderr, "Error: Scrape %d failed\n", i);
+            return 1;
+        }
+        millis.push_back(chrono::duration<double, milli>(Clock::now() - start).count());
+    }
+    exporter.stop();
+    double total = 0.0;
+    double worst = 0.0;
+    for (double value : millis) {
+        total += value;
+        if (value > worst) worst = value;
+    }
+    printf("scrape of 127.0.0.1:%u %6.2f ms average, %.2f ms worst (%d scrapes, %llu served)\n", (unsigned)port,
+        total / scrapes, worst, scrapes, (unsigned long long)exporter.scrapes());
+    return 0;
+}
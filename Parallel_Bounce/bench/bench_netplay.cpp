@@ -0,0 +1,166 @@
+// Benchmark for networked play: two NetSessions (host and client, each driven by an AI) play
+// whole matches through NetImpairment links on a simulated clock, across a matrix of round
+// trip times and loss rates. Reports bandwidth per match, rollbacks, the cost of re-simulating,
+// ticks the local player had to wait for the network, and checks both sides end in the same state.
+//
+// Usage: bench_netplay [--matches N] [--delay TICKS] [--max-rollback TICKS]
+
+#include "net_impairment.h"
+#include "netplay.h"
+#include "pong_ai.h"
+#include "replay.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+const double FRAME_MILLIS = 1000.0 / 60.0;
+const int UDP_OVERHEAD = 28;        // IPv4 + UDP headers per packet
+
+struct Scenario {
+    double rttMillis;
+    double jitterMillis;
+    double lossRate;
+};
+
+struct ScenarioResult {
+    uint64_t ticks = 0;
+    uint64_t packets = 0;
+    uint64_t wireBytes = 0;
+    uint64_t snapshotBytes = 0;
+    uint64_t rollbacks = 0;
+    uint64_t resimulated = 0;
+    uint32_t maxRollback = 0;
+    uint64_t rollbackNanos = 0;
+    uint64_t waitTicks = 0;         // Frames where a side couldn't advance
+    uint64_t stalls = 0;
+    uint64_t desyncs = 0;
+    int mismatches = 0;             // Matches where the two sides ended differently
+};
+
+// One side of the match: a session, the AI playing it and the link its packets travel on
+struct Peer {
+    NetSession session;
+    PongAI ai;
+    NetImpairment outgoing;
+    double startMillis;
+
+    Peer(const PongConfig& config, bool host, const NetSessionSettings& settings, const NetImpairmentSettings& link, uint32_t seed, double start)
+        : session(config, host, 42, settings), ai(AI_NORMAL, host, seed), outgoing(link), startMillis(start) {}
+};
+
+static void Frame(Peer& peer, Peer& remote, double now, vector<uint8_t>& packet, ScenarioResult& result) {
+    // Packets that reached this peer
+    while (remote.outgoing.receive(now, packet)) peer.session.receive(packet.data(), packet.size());
+    if (now < peer.startMillis) return;
+
+    NetSession& session = peer.session;
+    if (!session.isOver()) {
+        session.setLocalInput(peer.ai.decide(session.state(), session.config()));
+        if (session.takeTimeSyncStall()) {
+            // Let the other side catch up
+        }
+        else if (session.canAdvance()) {
+            session.advance();
+        }
+        else {
+            result.waitTicks++;
+        }
+    }
+
+    session.writeInputPacket(packet);
+    peer.outgoing.send(now, packet.data(), packet.size());
+    if (session.writeSnapshotPacket(packet)) peer.outgoing.send(now, packet.data(), packet.size());
+}
+
+static void PlayMatch(const Scenario& scenario, const NetSessionSettings& settings, uint32_t seed, ScenarioResult& result) {
+    PongConfig config;
+    config.seed = seed;
+
+    NetImpairmentSettings link;
+    link.latencyMillis = scenario.rttMillis / 2;
+    link.jitterMillis = scenario.jitterMillis;
+    link.lossRate = scenario.lossRate;
+    link.seed = seed * 2 + 1;
+
+    // The client hears the welcome half a round trip after the host started
+    Peer host(config, true, settings, link, seed ^ 0x1234u, 0.0);
+    link.seed = seed * 2 + 2;
+    Peer client(config, false, settings, link, seed ^ 0x4321u, scenario.rttMillis / 2);
+
+    vector<uint8_t> packet;
+    double now = 0.0;
+    const uint32_t maxTicks = 60 * 60 * 10;
+    while (!(host.session.isOver() && client.session.isOver()) && now < maxTicks * 2 * FRAME_MILLIS) {
+        Frame(host, client, now, packet, result);
+        Frame(client, host, now, packet, result);
+        now += FRAME_MILLIS;
+    }
+
+    const Peer* peers[2] = { &host, &client };
+    for (const Peer* peer : peers) {
+        const NetSessionStats& stats = peer->session.stats();
+        result.packets += stats.packetsSent;
+        result.wireBytes += stats.bytesSent + stats.packetsSent * UDP_OVERHEAD;
+        result.snapshotBytes += stats.snapshotBytes;
+        result.rollbacks += stats.rollbacks;
+        result.resimulated += stats.resimulatedTicks;
+        if (stats.maxRollbackTicks > result.maxRollback) result.maxRollback = stats.maxRollbackTicks;
+        result.rollbackNanos += stats.rollbackNanos;
+        result.stalls += stats.timeSyncStalls;
+        result.desyncs += stats.desyncs;
+        result.ticks += peer->session.tick();
+    }
+    if (HashPongState(host.session.state()) != HashPongState(client.session.state())) result.mismatches++;
+}
+
+int main(int argc, char** argv) {
+    int matches = 20;
+    NetSessionSettings settings;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--matches") == 0 && hasValue) matches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--delay") == 0 && hasValue) settings.inputDelay = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-rollback") == 0 && hasValue) settings.maxRollback = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--matches N] [--delay TICKS] [--max-rollback TICKS]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (matches < 1) matches = 1;
+
+    const Scenario scenarios[] = {
+        { 0, 0, 0.0 }, { 50, 5, 0.0 }, { 100, 10, 0.0 }, { 100, 10, 0.05 }, { 150, 20, 0.02 }, { 200, 20, 0.10 }
+    };
+
+    printf("%d matches per row, input delay %d ticks, max rollback %d ticks\n\n", matches, settings.inputDelay, settings.maxRollback);
+    printf("%6s %6s %5s | %9s %7s %9s | %10s %8s %6s %11s %11s | %6s %6s %6s\n", "rtt", "jitter", "loss",
+        "KB/match", "kbit/s", "snap KB", "rollback/s", "resim/rb", "max", "ns/rb", "ns/tick", "wait%", "stalls", "desync");
+
+    int failures = 0;
+    for (const Scenario& scenario : scenarios) {
+        ScenarioResult result;
+        for (int m = 0; m < matches; m++) PlayMatch(scenario, settings, 1000u + (uint32_t)m * 7919u, result);
+
+        double ticksPerSide = result.ticks / 2.0;
+        double seconds = ticksPerSide / 60.0;
+        printf("%4.0fms %4.0fms %4.0f%% | %9.1f %7.1f %9.2f | %10.2f %8.2f %6u %11.0f %11.1f | %5.2f%% %6llu %6llu%s\n",
+            scenario.rttMillis, scenario.jitterMillis, scenario.lossRate * 100,
+            result.wireBytes / 1024.0 / matches, result.wireBytes * 8 / 1000.0 / seconds / 2,
+            result.snapshotBytes / 1024.0 / matches,
+            result.rollbacks / seconds / 2, result.rollbacks ? (double)result.resimulated / result.rollbacks : 0.0,
+            result.maxRollback, result.rollbacks ? (double)result.rollbackNanos / result.rollbacks : 0.0,
+            (double)result.rollbackNanos / result.ticks,
+            100.0 * result.waitTicks / result.ticks, (unsigned long long)result.stalls,
+            (unsigned long long)result.desyncs, result.mismatches ? "  MISMATCH" : "");
+        failures += result.mismatches;
+    }
+
+    printf("\nkbit/s is per direction. wait%% = ticks a side had to hold because the remote inputs were\n"
+        "more than max rollback ticks behind; at 0%% the local paddle always answers on the next tick.\n");
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+// Benchmark for the particle pool: CPU time per 60 Hz frame to update, remove the dead and
+// refill N particles, plus filling the vertex data DrawParticles hands to rlgl (positions and
+// colors of four corners per particle, into a buffer of the same layout). The GPU side needs
+// a window; run the game with --particle-stress for that.
+//
+// Usage: bench_particles [--frames F] [--max N]
+
+#include "particles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// One rlgl vertex: position, texture coordinate and color
+struct Vertex {
+    float x, y;
+    float u, v;
+    uint8_t r, g, b, a;
+};
+
+// Function to build the quads of every live particle, the CPU work of DrawParticles
+static void FillVertices(const ParticlePool& pool, vector<Vertex>& vertices) {
+    const float* x = pool.x();
+    const float* y = pool.y();
+    const float* sizes = pool.sizes();
+    const float* life = pool.life();
+    const float* invMaxLife = pool.invMaxLife();
+    const ParticleColor* colors = pool.colors();
+    Vertex* out = vertices.data();
+    for (size_t i = 0; i < pool.size(); i++) {
+        float left = life[i] * invMaxLife[i];
+        float half = sizes[i] * left * 0.5f + 0.5f;
+        ParticleColor c = colors[i];
+        uint8_t a = (uint8_t)(c.a * left);
+        *out++ = { x[i] - half, y[i] - half, 0.0f, 0.0f, c.r, c.g, c.b, a };
+        *out++ = { x[i] - half, y[i] + half, 0.0f, 1.0f, c.r, c.g, c.b, a };
+        *out++ = { x[i] + half, y[i] + half, 1.0f, 1.0f, c.r, c.g, c.b, a };
+        *out++ = { x[i] + half, y[i] - half, 1.0f, 0.0f, c.r, c.g, c.b, a };
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    size_t maxParticles = 1000000;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue) frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max") == 0 && hasValue) maxParticles = (size_t)strtoull(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "Usage: %s [--frames F] [--max N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames < 1) frames = 1;
+
+    const float dt = 1.0f / 60.0f;
+    printf("%d frames at 60 Hz, particles live 0.5-1.5 s and are refilled every frame\n", frames);
+    printf("%10s %14s %14s %14s %12s %10s\n", "particles", "update ms", "refill ms", "vertices ms", "ns/particle", "% of 16.7");
+    for (size_t count = 10000; count <= maxParticles; count *= 10) {
+        ParticlePool pool(count, 7);
+        vector<Vertex> vertices(count * 4);
+        ParticleBurst burst;
+        burst.minLife = 0.5f;
+        burst.maxLife = 1.5f;
+        burst.x = 396.0f;
+        burst.y = 267.0f;
+        burst.count = (int)count;
+        pool.emit(burst);
+
+        double updateNanos = 0.0, refillNanos = 0.0, vertexNanos = 0.0;
+        for (int f = 0; f < frames; f++) {
+            Clock::time_point start = Clock::now();
+            pool.update(dt, 200.0f, 0.5f);
+            Clock::time_point updated = Clock::now();
+            burst.count = (int)(count - pool.size());
+            burst.x = 200.0f + (f % 400);
+            pool.emit(burst);
+            Clock::time_point refilled = Clock::now();
+            FillVertices(pool, vertices);
+            Clock::time_point filled = Clock::now();
+            updateNanos += chrono::duration<double, nano>(updated - start).count();
+            refillNanos += chrono::duration<double, nano>(refilled - updated).count();
+            vertexNanos += chrono::duration<double, nano>(filled - refilled).count();
+        }
+
+        double total = (updateNanos + refillNanos + vertexNanos) / frames;
+        printf("%10zu %14.3f %14.3f %14.3f %12.2f %9.1f%%\n", count, updateNanos / frames / 1e6, refillNanos / frames / 1e6,
+            vertexNanos / frames / 1e6, total / count, 100.0 * total / 1e6 / 16.667);
+        if (pool.dropped() != 0) printf("(dropped %llu)\n", (unsigned long long)pool.dropped());
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Benchmark for the scope profiler: cost of a PROFILE_SCOPE while recording is off (what
+// release builds pay), while it is on, and on several threads at once, against the same loop
+// without a scope. Ends by exporting a Chrome trace of what was recorded.
+//
+// Usage: bench_profiler [--scopes N] [--threads T] [--trace FILE]
+
+#include "profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Some work for each scope to wrap, so the compiler can't drop the loop
+static volatile uint64_t sink = 0;
+
+static inline void Work(uint64_t& state) {
+    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+}
+
+static double LoopNanos(uint64_t scopes, bool scoped) {
+    uint64_t state = 88172645463325252ULL;
+    Clock::time_point start = Clock::now();
+    for (uint64_t i = 0; i < scopes; i++) {
+        if (scoped) {
+            PROFILE_SCOPE("bench scope");
+            Work(state);
+        }
+        else {
+            Work(state);
+        }
+    }
+    sink = sink + state;
+    return chrono::duration<double, nano>(Clock::now() - start).count() / scopes;
+}
+
+int main(int argc, char** argv) {
+    uint64_t scopes = 20000000;
+    int threadCount = 4;
+    const char* tracePath = "bench_profiler_trace.json";
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--scopes") == 0 && hasValue) scopes = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue) tracePath = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--scopes N] [--threads T] [--trace FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (scopes == 0) scopes = 1;
+    if (threadCount < 1) threadCount = 1;
+    SetProfilerThreadName("bench main");
+
+    double baseline = LoopNanos(scopes, false);
+    SetProfilerEnabled(false);
+    double disabled = LoopNanos(scopes, true);
+    SetProfilerEnabled(true);
+    double enabled = LoopNanos(scopes, true);
+
+    // Every thread writes its own ring, so they shouldn't slow each other down
+    vector<double> perThread(threadCount);
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&perThread, t, scopes]() {
+            char name[32];
+            snprintf(name, sizeof(name), "bench worker %d", t);
+            SetProfilerThreadName(name);
+            perThread[t] = LoopNanos(scopes, true);
+        });
+    }
+    for (thread& worker : threads) worker.join();
+    double threaded = 0.0;
+    for (double nanos : perThread) threaded += nanos / threadCount;
+    SetProfilerEnabled(false);
+
+    printf("%llu scopes per run\n", (unsigned long long)scopes);
+    printf("no scope          %6.2f ns/iteration\n", baseline);
+    printf("scope, off        %6.2f ns/iteration (+%.2f)\n", disabled, disabled - baseline);
+    printf("scope, recording  %6.2f ns/iteration (+%.2f)\n", enabled, enabled - baseline);
+    printf("scope, %d threads  %6.2f ns/iteration (+%.2f)\n", threadCount, threaded, threaded - baseline);
+
+    Clock::time_point start = Clock::now();
+    if (!ExportChromeTrace(tracePath)) {
+        fprintf(stderr, "Error: Could not write %s\n", tracePath);
+        return 1;
+    }
+    printf("trace of the last scopes of each thread written to %s in %.0f ms\n", tracePath,
+        chrono::duration<double, milli>(Clock::now() - start).count());
+    return 0;
+}
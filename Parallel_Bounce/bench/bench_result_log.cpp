@@ -0,0 +1,111 @@
+// Benchmark for logging a match result on the game thread: the time the caller is blocked
+// per record when writing synchronously (open, write, fsync, close like the old text log)
+// versus pushing into the background logger, plus the logger's own counters.
+//
+// Usage: bench_result_log [--records N] [--path FILE] [--policy never|batch|interval]
+
+#include "result_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Micros(Clock::duration duration) {
+    return chrono::duration<double, micro>(duration).count();
+}
+
+static void PrintLatencies(const char* name, vector<double>& micros) {
+    sort(micros.begin(), micros.end());
+    size_t n = micros.size();
+    printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", name, micros[n / 2], micros[n * 99 / 100],
+        micros[n * 999 / 1000], micros[n - 1]);
+}
+
+int main(int argc, char** argv) {
+    int recordCount = 2000;
+    const char* path = "bench_result_log.bin";
+    FsyncPolicy policy = FSYNC_INTERVAL;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--records") == 0 && hasValue) recordCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--path") == 0 && hasValue) path = argv[++i];
+        else if (strcmp(argv[i], "--policy") == 0 && hasValue) {
+            const char* name = argv[++i];
+            if (strcmp(name, "never") == 0) policy = FSYNC_NEVER;
+            else if (strcmp(name, "batch") == 0) policy = FSYNC_EVERY_BATCH;
+            else policy = FSYNC_INTERVAL;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--records N] [--path FILE] [--policy never|batch|interval]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (recordCount < 1) recordCount = 1;
+
+    ResultRecord record = MakeResultRecord(RESULT_MODE_MULTIPLAYER, "Player 1", "Player 2", 1736772820);
+    vector<double> micros(recordCount);
+    printf("%-12s %10s %10s %10s %10s   (caller blocked, us)\n", "logger", "p50", "p99", "p99.9", "max");
+
+    // The old way: every match end opens the file, writes, syncs and closes on the caller
+    remove(path);
+    for (int i = 0; i < recordCount; i++) {
+        Clock::time_point start = Clock::now();
+        ResultWriter writer(1);
+        if (writer.open(path)) {
+            writer.append(record);
+            writer.sync();
+        }
+        writer.close();
+        micros[i] = Micros(Clock::now() - start);
+    }
+    PrintLatencies("synchronous", micros);
+
+    // The background logger; records arrive in bursts like a busy game loop would produce
+    remove(path);
+    AsyncResultLog log;
+    ResultLogSettings settings;
+    settings.path = path;
+    settings.queueCapacity = (size_t)recordCount;
+    settings.fsyncPolicy = policy;
+    log.start(settings);
+
+    Clock::time_point total = Clock::now();
+    for (int i = 0; i < recordCount; i++) {
+        Clock::time_point start = Clock::now();
+        log.push(record);
+        micros[i] = Micros(Clock::now() - start);
+        if (i % 64 == 63) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    log.shutdown();
+    double totalMillis = Micros(Clock::now() - total) / 1000.0;
+    PrintLatencies("async push", micros);
+
+    ResultLogStats stats = log.stats();
+    printf("\nbackground: %llu written, %llu dropped, %llu failed writes, %llu batches, %llu fsyncs in %.1f ms\n",
+        (unsigned long long)stats.written, (unsigned long long)stats.dropped,
+        (unsigned long long)stats.failedWrites, (unsigned long long)stats.batches,
+        (unsigned long long)stats.syncs, totalMillis);
+    printf("queue depth max %llu, batch write avg %.1f us, max %llu us\n",
+        (unsigned long long)stats.maxDepth,
+        stats.batches ? (double)stats.totalWriteMicros / stats.batches : 0.0,
+        (unsigned long long)stats.maxWriteMicros);
+
+    ResultReader reader;
+    bool complete = reader.open(path) && reader.count() == (size_t)recordCount;
+    reader.close();
+    remove(path);
+    if (!complete) {
+        fprintf(stderr, "Error: the background logger lost records\n");
+        return 1;
+    }
+    return 0;
+}
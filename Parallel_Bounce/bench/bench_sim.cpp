@@ -0,0 +1,115 @@
+// Benchmark for the simulation step: ns per PongSim::step with swept and with discrete
+// collision, fed the inputs of recorded matches, and whole AI vs AI matches per second (step
+// plus both AIs). This is the workload the PGO build trains on and is measured with.
+//
+// Usage: bench_sim [--matches N] [--repeat R] [REPLAY.pbr...]
+//        Without replay files, N AI vs AI matches are recorded in memory first.
+
+#include "match_farm.h"
+#include "pong_ai.h"
+#include "replay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// One recorded match: the rules and every tick's inputs
+struct RecordedMatch {
+    PongConfig config;
+    vector<PongInputs> inputs;
+};
+
+// Keep results alive so the compiler can't drop the timed loops
+static volatile uint64_t sink;
+
+// Function to play an AI vs AI match and keep its inputs
+static RecordedMatch RecordMatch(uint32_t seed) {
+    RecordedMatch match;
+    match.config.seed = seed;
+    PongSim sim(match.config);
+    PongAI playerAI(AI_NORMAL, true, seed ^ 0xA5A5A5A5u);
+    PongAI opponentAI(AI_NORMAL, false, seed ^ 0x5A5A5A5Au);
+    while (!sim.isOver() && sim.state().tick < 60 * 60 * 10) {
+        PongInputs inputs = { playerAI.decide(sim.state(), match.config), opponentAI.decide(sim.state(), match.config) };
+        sim.step(inputs);
+        match.inputs.push_back(inputs);
+    }
+    return match;
+}
+
+// Function to re-simulate every match repeat times; returns ns per step
+static double StepNanos(const vector<RecordedMatch>& matches, int repeat, bool continuous) {
+    uint64_t steps = 0;
+    uint64_t hash = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+        for (const RecordedMatch& match : matches) {
+            PongConfig config = match.config;
+            config.continuousCollision = continuous;
+            PongSim sim(config);
+            for (const PongInputs& inputs : match.inputs) hash += sim.step(inputs);
+            hash += HashPongState(sim.state());
+            steps += match.inputs.size();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    sink = hash;
+    return steps ? 1e9 * seconds / steps : 0.0;
+}
+
+int main(int argc, char** argv) {
+    int matchCount = 200;
+    int repeat = 10;
+    vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--matches") == 0 && hasValue) matchCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = atoi(argv[++i]);
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else {
+            fprintf(stderr, "Usage: %s [--matches N] [--repeat R] [REPLAY.pbr...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (matchCount < 1) matchCount = 1;
+    if (repeat < 1) repeat = 1;
+
+    vector<RecordedMatch> matches;
+    for (const char* path : paths) {
+        Replay replay;
+        RecordedMatch match;
+        if (!replay.load(path) || !replay.decode(match.inputs)) {
+            fprintf(stderr, "Error: %s is not a replay file\n", path);
+            return 1;
+        }
+        match.config = replay.config();
+        matches.push_back(move(match));
+    }
+    if (matches.empty()) {
+        for (int i = 0; i < matchCount; i++) matches.push_back(RecordMatch(1 + (uint32_t)i * 2654435761u));
+    }
+
+    uint64_t ticks = 0;
+    for (const RecordedMatch& match : matches) ticks += match.inputs.size();
+    printf("%zu %s, %llu ticks, %d repeats\n", matches.size(), paths.empty() ? "AI vs AI matches" : "replays",
+        (unsigned long long)ticks, repeat);
+
+    printf("%-24s %12.2f ns/step\n", "step (swept)", StepNanos(matches, repeat, true));
+    printf("%-24s %12.2f ns/step\n", "step (discrete)", StepNanos(matches, repeat, false));
+
+    // Whole matches, both AIs deciding every tick
+    MatchSettings settings;
+    FarmStats stats;
+    int farmMatches = matchCount * repeat / 4 > 0 ? matchCount * repeat / 4 : 1;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < farmMatches; i++) PlayMatch(settings, (uint64_t)i, stats);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%-24s %12.0f matches/sec (%.2f ns/tick)\n", "AI vs AI match", farmMatches / seconds,
+        stats.totalTicks ? 1e9 * seconds / stats.totalTicks : 0.0);
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Benchmark for the simulation thread: emulates the game's 60 Hz render loop (draw work with
+// jitter, an occasional long frame, vsync) and compares the serial loop (60 Hz ticks stepped
+// by each frame) with the simulation thread (240 Hz ticks started early by each frame's inputs,
+// never waited for; the frame draws the state as of now, interpolated between the newest two
+// ticks or stepped on from the newest with the frame's keys).
+//
+// Reports, for inputs that change at random moments: time from the change to the first frame
+// handed to the display whose state includes it, how old the drawn state is at that point,
+// and how far match time fell behind wall time.
+//
+// --search-ai plays the opponent with MctsAI (2 ms a decision), as the game's --search-ai does:
+// inside the frame in the serial loop, on the simulation thread otherwise.
+//
+// Usage: bench_sim_thread [--seconds S] [--refresh HZ] [--draw MS] [--stall-every N] [--stall MS] [--search-ai]
+
+#include "sim_thread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct LoopSettings {
+    double seconds = 20.0;
+    double refreshHz = 60.0;        // Display the frames wait for (the game caps itself at 60 fps)
+    double drawMillis = 3.0;        // CPU time of a frame's drawing, +-50% jitter
+    int stallEvery = 120;           // Every Nth frame takes stallMillis more (0 = never)
+    double stallMillis = 40.0;
+    bool searchAI = false;
+};
+
+// When the player's key state changes, and to what, over the whole run
+struct InputScript {
+    vector<uint64_t> times;
+    vector<int8_t> moves;
+
+    // Function to get the input at time t and the index of the change it came from
+    int8_t at(uint64_t t, size_t& index) const {
+        while (index + 1 < times.size() && times[index + 1] <= t) index++;
+        return times.empty() || times[index] > t ? 0 : moves[index];
+    }
+};
+
+struct LoopResult {
+    LatencySamples inputToSubmit;
+    LatencySamples stateAge;
+    double matchSeconds = 0.0;
+    double wallSeconds = 0.0;
+    uint64_t frames = 0;
+    uint64_t predictedFrames = 0;       // Frames drawn past the newest tick (by over a quarter tick), stepped on from it
+};
+
+static InputScript MakeScript(uint64_t start, double seconds, uint32_t seed) {
+    InputScript script;
+    mt19937 rng(seed);
+    uniform_int_distribution<int> gap(20, 150);     // Milliseconds between key changes
+    uniform_int_distribution<int> move(-1, 1);
+    uint64_t t = start;
+    int8_t last = 0;
+    while (t < start + (uint64_t)(seconds * 1e9)) {
+        t += (uint64_t)gap(rng) * 1000000;
+        int8_t next;
+        do next = (int8_t)move(rng); while (next == last);
+        script.times.push_back(t);
+        script.moves.push_back(next);
+        last = next;
+    }
+    return script;
+}
+
+// Function to spend a frame's worth of CPU time, like DrawMatch does
+static void Draw(mt19937& rng, const LoopSettings& settings, uint64_t frame) {
+    uniform_real_distribution<double> jitter(0.5, 1.5);
+    double millis = settings.drawMillis * jitter(rng);
+    if (settings.stallEvery > 0 && frame % settings.stallEvery == (uint64_t)settings.stallEvery - 1) millis += settings.stallMillis;
+    uint64_t until = SimClockNanos() + (uint64_t)(millis * 1e6);
+    while (SimClockNanos() < until) {}
+}
+
+// Function to wait like EndDrawing does: until the next refresh after the 60 fps cap allows a
+// new frame (the refresh right after the previous frame's when the display is faster)
+static void WaitForVsync(uint64_t origin, uint64_t& lastSwap, const LoopSettings& settings) {
+    uint64_t refreshNanos = (uint64_t)(1e9 / settings.refreshHz);
+    uint64_t earliest = max(SimClockNanos(), lastSwap + 16666667 - refreshNanos / 2);
+    uint64_t next = origin + ((earliest - origin) / refreshNanos + 1) * refreshNanos;
+    lastSwap = next;
+    this_thread::sleep_until(chrono::steady_clock::time_point(chrono::nanoseconds(next)));
+}
+
+static PongConfig MatchConfig(float dt) {
+    PongConfig config;
+    config.maxHearts = 1000000;     // Keep the match going for the whole run
+    config.dt = dt;
+    return config;
+}
+
+// Function to get the search AI for --search-ai, on all cores but one like the game's
+static unique_ptr<MctsAI> SearchAi(const LoopSettings& settings, uint32_t seed) {
+    if (!settings.searchAI) return nullptr;
+    MctsSettings search;
+    search.threads = max(1, (int)thread::hardware_concurrency() - 1);
+    return unique_ptr<MctsAI>(new MctsAI(search, false, seed));
+}
+
+static LoopResult RunSerial(const LoopSettings& settings, uint32_t seed) {
+    PongConfig config = MatchConfig(1.0f / 60.0f);
+    PongSim sim(config);
+    PongAI ai(AI_NORMAL, false, seed);
+    unique_ptr<MctsAI> search = SearchAi(settings, seed);
+    mt19937 rng(seed);
+    LoopResult result;
+
+    uint64_t origin = SimClockNanos();
+    InputScript script = MakeScript(origin, settings.seconds, seed);
+    size_t change = 0;
+    size_t measured = 0;            // Changes before this one have been measured
+    uint64_t lastSwap = origin;
+    uint64_t lastFrame = origin;
+    float accumulator = 0.0f;
+    uint64_t ticks = 0;
+
+    while (SimClockNanos() < origin + (uint64_t)(settings.seconds * 1e9)) {
+        uint64_t frameStart = SimClockNanos();
+        PongInputs inputs = { script.at(frameStart, change), 0 };
+        size_t readChange = change;
+
+        accumulator += (frameStart - lastFrame) / 1e9f;
+        lastFrame = frameStart;
+        if (accumulator > 0.25f) accumulator = 0.25f;
+        bool stepped = false;
+        while (accumulator >= config.dt) {
+            inputs.opponent = search ? search->decide(sim.state(), config) : ai.decide(sim.state(), config);
+            sim.step(inputs);
+            accumulator -= config.dt;
+            ticks++;
+            stepped = true;
+        }
+        uint64_t simulatedNanos = SimClockNanos() - (uint64_t)(accumulator * 1e9f);
+
+        Draw(rng, settings, result.frames);
+        uint64_t submit = SimClockNanos();
+        if (stepped) {
+            for (; measured <= readChange && measured < script.times.size(); measured++) {
+                if (script.times[measured] <= frameStart) result.inputToSubmit.add((submit - script.times[measured]) / 1000.0);
+                else break;
+            }
+        }
+        result.stateAge.add((submit - simulatedNanos) / 1000.0);
+        result.frames++;
+        WaitForVsync(origin, lastSwap, settings);
+    }
+
+    result.wallSeconds = (SimClockNanos() - origin) / 1e9;
+    result.matchSeconds = ticks * config.dt;
+    return result;
+}
+
+static LoopResult RunThreaded(const LoopSettings& settings, uint32_t seed, SimThreadStats& stats) {
+    PongConfig config = MatchConfig(1.0f / 240.0f);
+    AiSettings aiSettings = AiSettingsFor(AI_NORMAL);
+    aiSettings.reactionTicks *= 4;
+    PongAI ai(aiSettings, false, seed);
+    unique_ptr<MctsAI> search = SearchAi(settings, seed);
+    SimThread sim(config, &ai, nullptr, search.get());
+    const uint64_t tickNanos = sim.tickNanos();
+    mt19937 rng(seed);
+    LoopResult result;
+
+    uint64_t origin = SimClockNanos();
+    InputScript script = MakeScript(origin, settings.seconds, seed);
+    size_t change = 0;
+    size_t measured = 0;
+    uint64_t lastSwap = origin;
+    int8_t lastMove = 0;
+    uint32_t pendingSequence = 0;
+    size_t pendingChange = 0;       // Newest change included in pendingSequence
+    sim.start();
+
+    while (SimClockNanos() < origin + (uint64_t)(settings.seconds * 1e9)) {
+        uint64_t frameStart = SimClockNanos();
+        PongInputs inputs = { script.at(frameStart, change), 0 };
+        uint32_t sequence = sim.setInputs(inputs);
+        if (inputs.player != lastMove) {
+            pendingSequence = sequence;
+            pendingChange = change;
+            lastMove = inputs.player;
+        }
+
+        // Like MatchScene: no waiting, the state as of now with the frame's keys
+        const SimSnapshot& snapshot = sim.latest();
+        float alpha = SnapshotAlpha(snapshot, SimClockNanos(), tickNanos);
+        PongInputs moves = { inputs.player, LastPaddleMoves(snapshot.previous, snapshot.current).opponent };
+        PongState shown = InterpolatePongState(snapshot.previous, snapshot.current, alpha, config, moves);
+        (void)shown;
+        if (alpha > 1.25f) result.predictedFrames++;
+        double shownNanos = (double)snapshot.currentNanos + (alpha - 1.0) * tickNanos;
+        bool includesChange = alpha > 1.0f || snapshot.inputSequence >= pendingSequence;
+
+        Draw(rng, settings, result.frames);
+        uint64_t submit = SimClockNanos();
+        if (pendingSequence != 0 && includesChange) {
+            for (; measured <= pendingChange && measured < script.times.size(); measured++) {
+                result.inputToSubmit.add((submit - script.times[measured]) / 1000.0);
+            }
+            pendingSequence = 0;
+        }
+        result.stateAge.add(((double)submit - shownNanos) / 1000.0);
+        result.frames++;
+        WaitForVsync(origin, lastSwap, settings);
+    }
+
+    sim.stop();
+    stats = sim.stats();
+    result.wallSeconds = (SimClockNanos() - origin) / 1e9;
+    result.matchSeconds = stats.ticks * config.dt;
+    return result;
+}
+
+static void PrintResult(const char* name, const LoopResult& result) {
+    printf("%-22s %8.1f %8.1f %8.1f %8.1f   %6.2f%%\n", name,
+        result.inputToSubmit.percentile(50) / 1000.0, result.inputToSubmit.percentile(99) / 1000.0,
+        result.stateAge.percentile(50) / 1000.0, result.stateAge.percentile(99) / 1000.0,
+        100.0 * (result.wallSeconds - result.matchSeconds) / result.wallSeconds);
+}
+
+int main(int argc, char** argv) {
+    LoopSettings settings;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) settings.seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--refresh") == 0 && hasValue) settings.refreshHz = atof(argv[++i]);
+        else if (strcmp(argv[i], "--draw") == 0 && hasValue) settings.drawMillis = atof(argv[++i]);
+        else if (strcmp(argv[i], "--stall-every") == 0 && hasValue) settings.stallEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stall") == 0 && hasValue) settings.stallMillis = atof(argv[++i]);
+        else if (strcmp(argv[i], "--search-ai") == 0) settings.searchAI = true;
+        else {
+            fprintf(stderr, "Usage: %s [--seconds S] [--refresh HZ] [--draw MS] [--stall-every N] [--stall MS] [--search-ai]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%.0f s per loop, %.0f Hz display, %.1f ms draw, %.0f ms stall every %d frames, %s AI\n",
+        settings.seconds, settings.refreshHz, settings.drawMillis, settings.stallMillis, settings.stallEvery,
+        settings.searchAI ? "search" : "normal");
+    printf("%-22s %8s %8s %8s %8s   %7s\n", "", "input", "p99", "age", "p99", "behind");
+    printf("%-22s %8s %8s %8s %8s\n", "", "p50 ms", "ms", "p50 ms", "ms");
+
+    LoopResult serial = RunSerial(settings, 1);
+    PrintResult("serial, 60 Hz ticks", serial);
+    SimThreadStats stats;
+    LoopResult threaded = RunThreaded(settings, 1, stats);
+    PrintResult("thread, 240 Hz ticks", threaded);
+
+    printf("input changes measured: %d serial, %d threaded; %llu frames serial, %llu threaded\n",
+        (int)serial.inputToSubmit.count(), (int)threaded.inputToSubmit.count(),
+        (unsigned long long)serial.frames, (unsigned long long)threaded.frames);
+    printf("simulation thread: %llu ticks, %llu caught up late (max %.1f ms), %llu dropped, %llu frames predicted\n",
+        (unsigned long long)stats.ticks, (unsigned long long)stats.lateTicks, stats.maxLateNanos / 1e6,
+        (unsigned long long)stats.droppedTicks, (unsigned long long)threaded.predictedFrames);
+    return 0;
+}
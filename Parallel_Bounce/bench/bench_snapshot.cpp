@@ -0,0 +1,143 @@
+// Benchmark for match snapshots: ns to capture one, restore it and fork a running match, the
+// cost of a look-ahead (fork, then play each paddle move a second ahead), and how long a
+// checkpoint takes to reach the disk, directly and through the background writer.
+//
+// Usage: bench_snapshot [--count N] [--checkpoints C] [--path FILE]
+
+#include "match_snapshot.h"
+#include "sim_thread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Keep results alive so the compiler can't drop the timed loops
+static volatile uint64_t sink;
+
+static double NanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int count = 1000000;
+    int checkpoints = 200;
+    string path = "bench_checkpoint.pbs";
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--count") == 0 && hasValue) count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--checkpoints") == 0 && hasValue) checkpoints = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--path") == 0 && hasValue) path = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--count N] [--checkpoints C] [--path FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count < 1) count = 1;
+    if (checkpoints < 1) checkpoints = 1;
+
+    // A match some way in, so the snapshots hold a real rally
+    PongConfig config;
+    config.seed = 7;
+    PongSim sim(config);
+    PongAI ai(AI_NORMAL, false, 7);
+    PongAI playerAI(AI_NORMAL, true, 11);
+    for (int t = 0; t < 600 && !sim.isOver(); t++) {
+        PongInputs inputs = { playerAI.decide(sim.state(), config), ai.decide(sim.state(), config) };
+        sim.step(inputs);
+    }
+    PongAIState aiState = ai.save();
+    printf("snapshot %zu bytes (state %zu, AI %zu)\n", sizeof(MatchSnapshot), sizeof(PongState), sizeof(PongAIState));
+    printf("%-28s %12s\n", "operation", "ns");
+
+    uint64_t hash = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        MatchSnapshot snapshot = CaptureMatch(config, sim.state(), &aiState, true, "Player 1", "AI");
+        hash += snapshot.checksum;
+    }
+    printf("%-28s %12.1f\n", "capture (with checksum)", NanosSince(start) / count);
+
+    // A few different snapshots, so the restores can't be folded into one
+    vector<MatchSnapshot> snapshots;
+    PongSim later(sim);
+    for (int i = 0; i < 64; i++) {
+        later.step({ 1, -1 });
+        snapshots.push_back(CaptureMatch(config, later.state(), &aiState, true, "Player 1", "AI"));
+    }
+    MatchSnapshot snapshot = CaptureMatch(config, sim.state(), &aiState, true, "Player 1", "AI");
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        MatchBranch branch(snapshots[i & 63]);
+        hash += HashPongState(branch.state());
+    }
+    printf("%-28s %12.1f\n", "restore (+ state hash)", NanosSince(start) / count);
+
+    MatchBranch live(sim, &ai);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        MatchBranch branch = live.fork();
+        hash += branch.step({ (int8_t)(i % 3 - 1), 0 });
+    }
+    printf("%-28s %12.1f\n", "fork + 1 step", NanosSince(start) / count);
+
+    // Look-ahead as an AI or a rollback would do it: each of the three moves, held for a second
+    int lookAheads = count / 100 > 0 ? count / 100 : 1;
+    int horizon = (int)lround(1.0f / config.dt);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < lookAheads; i++) {
+        for (int8_t move = -1; move <= 1; move++) {
+            MatchBranch branch = live.fork();
+            for (int t = 0; t < horizon && !branch.sim().isOver(); t++) branch.step({ move, 0 });
+            hash += HashPongState(branch.state());
+        }
+    }
+    char name[48];
+    snprintf(name, sizeof(name), "look-ahead 3 x %d ticks", horizon);
+    printf("%-28s %12.1f\n", name, NanosSince(start) / lookAheads);
+
+    // Checkpoints: direct writes (fsync included), then what the frame pays with the writer
+    vector<double> writes;
+    for (int i = 0; i < checkpoints; i++) {
+        snapshot.savedAt = i;
+        SealSnapshot(snapshot);
+        auto writeStart = chrono::steady_clock::now();
+        if (!SaveCheckpoint(path.c_str(), snapshot)) {
+            fprintf(stderr, "Error: can't write %s\n", path.c_str());
+            return 1;
+        }
+        writes.push_back(NanosSince(writeStart) / 1000.0);
+    }
+    sort(writes.begin(), writes.end());
+    MatchSnapshot loaded;
+    if (!LoadCheckpoint(path.c_str(), loaded) || memcmp(&loaded, &snapshot, sizeof(snapshot)) != 0) {
+        fprintf(stderr, "Error: %s doesn't read back\n", path.c_str());
+        return 1;
+    }
+    printf("\n%-28s %12s %12s\n", "checkpoint to disk", "median us", "p99 us");
+    printf("%-28s %12.1f %12.1f\n", "SaveCheckpoint", writes[writes.size() / 2], writes[writes.size() * 99 / 100]);
+
+    LatencySamples submits;
+    {
+        CheckpointWriter writer(path);
+        for (int i = 0; i < checkpoints; i++) {
+            snapshot.savedAt = i;
+            SealSnapshot(snapshot);
+            auto submitStart = chrono::steady_clock::now();
+            writer.submit(snapshot);
+            submits.add(NanosSince(submitStart) / 1000.0);
+        }
+        writer.flush();
+        printf("%-28s %12.1f %12.1f   (%llu of %d written, newer ones replaced waiting ones)\n", "CheckpointWriter::submit",
+            submits.percentile(50), submits.percentile(99), (unsigned long long)writer.written(), checkpoints);
+        writer.discard();
+    }
+    sink = hash;
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Benchmark for the player statistics index: building it from a large history, answering
+// "top 10" while results keep coming in, and a restart that loads the saved index and only
+// catches up on the tail of the result file.
+//
+// Usage: bench_stats [--records N] [--players P] [--tail T]
+
+#include "player_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Millis(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Function to make a synthetic match between two of playerCount players
+static ResultRecord RandomResult(uint64_t& rng, int playerCount, int64_t timestamp) {
+    rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+    int winner = (int)(rng % (uint64_t)playerCount);
+    int loser = (int)((rng >> 32) % (uint64_t)playerCount);
+    if (loser == winner) loser = (loser + 1) % playerCount;
+    // Lower numbered players win a bit more often, so the ranking has a clear top
+    if (winner > loser && (rng >> 20) % 4 == 0) swap(winner, loser);
+    return MakeResultRecord((uint8_t)(rng >> 60) % RESULT_MODE_COUNT, "Player " + to_string(winner),
+        "Player " + to_string(loser), timestamp);
+}
+
+int main(int argc, char** argv) {
+    size_t recordCount = 2000000;
+    int playerCount = 100000;
+    size_t tailCount = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--records") == 0 && hasValue) recordCount = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--players") == 0 && hasValue) playerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tail") == 0 && hasValue) tailCount = strtoull(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "Usage: %s [--records N] [--players P] [--tail T]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (playerCount < 2) playerCount = 2;
+    if (tailCount > recordCount) tailCount = recordCount;
+
+    const char* resultPath = "bench_stats_results.bin";
+    const char* indexPath = "bench_stats_index.bin";
+    remove(resultPath);
+    remove(indexPath);
+
+    // The history, minus a tail that is logged after the index was saved
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+    vector<ResultRecord> records(recordCount);
+    for (size_t i = 0; i < recordCount; i++) records[i] = RandomResult(rng, playerCount, 1700000000 + (int64_t)i);
+    {
+        ResultWriter writer(4096);
+        if (!writer.open(resultPath)) {
+            fprintf(stderr, "Error: Could not create %s\n", resultPath);
+            return 1;
+        }
+        writer.append(records.data(), recordCount - tailCount);
+    }
+
+    Clock::time_point start = Clock::now();
+    PlayerStatsIndex index;
+    index.apply(records.data(), recordCount - tailCount);
+    double buildMillis = Millis(start);
+    printf("build:    %zu records, %zu players in %.1f ms (%.2f M records/s)\n", recordCount - tailCount,
+        index.playerCount(), buildMillis, (recordCount - tailCount) / buildMillis / 1000.0);
+
+    start = Clock::now();
+    index.save(indexPath);
+    printf("save:     %.1f ms\n", Millis(start));
+
+    // Live play: each result updates the index, and the leaderboard is asked for in between
+    vector<const PlayerStats*> top;
+    vector<double> topMicros;
+    {
+        ResultWriter writer(4096);
+        writer.open(resultPath);
+        writer.append(records.data() + recordCount - tailCount, tailCount);
+    }
+    for (size_t i = recordCount - tailCount; i < recordCount; i++) {
+        index.apply(records[i]);
+        Clock::time_point queryStart = Clock::now();
+        index.top(10, top);
+        topMicros.push_back(chrono::duration<double, micro>(Clock::now() - queryStart).count());
+    }
+    if (!topMicros.empty()) {
+        sort(topMicros.begin(), topMicros.end());
+        printf("top 10:   p50 %.2f us, p99 %.2f us, max %.2f us over %zu queries\n", topMicros[topMicros.size() / 2],
+            topMicros[topMicros.size() * 99 / 100], topMicros.back(), topMicros.size());
+    }
+
+    // Restart: saved index + catch up on the tail vs rebuilding from the whole file
+    start = Clock::now();
+    PlayerStatsIndex restarted;
+    restarted.load(indexPath, resultPath);
+    printf("restart:  load + %zu record tail in %.1f ms\n", tailCount, Millis(start));
+
+    remove(indexPath);
+    start = Clock::now();
+    PlayerStatsIndex rebuilt;
+    rebuilt.load(indexPath, resultPath);
+    printf("rebuild:  full scan in %.1f ms\n", Millis(start));
+
+    // All three must agree
+    vector<const PlayerStats*> restartedTop, rebuiltTop;
+    index.top(10, top);
+    restarted.top(10, restartedTop);
+    rebuilt.top(10, rebuiltTop);
+    bool same = restarted.recordsApplied() == recordCount && rebuilt.recordsApplied() == recordCount &&
+        top.size() == restartedTop.size() && top.size() == rebuiltTop.size();
+    for (size_t i = 0; same && i < top.size(); i++) {
+        same = top[i]->name == restartedTop[i]->name && top[i]->name == rebuiltTop[i]->name &&
+            top[i]->wins == rebuiltTop[i]->wins && top[i]->streak == rebuiltTop[i]->streak &&
+            top[i]->streak == restartedTop[i]->streak;
+    }
+
+    printf("\n%-4s %-16s %8s %8s %8s %8s\n", "#", "player", "wins", "losses", "streak", "best");
+    for (size_t i = 0; i < top.size(); i++) {
+        printf("%-4zu %-16s %8u %8u %8d %8u\n", i + 1, top[i]->name.c_str(), top[i]->wins, top[i]->losses,
+            top[i]->streak, top[i]->bestStreak);
+    }
+
+    remove(resultPath);
+    if (!same) {
+        fprintf(stderr, "Error: restarted or rebuilt index differs from the live one\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,435 @@
+#include "asset_manager.h"
+
+#include "metrics.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+// Function to read and decode an image file as RGBA8, scaled down to fit the request's box.
+// Runs on the loader thread (raylib's image functions don't touch the GPU).
+static Image DecodeImage(const AssetRequest& request, int& fileWidth, int& fileHeight) {
+    Image image = LoadImage(request.path.c_str());
+    if (image.data == nullptr) return image;
+
+    fileWidth = image.width;
+    fileHeight = image.height;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    if (request.fitWidth > 0 && request.fitHeight > 0) {
+        Rectangle fit = FitRectangle((float)image.width, (float)image.height,
+            { 0.0f, 0.0f, (float)request.fitWidth, (float)request.fitHeight });
+        int width = max(1, (int)(fit.width + 0.5f));
+        int height = max(1, (int)(fit.height + 0.5f));
+        if (width < image.width) ImageResize(&image, width, height);
+    }
+    return image;
+}
+
+Rectangle FitRectangle(float width, float height, Rectangle box) {
+    if (width <= 0.0f || height <= 0.0f) return box;
+    float scale = min(box.width / width, box.height / height);
+    float fitWidth = width * scale;
+    float fitHeight = height * scale;
+    return { box.x + (box.width - fitWidth) / 2.0f, box.y + (box.height - fitHeight) / 2.0f, fitWidth, fitHeight };
+}
+
+// Function to copy an RGBA8 image into dest with its top left at (x, y), repeating the edge
+// pixels padding times around it, so filtering at the border never samples a neighbour
+static void BlitPadded(const Image& image, Color* dest, int destWidth, int x, int y, int padding) {
+    const Color* source = (const Color*)image.data;
+    for (int row = -padding; row < image.height + padding; row++) {
+        int sourceRow = row < 0 ? 0 : (row >= image.height ? image.height - 1 : row);
+        const Color* from = source + sourceRow * image.width;
+        Color* to = dest + (y + row) * destWidth + x;
+        for (int col = -padding; col < 0; col++) to[col] = from[0];
+        memcpy(to, from, image.width * sizeof(Color));
+        for (int col = image.width; col < image.width + padding; col++) to[col] = from[image.width - 1];
+    }
+}
+
+AssetHandle::AssetHandle(AssetManager* manager, int index) : manager_(manager), index_(index) {
+    manager_->addRef(index_);
+}
+
+AssetHandle::AssetHandle(const AssetHandle& other) : manager_(other.manager_), index_(other.index_) {
+    if (manager_) manager_->addRef(index_);
+}
+
+AssetHandle& AssetHandle::operator=(const AssetHandle& other) {
+    if (this == &other) return *this;
+    if (other.manager_) other.manager_->addRef(other.index_);
+    reset();
+    manager_ = other.manager_;
+    index_ = other.index_;
+    return *this;
+}
+
+AssetHandle::~AssetHandle() {
+    reset();
+}
+
+void AssetHandle::reset() {
+    if (manager_) manager_->release(index_);
+    manager_ = nullptr;
+    index_ = -1;
+}
+
+bool AssetHandle::valid() const {
+    return manager_ && manager_->entries_[index_].loaded;
+}
+
+Texture2D AssetHandle::texture() const {
+    if (!valid()) return Texture2D{};
+    const AssetManager::Entry& entry = manager_->entries_[index_];
+    return entry.packed ? manager_->atlas_ : entry.texture;
+}
+
+Rectangle AssetHandle::source() const {
+    if (!valid()) return Rectangle{};
+    return manager_->entries_[index_].source;
+}
+
+AssetManager::~AssetManager() {
+    // Textures belong to the window and must go in shutdown(); only the thread is ours to stop
+    stopLoader();
+}
+
+void AssetManager::start(const vector<AssetRequest>& preload, const AssetSettings& settings) {
+    settings_ = settings;
+    startTime_ = GetTime();
+    preloadCount_ = (int)preload.size();
+
+    for (const AssetRequest& request : preload) {
+        Entry entry;
+        entry.request = request;
+        entry.preloaded = true;
+        entries_.push_back(entry);
+    }
+
+    stopping_ = false;
+    loader_ = thread(&AssetManager::loaderLoop, this);
+    for (int i = 0; i < preloadCount_; i++) queueDecode(i);
+}
+
+void AssetManager::queueDecode(int entry) {
+    entries_[entry].decoding = true;
+    {
+        lock_guard<mutex> lock(mutex_);
+        decodeQueue_.push_back({ entry, entries_[entry].request, !ready_ });
+    }
+    wake_.notify_one();
+}
+
+void AssetManager::loaderLoop() {
+    SetProfilerThreadName("asset loader");
+    for (;;) {
+        DecodeJob job;
+        {
+            unique_lock<mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !decodeQueue_.empty(); });
+            if (stopping_) return;
+            job = decodeQueue_.front();
+            decodeQueue_.pop_front();
+        }
+
+        PROFILE_SCOPE("decode image");
+        auto begin = chrono::steady_clock::now();
+        Decoded decoded;
+        decoded.entry = job.entry;
+        decoded.modTime = GetFileModTime(job.request.path.c_str());
+        decoded.fileWidth = 0;
+        decoded.fileHeight = 0;
+        decoded.image = DecodeImage(job.request, decoded.fileWidth, decoded.fileHeight);
+        decoded.millis = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+        lock_guard<mutex> lock(mutex_);
+        decoded_.push_back(decoded);
+        if (job.preload) decodedCount_++;
+    }
+}
+
+void AssetManager::stopLoader() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (loader_.joinable()) loader_.join();
+}
+
+float AssetManager::progress() const {
+    if (preloadCount_ == 0) return 1.0f;
+    return (float)decodedCount_.load() / preloadCount_;
+}
+
+bool AssetManager::update() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        uploading_.swap(decoded_);
+    }
+    for (Decoded& decoded : uploading_) upload(decoded);
+    uploading_.clear();
+
+    if (!ready_ && preloadDone_ == preloadCount_) finishPreload();
+
+    // Look for edited files, a few times a second (a stat per file, so keep it off most frames)
+    if (ready_ && settings_.hotReload && GetTime() - lastPoll_ >= settings_.pollSeconds) {
+        lastPoll_ = GetTime();
+        for (size_t i = 0; i < entries_.size(); i++) {
+            Entry& entry = entries_[i];
+            if (!entry.loaded || entry.decoding) continue;
+            long modTime = GetFileModTime(entry.request.path.c_str());
+            if (modTime == entry.modTime) continue;
+            entry.modTime = modTime;    // A file that fails to decode isn't tried again until it changes
+            queueDecode((int)i);
+        }
+    }
+    return ready_;
+}
+
+static MetricHistogram& loadSeconds = Metrics().histogram("pb_asset_load_seconds",
+    "Time to read and decode one image (on a loader thread)", MetricSecondsBuckets());
+static MetricCounter& loadFailures = Metrics().counter("pb_asset_load_failures_total", "Images that failed to load");
+
+void AssetManager::upload(Decoded& decoded) {
+    Entry& entry = entries_[decoded.entry];
+    entry.decoding = false;
+    bool preloading = !ready_ && entry.preloaded;
+    if (preloading) preloadDone_++;
+
+    if (decoded.image.data == nullptr) {
+        // During a reload this is usually an editor still writing the file: keep the old pixels
+        TraceLog(LOG_WARNING, "ASSETS: Failed to load '%s'", entry.request.path.c_str());
+        loadFailures.add();
+        return;
+    }
+
+    loadSeconds.observe(decoded.millis / 1000.0);
+    double begin = GetTime();
+    entry.modTime = decoded.modTime;
+    entry.fileWidth = decoded.fileWidth;
+    entry.fileHeight = decoded.fileHeight;
+
+    if (preloading) {
+        report_.decodeMillis += decoded.millis;
+        if (decoded.image.width <= settings_.maxPackedSize && decoded.image.height <= settings_.maxPackedSize) {
+            // Packed together in finishPreload()
+            entry.packed = true;
+            entry.pixels = decoded.image;
+        }
+        else {
+            uploadStandalone(entry, decoded.image);
+            UnloadImage(decoded.image);
+        }
+        report_.uploadMillis += (GetTime() - begin) * 1000.0;
+        return;
+    }
+
+    // Reload of a file that changed on disk
+    if (!entry.loaded && !entry.packed) {
+        UnloadImage(decoded.image);    // Its last handle went away while it was decoding
+        return;
+    }
+    if (entry.packed) {
+        bool sameSize = decoded.image.width == entry.pixels.width && decoded.image.height == entry.pixels.height;
+        UnloadImage(entry.pixels);
+        entry.pixels = decoded.image;
+        if (sameSize) {
+            // Overwrite the image's region of the atlas, padding included
+            int padding = settings_.padding;
+            int width = entry.pixels.width + 2 * padding;
+            int height = entry.pixels.height + 2 * padding;
+            vector<Color> region(width * height);
+            BlitPadded(entry.pixels, region.data(), width, padding, padding, padding);
+            UpdateTextureRec(atlas_, { entry.source.x - padding, entry.source.y - padding, (float)width, (float)height }, region.data());
+        }
+        else {
+            packAtlas();
+        }
+    }
+    else {
+        if (entry.loaded && entry.texture.width == decoded.image.width && entry.texture.height == decoded.image.height) {
+            UpdateTexture(entry.texture, decoded.image.data);
+        }
+        else {
+            if (entry.loaded) UnloadTexture(entry.texture);
+            uploadStandalone(entry, decoded.image);
+        }
+        UnloadImage(decoded.image);
+    }
+
+    report_.reloads++;
+    updateReport();
+    TraceLog(LOG_INFO, "ASSETS: Reloaded '%s' (%.1f ms)", entry.request.path.c_str(), decoded.millis + (GetTime() - begin) * 1000.0);
+}
+
+void AssetManager::uploadStandalone(Entry& entry, const Image& image) {
+    entry.packed = false;
+    entry.texture = LoadTextureFromImage(image);
+    entry.source = { 0.0f, 0.0f, (float)image.width, (float)image.height };
+    entry.loaded = entry.texture.id != 0;
+}
+
+void AssetManager::finishPreload() {
+    double begin = GetTime();
+    packAtlas();
+    report_.uploadMillis += (GetTime() - begin) * 1000.0;
+
+    ready_ = true;
+    lastPoll_ = GetTime();
+    report_.readyMillis = (GetTime() - startTime_) * 1000.0;
+    updateReport();
+}
+
+// Shelf packing: tallest images first, left to right, a new shelf when the row is full. The
+// atlas is as tall as the shelves need; for a handful of UI images that wastes little.
+void AssetManager::packAtlas() {
+    vector<int> order;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (entries_[i].packed && entries_[i].pixels.data != nullptr) order.push_back((int)i);
+    }
+    if (atlas_.id != 0) {
+        UnloadTexture(atlas_);
+        atlas_ = Texture2D{};
+    }
+    if (order.empty()) return;
+
+    sort(order.begin(), order.end(), [this](int a, int b) {
+        const Image& imageA = entries_[a].pixels;
+        const Image& imageB = entries_[b].pixels;
+        if (imageA.height != imageB.height) return imageA.height > imageB.height;
+        return imageA.width > imageB.width;
+    });
+
+    const int padding = settings_.padding;
+    // No wider than one row of everything, no narrower than the widest image
+    int rowWidth = 0;
+    int widest = 0;
+    for (int index : order) {
+        rowWidth += entries_[index].pixels.width + 2 * padding;
+        widest = max(widest, entries_[index].pixels.width + 2 * padding);
+    }
+    int atlasWidth = max(widest, min(settings_.atlasWidth, rowWidth));
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    for (int index : order) {
+        Entry& entry = entries_[index];
+        int cellWidth = entry.pixels.width + 2 * padding;
+        int cellHeight = entry.pixels.height + 2 * padding;
+        if (x + cellWidth > atlasWidth) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        entry.source = { (float)(x + padding), (float)(y + padding), (float)entry.pixels.width, (float)entry.pixels.height };
+        x += cellWidth;
+        shelfHeight = max(shelfHeight, cellHeight);
+    }
+
+    Image atlas = GenImageColor(atlasWidth, y + shelfHeight, BLANK);
+    for (int index : order) {
+        Entry& entry = entries_[index];
+        BlitPadded(entry.pixels, (Color*)atlas.data, atlas.width, (int)entry.source.x, (int)entry.source.y, padding);
+    }
+    atlas_ = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+
+    for (int index : order) {
+        Entry& entry = entries_[index];
+        entry.loaded = atlas_.id != 0;
+        // Without hot reload the atlas is never rebuilt, so the CPU copies can go
+        if (!settings_.hotReload) {
+            UnloadImage(entry.pixels);
+            entry.pixels = Image{};
+        }
+    }
+}
+
+void AssetManager::updateReport() {
+    report_.images = 0;
+    report_.packed = 0;
+    report_.standalone = 0;
+    report_.textureBytes = 0;
+    report_.unpackedBytes = 0;
+    for (const Entry& entry : entries_) {
+        if (!entry.loaded) continue;
+        report_.images++;
+        if (entry.packed) report_.packed++;
+        else {
+            report_.standalone++;
+            report_.textureBytes += (uint64_t)entry.texture.width * entry.texture.height * 4;
+        }
+        report_.unpackedBytes += (uint64_t)entry.fileWidth * entry.fileHeight * 4;
+    }
+    report_.atlasWidth = atlas_.width;
+    report_.atlasHeight = atlas_.height;
+    report_.textureBytes += (uint64_t)atlas_.width * atlas_.height * 4;
+}
+
+int AssetManager::findEntry(const string& path) const {
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (entries_[i].request.path == path) return (int)i;
+    }
+    return -1;
+}
+
+AssetHandle AssetManager::acquire(const string& path) {
+    int index = findEntry(path);
+    if (index < 0) {
+        Entry entry;
+        entry.request.path = path;
+        entries_.push_back(entry);
+        index = (int)entries_.size() - 1;
+    }
+
+    // Not preloaded and not on the GPU (never loaded, or its last handle went away): load it now
+    Entry& entry = entries_[index];
+    if (!entry.loaded && !entry.preloaded && !entry.decoding) {
+        entry.modTime = GetFileModTime(path.c_str());
+        Image image = DecodeImage(entry.request, entry.fileWidth, entry.fileHeight);
+        if (image.data == nullptr) {
+            TraceLog(LOG_WARNING, "ASSETS: Failed to load '%s'", path.c_str());
+            return AssetHandle();
+        }
+        uploadStandalone(entry, image);
+        UnloadImage(image);
+        updateReport();
+    }
+    return AssetHandle(this, index);
+}
+
+void AssetManager::addRef(int entry) {
+    entries_[entry].refs++;
+}
+
+void AssetManager::release(int entry) {
+    Entry& released = entries_[entry];
+    if (--released.refs > 0 || released.preloaded || released.packed || !released.loaded) return;
+    UnloadTexture(released.texture);
+    released.texture = Texture2D{};
+    released.loaded = false;
+    updateReport();
+}
+
+void AssetManager::shutdown() {
+    stopLoader();
+    for (Decoded& decoded : decoded_) UnloadImage(decoded.image);
+    decoded_.clear();
+    decodeQueue_.clear();
+
+    for (Entry& entry : entries_) {
+        if (entry.loaded && !entry.packed) UnloadTexture(entry.texture);
+        if (entry.pixels.data != nullptr) UnloadImage(entry.pixels);
+        entry.texture = Texture2D{};
+        entry.pixels = Image{};
+        entry.loaded = false;
+    }
+    if (atlas_.id != 0) UnloadTexture(atlas_);
+    atlas_ = Texture2D{};
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Central owner of the game's images. Files are read and decoded on a loader thread (so the
+// window can show a loading screen), then uploaded on the main thread: small UI images are
+// packed into one atlas texture, large ones (backgrounds) become their own texture, scaled
+// down to the size they are drawn at. Screens hold AssetHandles, which count references; a
+// texture that isn't preloaded is unloaded when its last handle goes away. With hot reload on,
+// files that change on disk are decoded again and replace the old pixels in place, so handles
+// keep working.
+
+struct AssetRequest {
+    std::string path;           // Also the name to acquire() it by
+    int fitWidth = 0;           // Scale down to fit this box (0 = keep the file's size)
+    int fitHeight = 0;
+};
+
+// Function to get the largest rectangle of width:height's aspect ratio that fits in the box,
+// centered in it. Images with a fit box are decoded at most this big; draw them into it too,
+// so they are never stretched.
+Rectangle FitRectangle(float width, float height, Rectangle box);
+
+struct AssetSettings {
+    bool hotReload = false;     // Watch the files and reload the ones that change
+    int maxPackedSize = 512;    // Images up to this width and height go into the atlas
+    int atlasWidth = 1024;      // Most images per atlas row (wider if one image needs it)
+    int padding = 2;            // Edge pixels repeated around each packed image (no bleeding when filtered)
+    double pollSeconds = 0.5;   // Time between file checks for hot reload
+};
+
+// Startup and memory figures, written to the log once the preload is done
+struct AssetReport {
+    int images = 0;
+    int packed = 0;
+    int standalone = 0;
+    double decodeMillis = 0.0;      // Loader thread: file read, decode, resize
+    double uploadMillis = 0.0;      // Main thread: packing and texture upload
+    double readyMillis = 0.0;       // From start() until update() returned true
+    uint64_t textureBytes = 0;      // GPU memory now (atlas + standalone textures)
+    uint64_t unpackedBytes = 0;     // The same images as separate textures at file size
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    uint64_t reloads = 0;
+};
+
+class AssetManager;
+
+// Reference to one image: a texture and the rectangle of it to draw. Copying adds a reference.
+class AssetHandle {
+public:
+    AssetHandle() = default;
+    AssetHandle(const AssetHandle& other);
+    AssetHandle& operator=(const AssetHandle& other);
+    ~AssetHandle();
+
+    bool valid() const;
+    Texture2D texture() const;
+    Rectangle source() const;
+
+    void reset();
+
+private:
+    friend class AssetManager;
+    AssetHandle(AssetManager* manager, int index);
+
+    AssetManager* manager_ = nullptr;
+    int index_ = -1;
+};
+
+class AssetManager {
+public:
+    AssetManager() = default;
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Function to start decoding the preload list on the loader thread. Call after InitWindow;
+    // nothing touches the GPU until update().
+    void start(const std::vector<AssetRequest>& preload, const AssetSettings& settings = AssetSettings());
+
+    // Function to upload finished work and poll for changed files. Call once per frame on the
+    // main thread. Returns true once every preloaded image is on the GPU.
+    bool update();
+
+    // Share of the preload list decoded so far, for the loading screen (0..1)
+    float progress() const;
+    bool ready() const { return ready_; }
+
+    // Function to get a handle to an image. An image outside the preload list is loaded
+    // right here; a file that can't be loaded gives a handle that isn't valid().
+    AssetHandle acquire(const std::string& path);
+
+    // Function to stop the loader thread and unload every texture (before CloseWindow)
+    void shutdown();
+
+    const AssetReport& report() const { return report_; }
+
+private:
+    friend class AssetHandle;
+
+    struct Entry {
+        AssetRequest request;
+        bool preloaded = false;
+        bool packed = false;        // Lives in the atlas
+        bool loaded = false;        // Texture (or atlas region) holds its pixels
+        bool decoding = false;      // Queued on the loader thread
+        int refs = 0;
+        long modTime = 0;
+        int fileWidth = 0;          // Size in the file, before scaling
+        int fileHeight = 0;
+        Texture2D texture = {};     // Standalone texture; packed images use atlas_
+        Rectangle source = {};
+        Image pixels = {};          // Decoded, kept only while a packed image may be repacked
+    };
+
+    // Image for the loader thread to decode
+    struct DecodeJob {
+        int entry;
+        AssetRequest request;       // Copied, entries_ may grow meanwhile
+        bool preload;
+    };
+
+    // Decoded image coming back from the loader thread
+    struct Decoded {
+        int entry;
+        Image image;
+        long modTime;
+        int fileWidth;
+        int fileHeight;
+        double millis;
+    };
+
+    void loaderLoop();
+    void stopLoader();
+    void queueDecode(int entry);
+    void upload(Decoded& decoded);
+    void finishPreload();
+    void packAtlas();
+    void uploadStandalone(Entry& entry, const Image& image);
+    void updateReport();
+    void addRef(int entry);
+    void release(int entry);
+    int findEntry(const std::string& path) const;
+
+    AssetSettings settings_;
+    std::vector<Entry> entries_;
+    Texture2D atlas_ = {};
+    int preloadCount_ = 0;
+    int preloadDone_ = 0;
+    bool ready_ = false;
+    double startTime_ = 0.0;
+    double lastPoll_ = 0.0;
+    AssetReport report_;
+
+    std::thread loader_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<DecodeJob> decodeQueue_;
+    std::vector<Decoded> decoded_;
+    std::vector<Decoded> uploading_;        // Main thread's side of decoded_, swapped each update()
+    std::atomic<int> decodedCount_{ 0 };    // Preloaded images decoded (for progress)
+    bool stopping_ = false;
+};
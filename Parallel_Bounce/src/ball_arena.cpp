@@ -0,0 +1,283 @@
+#include "ball_arena.h"
+#include "xorshift.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ARENA_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang need the AVX2 kernel marked so it compiles without -mavx2 for the whole file
+#if defined(ARENA_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ARENA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ARENA_TARGET_AVX2
+#endif
+
+using namespace std;
+
+// Everything a kernel needs, copied out of the arena so the loops don't reload members
+struct ArenaParams {
+    float dt;
+    float radius;
+    float screenWidth;
+    float screenHeight;
+    SimRect paddles[2];
+};
+
+BallArena::BallArena(const PongConfig& config) : config_(config) {
+    PongSim sim(config);
+    paddles[0] = sim.state().playerPaddle;
+    paddles[1] = sim.state().opponentPaddle;
+}
+
+void BallArena::spawn(size_t count, uint32_t seed) {
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    leftExits = 0;
+    rightExits = 0;
+
+    uint32_t rng = XorShiftSeed(seed);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t r = XorShift32(rng);
+        x[i] = (float)(r >> 8) * (1.0f / 16777216.0f) * config_.screenWidth;
+        y[i] = XorShiftUnit(rng) * config_.screenHeight;
+        vx[i] = (r & 1) ? config_.ballSpeed : -config_.ballSpeed;
+        vy[i] = (r & 2) ? config_.ballSpeed : -config_.ballSpeed;
+    }
+}
+
+// Function to step balls [begin, end) one at a time
+static void StepScalar(const ArenaParams& p, float* x, float* y, float* vx, float* vy,
+    size_t begin, size_t end, uint64_t& leftExits, uint64_t& rightExits) {
+    const float radiusSq = p.radius * p.radius;
+
+    for (size_t i = begin; i < end; i++) {
+        float bx = x[i] + vx[i] * p.dt;
+        float by = y[i] + vy[i] * p.dt;
+        float bvx = vx[i];
+        float bvy = vy[i];
+
+        if ((by <= 0 && bvy < 0) || (by >= p.screenHeight && bvy > 0)) bvy = -bvy;
+
+        // Player paddle only deflects balls moving right, opponent paddle balls moving left
+        for (int k = 0; k < 2; k++) {
+            const SimRect& r = p.paddles[k];
+            float cx = bx < r.x ? r.x : (bx > r.x + r.width ? r.x + r.width : bx);
+            float cy = by < r.y ? r.y : (by > r.y + r.height ? r.y + r.height : by);
+            float dx = bx - cx;
+            float dy = by - cy;
+            bool towards = k == 0 ? bvx > 0 : bvx < 0;
+            if (towards && dx * dx + dy * dy <= radiusSq) bvx = -bvx;
+        }
+
+        if (bx <= 0 || bx >= p.screenWidth) {
+            if (bx <= 0) leftExits++;
+            else rightExits++;
+            bx = p.screenWidth * 0.5f;
+            by = p.screenHeight * 0.5f;
+            bvx = -bvx;
+        }
+
+        x[i] = bx;
+        y[i] = by;
+        vx[i] = bvx;
+        vy[i] = bvy;
+    }
+}
+
+#ifdef ARENA_X86
+
+// SSE2 has no blend instruction, so select with and/andnot/or
+static inline __m128 Select128(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Function to count set lanes in a movemask result (at most 8 bits)
+static inline int CountLanes(int bits) {
+    int count = 0;
+    for (; bits; bits &= bits - 1) count++;
+    return count;
+}
+
+static size_t StepSse(const ArenaParams& p, float* x, float* y, float* vx, float* vy,
+    size_t count, uint64_t& leftExits, uint64_t& rightExits) {
+    const __m128 dt = _mm_set1_ps(p.dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 width = _mm_set1_ps(p.screenWidth);
+    const __m128 height = _mm_set1_ps(p.screenHeight);
+    const __m128 centerX = _mm_set1_ps(p.screenWidth * 0.5f);
+    const __m128 centerY = _mm_set1_ps(p.screenHeight * 0.5f);
+    const __m128 radiusSq = _mm_set1_ps(p.radius * p.radius);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 rectMinX[2], rectMaxX[2], rectMinY[2], rectMaxY[2];
+    for (int k = 0; k < 2; k++) {
+        rectMinX[k] = _mm_set1_ps(p.paddles[k].x);
+        rectMaxX[k] = _mm_set1_ps(p.paddles[k].x + p.paddles[k].width);
+        rectMinY[k] = _mm_set1_ps(p.paddles[k].y);
+        rectMaxY[k] = _mm_set1_ps(p.paddles[k].y + p.paddles[k].height);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 bvx = _mm_loadu_ps(vx + i);
+        __m128 bvy = _mm_loadu_ps(vy + i);
+        __m128 bx = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(bvx, dt));
+        __m128 by = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(bvy, dt));
+
+        __m128 hitWall = _mm_or_ps(
+            _mm_and_ps(_mm_cmple_ps(by, zero), _mm_cmplt_ps(bvy, zero)),
+            _mm_and_ps(_mm_cmpge_ps(by, height), _mm_cmpgt_ps(bvy, zero)));
+        bvy = _mm_xor_ps(bvy, _mm_and_ps(hitWall, signBit));
+
+        for (int k = 0; k < 2; k++) {
+            __m128 dx = _mm_sub_ps(bx, _mm_min_ps(_mm_max_ps(bx, rectMinX[k]), rectMaxX[k]));
+            __m128 dy = _mm_sub_ps(by, _mm_min_ps(_mm_max_ps(by, rectMinY[k]), rectMaxY[k]));
+            __m128 overlap = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), radiusSq);
+            __m128 towards = k == 0 ? _mm_cmpgt_ps(bvx, zero) : _mm_cmplt_ps(bvx, zero);
+            bvx = _mm_xor_ps(bvx, _mm_and_ps(_mm_and_ps(overlap, towards), signBit));
+        }
+
+        __m128 exitLeft = _mm_cmple_ps(bx, zero);
+        __m128 exitRight = _mm_andnot_ps(exitLeft, _mm_cmpge_ps(bx, width));
+        __m128 exited = _mm_or_ps(exitLeft, exitRight);
+        int exitedBits = _mm_movemask_ps(exited);
+        if (exitedBits) {
+            leftExits += CountLanes(_mm_movemask_ps(exitLeft));
+            rightExits += CountLanes(_mm_movemask_ps(exitRight));
+            bx = Select128(exited, centerX, bx);
+            by = Select128(exited, centerY, by);
+            bvx = _mm_xor_ps(bvx, _mm_and_ps(exited, signBit));
+        }
+
+        _mm_storeu_ps(x + i, bx);
+        _mm_storeu_ps(y + i, by);
+        _mm_storeu_ps(vx + i, bvx);
+        _mm_storeu_ps(vy + i, bvy);
+    }
+    return i;
+}
+
+ARENA_TARGET_AVX2
+static size_t StepAvx2(const ArenaParams& p, float* x, float* y, float* vx, float* vy,
+    size_t count, uint64_t& leftExits, uint64_t& rightExits) {
+    const __m256 dt = _mm256_set1_ps(p.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(p.screenWidth);
+    const __m256 height = _mm256_set1_ps(p.screenHeight);
+    const __m256 centerX = _mm256_set1_ps(p.screenWidth * 0.5f);
+    const __m256 centerY = _mm256_set1_ps(p.screenHeight * 0.5f);
+    const __m256 radiusSq = _mm256_set1_ps(p.radius * p.radius);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 rectMinX[2], rectMaxX[2], rectMinY[2], rectMaxY[2];
+    for (int k = 0; k < 2; k++) {
+        rectMinX[k] = _mm256_set1_ps(p.paddles[k].x);
+        rectMaxX[k] = _mm256_set1_ps(p.paddles[k].x + p.paddles[k].width);
+        rectMinY[k] = _mm256_set1_ps(p.paddles[k].y);
+        rectMaxY[k] = _mm256_set1_ps(p.paddles[k].y + p.paddles[k].height);
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 bvx = _mm256_loadu_ps(vx + i);
+        __m256 bvy = _mm256_loadu_ps(vy + i);
+        __m256 bx = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(bvx, dt));
+        __m256 by = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(bvy, dt));
+
+        __m256 hitWall = _mm256_or_ps(
+            _mm256_and_ps(_mm256_cmp_ps(by, zero, _CMP_LE_OQ), _mm256_cmp_ps(bvy, zero, _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(by, height, _CMP_GE_OQ), _mm256_cmp_ps(bvy, zero, _CMP_GT_OQ)));
+        bvy = _mm256_xor_ps(bvy, _mm256_and_ps(hitWall, signBit));
+
+        for (int k = 0; k < 2; k++) {
+            __m256 dx = _mm256_sub_ps(bx, _mm256_min_ps(_mm256_max_ps(bx, rectMinX[k]), rectMaxX[k]));
+            __m256 dy = _mm256_sub_ps(by, _mm256_min_ps(_mm256_max_ps(by, rectMinY[k]), rectMaxY[k]));
+            __m256 overlap = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), radiusSq, _CMP_LE_OQ);
+            __m256 towards = _mm256_cmp_ps(bvx, zero, k == 0 ? _CMP_GT_OQ : _CMP_LT_OQ);
+            bvx = _mm256_xor_ps(bvx, _mm256_and_ps(_mm256_and_ps(overlap, towards), signBit));
+        }
+
+        __m256 exitLeft = _mm256_cmp_ps(bx, zero, _CMP_LE_OQ);
+        __m256 exitRight = _mm256_andnot_ps(exitLeft, _mm256_cmp_ps(bx, width, _CMP_GE_OQ));
+        __m256 exited = _mm256_or_ps(exitLeft, exitRight);
+        if (_mm256_movemask_ps(exited)) {
+            leftExits += CountLanes(_mm256_movemask_ps(exitLeft));
+            rightExits += CountLanes(_mm256_movemask_ps(exitRight));
+            bx = _mm256_blendv_ps(bx, centerX, exited);
+            by = _mm256_blendv_ps(by, centerY, exited);
+            bvx = _mm256_xor_ps(bvx, _mm256_and_ps(exited, signBit));
+        }
+
+        _mm256_storeu_ps(x + i, bx);
+        _mm256_storeu_ps(y + i, by);
+        _mm256_storeu_ps(vx + i, bvx);
+        _mm256_storeu_ps(vy + i, bvy);
+    }
+    return i;
+}
+
+#endif // ARENA_X86
+
+void BallArena::step(float dt, ArenaKernel kernel) {
+    ArenaParams params;
+    params.dt = dt;
+    params.radius = config_.ballRadius;
+    params.screenWidth = (float)config_.screenWidth;
+    params.screenHeight = (float)config_.screenHeight;
+    params.paddles[0] = paddles[0];
+    params.paddles[1] = paddles[1];
+
+    if (!ArenaKernelSupported(kernel)) kernel = ARENA_KERNEL_SCALAR;
+
+    const size_t count = size();
+    size_t done = 0;
+#ifdef ARENA_X86
+    if (kernel == ARENA_KERNEL_AVX2) done = StepAvx2(params, x.data(), y.data(), vx.data(), vy.data(), count, leftExits, rightExits);
+    else if (kernel == ARENA_KERNEL_SSE) done = StepSse(params, x.data(), y.data(), vx.data(), vy.data(), count, leftExits, rightExits);
+#endif
+    // Scalar path, also handles the tail the vector kernels leave behind
+    StepScalar(params, x.data(), y.data(), vx.data(), vy.data(), done, count, leftExits, rightExits);
+}
+
+bool ArenaKernelSupported(ArenaKernel kernel) {
+    switch (kernel) {
+    case ARENA_KERNEL_SCALAR:
+        return true;
+#ifdef ARENA_X86
+    case ARENA_KERNEL_SSE:
+        return true; // SSE2 is part of every x86-64 CPU
+    case ARENA_KERNEL_AVX2: {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+ArenaKernel BestArenaKernel() {
+    if (ArenaKernelSupported(ARENA_KERNEL_AVX2)) return ARENA_KERNEL_AVX2;
+    if (ArenaKernelSupported(ARENA_KERNEL_SSE)) return ARENA_KERNEL_SSE;
+    return ARENA_KERNEL_SCALAR;
+}
+
+const char* ArenaKernelName(ArenaKernel kernel) {
+    switch (kernel) {
+    case ARENA_KERNEL_SCALAR: return "scalar";
+    case ARENA_KERNEL_SSE: return "sse";
+    case ARENA_KERNEL_AVX2: return "avx2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "pong_sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Implementation used by BallArena::step
+enum ArenaKernel {
+    ARENA_KERNEL_SCALAR,
+    ARENA_KERNEL_SSE,       // 4 balls per instruction (SSE2)
+    ARENA_KERNEL_AVX2       // 8 balls per instruction
+};
+
+// Stress mode: many balls sharing one field, stored as structure-of-arrays so the
+// wall and paddle tests can run on several balls per instruction.
+// Uses the same rules as PongSim: reflect off top/bottom, bounce off the two paddles,
+// and go back to the center after leaving through the left or right side.
+class BallArena {
+public:
+    explicit BallArena(const PongConfig& config = PongConfig());
+
+    // Function to replace all balls with count balls at random positions and 45 degree
+    // velocities of config().ballSpeed
+    void spawn(size_t count, uint32_t seed);
+
+    // Advance every ball by dt seconds with the given kernel (falls back to scalar if unsupported)
+    void step(float dt, ArenaKernel kernel);
+
+    size_t size() const { return x.size(); }
+    const PongConfig& config() const { return config_; }
+
+    // Ball data, one entry per ball
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+
+    SimRect paddles[2];         // Player (right) and opponent (left) paddle, as in PongSim
+    uint64_t leftExits = 0;     // Balls that left through x <= 0
+    uint64_t rightExits = 0;    // Balls that left through x >= screenWidth
+
+private:
+    PongConfig config_;
+};
+
+bool ArenaKernelSupported(ArenaKernel kernel);
+ArenaKernel BestArenaKernel();
+const char* ArenaKernelName(ArenaKernel kernel);
@@ -0,0 +1,127 @@
+#include "ball_grid.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Function to bounce balls i and j if they overlap and are moving towards each other.
+// Returns true when the pair overlaps.
+static inline bool ResolvePair(BallArena& arena, uint32_t i, uint32_t j, float dx, float dy, float minDistSq) {
+    float distSq = dx * dx + dy * dy;
+    if (distSq >= minDistSq) return false;
+    if (distSq == 0.0f) return true; // Exactly on top of each other: no contact normal to push along
+
+    float relVx = arena.vx[i] - arena.vx[j];
+    float relVy = arena.vy[i] - arena.vy[j];
+    float approach = relVx * dx + relVy * dy; // d = pos[i] - pos[j], moving together when negative
+    if (approach < 0) {
+        // Equal masses: swap the velocity components along the contact normal
+        float impulse = approach / distSq;
+        arena.vx[i] -= impulse * dx;
+        arena.vy[i] -= impulse * dy;
+        arena.vx[j] += impulse * dx;
+        arena.vy[j] += impulse * dy;
+    }
+    return true;
+}
+
+BallGrid::BallGrid(float width, float height, float ballRadius) : radius_(ballRadius) {
+    float cellSize = 2.0f * ballRadius;
+    invCellSize_ = 1.0f / cellSize;
+    columns_ = (int)(width * invCellSize_) + 1;
+    rows_ = (int)(height * invCellSize_) + 1;
+    cellStart_.resize((size_t)columns_ * rows_ + 1);
+}
+
+void BallGrid::build(const BallArena& arena) {
+    const size_t count = arena.size();
+    ballCell_.resize(count);
+    sortedBall_.resize(count);
+    sortedX_.resize(count);
+    sortedY_.resize(count);
+
+    // Count balls per cell. Balls slightly outside the field go to the border cells.
+    fill(cellStart_.begin(), cellStart_.end(), 0u);
+    for (size_t i = 0; i < count; i++) {
+        int cellX = (int)(arena.x[i] * invCellSize_);
+        int cellY = (int)(arena.y[i] * invCellSize_);
+        cellX = cellX < 0 ? 0 : (cellX >= columns_ ? columns_ - 1 : cellX);
+        cellY = cellY < 0 ? 0 : (cellY >= rows_ ? rows_ - 1 : cellY);
+        uint32_t cell = (uint32_t)(cellY * columns_ + cellX);
+        ballCell_[i] = cell;
+        cellStart_[cell + 1]++;
+    }
+
+    // Prefix sum turns counts into bucket starts
+    for (size_t c = 1; c < cellStart_.size(); c++) cellStart_[c] += cellStart_[c - 1];
+
+    // Scatter, using cellStart_[c] as the write cursor of bucket c then shifting back
+    for (size_t i = 0; i < count; i++) {
+        uint32_t slot = cellStart_[ballCell_[i]]++;
+        sortedBall_[slot] = (uint32_t)i;
+        sortedX_[slot] = arena.x[i];
+        sortedY_[slot] = arena.y[i];
+    }
+    for (size_t c = cellStart_.size() - 1; c > 0; c--) cellStart_[c] = cellStart_[c - 1];
+    cellStart_[0] = 0;
+}
+
+size_t BallGrid::collideCell(BallArena& arena, uint32_t cell, int cellX, int cellY) {
+    const float minDistSq = 4.0f * radius_ * radius_;
+    const uint32_t begin = cellStart_[cell];
+    const uint32_t end = cellStart_[cell + 1];
+    size_t contacts = 0;
+
+    // Pairs inside the cell
+    for (uint32_t a = begin; a < end; a++) {
+        for (uint32_t b = a + 1; b < end; b++) {
+            contacts += ResolvePair(arena, sortedBall_[a], sortedBall_[b],
+                sortedX_[a] - sortedX_[b], sortedY_[a] - sortedY_[b], minDistSq);
+        }
+    }
+
+    // Pairs with the four "forward" neighbours, so every pair of cells is visited once
+    static const int offsets[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+    for (int n = 0; n < 4; n++) {
+        int neighbourX = cellX + offsets[n][0];
+        int neighbourY = cellY + offsets[n][1];
+        if (neighbourX < 0 || neighbourX >= columns_ || neighbourY >= rows_) continue;
+
+        uint32_t neighbour = (uint32_t)(neighbourY * columns_ + neighbourX);
+        const uint32_t otherBegin = cellStart_[neighbour];
+        const uint32_t otherEnd = cellStart_[neighbour + 1];
+        for (uint32_t a = begin; a < end; a++) {
+            for (uint32_t b = otherBegin; b < otherEnd; b++) {
+                contacts += ResolvePair(arena, sortedBall_[a], sortedBall_[b],
+                    sortedX_[a] - sortedX_[b], sortedY_[a] - sortedY_[b], minDistSq);
+            }
+        }
+    }
+    return contacts;
+}
+
+size_t BallGrid::collide(BallArena& arena) {
+    size_t contacts = 0;
+    for (int cellY = 0; cellY < rows_; cellY++) {
+        for (int cellX = 0; cellX < columns_; cellX++) {
+            uint32_t cell = (uint32_t)(cellY * columns_ + cellX);
+            if (cellStart_[cell] == cellStart_[cell + 1]) continue;
+            contacts += collideCell(arena, cell, cellX, cellY);
+        }
+    }
+    return contacts;
+}
+
+size_t CollideBallsBruteForce(BallArena& arena) {
+    const float radius = arena.config().ballRadius;
+    const float minDistSq = 4.0f * radius * radius;
+    const uint32_t count = (uint32_t)arena.size();
+    size_t contacts = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t j = i + 1; j < count; j++) {
+            contacts += ResolvePair(arena, i, j, arena.x[i] - arena.x[j], arena.y[i] - arena.y[j], minDistSq);
+        }
+    }
+    return contacts;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ball_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the field for ball-ball collisions in the multi-ball arena.
+// Rebuilt every step with a counting sort into flat buckets; the buffers only grow,
+// so a steady ball count means no heap allocation per step.
+class BallGrid {
+public:
+    // Cells are one ball diameter wide so only neighbouring cells can hold contacts
+    BallGrid(float width, float height, float ballRadius);
+
+    // Function to bucket the arena's balls by cell
+    void build(const BallArena& arena);
+
+    // Function to bounce every overlapping pair that is moving together (equal-mass
+    // elastic collision). Uses the buckets from the last build(). Returns overlapping pairs.
+    size_t collide(BallArena& arena);
+
+    int columns() const { return columns_; }
+    int rows() const { return rows_; }
+
+private:
+    size_t collideCell(BallArena& arena, uint32_t cell, int cellX, int cellY);
+
+    float radius_;
+    float invCellSize_;
+    int columns_;
+    int rows_;
+    std::vector<uint32_t> cellStart_;   // Bucket c holds sorted entries [cellStart_[c], cellStart_[c + 1])
+    std::vector<uint32_t> ballCell_;    // Cell of each ball
+    std::vector<uint32_t> sortedBall_;  // Ball indices ordered by cell
+    std::vector<float> sortedX_;        // Positions copied in bucket order so neighbour scans are contiguous
+    std::vector<float> sortedY_;
+};
+
+// Function to resolve ball-ball collisions by testing every pair (reference for BallGrid)
+size_t CollideBallsBruteForce(BallArena& arena);
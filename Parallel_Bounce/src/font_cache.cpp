@@ -0,0 +1,112 @@
+#include "font_cache.h"
+
+using namespace std;
+
+// Alpha from the distance: a smooth step one screen pixel wide across the outline (onEdge, the
+// file's onEdgeValue), so edges stay sharp when magnified and don't alias when shrunk
+#if defined(PLATFORM_WEB)
+static const char* SDF_FRAGMENT_SHADER = R"(#version 100
+#extension GL_OES_standard_derivatives : enable
+precision mediump float;
+varying vec2 fragTexCoord;
+varying vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float onEdge;
+void main() {
+    float distance = texture2D(texture0, fragTexCoord).r;
+    float width = fwidth(distance);
+    float alpha = smoothstep(onEdge - width, onEdge + width, distance);
+    gl_FragColor = vec4(fragColor.rgb, fragColor.a * alpha) * colDiffuse;
+}
+)";
+#else
+static const char* SDF_FRAGMENT_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float onEdge;
+out vec4 finalColor;
+void main() {
+    float distance = texture(texture0, fragTexCoord).r;
+    float width = fwidth(distance);
+    float alpha = smoothstep(onEdge - width, onEdge + width, distance);
+    finalColor = vec4(fragColor.rgb, fragColor.a * alpha) * colDiffuse;
+}
+)";
+#endif
+
+Font FontCache::load(const char* sdfPath, const char* ttfPath) {
+    unload();
+    double begin = GetTime();
+
+    if (file_.open(sdfPath)) {
+        const SdfFontHeader& header = file_.header();
+        const SdfGlyphRecord* records = file_.glyphs();
+
+        glyphs_.resize(header.glyphCount);
+        recs_.resize(header.glyphCount);
+        for (uint32_t i = 0; i < header.glyphCount; i++) {
+            const SdfGlyphRecord& record = records[i];
+            glyphs_[i].value = record.codepoint;
+            glyphs_[i].offsetX = record.offsetX;
+            glyphs_[i].offsetY = record.offsetY;
+            glyphs_[i].advanceX = record.advanceX;
+            glyphs_[i].image = Image{};
+            recs_[i] = { (float)record.x, (float)record.y, (float)record.width, (float)record.height };
+        }
+
+        // The mapped pixels are uploaded directly, one byte per pixel
+        Image atlas = {};
+        atlas.data = (void*)file_.pixels();
+        atlas.width = header.atlasWidth;
+        atlas.height = header.atlasHeight;
+        atlas.mipmaps = 1;
+        atlas.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+
+        font_.baseSize = header.baseSize;
+        font_.glyphCount = (int)header.glyphCount;
+        font_.glyphPadding = header.glyphPadding;
+        font_.texture = LoadTextureFromImage(atlas);
+        font_.recs = recs_.data();
+        font_.glyphs = glyphs_.data();
+        shader_ = LoadShaderFromMemory(nullptr, SDF_FRAGMENT_SHADER);
+        if (shader_.id != 0) {
+            float onEdge = header.onEdgeValue / 255.0f;
+            SetShaderValue(shader_, GetShaderLocation(shader_, "onEdge"), &onEdge, SHADER_UNIFORM_FLOAT);
+        }
+
+        if (font_.texture.id != 0 && shader_.id != 0) {
+            // Filtering is what makes a distance field work; the mipmaps keep small text from aliasing
+            GenTextureMipmaps(&font_.texture);
+            SetTextureFilter(font_.texture, TEXTURE_FILTER_TRILINEAR);
+            loadMillis_ = (GetTime() - begin) * 1000.0;
+            TraceLog(LOG_INFO, "FONT: '%s' mapped, %d glyphs at %d px, %dx%d atlas, %.2f ms", sdfPath,
+                font_.glyphCount, font_.baseSize, atlas.width, atlas.height, loadMillis_);
+            return font_;
+        }
+        TraceLog(LOG_WARNING, "FONT: Couldn't set up '%s' on the GPU, using the TTF", sdfPath);
+        unload();
+        begin = GetTime();
+    }
+
+    font_ = LoadFont(ttfPath);
+    ttf_ = true;
+    loadMillis_ = (GetTime() - begin) * 1000.0;
+    TraceLog(LOG_INFO, "FONT: '%s' loaded from the TTF in %.2f ms (run 'make fonts' to bake it)", ttfPath, loadMillis_);
+    return font_;
+}
+
+void FontCache::unload() {
+    if (ttf_) UnloadFont(font_);
+    else if (font_.texture.id != 0) UnloadTexture(font_.texture);
+    if (shader_.id != 0) UnloadShader(shader_);
+
+    font_ = Font{};
+    shader_ = Shader{};
+    ttf_ = false;
+    glyphs_.clear();
+    recs_.clear();
+    file_.close();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "raylib.h"
+#include "sdf_font.h"
+
+#include <vector>
+
+// The game's UI font. LoadFont parses the TTF and rasterizes it at one size on every start,
+// and text drawn at other sizes is scaled from that bitmap and looks soft. A FontCache maps the
+// atlas baked by tools/font_bake instead (make fonts), uploads it as is and draws it through a
+// distance field shader that is sharp at any size. Without a baked file it falls back to the TTF.
+class FontCache {
+public:
+    FontCache() = default;
+
+    FontCache(const FontCache&) = delete;
+    FontCache& operator=(const FontCache&) = delete;
+
+    // Function to load the font, the baked file if it exists and is valid, the TTF otherwise
+    // (after InitWindow). The Font stays valid until unload().
+    Font load(const char* sdfPath, const char* ttfPath);
+    // Function to free the texture, shader and mapping (before CloseWindow)
+    void unload();
+
+    const Font& font() const { return font_; }
+    // Shader to draw the font's quads with; id 0 for the TTF fallback (plain textured quads)
+    Shader shader() const { return shader_; }
+    bool isSdf() const { return file_.isOpen(); }
+    double loadMillis() const { return loadMillis_; }
+
+private:
+    SdfFontFile file_;
+    std::vector<GlyphInfo> glyphs_;
+    std::vector<Rectangle> recs_;
+    Font font_ = {};
+    Shader shader_ = {};
+    bool ttf_ = false;
+    double loadMillis_ = 0.0;
+};
@@ -0,0 +1,76 @@
+#include "frame_stats.h"
+
+#include "profiler.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// Plain counters: trivially constructed, so they are usable from the first allocation on
+static thread_local HeapCounters threadHeap;
+
+static void* CountedAlloc(size_t size) {
+    void* memory = malloc(size ? size : 1);
+    if (!memory) throw bad_alloc();
+    threadHeap.allocations++;
+    threadHeap.bytes += size;
+    return memory;
+}
+
+static void CountedFree(void* memory) {
+    if (!memory) return;
+    threadHeap.frees++;
+    free(memory);
+}
+
+// Replacements of the global allocation functions (the other forms call these)
+void* operator new(size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAlloc(size);
+}
+
+void operator delete(void* memory) noexcept {
+    CountedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    CountedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    CountedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    CountedFree(memory);
+}
+
+HeapCounters ThreadHeapCounters() {
+    return threadHeap;
+}
+
+void FrameStats::beginFrame() {
+    ProfilerFrameMark();    // Frame boundary for the profiler's per-frame statistics too
+    startHeap_ = threadHeap;
+    start_ = chrono::steady_clock::now();
+    inFrame_ = true;
+}
+
+void FrameStats::endFrame() {
+    if (!inFrame_) return;
+    inFrame_ = false;
+
+    workMicros_ = chrono::duration<double, micro>(chrono::steady_clock::now() - start_).count();
+    allocations_ = threadHeap.allocations - startHeap_.allocations;
+    allocatedBytes_ = threadHeap.bytes - startHeap_.bytes;
+
+    frames_++;
+    if (allocations_ > 0) framesWithAllocations_++;
+    if (allocations_ > maxAllocations_) maxAllocations_ = allocations_;
+    totalWorkMicros_ += workMicros_;
+    if (workMicros_ > maxWorkMicros_) maxWorkMicros_ = workMicros_;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Heap counters of the calling thread. The game replaces the global operator new and delete
+// (frame_stats.cpp) to count them; background threads keep their own counts, so the render
+// thread's numbers only show its own allocations.
+struct HeapCounters {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;         // Requested by allocations
+};
+
+HeapCounters ThreadHeapCounters();
+
+// Per-frame allocation and work time counters for the render thread. Call beginFrame() at
+// the top of a loop iteration and endFrame() just before EndDrawing(), so the time excludes
+// the vsync wait and the buffer swap. Work time is wall-clock time, so it includes time the
+// thread was preempted; it is what the frame took, not the CPU it used.
+class FrameStats {
+public:
+    void beginFrame();
+    void endFrame();
+
+    // Last finished frame
+    uint64_t allocations() const { return allocations_; }
+    uint64_t allocatedBytes() const { return allocatedBytes_; }
+    double workMicros() const { return workMicros_; }
+
+    // Since the start
+    uint64_t frames() const { return frames_; }
+    uint64_t framesWithAllocations() const { return framesWithAllocations_; }
+    uint64_t maxAllocations() const { return maxAllocations_; }
+    double averageWorkMicros() const { return frames_ ? totalWorkMicros_ / frames_ : 0.0; }
+    double maxWorkMicros() const { return maxWorkMicros_; }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    HeapCounters startHeap_;
+    bool inFrame_ = false;
+
+    uint64_t allocations_ = 0;
+    uint64_t allocatedBytes_ = 0;
+    double workMicros_ = 0.0;
+
+    uint64_t frames_ = 0;
+    uint64_t framesWithAllocations_ = 0;
+    uint64_t maxAllocations_ = 0;
+    double totalWorkMicros_ = 0.0;
+    double maxWorkMicros_ = 0.0;
+};
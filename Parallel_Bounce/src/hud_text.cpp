@@ -0,0 +1,133 @@
+#include "hud_text.h"
+
+#include "quad_batch.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+using namespace std;
+
+static uint64_t hudLayouts = 0;
+static uint64_t hudSubmissions = 0;
+
+// raylib's default gap between lines of DrawTextEx (SetTextLineSpacing)
+static const float HUD_LINE_SPACING = 2.0f;
+
+HudText::HudText(Font font, float fontSize, float spacing) {
+    setFont(font, fontSize, spacing);
+}
+
+void HudText::setFont(Font font, float fontSize, float spacing) {
+    if (font.texture.id == font_.texture.id && font.recs == font_.recs && fontSize == fontSize_ && spacing == spacing_) return;
+    font_ = font;
+    fontSize_ = fontSize;
+    spacing_ = spacing;
+    laidOut_ = false;
+}
+
+bool HudText::set(const char* text) {
+    if (laidOut_ && text_ == text) return false;
+    text_.assign(text);
+    layout();
+    return true;
+}
+
+bool HudText::setFormat(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return set(buffer);
+}
+
+uint64_t HudText::layoutCount() {
+    return hudLayouts;
+}
+
+// Same placement as DrawTextEx/DrawTextCodepoint, computed once
+void HudText::layout() {
+    hudLayouts++;
+    laidOut_ = true;
+    quads_.clear();
+    size_ = { 0.0f, 0.0f };
+    if (font_.texture.id == 0 || font_.baseSize == 0 || text_.empty()) return;
+
+    const float scale = fontSize_ / font_.baseSize;
+    const float padding = (float)font_.glyphPadding;
+    const float textureWidth = (float)font_.texture.width;
+    const float textureHeight = (float)font_.texture.height;
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    const char* next = text_.c_str();
+    while (*next) {
+        int bytes = 0;
+        int codepoint = GetCodepointNext(next, &bytes);
+        next += bytes > 0 ? bytes : 1;
+
+        if (codepoint == '\n') {
+            if (x - spacing_ > width) width = x - spacing_;
+            x = 0.0f;
+            y += fontSize_ + HUD_LINE_SPACING;
+            continue;
+        }
+
+        int index = GetGlyphIndex(font_, codepoint);
+        const Rectangle& rec = font_.recs[index];
+        const GlyphInfo& glyph = font_.glyphs[index];
+
+        if (codepoint != ' ' && codepoint != '\t') {
+            HudQuad quad;
+            quad.x0 = x + (glyph.offsetX - padding) * scale;
+            quad.y0 = y + (glyph.offsetY - padding) * scale;
+            quad.x1 = quad.x0 + (rec.width + 2.0f * padding) * scale;
+            quad.y1 = quad.y0 + (rec.height + 2.0f * padding) * scale;
+            quad.u0 = (rec.x - padding) / textureWidth;
+            quad.v0 = (rec.y - padding) / textureHeight;
+            quad.u1 = (rec.x + rec.width + padding) / textureWidth;
+            quad.v1 = (rec.y + rec.height + padding) / textureHeight;
+            quads_.push_back(quad);
+        }
+
+        x += (glyph.advanceX == 0 ? rec.width : (float)glyph.advanceX) * scale + spacing_;
+    }
+    if (x - spacing_ > width) width = x - spacing_;
+    size_ = { width, y + fontSize_ };
+}
+
+void HudBatch::add(const HudText& text, Vector2 position, Color color) {
+    for (const HudQuad& glyph : text.quads()) {
+        ColoredQuad quad = { glyph, color };
+        quad.quad.x0 += position.x;
+        quad.quad.x1 += position.x;
+        quad.quad.y0 += position.y;
+        quad.quad.y1 += position.y;
+        quads_.push_back(quad);
+    }
+}
+
+void HudBatch::addCentered(const HudText& text, float centerX, float y, Color color) {
+    add(text, { centerX - text.size().x / 2, y }, color);
+}
+
+void HudBatch::addShadowed(const HudText& text, Vector2 position, Color color, Color shadow, float shadowOffset) {
+    add(text, { position.x + shadowOffset, position.y + shadowOffset }, shadow);
+    add(text, position, color);
+}
+
+uint64_t HudBatch::submissionCount() {
+    return hudSubmissions;
+}
+
+void HudBatch::draw(Texture2D texture, Shader shader) {
+    if (quads_.empty() || texture.id == 0) return;
+    if (shader.id != 0) BeginShaderMode(shader);
+
+    hudSubmissions += SubmitQuads(texture.id, quads_.size(), [this](size_t i, BatchQuad& q) {
+        const HudQuad& glyph = quads_[i].quad;
+        q = { glyph.x0, glyph.y0, glyph.x1, glyph.y1, glyph.u0, glyph.v0, glyph.u1, glyph.v1, quads_[i].color };
+    });
+    if (shader.id != 0) EndShaderMode();
+}
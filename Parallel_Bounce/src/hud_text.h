@@ -0,0 +1,91 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Retained text for the HUD and menus. DrawTextEx decodes the UTF-8, looks up every glyph
+// (a linear search in raylib) and issues one textured quad per glyph on every call, and
+// MeasureText does it all again. A HudText does that work once, when its text changes, and
+// keeps the glyph quads. A HudBatch collects the quads of many texts and sends them to rlgl
+// in one rlBegin/rlEnd with the font texture bound once.
+
+// One glyph: screen rectangle relative to the text's top left, and atlas coordinates (0..1)
+struct HudQuad {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+};
+
+class HudText {
+public:
+    HudText() = default;
+    HudText(Font font, float fontSize, float spacing = 1.0f);
+
+    // Function to change the font or size; the next set() lays the text out again
+    void setFont(Font font, float fontSize, float spacing = 1.0f);
+
+    // Function to set the text. Lays it out only if it differs from the current one.
+    // Returns true if it did. Doesn't allocate once the buffers have grown to the text.
+    bool set(const char* text);
+    bool set(const std::string& text) { return set(text.c_str()); }
+    // Function to set printf-style text (formatted on the stack, at most 255 bytes)
+    bool setFormat(const char* format, ...);
+
+    const std::string& text() const { return text_; }
+    bool empty() const { return text_.empty(); }
+    // Same as MeasureTextEx with this font, size and spacing
+    Vector2 size() const { return size_; }
+    const std::vector<HudQuad>& quads() const { return quads_; }
+    unsigned int textureId() const { return font_.texture.id; }
+
+    // Layouts done by all HudTexts since the start (for the frame stats overlay)
+    static uint64_t layoutCount();
+
+private:
+    void layout();
+
+    Font font_ = {};
+    float fontSize_ = 20.0f;
+    float spacing_ = 1.0f;
+    bool laidOut_ = false;
+    std::string text_;
+    std::vector<HudQuad> quads_;
+    Vector2 size_ = { 0.0f, 0.0f };
+};
+
+// Quads of many HudTexts drawn with a single texture bind. All texts in a batch must use the
+// same font. Keeps its buffer between frames, so a steady HUD doesn't allocate.
+class HudBatch {
+public:
+    // Function to forget the previous frame's quads (keeps the memory)
+    void clear() { quads_.clear(); }
+    // Function to drop everything after the first quadCount quads, e.g. to keep a static part
+    void truncate(size_t quadCount) { if (quadCount < quads_.size()) quads_.resize(quadCount); }
+
+    // Function to add a text with its top left corner at position
+    void add(const HudText& text, Vector2 position, Color color);
+    // Function to add a text centered horizontally on centerX, top at y
+    void addCentered(const HudText& text, float centerX, float y, Color color);
+    // Function to add a text with a darker copy behind it, offset by shadowOffset pixels
+    void addShadowed(const HudText& text, Vector2 position, Color color, Color shadow, float shadowOffset = 2.0f);
+
+    // Function to submit everything added since clear() in one batch (between BeginDrawing and
+    // EndDrawing), through shader if it has an id (the distance field font's, see font_cache.h).
+    // The quads stay, so the same batch can be drawn again next frame.
+    void draw(Texture2D texture, Shader shader = Shader{});
+
+    size_t quadCount() const { return quads_.size(); }
+    // Batches submitted by all HudBatches since the start
+    static uint64_t submissionCount();
+
+private:
+    struct ColoredQuad {
+        HudQuad quad;
+        Color color;
+    };
+
+    std::vector<ColoredQuad> quads_;
+};
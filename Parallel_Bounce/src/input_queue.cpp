@@ -0,0 +1,87 @@
+#include "input_queue.h"
+
+using namespace std;
+
+void InputQueue::push(InputEventType type, uint32_t value, uint64_t nanos) {
+    InputEvent& event = events_[end_ % CAPACITY];
+    event.nanos = nanos;
+    event.value = value;
+    event.type = type;
+    end_++;
+
+    if (type != INPUT_TEXT && value < (uint32_t)INPUT_MAX_KEYS) down_[value] = type == INPUT_KEY_DOWN;
+}
+
+bool InputQueue::pressed(int key) const {
+    for (uint64_t i = frameBegin(); i < end_; i++) {
+        const InputEvent& event = at(i);
+        if (event.type == INPUT_KEY_DOWN && event.value == (uint32_t)key) return true;
+    }
+    return false;
+}
+
+void InputTickState::advance(const InputQueue& queue, uint64_t untilNanos) {
+    tapped_.reset();
+    bitset<INPUT_MAX_KEYS> pressedNow;
+    if (cursor_ < queue.begin()) cursor_ = queue.begin();   // Too far behind, the oldest are gone
+
+    for (; cursor_ < queue.end(); cursor_++) {
+        const InputEvent& event = queue.at(cursor_);
+        if (event.nanos > untilNanos) break;
+        if (event.type == INPUT_TEXT || event.value >= (uint32_t)INPUT_MAX_KEYS) continue;
+        if (event.type == INPUT_KEY_DOWN) {
+            down_[event.value] = true;
+            pressedNow[event.value] = true;
+        }
+        else {
+            down_[event.value] = false;
+            if (pressedNow[event.value]) tapped_[event.value] = true;
+        }
+    }
+}
+
+void InputTickState::catchUp(const InputQueue& queue) {
+    cursor_ = queue.end();
+    tapped_.reset();
+    for (int key = 0; key < INPUT_MAX_KEYS; key++) down_[key] = queue.isDown(key);
+}
+
+bool AppendUtf8(string& text, uint32_t codepoint, size_t maxBytes) {
+    // No control characters, surrogates or values past the last codepoint
+    if (codepoint < 0x20 || codepoint == 0x7F || (codepoint >= 0x80 && codepoint < 0xA0)) return false;
+    if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) return false;
+
+    char bytes[4];
+    size_t count;
+    if (codepoint < 0x80) {
+        bytes[0] = (char)codepoint;
+        count = 1;
+    }
+    else if (codepoint < 0x800) {
+        bytes[0] = (char)(0xC0 | (codepoint >> 6));
+        bytes[1] = (char)(0x80 | (codepoint & 0x3F));
+        count = 2;
+    }
+    else if (codepoint < 0x10000) {
+        bytes[0] = (char)(0xE0 | (codepoint >> 12));
+        bytes[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (codepoint & 0x3F));
+        count = 3;
+    }
+    else {
+        bytes[0] = (char)(0xF0 | (codepoint >> 18));
+        bytes[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (codepoint & 0x3F));
+        count = 4;
+    }
+    if (text.size() + count > maxBytes) return false;
+    text.append(bytes, count);
+    return true;
+}
+
+void PopUtf8(string& text) {
+    // Drop continuation bytes (10xxxxxx), then the lead byte
+    while (!text.empty() && ((unsigned char)text.back() & 0xC0) == 0x80) text.pop_back();
+    if (!text.empty()) text.pop_back();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Keyboard input as events. Once per frame the game drains raylib's key and character queues
+// into an InputQueue (key presses, key releases, typed characters, each with the time it was
+// drained), so a key pressed and released within one frame still shows up, and text entry
+// gets real characters (shifted, accented, any script) instead of key codes.
+//
+// Readers keep their own position in the queue: screens look at the events of the current
+// frame, a simulation takes them tick by tick with an InputTickState. No raylib here; key
+// codes are raylib's KeyboardKey values.
+
+const int INPUT_MAX_KEYS = 512;         // Above raylib's highest key code (KEY_KB_MENU = 348)
+
+enum InputEventType : uint8_t {
+    INPUT_KEY_DOWN,
+    INPUT_KEY_UP,
+    INPUT_TEXT                          // A typed character, value is its Unicode codepoint
+};
+
+struct InputEvent {
+    uint64_t nanos;                     // SimClockNanos() when it was drained
+    uint32_t value;                     // Key code, or codepoint for INPUT_TEXT
+    InputEventType type;
+};
+
+class InputQueue {
+public:
+    static const size_t CAPACITY = 256; // Events kept; a reader further behind loses the oldest
+
+    // Function to start a new frame: the events pushed from now on are this frame's
+    void beginFrame() { frameStart_ = end_; }
+    void push(InputEventType type, uint32_t value, uint64_t nanos);
+
+    // Events have increasing sequence numbers; [begin(), end()) are still in the buffer
+    uint64_t begin() const { return end_ > CAPACITY ? end_ - CAPACITY : 0; }
+    uint64_t end() const { return end_; }
+    uint64_t frameBegin() const { return frameStart_ > begin() ? frameStart_ : begin(); }
+    const InputEvent& at(uint64_t sequence) const { return events_[sequence % CAPACITY]; }
+
+    // Function to check whether key went down this frame
+    bool pressed(int key) const;
+    // Key state after every event pushed so far
+    bool isDown(int key) const { return key >= 0 && key < INPUT_MAX_KEYS && down_[key]; }
+
+private:
+    InputEvent events_[CAPACITY];
+    uint64_t end_ = 0;
+    uint64_t frameStart_ = 0;
+    std::bitset<INPUT_MAX_KEYS> down_;
+};
+
+// Key state as a simulation sees it, one tick at a time. Each tick takes the events up to its
+// time; a key pressed and released within the same stretch counts as held for that one tick,
+// so a quick tap always moves the paddle.
+class InputTickState {
+public:
+    // Function to move to the next tick, applying every event drained at or before untilNanos
+    void advance(const InputQueue& queue, uint64_t untilNanos);
+    // Function to skip to the newest event without applying anything (e.g. when a match starts)
+    void catchUp(const InputQueue& queue);
+
+    bool isDown(int key) const { return key >= 0 && key < INPUT_MAX_KEYS && (down_[key] || tapped_[key]); }
+
+private:
+    uint64_t cursor_ = 0;
+    std::bitset<INPUT_MAX_KEYS> down_;
+    std::bitset<INPUT_MAX_KEYS> tapped_;    // Released in the last stretch after going down in it
+};
+
+// Function to append codepoint to text as UTF-8 if the result stays within maxBytes. Returns
+// false (and leaves text alone) for control characters, invalid codepoints or no room.
+bool AppendUtf8(std::string& text, uint32_t codepoint, size_t maxBytes);
+// Function to remove the last character (all bytes of its UTF-8 sequence) from text
+void PopUtf8(std::string& text);
@@ -1,344 +1,1404 @@
 #include "raylib.h"
+#include "asset_manager.h"
+#include "font_cache.h"
+#include "frame_stats.h"
+#include "hud_text.h"
+#include "input_queue.h"
+#include "match_snapshot.h"
+#include "mcts_ai.h"
+#include "metrics.h"
+#include "metrics_server.h"
+#include "pong_ai.h"
+#include "pong_sim.h"
+#include "net_impairment.h"
+#include "net_socket.h"
+#include "netplay.h"
+#include "particle_draw.h"
+#include "particles.h"
+#include "player_stats.h"
+#include "profiler.h"
+#include "replay.h"
+#include "result_logger.h"
+#include "scene.h"
+#include "sim_thread.h"
+#include <memory>
 #include <string>
+#include <vector>
 #include <iostream>
-#include <fstream>
 #include <ctime>
 #include <cstdio> // For sprintf_s
+#include <cstdlib>
+#include <cmath>
 
 using namespace std;
 
+// Command line options for two-machine play
+struct NetOptions {
+    bool host = false;
+    bool join = false;
+    uint16_t port = NET_DEFAULT_PORT;
+    string address;                 // Host to join, "host[:port]"
+    string playerName = "Player";
+    NetImpairmentSettings impairment;   // Applied to outgoing packets, for testing on loopback
+};
+
 // Function prototypes
-void StartGame(bool vsAI, const string& player1Name, const string& player2Name, Font customFont);
-bool ShowMenu(string& player1Name, string& player2Name, Font customFont);
-void CapturePlayerName(string& playerName, const string& prompt, Font customFont);
-bool ShowGameOverScreen(bool playerWon, bool vsAI, const string& player1Name, const string& player2Name, Font customFont);
-void LogGameResult(const string& mode, const string& winner);
+void LogGameResult(const string& mode, const string& winner, const string& loser);
 
 // Button Struct
 struct Button {
     Rectangle rect;          // Button rectangle (position and size)
     string text;        // Button text
-    Texture2D image;         // Button image
+    AssetHandle image;       // Button image (none: text only)
     bool hovered;            // Is the button hovered?
+    HudText label;           // Laid out text, built on the first draw
 };
 
-// Function to log game results to a file
-void LogGameResult(const string& mode, const string& winner) {
+// Window size; every screen is laid out for it
+static const int SCREEN_WIDTH = 792;
+static const int SCREEN_HEIGHT = 534;
+
+// Screens, the top one is shown (see scene.h)
+static SceneStack scenes;
+// Match history, written to disk by a background thread
+static AsyncResultLog resultLog;
+// Per-player statistics, updated with every logged result
+static PlayerStatsIndex playerStats;
+// Keyboard events, drained from raylib once per frame (see input_queue.h)
+static InputQueue input;
+// Allocations and work time of each frame on the render thread (F3 shows them during a match)
+static FrameStats frameStats;
+static bool showFrameStats = false;
+// Menu images, decoded in the background at startup and packed into one atlas
+static AssetManager assets;
+// UI font (a baked distance field atlas when there is one) and the shader its text is drawn with
+static FontCache fonts;
+// Profiler overlay (F4) with p50/p99 of the frame and of each timed scope
+static HudText profilerText;
+static uint64_t profilerOverlayFrames = 0;
+static bool showProfiler = false;
+static bool profileFromStart = false;  // --profile: record from the start, whether the overlay is shown or not
+// Local matches tick on their own thread at this rate; --serial-sim steps them on the render
+// thread at 60 Hz instead, as before, to compare latency
+static const float SIM_TICK_RATE = 240.0f;
+static bool serialSim = false;
+// --search-ai: the AI of local matches searches its moves (see mcts_ai.h) instead of predicting
+static bool searchAI = false;
+
+// Metrics of the running game (see metrics.h), served by --metrics-port and --metrics-json
+static MetricsExporter metricsExporter(Metrics());
+static MetricHistogram& frameSeconds = Metrics().histogram("pb_frame_seconds",
+    "Time between frames, vsync wait included", MetricSecondsBuckets());
+static MetricHistogram& frameWorkSeconds = Metrics().histogram("pb_frame_work_seconds",
+    "Render thread time per frame up to the vsync wait (wall clock, preemption included)", MetricSecondsBuckets());
+static MetricCounter& aiMatches = Metrics().counter("pb_matches_total", "Matches played to the end",
+    "mode", ResultModeName(RESULT_MODE_AI));
+static MetricCounter& multiplayerMatches = Metrics().counter("pb_matches_total", "Matches played to the end",
+    "mode", ResultModeName(RESULT_MODE_MULTIPLAYER));
+static MetricGauge& assetsReadySeconds = Metrics().gauge("pb_assets_ready_seconds",
+    "Time from startup until the preloaded images were ready");
+
+// Function to log game results to the binary history file. Only queues the record,
+// so the render thread never waits for the disk.
+void LogGameResult(const string& mode, const string& winner, const string& loser) {
     if (winner.empty()) return; // Don't log if there's no winner
 
-    ofstream outFile("game_results.txt", ios::app); // Append to the file
-    if (outFile.is_open()) {
-        // Get the current time
-        time_t now = time(nullptr);
-        struct tm timeInfo;
-        localtime_s(&timeInfo, &now);  // Safe time handling
+    uint8_t modeId;
+    if (!ParseResultMode(mode, modeId)) return;
+    (modeId == RESULT_MODE_AI ? aiMatches : multiplayerMatches).add();
 
-        char timeBuffer[100];
-        strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", &timeInfo);
+    ResultRecord record = MakeResultRecord(modeId, winner, loser, (int64_t)time(nullptr));
+    if (!resultLog.push(record)) {
+        cerr << "Error: Result log queue is full, match result dropped.\n";
+        return;
+    }
+    playerStats.apply(record);  // Only results that reach the file, so the index stays in step with it
+}
 
-        // Write to the file
-        outFile << "Mode: " << mode << " | Date & Time: " << timeBuffer << " | Winner: " << winner << "\n";
-        outFile.close();
+// Function to handle the profiler keys and add its overlay to a screen's text batch. F4 shows
+// the overlay and records while it is shown; F5 writes what was recorded to profile_trace.json
+// (open it in chrome://tracing or ui.perfetto.dev).
+static void AddProfilerOverlay(HudBatch& batch, Font customFont) {
+    if (input.pressed(KEY_F4)) {
+        showProfiler = !showProfiler;
+        SetProfilerEnabled(showProfiler || profileFromStart);
     }
-    else {
-        cerr << "Error: Could not open file to log results.\n";
+    if (input.pressed(KEY_F5)) {
+        if (ExportChromeTrace("profile_trace.json")) TraceLog(LOG_INFO, "PROFILE: Wrote profile_trace.json");
+        else TraceLog(LOG_WARNING, "PROFILE: Could not write profile_trace.json");
+    }
+    if (!showProfiler) return;
+
+    // Refreshed twice a second, like the F3 overlay
+    if (profilerOverlayFrames++ % 30 == 0) {
+        ProfilePhaseStats stats[16];
+        int count = ProfilerPhaseStats(stats, 16);
+        char text[1024];
+        int used = snprintf(text, sizeof(text), "p50 / p99 us over 240 frames");
+        for (int i = 0; i < count && used < (int)sizeof(text); i++) {
+            used += snprintf(text + used, sizeof(text) - used, "\n%s  %.0f / %.0f", stats[i].name, stats[i].p50Micros, stats[i].p99Micros);
+        }
+        profilerText.setFont(customFont, 16.0f);
+        profilerText.set(text);
     }
+    batch.add(profilerText, { 560, 60 }, SKYBLUE);
 }
 
-// Function to Draw Button (with image and text)
-void DrawButton(Button button, Color textColor, Font customFont) {
-    DrawTexturePro(
-        button.image,
-        { 0.0f, 0.0f, (float)button.image.width, (float)button.image.height }, // Source rectangle
-        button.rect,                                                        // Destination rectangle
-        { 0.0f, 0.0f },                                                     // Origin
-        0.0f,                                                               // Rotation
-        WHITE                                                               // Tint color
-    );
+// Function to Draw Button (with image and text). The image is drawn right away, the text goes
+// into the screen's text batch.
+void DrawButton(Button& button, Color textColor, Font customFont, HudBatch& textBatch) {
+    if (button.image.valid()) {
+        DrawTexturePro(
+            button.image.texture(),
+            button.image.source(),  // Source rectangle (the image's place in the atlas)
+            button.rect,            // Destination rectangle
+            { 0.0f, 0.0f },         // Origin
+            0.0f,                   // Rotation
+            WHITE                   // Tint color
+        );
+    }
 
     // Draw button text with a shadow for a more beautiful look
-    int fontSize = 30;
-    Vector2 textSize = MeasureTextEx(customFont, button.text.c_str(), (float)fontSize, 1.0f);
-    DrawTextEx(customFont, button.text.c_str(),
-        { button.rect.x + (button.rect.width / 2 - textSize.x / 2) + 2,
-          button.rect.y + (button.rect.height / 2 - textSize.y / 2) + 2 }, 
-        fontSize, 1.0f, DARKGRAY);  // Text shadow
-
-    DrawTextEx(customFont, button.text.c_str(),
+    button.label.setFont(customFont, 30.0f);
+    button.label.set(button.text);
+    Vector2 textSize = button.label.size();
+    textBatch.addShadowed(button.label,
         { button.rect.x + (button.rect.width / 2 - textSize.x / 2),
           button.rect.y + (button.rect.height / 2 - textSize.y / 2) },
-        fontSize, 1.0f, textColor); // Main text
+        textColor, DARKGRAY);
 }
 
-// Function to load the menu and handle transitions
-bool ShowMenu(string& player1Name, string& player2Name, Font customFont) {
-    const int screenWidth = 792;
-    const int screenHeight = 534;
+// Function to convert simulation types to raylib types for drawing
+static Rectangle ToRectangle(const SimRect& rect) {
+    return { rect.x, rect.y, rect.width, rect.height };
+}
 
-    // Load resources
-    Texture2D background = LoadTexture("background.png");
-    Texture2D buttonImage = LoadTexture("button_image.png");
+static Vector2 ToVector2(SimVec2 vec) {
+    return { vec.x, vec.y };
+}
 
-    if (background.id == 0 || buttonImage.id == 0) {
-        while (!WindowShouldClose()) {
-            BeginDrawing();
-            ClearBackground(RED);
-            DrawText(
-                background.id == 0 ? "ERROR: 'background.png' not found!"
-                : "ERROR: 'button_image.png' not found!",
-                100, screenHeight / 2 - 20, 20, WHITE);
-            DrawText("Place the file in the same directory as the .exe!",
-                100, screenHeight / 2 + 20, 20, WHITE);
-            EndDrawing();
+// Retained HUD of a match: each label is laid out again only when the value in it changes,
+// and all of the text goes to the GPU as one batch
+struct MatchHud {
+    Font font;
+    string player1Name;
+    string player2Name;
+    HudText player1Hearts;
+    HudText player2Hearts;
+    HudText title;
+    HudText status;             // Optional line at the bottom (replay position, network stats)
+    HudText frameInfo;          // F3 overlay
+    int shownHearts[2];         // Values in the hearts labels (-1 = not laid out yet)
+    uint64_t framesSinceInfo;
+    uint64_t lastLayouts;
+    HudBatch batch;
+
+    MatchHud(const string& p1, const string& p2, Font customFont)
+        : font(customFont), player1Name(p1), player2Name(p2), player1Hearts(customFont, 20.0f), player2Hearts(customFont, 20.0f),
+          title(customFont, 30.0f), status(customFont, 20.0f), frameInfo(customFont, 18.0f), framesSinceInfo(0), lastLayouts(0) {
+        shownHearts[0] = shownHearts[1] = -1;
+        title.set("Pong Game");
+    }
+};
+
+// Particles of one match: a trail behind the ball, sparks where it hits a paddle or a wall
+// and a burst where it leaves the field. They are started from the difference between the
+// states of two frames, so local, replayed and network matches all get them.
+static const size_t MATCH_PARTICLES = 8192;
+
+struct MatchEffects {
+    ParticlePool particles;
+    PongState previous;
+    bool hasPrevious;
+
+    MatchEffects() : particles(MATCH_PARTICLES, (uint32_t)time(nullptr)), hasPrevious(false) {}
+
+    void update(const PongState& state, const PongConfig& config, float dt) {
+        PROFILE_SCOPE("particles");
+        particles.update(dt, 300.0f, 2.0f);
+
+        ParticleBurst trail;
+        trail.x = state.ballPosition.x;
+        trail.y = state.ballPosition.y;
+        trail.count = 3;
+        trail.minSpeed = 5.0f;
+        trail.maxSpeed = 30.0f;
+        trail.minLife = 0.15f;
+        trail.maxLife = 0.35f;
+        trail.size = config.ballRadius;
+        trail.color = { 200, 200, 255, 120 };
+        particles.emit(trail);
+
+        if (hasPrevious && !sameMatchAs(state)) hasPrevious = false;
+        if (hasPrevious) {
+            const PongState& last = previous;
+            ParticleBurst burst;
+            burst.spread = 2.2f;
+            if (state.playerHearts < last.playerHearts || state.opponentHearts < last.opponentHearts) {
+                // The ball left through the side of whoever lost the heart
+                bool rightSide = state.playerHearts < last.playerHearts;
+                burst.x = rightSide ? (float)config.screenWidth : 0.0f;
+                burst.y = last.ballPosition.y;
+                burst.angle = rightSide ? 3.1415927f : 0.0f;
+                burst.count = 400;
+                burst.minSpeed = 80.0f;
+                burst.maxSpeed = 520.0f;
+                burst.minLife = 0.5f;
+                burst.maxLife = 1.4f;
+                burst.size = 5.0f;
+                burst.color = rightSide ? ParticleColor{ 255, 80, 60, 255 } : ParticleColor{ 80, 255, 90, 255 };
+                particles.emit(burst);
+            }
+            else if ((state.ballSpeedVector.x < 0) != (last.ballSpeedVector.x < 0)) {
+                // Paddle hit: the player's paddle sends the ball left, the opponent's right
+                bool player = state.ballSpeedVector.x < 0;
+                burst.x = state.ballPosition.x;
+                burst.y = state.ballPosition.y;
+                burst.angle = player ? 3.1415927f : 0.0f;
+                burst.count = 60;
+                burst.color = player ? ParticleColor{ 255, 120, 100, 255 } : ParticleColor{ 120, 255, 130, 255 };
+                particles.emit(burst);
+            }
+            else if ((state.ballSpeedVector.y < 0) != (last.ballSpeedVector.y < 0)) {
+                burst.x = state.ballPosition.x;
+                burst.y = state.ballPosition.y;
+                burst.angle = state.ballSpeedVector.y < 0 ? -1.5707964f : 1.5707964f;
+                burst.count = 20;
+                burst.maxSpeed = 150.0f;
+                burst.color = { 255, 240, 180, 255 };
+                particles.emit(burst);
+            }
         }
-        CloseWindow();
-        return false; // Exit if resources are missing
+        previous = state;
+        hasPrevious = true;
+    }
+
+    // A replay can't go back, but a network match rolls back; a new match starts over
+    bool sameMatchAs(const PongState& state) const {
+        return state.tick >= previous.tick && state.playerHearts <= previous.playerHearts &&
+            state.opponentHearts <= previous.opponentHearts;
+    }
+};
+
+// Function to draw one frame of a match (between BeginDrawing and EndDrawing)
+void DrawMatch(const PongState& state, const PongConfig& config, MatchHud& hud, MatchEffects& effects) {
+    PROFILE_SCOPE("draw");
+    const int screenWidth = config.screenWidth;
+    const int screenHeight = config.screenHeight;
+
+    ClearBackground(BLACK);
+
+    // Draw paddles and ball
+    DrawRectangleRec(ToRectangle(state.playerPaddle), RED);  // Left paddle red
+    DrawRectangleRec(ToRectangle(state.opponentPaddle), GREEN);  // Right paddle green
+    DrawCircleV(ToVector2(state.ballPosition), config.ballRadius, WHITE);
+    {
+        PROFILE_SCOPE("draw particles");
+        DrawParticles(effects.particles);
+    }
+
+    PROFILE_SCOPE("hud text");
+    if (state.playerHearts != hud.shownHearts[0]) {
+        hud.player1Hearts.setFormat("%s's Hearts: %d", hud.player1Name.c_str(), state.playerHearts);
+        hud.shownHearts[0] = state.playerHearts;
     }
+    if (state.opponentHearts != hud.shownHearts[1]) {
+        hud.player2Hearts.setFormat("%s's Hearts: %d", hud.player2Name.c_str(), state.opponentHearts);
+        hud.shownHearts[1] = state.opponentHearts;
+    }
+
+    hud.batch.clear();
+    // Draw player 1 info on the left with red text
+    hud.batch.add(hud.player1Hearts, { 20, 20 }, RED);
+    // Draw player 2 info on the right with green text
+    hud.batch.add(hud.player2Hearts, { (float)(screenWidth - 200), 20 }, GREEN);
+    // Draw game name in the center with a beautiful font style
+    hud.batch.addCentered(hud.title, screenWidth / 2.0f, 20, YELLOW);
+    if (!hud.status.empty()) hud.batch.add(hud.status, { 20, (float)(screenHeight - 30) }, GRAY);
+
+    // F3: the previous frame's allocations and work time, refreshed twice a second so the
+    // overlay itself doesn't need a layout every frame
+    if (input.pressed(KEY_F3)) showFrameStats = !showFrameStats;
+    if (showFrameStats) {
+        uint64_t layouts = HudText::layoutCount();
+        if (hud.framesSinceInfo++ % 30 == 0) {
+            hud.frameInfo.setFormat("work %.0f us (avg %.0f)  allocs %llu (%llu B)  layouts %llu  glyphs %u  particles %u",
+                frameStats.workMicros(), frameStats.averageWorkMicros(), (unsigned long long)frameStats.allocations(),
+                (unsigned long long)frameStats.allocatedBytes(), (unsigned long long)(layouts - hud.lastLayouts),
+                (unsigned)hud.batch.quadCount(), (unsigned)effects.particles.size());
+        }
+        hud.lastLayouts = HudText::layoutCount();
+        hud.batch.add(hud.frameInfo, { 20, (float)(screenHeight - 55) }, SKYBLUE);
+    }
+    AddProfilerOverlay(hud.batch, hud.font);
 
-    // Buttons
-    Button buttons[2] = {
-        {{(float)(screenWidth / 2 - 100), 160.0f, 200.0f, 60.0f}, "Play with AI", buttonImage, false},
-        {{(float)(screenWidth / 2 - 100), 240.0f, 200.0f, 60.0f}, "Multiplayer", buttonImage, false}
-    };
+    hud.batch.draw(hud.font.texture, fonts.shader());
+}
+
+// Function to move this frame's keyboard input from raylib's queues into the event queue,
+// once per frame before the scenes update
+static void DrainInput() {
+    PROFILE_SCOPE("input");
+    input.beginFrame();
+    uint64_t now = SimClockNanos();
+    for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) input.push(INPUT_KEY_DOWN, (uint32_t)key, now);
+    for (int codepoint = GetCharPressed(); codepoint != 0; codepoint = GetCharPressed()) input.push(INPUT_TEXT, (uint32_t)codepoint, now);
+    // raylib keeps no queue of releases, so ask about every key that is down; this also
+    // catches a key pressed and released within the frame
+    for (int key = 0; key < INPUT_MAX_KEYS; key++) {
+        if (input.isDown(key) && !IsKeyDown(key)) input.push(INPUT_KEY_UP, (uint32_t)key, now);
+    }
+}
+
+// Function to get the paddle moves of one tick (the opponent's only in a two-player match)
+static PongInputs ReadMatchInputs(const InputTickState& keys, bool vsAI) {
+    PongInputs inputs = { 0, 0 };
+    inputs.player = (int8_t)((keys.isDown(KEY_S) ? 1 : 0) - (keys.isDown(KEY_W) ? 1 : 0));
+    if (!vsAI) {
+        inputs.opponent = (int8_t)((keys.isDown(KEY_DOWN) ? 1 : 0) - (keys.isDown(KEY_UP) ? 1 : 0));
+    }
+    return inputs;
+}
+
+// Latency of a local match, both measured just before the frame is handed to EndDrawing:
+// from reading a changed input to the first frame whose state includes it, and how old the
+// drawn state is at that point
+struct MatchLatency {
+    LatencySamples inputToSubmit;
+    LatencySamples stateAge;
+};
+
+static void LogMatchLatency(const char* loop, const MatchLatency& latency) {
+    TraceLog(LOG_INFO, "LATENCY: %s: input to frame p50 %.1f ms p99 %.1f ms (%d changes), drawn state age p50 %.1f ms p99 %.1f ms",
+        loop, latency.inputToSubmit.percentile(50) / 1000.0, latency.inputToSubmit.percentile(99) / 1000.0,
+        (int)latency.inputToSubmit.count(), latency.stateAge.percentile(50) / 1000.0, latency.stateAge.percentile(99) / 1000.0);
+}
 
-    bool exitGame = false;
+// Game over screen. "Main Menu" goes back to the scene underneath (the menu, or the end of a
+// network game).
+class GameOverScene : public Scene {
+public:
+    GameOverScene(bool playerWon, bool vsAI, const string& player1Name, const string& player2Name, Font customFont)
+        : font_(customFont), mainMenuButton_{ {SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 + 40, 200, 60}, "Main Menu", {}, false },
+          winnerText_(customFont, 40.0f) {
+        string winner = playerWon ? player1Name : (vsAI ? "AI" : player2Name);
+        string loser = playerWon ? (vsAI ? "AI" : player2Name) : player1Name;
+        string mode = vsAI ? "AI vs Player" : "Multiplayer";
+
+        // Log the result only once and with a valid winner
+        LogGameResult(mode, winner, loser);  // Log only if a valid winner exists
+        winnerText_.set(winner + " Wins!");
+    }
 
-    while (!WindowShouldClose() && !exitGame) {
+    void update(float) override {
         Vector2 mousePoint = GetMousePosition();
-        for (int i = 0; i < 2; i++) {
-            buttons[i].hovered = CheckCollisionPointRec(mousePoint, buttons[i].rect);
+        mainMenuButton_.hovered = CheckCollisionPointRec(mousePoint, mainMenuButton_.rect);
+
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && mainMenuButton_.hovered) {
+            scenes.pop(); // Return to main menu
         }
+    }
 
-        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            if (buttons[0].hovered) {
-                return true;  // Play with AI
-            }
-            if (buttons[1].hovered) {
-                player1Name = "";
-                player2Name = "";
-                return false; // Multiplayer
-            }
+    void draw() override {
+        ClearBackground(BLACK);
+
+        // Draw winner text with shadow and better font style
+        textBatch_.clear();
+        textBatch_.addShadowed(winnerText_,
+            { SCREEN_WIDTH / 2 - winnerText_.size().x / 2, (float)(SCREEN_HEIGHT / 2 - 30) }, GREEN, DARKGRAY);
+
+        DrawButton(mainMenuButton_, mainMenuButton_.hovered ? GOLD : WHITE, font_, textBatch_);
+        AddProfilerOverlay(textBatch_, font_);
+        textBatch_.draw(font_.texture, fonts.shader());
+    }
+
+private:
+    Font font_;
+    Button mainMenuButton_;
+    HudText winnerText_;
+    HudBatch textBatch_;
+};
+
+// Top 10 players until "Back" is clicked. The menu prepares it, so the table is laid out
+// before the screen opens.
+class LeaderboardScene : public Scene {
+public:
+    explicit LeaderboardScene(Font customFont)
+        : font_(customFont), backButton_{ {SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT - 90, 200, 60}, "Back", {}, false } {}
+
+    bool warmUp() override {
+        if (!built_) build();
+        return true;
+    }
+
+    void enter() override {
+        if (!built_) build();
+    }
+
+    void update(float) override {
+        Vector2 mousePoint = GetMousePosition();
+        backButton_.hovered = CheckCollisionPointRec(mousePoint, backButton_.rect);
+
+        if ((IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && backButton_.hovered) || input.pressed(KEY_BACKSPACE)) {
+            scenes.pop();
         }
+    }
 
-        BeginDrawing();
+    void draw() override {
         ClearBackground(BLACK);
-        DrawTexturePro(
-            background,
-            { 0.0f, 0.0f, (float)background.width, (float)background.height },
-            { 0.0f, 0.0f, (float)screenWidth, (float)screenHeight },
-            { 0.0f, 0.0f },
-            0.0f,
-            WHITE
-        );
 
-        DrawTextEx(customFont, "Welcome to the Pong Game!",
-            { (float)(screenWidth / 2 - MeasureText("Welcome to the Pong Game!", 30) / 2),
-            50 }, 30, 1.0f, RAYWHITE);
+        // Keep the table, replace the button text of the previous frame
+        table_.truncate(tableQuads_);
+        DrawButton(backButton_, backButton_.hovered ? GOLD : WHITE, font_, table_);
+        AddProfilerOverlay(table_, font_);
+        table_.draw(font_.texture, fonts.shader());
+    }
+
+private:
+    // Function to lay out the table once into one batch (it doesn't change while the screen is open)
+    void build() {
+        vector<const PlayerStats*> top;
+        playerStats.top(10, top);
 
-        for (int i = 0; i < 2; i++) {
-            DrawButton(buttons[i], buttons[i].hovered ? GOLD : WHITE, customFont);
+        const float columns[] = { 40, 90, 360, 430, 500, 580, 680 };
+        const char* headers[] = { "#", "Player", "Wins", "Losses", "Win %", "Streak", "Best" };
+
+        HudText title(font_, 40.0f);
+        title.set("Leaderboard");
+        table_.clear();
+        table_.addCentered(title, SCREEN_WIDTH / 2.0f, 20, GOLD);
+
+        HudText cell(font_, 22.0f);
+        for (int c = 0; c < 7; c++) {
+            cell.set(headers[c]);
+            table_.add(cell, { columns[c], 80 }, GRAY);
         }
 
-        EndDrawing();
+        if (top.empty()) {
+            HudText empty(font_, 24.0f);
+            empty.set("No matches played yet");
+            table_.add(empty, { columns[1], 120 }, RAYWHITE);
+        }
+
+        for (size_t i = 0; i < top.size(); i++) {
+            const PlayerStats& player = *top[i];
+            float y = 112.0f + 30.0f * i;
+            char cells[7][64];
+            sprintf(cells[0], "%d", (int)i + 1);
+            snprintf(cells[1], sizeof(cells[1]), "%s", player.name.c_str());
+            sprintf(cells[2], "%u", player.wins);
+            sprintf(cells[3], "%u", player.losses);
+            sprintf(cells[4], "%.0f", player.matches() ? 100.0 * player.wins / player.matches() : 0.0);
+            if (player.streak == 0) sprintf(cells[5], "-");
+            else sprintf(cells[5], "%s%d", player.streak > 0 ? "W" : "L", player.streak > 0 ? player.streak : -player.streak);
+            sprintf(cells[6], "%u", player.bestStreak);
+
+            Color color = i == 0 ? GOLD : RAYWHITE;
+            for (int c = 0; c < 7; c++) {
+                cell.set(cells[c]);
+                table_.add(cell, { columns[c], y }, color);
+            }
+        }
+
+        HudText footer(font_, 18.0f);
+        footer.setFormat("%d players, %d matches", (int)playerStats.playerCount(), (int)playerStats.recordsApplied());
+        table_.add(footer, { columns[0], (float)(SCREEN_HEIGHT - 120) }, GRAY);
+        tableQuads_ = table_.quadCount();
+        built_ = true;
     }
 
-    UnloadTexture(background);
-    UnloadTexture(buttonImage);
+    Font font_;
+    Button backButton_;
+    HudBatch table_;
+    size_t tableQuads_ = 0;
+    bool built_ = false;
+};
 
-    return false;
+// Function to get the rules of a local match: ticks at SIM_TICK_RATE, or 60 Hz with --serial-sim
+static PongConfig LocalMatchConfig() {
+    PongConfig config;
+    config.seed = (uint32_t)time(nullptr);  // Only used with serveJitter, but recorded in the replay
+    if (!serialSim) config.dt = 1.0f / SIM_TICK_RATE;
+    return config;
 }
 
-// Function to show the Game Over screen with "Main Menu" option
-bool ShowGameOverScreen(bool playerWon, bool vsAI, const string& player1Name, const string& player2Name, Font customFont) {
-    const int screenWidth = 792;
-    const int screenHeight = 534;
+// Checkpoint of the running local match, left behind if the game quits or crashes mid-match
+static const char* MATCH_CHECKPOINT_PATH = "match_checkpoint.pbs";
+static const uint64_t MATCH_CHECKPOINT_NANOS = 2000000000ull;  // How often one is taken
+
+// Function to get the search AI of a local match, if --search-ai asked for it. It searches on
+// the simulation thread and all cores but one, which is left for rendering.
+static unique_ptr<MctsAI> LocalMatchSearchAi(bool vsAI) {
+    if (!vsAI || !searchAI) return nullptr;
+    MctsSettings settings;
+    settings.threads = max(1, (int)thread::hardware_concurrency() - 1);
+    return unique_ptr<MctsAI>(new MctsAI(settings, false, (uint32_t)time(nullptr)));
+}
 
-    string winner = playerWon ? player1Name : (vsAI ? "AI" : player2Name);
-    string mode = vsAI ? "AI vs Player" : "Multiplayer";
+// Function to get the AI of a local match. It reacts a number of ticks after a bounce; keep
+// that the same time at any tick rate.
+static AiSettings LocalMatchAi(const PongConfig& config) {
+    AiSettings settings = AiSettingsFor(AI_NORMAL);
+    settings.reactionTicks = (int)lround(settings.reactionTicks / 60.0f / config.dt);
+    return settings;
+}
 
-    // Log the result only once and with a valid winner
-    LogGameResult(mode, winner);  // Log only if a valid winner exists
+// A match on this machine, against the AI or two players on one keyboard. Steps on the
+// simulation thread (see sim_thread.h) without ever waiting on it: each frame draws the match
+// as of the moment it draws, between the newest two ticks or stepped on from the newest with
+// the frame's keys. --serial-sim steps it on this thread instead, by
+// whatever frame time has accumulated (the loop before the simulation thread, kept to compare
+// against). Ends in the game over screen.
+//
+// Every couple of seconds the match is checkpointed (see match_snapshot.h); the menu offers to
+// resume from the checkpoint when the last match didn't get to the end.
+class MatchScene : public Scene {
+public:
+    MatchScene(bool vsAI, const string& player1Name, const string& player2Name, Font customFont)
+        : vsAI_(vsAI), player1Name_(player1Name), player2Name_(player2Name), font_(customFont),
+          config_(LocalMatchConfig()), ai_(LocalMatchAi(config_), false, (uint32_t)time(nullptr)),
+          hud_(player1Name, player2Name, customFont), serialSim_(config_), search_(LocalMatchSearchAi(vsAI)) {
+        recorder_.begin(config_, vsAI, player1Name, player2Name);
+        shown_ = serialSim_.state();
+    }
 
-    Button mainMenuButton = { {screenWidth / 2 - 100, screenHeight / 2 + 40, 200, 60}, "Main Menu", {}, false };
+    // Function to continue a checkpointed match. It has no replay: one has to start at the serve.
+    MatchScene(const MatchSnapshot& checkpoint, Font customFont)
+        : vsAI_(checkpoint.vsAI != 0), player1Name_(checkpoint.player1Name), player2Name_(checkpoint.player2Name),
+          font_(customFont), config_(checkpoint.config), ai_(LocalMatchAi(config_), false, (uint32_t)time(nullptr)),
+          hud_(player1Name_, player2Name_, customFont), serialSim_(config_), search_(LocalMatchSearchAi(vsAI_)),
+          resumed_(true) {
+        if (checkpoint.hasAI) ai_.restore(checkpoint.ai);
+        serialSim_.restore(checkpoint.state);
+        shown_ = serialSim_.state();
+    }
 
-    while (!WindowShouldClose()) {
-        Vector2 mousePoint = GetMousePosition();
-        mainMenuButton.hovered = CheckCollisionPointRec(mousePoint, mainMenuButton.rect);
+    ~MatchScene() {
+        if (started_ && !ended_) {
+            // Window closed mid-match: checkpoint where it stopped, to resume next time
+            endMatch();
+            checkpoint(sim_ ? sim_->latest().current : serialSim_.state(), sim_ ? sim_->latest().ai : ai_.save());
+        }
+    }
+
+    // Lays out the HUD labels, so the first frame of the match doesn't have to
+    bool warmUp() override {
+        hud_.player1Hearts.setFormat("%s's Hearts: %d", hud_.player1Name.c_str(), shown_.playerHearts);
+        hud_.player2Hearts.setFormat("%s's Hearts: %d", hud_.player2Name.c_str(), shown_.opponentHearts);
+        hud_.shownHearts[0] = shown_.playerHearts;
+        hud_.shownHearts[1] = shown_.opponentHearts;
+        return true;
+    }
 
-        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && mainMenuButton.hovered) {
-            return true; // Return to main menu
+    void enter() override {
+        started_ = true;
+        keys_.catchUp(input);   // Keys held when the match opens count, older presses don't
+        if (!checkpoints_) checkpoints_.reset(new CheckpointWriter(MATCH_CHECKPOINT_PATH));
+        if (lastCheckpointNanos_ == 0) lastCheckpointNanos_ = SimClockNanos();
+        if (serialSim || sim_) return;
+        sim_.reset(new SimThread(config_, vsAI_ ? &ai_ : nullptr, resumed_ ? nullptr : &recorder_, search_.get()));
+        if (resumed_) sim_->restore(serialSim_.state());
+        sim_->start();
+    }
+
+    void update(float dt) override {
+        if (ended_) return;
+        const uint64_t now = SimClockNanos();
+
+        if (serialSim) {
+            // Run the physics in fixed steps so the result doesn't depend on the frame rate
+            accumulator_ += dt;
+            if (accumulator_ > 0.25f) accumulator_ = 0.25f; // Don't try to catch up after a long stall
+            stepped_ = false;
+            while (accumulator_ >= config_.dt && !serialSim_.isOver()) {
+                // Keys are taken at tick boundaries: the first tick of the frame gets this frame's
+                // events, the ones after it only end the taps
+                keys_.advance(input, now);
+                PongInputs inputs = ReadMatchInputs(keys_, vsAI_);
+                noteInputs(inputs, now);
+                const uint64_t tickStart = SimClockNanos();
+                const PongState before = serialSim_.state();
+                if (vsAI_) {
+                    PROFILE_SCOPE("ai");
+                    inputs.opponent = search_ ? search_->decide(serialSim_.state(), config_) : ai_.decide(serialSim_.state(), config_);
+                }
+                uint32_t events;
+                {
+                    PROFILE_SCOPE("physics");
+                    events = serialSim_.step(inputs);
+                }
+                RecordSimTickMetrics(SimClockNanos() - tickStart, events, before);
+                if (!resumed_) {
+                    PROFILE_SCOPE("replay record");
+                    recorder_.record(inputs, serialSim_.state());
+                }
+                accumulator_ -= config_.dt;
+                stepped_ = true;
+            }
+            shown_ = serialSim_.state();
+            shownNanos_ = SimClockNanos() - (uint64_t)(accumulator_ * 1e9f);  // Time the state belongs to
+            effects_.update(shown_, config_, dt);
+            if (serialSim_.isOver()) finish(serialSim_.playerWon());
+            else if (now - lastCheckpointNanos_ >= MATCH_CHECKPOINT_NANOS) checkpoint(serialSim_.state(), ai_.save());
+            return;
         }
 
-        BeginDrawing();
+        const uint64_t tickNanos = sim_->tickNanos();
+        keys_.advance(input, now);
+        PongInputs inputs = ReadMatchInputs(keys_, vsAI_);
+        bool changed = noteInputs(inputs, now);
+        // Handing the inputs over starts the next tick early; nothing here waits for it
+        uint32_t sequence = sim_->setInputs(inputs);
+        if (changed) pendingSequence_ = sequence;
+
+        // Draw the match as of now: between the last two ticks, or stepped on from the newest
+        // one with this frame's keys when the simulation hasn't got to now yet
+        const SimSnapshot& snapshot = sim_->latest();
+        float alpha = SnapshotAlpha(snapshot, SimClockNanos(), tickNanos);
+        PongInputs moves = inputs;
+        if (vsAI_) moves.opponent = LastPaddleMoves(snapshot.previous, snapshot.current).opponent;
+        shown_ = InterpolatePongState(snapshot.previous, snapshot.current, alpha, config_, moves);
+        shownNanos_ = snapshot.currentNanos + (int64_t)((alpha - 1.0f) * tickNanos);
+        shownSequence_ = alpha > 1.0f ? sequence : snapshot.inputSequence;
+        effects_.update(shown_, config_, dt);
+        if (snapshot.over) finish(snapshot.current.playerHearts > 0);
+        else if (now - lastCheckpointNanos_ >= MATCH_CHECKPOINT_NANOS) checkpoint(snapshot.current, snapshot.ai);
+    }
+
+    void draw() override {
+        DrawMatch(shown_, config_, hud_, effects_);
+
+        uint64_t submitNanos = SimClockNanos();
+        bool includesChange = serialSim ? stepped_ : pendingSequence_ != 0 && shownSequence_ >= pendingSequence_;
+        if (changedNanos_ != 0 && includesChange) {
+            latency_.inputToSubmit.add((submitNanos - changedNanos_) / 1000.0);
+            changedNanos_ = 0;
+            pendingSequence_ = 0;
+        }
+        latency_.stateAge.add((submitNanos - shownNanos_) / 1000.0);
+    }
+
+private:
+    // Function to remember the inputs of a tick; true if they differ from the last ones
+    bool noteInputs(const PongInputs& inputs, uint64_t nanos) {
+        if (inputs.player == lastInputs_.player && inputs.opponent == lastInputs_.opponent) return false;
+        changedNanos_ = nanos;
+        lastInputs_ = inputs;
+        return true;
+    }
+
+    // Function to hand a checkpoint of the match to the writer thread (a copy, no waiting)
+    void checkpoint(const PongState& state, const PongAIState& ai) {
+        lastCheckpointNanos_ = SimClockNanos();
+        checkpoints_->submit(CaptureMatch(config_, state, vsAI_ ? &ai : nullptr, vsAI_, player1Name_, player2Name_));
+    }
+
+    void finish(bool playerWon) {
+        endMatch();
+        checkpoints_->discard();    // Nothing left to resume
+        scenes.replace(unique_ptr<Scene>(new GameOverScene(playerWon, vsAI_, player1Name_, player2Name_, font_)));
+    }
+
+    // Function to stop the simulation and write out what the match leaves behind
+    void endMatch() {
+        ended_ = true;
+        if (sim_) {
+            sim_->stop();
+            const SimThreadStats& stats = sim_->stats();
+            TraceLog(LOG_INFO, "SIM: %llu ticks, %llu caught up late (max %.1f ms), %llu dropped",
+                (unsigned long long)stats.ticks, (unsigned long long)stats.lateTicks, stats.maxLateNanos / 1e6,
+                (unsigned long long)stats.droppedTicks);
+        }
+        LogMatchLatency(serialSim ? "serial" : "threaded", latency_);
+        if (search_) {
+            const MctsStats& stats = search_->stats();
+            TraceLog(LOG_INFO, "SEARCH AI: %llu decisions on %d threads, %.0f us average (max %.0f us), %.0f rollouts each",
+                (unsigned long long)stats.decisions, search_->threadCount(),
+                stats.decisions ? stats.totalNanos / 1e3 / stats.decisions : 0.0, stats.maxNanos / 1e3,
+                stats.decisions ? (double)stats.rollouts / stats.decisions : 0.0);
+        }
+        if (!resumed_) recorder_.save("last_replay.pbr");  // Replay of the latest match, for bug reports
+    }
+
+    bool vsAI_;
+    string player1Name_;
+    string player2Name_;
+    Font font_;
+    PongConfig config_;
+    PongAI ai_;
+    ReplayRecorder recorder_;
+    MatchHud hud_;
+    MatchEffects effects_;
+    MatchLatency latency_;
+
+    PongSim serialSim_;                 // --serial-sim
+    float accumulator_ = 0.0f;          // Frame time not yet simulated
+    bool stepped_ = false;
+    unique_ptr<MctsAI> search_;         // --search-ai, moves the opponent instead of ai_
+    unique_ptr<SimThread> sim_;         // Otherwise, started when the scene is first shown
+
+    InputTickState keys_;
+    PongState shown_;                   // State drawn this frame
+    uint64_t shownNanos_ = 0;           // Time it belongs to
+    uint32_t shownSequence_ = 0;        // Newest input it includes
+    PongInputs lastInputs_ = { 0, 0 };
+    uint64_t changedNanos_ = 0;         // When a changed input not yet drawn was read, 0 if none
+    uint32_t pendingSequence_ = 0;
+    bool started_ = false;              // Shown at least once (a prepared match may never be)
+    bool ended_ = false;
+
+    bool resumed_ = false;              // Continued from a checkpoint
+    unique_ptr<CheckpointWriter> checkpoints_;  // Created when the match is first shown
+    uint64_t lastCheckpointNanos_ = 0;
+};
+
+// Name entry for a two-player match: player 1, then player 2, then the match
+class NameEntryScene : public Scene {
+public:
+    NameEntryScene(int player, const string& player1Name, Font customFont)
+        : player_(player), player1Name_(player1Name), font_(customFont),
+          promptText_(customFont, 20.0f), nameText_(customFont, 20.0f), hintText_(customFont, 20.0f) {
+        promptText_.setFormat("Enter Player %d Name: ", player);
+        hintText_.set("Press Enter to confirm name");
+    }
+
+    void update(float) override {
+        // Typed characters in the order they came, as UTF-8; names are limited to 49 bytes
+        // (RESULT_NAME_SIZE) and never cut inside a character
+        for (uint64_t i = input.frameBegin(); i < input.end(); i++) {
+            const InputEvent& event = input.at(i);
+            if (event.type == INPUT_TEXT) AppendUtf8(playerName_, event.value, 49);
+            else if (event.type == INPUT_KEY_DOWN && event.value == KEY_BACKSPACE) PopUtf8(playerName_);
+            else if (event.type == INPUT_KEY_DOWN && event.value == KEY_ENTER && !playerName_.empty()) {
+                if (player_ == 1) scenes.replace(unique_ptr<Scene>(new NameEntryScene(2, playerName_, font_)));
+                else scenes.replace(unique_ptr<Scene>(new MatchScene(false, player1Name_, playerName_, font_)));
+                return;
+            }
+        }
+    }
+
+    void draw() override {
         ClearBackground(BLACK);
 
-        // Draw winner text with shadow and better font style
-        DrawTextEx(customFont, (winner + " Wins!").c_str(),
-            { (float)(screenWidth / 2 - MeasureText((winner + " Wins!").c_str(), 40) / 2) + 2,
-              (float)(screenHeight / 2 - 30) + 2 }, 40, 1.0f, DARKGRAY); // Shadow
-        DrawTextEx(customFont, (winner + " Wins!").c_str(),
-            { (float)(screenWidth / 2 - MeasureText((winner + " Wins!").c_str(), 40) / 2),
-              (float)(screenHeight / 2 - 30) }, 40, 1.0f, GREEN); // Main text
+        // Draw text with a better font style (the name is laid out again only after a key press)
+        nameText_.set(playerName_);
+        textBatch_.clear();
+        textBatch_.addCentered(promptText_, SCREEN_WIDTH / 2.0f, 100, WHITE);
+        textBatch_.addCentered(nameText_, SCREEN_WIDTH / 2.0f, 130, WHITE);
+        textBatch_.addCentered(hintText_, SCREEN_WIDTH / 2.0f, 180, WHITE);
+        AddProfilerOverlay(textBatch_, font_);
+        textBatch_.draw(font_.texture, fonts.shader());
+    }
 
-        DrawButton(mainMenuButton, mainMenuButton.hovered ? GOLD : WHITE, customFont);
+private:
+    int player_;
+    string player1Name_;        // Entered on the previous screen (player 2's only)
+    string playerName_;
+    Font font_;
+    HudText promptText_;
+    HudText nameText_;
+    HudText hintText_;
+    HudBatch textBatch_;
+};
 
-        EndDrawing();
+// Main menu. Stays at the bottom of the stack with its images while the other screens come
+// and go, and prepares the AI match and the leaderboard while it is shown.
+class MenuScene : public Scene {
+public:
+    explicit MenuScene(Font customFont)
+        : font_(customFont), title_(customFont, 30.0f) {
+        title_.set("Welcome to the Pong Game!");
     }
 
-    return false; // Default to exit
-}
+    void enter() override {
+        // Resources (already on the GPU, loaded at startup)
+        if (!background_.valid()) background_ = assets.acquire("background.png");
+        if (!buttonImage_.valid()) {
+            buttonImage_ = assets.acquire("button_image.png");
+            const char* labels[4] = { "Play with AI", "Multiplayer", "Leaderboard", "Resume Match" };
+            for (int i = 0; i < 4; i++) {
+                buttons_[i].rect = { (float)(SCREEN_WIDTH / 2 - 100), 160.0f + 80.0f * i, 200.0f, 60.0f };
+                buttons_[i].text = labels[i];
+                buttons_[i].image = buttonImage_;
+                buttons_[i].hovered = false;
+            }
+        }
 
-// Function to capture a single player's name
-void CapturePlayerName(string& playerName, const string& prompt, Font customFont) {
-    const int screenWidth = 792;
-    const int screenHeight = 534;
+        // The last match may have been cut short (the window closed, or the game crashed)
+        hasCheckpoint_ = LoadCheckpoint(MATCH_CHECKPOINT_PATH, checkpoint_) &&
+            checkpoint_.state.playerHearts > 0 && checkpoint_.state.opponentHearts > 0;
 
-    // Input buffer for player name
-    playerName = "";
+        // A match may have changed the standings, so the leaderboard is laid out again each time
+        if (!scenes.isPrepared("ai match")) scenes.prepare("ai match", unique_ptr<Scene>(new MatchScene(true, "Player 1", "AI", font_)));
+        scenes.prepare("leaderboard", unique_ptr<Scene>(new LeaderboardScene(font_)));
+    }
 
-    while (!WindowShouldClose()) {
-        // Handle text input
-        if (IsKeyPressed(KEY_BACKSPACE) && playerName.length() > 0) {
-            playerName.pop_back();  // Remove last character on backspace
+    void update(float) override {
+        if (!background_.valid() || !buttonImage_.valid()) return;  // Only the error message
+
+        Vector2 mousePoint = GetMousePosition();
+        for (int i = 0; i < buttonCount(); i++) {
+            buttons_[i].hovered = CheckCollisionPointRec(mousePoint, buttons_[i].rect);
         }
 
-        // Allow characters to be typed (A-Z, a-z, space, etc.)
-        for (int i = 32; i < 123; ++i) {
-            if (IsKeyPressed(i)) {
-                if (playerName.length() < 49) {  // Limit name to 50 characters
-                    playerName += static_cast<char>(i);
-                }
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            if (buttons_[0].hovered) {
+                unique_ptr<Scene> match = scenes.takePrepared("ai match");
+                if (!match) match.reset(new MatchScene(true, "Player 1", "AI", font_));
+                scenes.push(move(match));
+            }
+            else if (buttons_[1].hovered) {
+                scenes.push(unique_ptr<Scene>(new NameEntryScene(1, "", font_)));
+            }
+            else if (buttons_[2].hovered) {
+                unique_ptr<Scene> leaderboard = scenes.takePrepared("leaderboard");
+                if (!leaderboard) leaderboard.reset(new LeaderboardScene(font_));
+                scenes.push(move(leaderboard));
+            }
+            else if (hasCheckpoint_ && buttons_[3].hovered) {
+                scenes.push(unique_ptr<Scene>(new MatchScene(checkpoint_, font_)));
             }
         }
+    }
 
-        BeginDrawing();
-        ClearBackground(BLACK);
+    void draw() override {
+        if (!background_.valid() || !buttonImage_.valid()) {
+            ClearBackground(RED);
+            DrawText(
+                !background_.valid() ? "ERROR: 'background.png' not found!"
+                : "ERROR: 'button_image.png' not found!",
+                100, SCREEN_HEIGHT / 2 - 20, 20, WHITE);
+            DrawText("Place the file in the same directory as the .exe!",
+                100, SCREEN_HEIGHT / 2 + 20, 20, WHITE);
+            return;
+        }
 
-        // Draw text with a better font style
-        DrawTextEx(customFont, prompt.c_str(), 
-            { (float)(screenWidth / 2 - MeasureText(prompt.c_str(), 20) / 2), 100 }, 20, 1.0f, WHITE);
-        DrawTextEx(customFont, playerName.c_str(),
-            { (float)(screenWidth / 2 - MeasureText(playerName.c_str(), 20) / 2), 130 }, 20, 1.0f, WHITE);
-        DrawTextEx(customFont, "Press Enter to confirm name", 
-            { (float)(screenWidth / 2 - MeasureText("Press Enter to confirm name", 20) / 2), 180 }, 20, 1.0f, WHITE);
+        // Into the same rectangle it was fitted to when decoded (see FitRectangle), so a picture
+        // of another aspect ratio gets black bars instead of being stretched
+        ClearBackground(BLACK);
+        const Rectangle source = background_.source();
+        DrawTexturePro(
+            background_.texture(),
+            source,
+            FitRectangle(source.width, source.height, { 0.0f, 0.0f, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT }),
+            { 0.0f, 0.0f },
+            0.0f,
+            WHITE
+        );
 
-        EndDrawing();
+        textBatch_.clear();
+        textBatch_.addCentered(title_, SCREEN_WIDTH / 2.0f, 50, RAYWHITE);
 
-        if (IsKeyPressed(KEY_ENTER) && playerName.length() > 0) {
-            break;
+        for (int i = 0; i < buttonCount(); i++) {
+            DrawButton(buttons_[i], buttons_[i].hovered ? GOLD : WHITE, font_, textBatch_);
         }
+        AddProfilerOverlay(textBatch_, font_);
+        textBatch_.draw(font_.texture, fonts.shader());
     }
-}
 
-// Full StartGame function implementation
-void StartGame(bool vsAI, const string& player1Name, const string& player2Name, Font customFont) {
-    const int screenWidth = 792;
-    const int screenHeight = 534;
-    const float paddleSpeed = 400.0f;
-    const float ballSpeed = 350.0f;
-    const int maxHearts = 5;
+private:
+    int buttonCount() const { return hasCheckpoint_ ? 4 : 3; }
+
+    Font font_;
+    AssetHandle background_;
+    AssetHandle buttonImage_;
+    Button buttons_[4];
+    HudText title_;
+    HudBatch textBatch_;
+    MatchSnapshot checkpoint_;      // Of a match cut short, if hasCheckpoint_
+    bool hasCheckpoint_ = false;
+};
 
-    Rectangle playerPaddle = { screenWidth - 70, screenHeight / 2 - 60, 20, 120 };
-    Rectangle opponentPaddle = { 50, screenHeight / 2 - 60, 20, 120 };
-    Vector2 ballPosition = { screenWidth / 2, screenHeight / 2 };
-    Vector2 ballSpeedVector = { -ballSpeed, ballSpeed };
+// Progress bar until the preloaded images are on the GPU, then the first real scene (none:
+// the game ends)
+class LoadingScene : public Scene {
+public:
+    LoadingScene(unique_ptr<Scene> next, Font customFont)
+        : next_(move(next)), font_(customFont) {
+        HudText loading(customFont, 24.0f);
+        loading.set("Loading...");
+        textBatch_.addCentered(loading, SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f - 50, RAYWHITE);
+    }
 
-    int playerScore = 0;
-    int opponentScore = 0;
-    int playerHearts = maxHearts;
-    int opponentHearts = maxHearts;
+    void update(float) override {
+        if (!assets.ready()) return;
 
-    SetTargetFPS(60);
+        const AssetReport& report = assets.report();
+        TraceLog(LOG_INFO, "ASSETS: %d images ready in %.1f ms (decode %.1f ms, upload %.1f ms), %d in a %dx%d atlas, %d separate",
+            report.images, report.readyMillis, report.decodeMillis, report.uploadMillis, report.packed,
+            report.atlasWidth, report.atlasHeight, report.standalone);
+        assetsReadySeconds.set(report.readyMillis / 1000.0);
+        TraceLog(LOG_INFO, "ASSETS: %.2f MB of textures (%.2f MB as separate full-size textures)",
+            report.textureBytes / 1048576.0, report.unpackedBytes / 1048576.0);
 
-    while (!WindowShouldClose()) {
-        if (IsKeyDown(KEY_W) && playerPaddle.y > 0) playerPaddle.y -= paddleSpeed * GetFrameTime();
-        if (IsKeyDown(KEY_S) && playerPaddle.y + playerPaddle.height < screenHeight) playerPaddle.y += paddleSpeed * GetFrameTime();
+        if (next_) scenes.replace(move(next_));
+        else scenes.pop();
+    }
+
+    void draw() override {
+        Rectangle bar = { SCREEN_WIDTH / 2.0f - 150, SCREEN_HEIGHT / 2.0f, 300, 16 };
+        ClearBackground(BLACK);
+        textBatch_.draw(font_.texture, fonts.shader());
+        DrawRectangleLinesEx(bar, 2, GRAY);
+        DrawRectangle((int)bar.x + 4, (int)bar.y + 4, (int)((bar.width - 8) * assets.progress()), (int)bar.height - 8, GOLD);
+    }
+
+private:
+    unique_ptr<Scene> next_;
+    Font font_;
+    HudBatch textBatch_;
+};
 
-        if (!vsAI) {
-            if (IsKeyDown(KEY_UP) && opponentPaddle.y > 0) opponentPaddle.y -= paddleSpeed * GetFrameTime();
-            if (IsKeyDown(KEY_DOWN) && opponentPaddle.y + opponentPaddle.height < screenHeight) opponentPaddle.y += paddleSpeed * GetFrameTime();
+// Playback of a recorded match. SPACE pauses, LEFT/RIGHT change the speed (1/4x to 64x).
+class ReplayScene : public Scene {
+public:
+    ReplayScene(Replay replay, Font customFont)
+        : replay_(move(replay)), config_(replay_.config()), sim_(config_), cursor_(replay_),
+          hud_(replay_.playerName(), replay_.opponentName(), customFont) {}
+
+    void update(float dt) override {
+        if (input.pressed(KEY_SPACE)) paused_ = !paused_;
+        if (input.pressed(KEY_RIGHT) && speed_ < 64.0f) speed_ *= 2.0f;
+        if (input.pressed(KEY_LEFT) && speed_ > 0.25f) speed_ *= 0.5f;
+        if (finished_ && input.pressed(KEY_ENTER)) {
+            scenes.pop();
+            return;
         }
-        else {
-            if (ballPosition.y < opponentPaddle.y && opponentPaddle.y > 0) opponentPaddle.y -= paddleSpeed * GetFrameTime();
-            if (ballPosition.y > opponentPaddle.y + opponentPaddle.height && opponentPaddle.y + opponentPaddle.height < screenHeight) opponentPaddle.y += paddleSpeed * GetFrameTime();
+
+        if (!paused_) accumulator_ += dt * speed_;
+        if (accumulator_ > 0.25f * speed_) accumulator_ = 0.25f * speed_;
+        PongInputs inputs;
+        while (accumulator_ >= config_.dt && !finished_) {
+            if (!cursor_.next(inputs)) {
+                finished_ = true;
+                break;
+            }
+            PROFILE_SCOPE("physics");
+            sim_.step(inputs);
+            accumulator_ -= config_.dt;
         }
+        effects_.update(sim_.state(), config_, paused_ ? 0.0f : dt);
 
-        ballPosition.x += ballSpeedVector.x * GetFrameTime();
-        ballPosition.y += ballSpeedVector.y * GetFrameTime();
+        hud_.status.set(finished_
+            ? (HashPongState(sim_.state()) == replay_.header().finalHash ? "Replay finished - ENTER to close" : "Replay DIVERGED - ENTER to close")
+            : TextFormat("Replay  tick %u / %u  %gx%s", cursor_.tick(), replay_.tickCount(), speed_, paused_ ? "  paused" : ""));
+    }
 
-        if (ballPosition.y <= 0 || ballPosition.y >= screenHeight) ballSpeedVector.y *= -1;
-        if (CheckCollisionCircleRec(ballPosition, 10, playerPaddle)) ballSpeedVector.x *= -1;
-        if (CheckCollisionCircleRec(ballPosition, 10, opponentPaddle)) ballSpeedVector.x *= -1;
+    void draw() override {
+        DrawMatch(sim_.state(), config_, hud_, effects_);
+    }
 
-        if (ballPosition.x <= 0) {
-            playerScore++;
-            opponentHearts--;
-            ballPosition = { screenWidth / 2, screenHeight / 2 };
-            ballSpeedVector.x *= -1;
+private:
+    Replay replay_;
+    PongConfig config_;
+    PongSim sim_;
+    ReplayCursor cursor_;
+    MatchHud hud_;
+    MatchEffects effects_;
+    float accumulator_ = 0.0f;
+    float speed_ = 1.0f;
+    bool paused_ = false;
+    bool finished_ = false;
+};
+
+// Stress test of the particle system (--particle-stress [N]): emitters circle the field and
+// keep N particles alive. UP/DOWN double or halve the target, ENTER closes it. The line at the
+// bottom shows the CPU time of the update and of building the draw batches.
+class ParticleStressScene : public Scene {
+public:
+    ParticleStressScene(size_t capacity, Font customFont)
+        : particles_(capacity), target_(capacity), text_(customFont, 20.0f), font_(customFont) {}
+
+    void update(float dt) override {
+        if (input.pressed(KEY_ENTER)) {
+            scenes.pop();
+            return;
         }
+        if (input.pressed(KEY_UP) && target_ < particles_.capacity()) target_ = min(target_ * 2, particles_.capacity());
+        if (input.pressed(KEY_DOWN) && target_ > 1000) target_ /= 2;
+
+        uint64_t start = SimClockNanos();
+        particles_.update(dt, 200.0f, 0.5f);
+
+        // Refill to the target from eight emitters; a particle lives a second on average
+        time_ += dt;
+        ParticleBurst burst;
+        burst.minLife = 0.5f;
+        burst.maxLife = 1.5f;
+        burst.size = 4.0f;
+        size_t missing = target_ > particles_.size() ? target_ - particles_.size() : 0;
+        for (int k = 0; k < 8; k++) {
+            float angle = time_ * 0.7f + k * 0.785398f;
+            burst.x = SCREEN_WIDTH * 0.5f + cosf(angle) * SCREEN_WIDTH * 0.3f;
+            burst.y = SCREEN_HEIGHT * 0.5f + sinf(angle) * SCREEN_HEIGHT * 0.3f;
+            burst.count = (int)(missing / 8);
+            burst.color = { (uint8_t)(128 + 127 * cosf(angle)), (uint8_t)(128 + 127 * sinf(angle)), 255, 200 };
+            particles_.emit(burst);
+        }
+        updateNanos_ = SimClockNanos() - start;
+    }
 
-        if (ballPosition.x >= screenWidth) {
-            opponentScore++;
-            playerHearts--;
-            ballPosition = { screenWidth / 2, screenHeight / 2 };
-            ballSpeedVector.x *= -1;
+    void draw() override {
+        ClearBackground(BLACK);
+        uint64_t start = SimClockNanos();
+        DrawParticles(particles_);
+        drawNanos_ = SimClockNanos() - start;
+
+        if (frames_++ % 15 == 0) {
+            text_.setFormat("particles %u / %u  update %.2f ms  draw %.2f ms  %d fps  (UP/DOWN, ENTER to close)",
+                (unsigned)particles_.size(), (unsigned)target_, updateNanos_ / 1e6, drawNanos_ / 1e6, GetFPS());
         }
+        batch_.clear();
+        batch_.add(text_, { 20, (float)(SCREEN_HEIGHT - 30) }, RAYWHITE);
+        AddProfilerOverlay(batch_, font_);
+        batch_.draw(font_.texture, fonts.shader());
+    }
 
-        if (playerHearts <= 0 || opponentHearts <= 0) {
-            break;
+private:
+    ParticlePool particles_;
+    size_t target_;
+    float time_ = 0.0f;
+    uint64_t updateNanos_ = 0;
+    uint64_t drawNanos_ = 0;
+    uint64_t frames_ = 0;
+    HudText text_;
+    HudBatch batch_;
+    Font font_;
+};
+
+// A match against another machine (see netplay.h): the handshake, the match, and a message if
+// the other side goes quiet. The host plays the right paddle and the joining player the left
+// one; both steer with W/S or UP/DOWN.
+class NetworkScene : public Scene {
+public:
+    NetworkScene(const NetOptions& options, Font customFont)
+        : options_(options), font_(customFont), link_(options.impairment),
+          hostName_(options.host ? options.playerName : ""), clientName_(options.host ? "" : options.playerName),
+          statusText_(customFont, 26.0f), cancelText_(customFont, 20.0f) {
+        config_.seed = (uint32_t)time(nullptr);
+        cancelText_.set("BACKSPACE to cancel");
+    }
+
+    // Function to open the socket and find the host to join. Returns false (and logs why) if
+    // there is no game to play.
+    bool open() {
+        if (!socket_.open(options_.host ? options_.port : 0)) {
+            TraceLog(LOG_WARNING, "NET: Could not open UDP port %d", options_.host ? options_.port : 0);
+            return false;
         }
+        if (options_.join && !ParseNetAddress(options_.address, NET_DEFAULT_PORT, peer_)) {
+            TraceLog(LOG_WARNING, "NET: Could not resolve %s", options_.address.c_str());
+            return false;
+        }
+        return true;
+    }
 
-        BeginDrawing();
+    void enter() override {
+        if (connectStart_ < 0) connectStart_ = GetTime();
+    }
+
+    void update(float dt) override {
+        if (phase_ == NET_CONNECTING) updateHandshake();
+        else if (phase_ == NET_PLAYING) updateMatch(dt);
+        else if (input.pressed(KEY_ENTER)) scenes.pop();
+    }
+
+    void draw() override {
+        if (phase_ == NET_PLAYING) {
+            DrawMatch(session_->state(), config_, *hud_, effects_);
+            return;
+        }
         ClearBackground(BLACK);
+        textBatch_.draw(font_.texture, fonts.shader());
+    }
+
+private:
+    enum NetPhase { NET_CONNECTING, NET_PLAYING, NET_LOST };
+
+    // Outgoing packets go through the impairment shim when one is configured
+    void sendPacket(const vector<uint8_t>& data) {
+        if (options_.impairment.active()) link_.send(GetTime() * 1000.0, data.data(), data.size());
+        else socket_.send(peer_, data.data(), data.size());
+    }
 
-        // Draw player 1 info on the left with red text
-        DrawTextEx(customFont, (player1Name + "'s Hearts: " + to_string(playerHearts)).c_str(),
-            { 20, 20 }, 20, 1.0f, RED);
+    void flushLink() {
+        vector<uint8_t> delayed;
+        while (link_.receive(GetTime() * 1000.0, delayed)) socket_.send(peer_, delayed.data(), delayed.size());
+    }
 
-        // Draw player 2 info on the right with green text
-        DrawTextEx(customFont, (player2Name + "'s Hearts: " + to_string(opponentHearts)).c_str(),
-            { (float)(screenWidth - 200), 20 }, 20, 1.0f, GREEN);
+    // Handshake: the client repeats HELLO until the host answers with WELCOME
+    void updateHandshake() {
+        if (input.pressed(KEY_BACKSPACE)) {
+            scenes.pop();
+            return;
+        }
+        if (options_.join && GetTime() - connectStart_ > 15.0) {
+            TraceLog(LOG_WARNING, "NET: No answer from %s", options_.address.c_str());
+            scenes.pop();
+            return;
+        }
 
-        // Draw game name in the center with a beautiful font style
-        DrawTextEx(customFont, "Pong Game", 
-            { (float)(screenWidth / 2 - MeasureText("Pong Game", 30) / 2), 20 }, 30, 1.0f, YELLOW);
+        if (options_.join && GetTime() - lastHello_ > 0.25) {
+            WriteHelloPacket(options_.playerName, packet_);
+            sendPacket(packet_);
+            lastHello_ = GetTime();
+        }
+        flushLink();
+
+        uint8_t buffer[NET_MAX_PACKET];
+        NetAddress from;
+        int size;
+        while ((size = socket_.receive(buffer, sizeof(buffer), from)) > 0) {
+            if (options_.host && ReadHelloPacket(buffer, size, clientName_)) {
+                peer_ = from;
+                sessionId_ = (uint32_t)GetRandomValue(1, 0x7FFFFFFF);
+            }
+            else if (options_.join && from == peer_) {
+                uint32_t welcomeId;
+                if (ReadWelcomePacket(buffer, size, welcomeId, config_, settings_, hostName_) && welcomeId != 0) sessionId_ = welcomeId;
+            }
+        }
 
-        // Draw paddles and ball
-        DrawRectangleRec(playerPaddle, RED);  // Left paddle red
-        DrawRectangleRec(opponentPaddle, GREEN);  // Right paddle green
-        DrawCircleV(ballPosition, 10, WHITE);
+        if (sessionId_ != 0) {
+            WriteWelcomePacket(sessionId_, config_, settings_, hostName_, packet_);
+            if (options_.host) sendPacket(packet_);
+            welcome_ = packet_;
+
+            session_.reset(new NetSession(config_, options_.host, sessionId_, settings_));
+            hud_.reset(new MatchHud(hostName_, clientName_, font_));
+            hud_->status.setFont(font_, 18.0f);
+            lastReceive_ = GetTime();
+            phase_ = NET_PLAYING;
+            return;
+        }
 
-        EndDrawing();
+        if (options_.host) statusText_.setFormat("Waiting for a player to join on port %d...", (int)socket_.localPort());
+        else if (statusText_.empty()) statusText_.setFormat("Connecting to %s...", NetAddressToString(peer_).c_str());
+        textBatch_.clear();
+        textBatch_.add(statusText_, { 40, (float)(SCREEN_HEIGHT / 2 - 20) }, RAYWHITE);
+        textBatch_.add(cancelText_, { 40, (float)(SCREEN_HEIGHT / 2 + 20) }, GRAY);
     }
 
-    ShowGameOverScreen(playerHearts > 0, vsAI, player1Name, player2Name, customFont);
-}
+    void updateMatch(float dt) {
+        NetSession& session = *session_;
+        {
+            PROFILE_SCOPE("network receive");
+            uint8_t buffer[NET_MAX_PACKET];
+            NetAddress from;
+            int size;
+            while ((size = socket_.receive(buffer, sizeof(buffer), from)) > 0) {
+                if (from != peer_) continue;
+                lastReceive_ = GetTime();
+                if (NetPacketTypeOf(buffer, size) == NET_PACKET_HELLO) sendPacket(welcome_);  // Our WELCOME got lost
+                else session.receive(buffer, size);
+            }
+        }
+        if (GetTime() - lastReceive_ > 5.0) {
+            statusText_.set("Connection lost - ENTER to close");
+            textBatch_.clear();
+            textBatch_.addCentered(statusText_, SCREEN_WIDTH / 2.0f, (float)(SCREEN_HEIGHT / 2), RED);
+            phase_ = NET_LOST;
+            return;
+        }
 
-int main() {
-    const int screenWidth = 792;
-    const int screenHeight = 534;
+        const uint64_t now = SimClockNanos();
+        accumulator_ += dt;
+        if (accumulator_ > 0.25f) accumulator_ = 0.25f;
+        while (accumulator_ >= config_.dt && !session.isOver()) {
+            accumulator_ -= config_.dt;
+            keys_.advance(input, now);
+            session.setLocalInput((int8_t)((keys_.isDown(KEY_S) || keys_.isDown(KEY_DOWN) ? 1 : 0) -
+                (keys_.isDown(KEY_W) || keys_.isDown(KEY_UP) ? 1 : 0)));
+            if (session.takeTimeSyncStall() || !session.canAdvance()) break;   // Let the other side catch up
+            PROFILE_SCOPE("netplay advance");   // Includes any rollback re-simulation
+            session.advance();
+        }
 
-    InitWindow(screenWidth, screenHeight, "Pong Game");
-    SetTargetFPS(60);
+        session.writeInputPacket(packet_);
+        sendPacket(packet_);
+        if (session.writeSnapshotPacket(packet_)) sendPacket(packet_);
+        flushLink();
+
+        // Keep sending for a second after the end so the other side gets our last inputs
+        if (session.isOver()) {
+            if (overSince_ < 0) overSince_ = GetTime();
+            else if (GetTime() - overSince_ > 1.0) {
+                scenes.replace(unique_ptr<Scene>(new GameOverScene(session.playerWon(), false, hostName_, clientName_, font_)));
+            }
+        }
 
-    // Load a custom font (Make sure the font file is in the assets/fonts/ directory)
-    Font customFont = LoadFont("assets/fonts/Roboto-Regular.ttf"); // Ensure you have this font file
+        effects_.update(session.state(), config_, dt);
+
+        const NetSessionStats& stats = session.stats();
+        hud_->status.setFormat("tick %u  confirmed %u  rollbacks %llu  stalls %llu", session.tick(),
+            session.confirmedTick(), (unsigned long long)stats.rollbacks, (unsigned long long)stats.timeSyncStalls);
+    }
+
+    NetOptions options_;
+    Font font_;
+    UdpSocket socket_;
+    NetAddress peer_;
+    NetImpairment link_;
+    vector<uint8_t> packet_;
+    vector<uint8_t> welcome_;
+    NetPhase phase_ = NET_CONNECTING;
+
+    PongConfig config_;
+    NetSessionSettings settings_;
+    uint32_t sessionId_ = 0;
+    string hostName_;
+    string clientName_;
+    double lastHello_ = -1.0;
+    double connectStart_ = -1.0;
+    HudText statusText_;
+    HudText cancelText_;
+    HudBatch textBatch_;
+
+    unique_ptr<NetSession> session_;    // Once the handshake is done
+    unique_ptr<MatchHud> hud_;
+    MatchEffects effects_;
+    InputTickState keys_;
+    float accumulator_ = 0.0f;
+    double lastReceive_ = 0.0;
+    double overSince_ = -1.0;
+};
 
+// Function to run the main loop until the window closes or the last scene is gone. The scene
+// warm-up runs before the vsync wait, so it counts in the frame's work time.
+static void RunScenes() {
     while (!WindowShouldClose()) {
-        string player1Name, player2Name;
-        bool vsAI = ShowMenu(player1Name, player2Name, customFont);
+        frameStats.beginFrame();
+        DrainInput();
+        assets.update();
+        scenes.update(GetFrameTime());
+        if (!scenes.top()) break;
 
-        if (vsAI) {
-            StartGame(true, player1Name.empty() ? "Player 1" : player1Name, "AI", customFont);
+        BeginDrawing();
+        scenes.draw();
+        scenes.warmUpPrepared();
+        frameStats.endFrame();
+        frameSeconds.observe(GetFrameTime());
+        frameWorkSeconds.observe(frameStats.workMicros() / 1e6);
+        PROFILE_SCOPE("EndDrawing");    // Buffer swap and the wait for vsync
+        EndDrawing();
+    }
+    scenes.closeAll();
+}
+
+int main(int argc, char** argv) {
+    // "--host [PORT]" or "--join HOST[:PORT]" play against another machine; --latency, --jitter
+    // (milliseconds) and --loss (percent) impair our outgoing packets to try it on one machine
+    NetOptions netOptions;
+    AssetSettings assetSettings;
+    size_t particleStress = 0;
+    // "--metrics-port PORT" serves Prometheus text on localhost (--metrics-public: every interface),
+    // "--metrics-json PATH" rewrites a JSON dump every --metrics-interval seconds (default 60)
+    MetricsExportSettings metricsSettings;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--host") {
+            netOptions.host = true;
+            if (hasValue && argv[i + 1][0] != '-') netOptions.port = (uint16_t)atoi(argv[++i]);
+        }
+        else if (arg == "--join" && hasValue) {
+            netOptions.join = true;
+            netOptions.address = argv[++i];
+        }
+        else if (arg == "--name" && hasValue) netOptions.playerName = argv[++i];
+        else if (arg == "--latency" && hasValue) netOptions.impairment.latencyMillis = atof(argv[++i]);
+        else if (arg == "--jitter" && hasValue) netOptions.impairment.jitterMillis = atof(argv[++i]);
+        else if (arg == "--loss" && hasValue) netOptions.impairment.lossRate = atof(argv[++i]) / 100.0;
+        else if (arg == "--hot-reload") assetSettings.hotReload = true;  // Pick up edited images while running
+        else if (arg == "--profile") profileFromStart = true;           // Record scope timings for F5 (see profiler.h)
+        else if (arg == "--serial-sim") serialSim = true;               // Simulate on the render thread (see MatchScene)
+        else if (arg == "--search-ai") searchAI = true;                 // Local AI matches against MctsAI
+        else if (arg == "--metrics-port" && hasValue) metricsSettings.port = (uint16_t)atoi(argv[++i]);
+        else if (arg == "--metrics-public") metricsSettings.loopbackOnly = false;
+        else if (arg == "--metrics-json" && hasValue) metricsSettings.jsonPath = argv[++i];
+        else if (arg == "--metrics-interval" && hasValue) metricsSettings.jsonIntervalSeconds = atoi(argv[++i]);
+        else if (arg == "--particle-stress") {                          // Only the particle stress test
+            particleStress = 100000;
+            if (hasValue && argv[i + 1][0] != '-') particleStress = (size_t)strtoull(argv[++i], nullptr, 10);
+        }
+    }
+
+    SetProfilerThreadName("main");
+    SetProfilerEnabled(profileFromStart);
+    metricsExporter.start(metricsSettings);
+
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Pong Game");
+    SetTargetFPS(60);
+
+    // Load the custom font: the atlas baked by 'make fonts', or the TTF if it hasn't been baked
+    Font customFont = fonts.load("assets/fonts/Roboto-Regular.sdff", "assets/fonts/Roboto-Regular.ttf");
+
+    // "--replay FILE" only plays back a recorded match
+    if (argc == 3 && string(argv[1]) == "--replay") {
+        Replay replay;
+        if (replay.load(argv[2])) {
+            scenes.push(unique_ptr<Scene>(new ReplayScene(move(replay), customFont)));
+            RunScenes();
         }
         else {
-            CapturePlayerName(player1Name, "Enter Player 1 Name: ", customFont);
-            CapturePlayerName(player2Name, "Enter Player 2 Name: ", customFont);
-            StartGame(false, player1Name, player2Name, customFont);
+            TraceLog(LOG_WARNING, "REPLAY: %s is not a replay file", argv[2]);
         }
+        fonts.unload();
+        CloseWindow();
+        return 0;
+    }
+
+    if (particleStress > 0) {
+        scenes.push(unique_ptr<Scene>(new ParticleStressScene(particleStress, customFont)));
+        RunScenes();
+        fonts.unload();
+        CloseWindow();
+        return 0;
     }
 
-    UnloadFont(customFont);  // Don't forget to unload the font when done
+    // Decode the menu images in the background while the result log and stats load. The
+    // background is only ever drawn at window size, so it's kept at that size.
+    AssetRequest backgroundImage;
+    backgroundImage.path = "background.png";
+    backgroundImage.fitWidth = SCREEN_WIDTH;
+    backgroundImage.fitHeight = SCREEN_HEIGHT;
+    AssetRequest buttonImage;
+    buttonImage.path = "button_image.png";
+    assets.start({ backgroundImage, buttonImage }, assetSettings);
+
+    ResultLogSettings logSettings;
+    logSettings.importTextPath = "game_results.txt";   // Keep the history of the old text log
+    resultLog.start(logSettings);
+
+    // The stats index reads the result file, so wait until it exists (first start imports the text log)
+    resultLog.waitUntilOpen();
+    playerStats.load("player_stats.bin", "game_results.bin");
+
+    // Network games go straight from the loading screen to the handshake, and end after the
+    // game over screen; otherwise the menu stays at the bottom of the stack until the window closes
+    unique_ptr<Scene> firstScene;
+    if (netOptions.host || netOptions.join) {
+        unique_ptr<NetworkScene> network(new NetworkScene(netOptions, customFont));
+        if (network->open()) firstScene = move(network);
+    }
+    else {
+        firstScene.reset(new MenuScene(customFont));
+    }
+    scenes.push(unique_ptr<Scene>(new LoadingScene(move(firstScene), customFont)));
+    RunScenes();
+
+    resultLog.shutdown();  // Write out and fsync any queued match results
+    metricsExporter.stop();  // Writes the last JSON dump
+    ResultLogStats logStats = resultLog.stats();
+    TraceLog(LOG_INFO, "RESULTS: %llu written, %llu dropped, max queue depth %llu, max write %llu us",
+        (unsigned long long)logStats.written, (unsigned long long)logStats.dropped, (unsigned long long)logStats.maxDepth,
+        (unsigned long long)logStats.maxWriteMicros);
+    playerStats.save("player_stats.bin");
+    TraceLog(LOG_INFO, "FRAME: %llu frames, %llu with heap allocations (max %llu in one), work %.0f us average, %.0f us max",
+        (unsigned long long)frameStats.frames(), (unsigned long long)frameStats.framesWithAllocations(),
+        (unsigned long long)frameStats.maxAllocations(), frameStats.averageWorkMicros(), frameStats.maxWorkMicros());
+    assets.shutdown();
+    fonts.unload();  // Don't forget to unload the font when done
     CloseWindow();
     return 0;
 }
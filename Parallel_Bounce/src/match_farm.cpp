@@ -0,0 +1,163 @@
+#include "match_farm.h"
+#include "xorshift.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Function to mix a 64-bit value into a well distributed seed (splitmix64 finalizer)
+static uint64_t MixSeed(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+void FarmStats::merge(const FarmStats& other) {
+    matches += other.matches;
+    playerWins += other.playerWins;
+    opponentWins += other.opponentWins;
+    draws += other.draws;
+    totalTicks += other.totalTicks;
+    points += other.points;
+    for (int i = 0; i < RALLY_HISTOGRAM_BINS; i++) rallyHistogram[i] += other.rallyHistogram[i];
+}
+
+void PlayMatch(const MatchSettings& settings, uint64_t matchIndex, FarmStats& stats) {
+    uint64_t seed = MixSeed(settings.seed ^ MixSeed(matchIndex));
+
+    PongConfig config = settings.config;
+    config.seed = (uint32_t)seed;
+    PongSim sim(config);
+
+    PongAI playerAI(settings.playerAI, true, (uint32_t)(seed >> 32));
+    PongAI opponentAI(settings.opponentAI, false, (uint32_t)(seed >> 16));
+    uint32_t rally = 0;
+
+    while (!sim.isOver() && sim.state().tick < settings.maxTicks) {
+        const PongState& state = sim.state();
+        PongInputs inputs;
+        inputs.player = playerAI.decide(state, config);
+        inputs.opponent = opponentAI.decide(state, config);
+
+        uint32_t events = sim.step(inputs);
+        if (events & (PONG_EVENT_PLAYER_HIT | PONG_EVENT_OPPONENT_HIT)) rally++;
+        if (events & (PONG_EVENT_PLAYER_SCORED | PONG_EVENT_OPPONENT_SCORED)) {
+            stats.rallyHistogram[rally < RALLY_HISTOGRAM_BINS ? rally : RALLY_HISTOGRAM_BINS - 1]++;
+            stats.points++;
+            rally = 0;
+        }
+    }
+
+    stats.matches++;
+    stats.totalTicks += sim.state().tick;
+    if (!sim.isOver()) stats.draws++;
+    else if (sim.playerWon()) stats.playerWins++;
+    else stats.opponentWins++;
+}
+
+// Range of match indices owned by one worker, packed as (begin << 32 | end) so the
+// owner (taking from the front) and thieves (taking the back half) can both use one CAS.
+// Padded to a cache line so workers don't false-share.
+struct WorkRange {
+    atomic<uint64_t> packed;
+    char padding[64 - sizeof(atomic<uint64_t>)];
+};
+
+static uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+// Function to take up to grain matches from the front of a range
+static bool TakeFront(WorkRange& range, uint32_t grain, uint32_t& begin, uint32_t& end) {
+    uint64_t current = range.packed.load(memory_order_relaxed);
+    for (;;) {
+        uint32_t rangeBegin = (uint32_t)(current >> 32);
+        uint32_t rangeEnd = (uint32_t)current;
+        if (rangeBegin >= rangeEnd) return false;
+
+        uint32_t takeEnd = rangeEnd - rangeBegin > grain ? rangeBegin + grain : rangeEnd;
+        if (range.packed.compare_exchange_weak(current, PackRange(takeEnd, rangeEnd), memory_order_acq_rel)) {
+            begin = rangeBegin;
+            end = takeEnd;
+            return true;
+        }
+    }
+}
+
+// Function to steal the back half of a victim's range
+static bool StealHalf(WorkRange& victim, uint32_t& begin, uint32_t& end) {
+    uint64_t current = victim.packed.load(memory_order_relaxed);
+    for (;;) {
+        uint32_t rangeBegin = (uint32_t)(current >> 32);
+        uint32_t rangeEnd = (uint32_t)current;
+        if (rangeBegin >= rangeEnd || rangeEnd - rangeBegin < 2) return false;
+
+        uint32_t middle = rangeBegin + (rangeEnd - rangeBegin) / 2;
+        if (victim.packed.compare_exchange_weak(current, PackRange(rangeBegin, middle), memory_order_acq_rel)) {
+            begin = middle;
+            end = rangeEnd;
+            return true;
+        }
+    }
+}
+
+// Per-thread stats padded so workers never share a cache line
+struct WorkerStats {
+    FarmStats stats;
+    char padding[64];
+};
+
+FarmStats RunMatchFarm(const MatchSettings& settings, uint64_t matchCount, int threadCount) {
+    if (threadCount <= 0) threadCount = (int)thread::hardware_concurrency();
+    if (threadCount <= 0) threadCount = 1;
+
+    const uint32_t total = (uint32_t)matchCount;
+    const uint32_t grain = 16; // Matches taken per pop; small enough to balance, large enough to avoid CAS traffic
+
+    vector<WorkRange> ranges(threadCount);
+    vector<WorkerStats> workerStats(threadCount);
+    for (int i = 0; i < threadCount; i++) {
+        uint32_t begin = (uint32_t)((uint64_t)total * i / threadCount);
+        uint32_t end = (uint32_t)((uint64_t)total * (i + 1) / threadCount);
+        ranges[i].packed.store(PackRange(begin, end), memory_order_relaxed);
+    }
+
+    auto worker = [&](int self) {
+        FarmStats& stats = workerStats[self].stats;
+        uint32_t victimSeed = (uint32_t)self * 2654435761u + 1u;
+        uint32_t begin = 0, end = 0;
+
+        for (;;) {
+            while (TakeFront(ranges[self], grain, begin, end)) {
+                for (uint32_t match = begin; match < end; match++) PlayMatch(settings, match, stats);
+            }
+
+            // Own range is empty: steal half of someone else's. Nobody else writes an empty
+            // range, so publishing the stolen work with a plain store is safe.
+            bool stole = false;
+            for (int attempt = 0; attempt < threadCount && !stole; attempt++) {
+                int victim = (int)(XorShift32(victimSeed) % (uint32_t)threadCount);
+                if (victim != self && StealHalf(ranges[victim], begin, end)) stole = true;
+            }
+            for (int victim = 0; victim < threadCount && !stole; victim++) {
+                if (victim != self && StealHalf(ranges[victim], begin, end)) stole = true;
+            }
+            // Nothing left to steal: any work still in flight belongs to a thread that will finish it
+            if (!stole) return;
+
+            ranges[self].packed.store(PackRange(begin, end), memory_order_release);
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 1; i < threadCount; i++) threads.emplace_back(worker, i);
+    worker(0);
+    for (thread& t : threads) t.join();
+
+    FarmStats result;
+    for (const WorkerStats& ws : workerStats) result.merge(ws.stats);
+    return result;
+}
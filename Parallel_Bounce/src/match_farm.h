@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pong_ai.h"
+#include "pong_sim.h"
+
+#include <cstdint>
+
+// How the AI vs AI matches of a batch are played
+struct MatchSettings {
+    PongConfig config;
+    AiDifficulty playerAI = AI_NORMAL;
+    AiDifficulty opponentAI = AI_NORMAL;
+    uint32_t maxTicks = 60 * 60 * 10;   // Ten simulated minutes, then the match counts as a draw
+    uint64_t seed = 1;
+};
+
+// Rally length = paddle hits before a point; longer rallies land in the last bin
+const int RALLY_HISTOGRAM_BINS = 64;
+
+// Aggregated results of a batch of matches
+struct FarmStats {
+    uint64_t matches = 0;
+    uint64_t playerWins = 0;
+    uint64_t opponentWins = 0;
+    uint64_t draws = 0;
+    uint64_t totalTicks = 0;
+    uint64_t points = 0;
+    uint64_t rallyHistogram[RALLY_HISTOGRAM_BINS] = {};
+
+    void merge(const FarmStats& other);
+};
+
+// Function to play match number matchIndex of a batch. The match seed is derived
+// from (settings.seed, matchIndex), so results don't depend on which thread runs it.
+void PlayMatch(const MatchSettings& settings, uint64_t matchIndex, FarmStats& stats);
+
+// Function to play matches [0, matchCount) on threadCount threads (0 = all cores)
+// using a work-stealing scheduler. matchCount must fit in 32 bits.
+FarmStats RunMatchFarm(const MatchSettings& settings, uint64_t matchCount, int threadCount = 0);
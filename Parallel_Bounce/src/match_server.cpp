@@ -0,0 +1,526 @@
+#include "match_server.h"
+
+#include "net_socket.h"
+#include "xorshift.h"
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+void TickHistogram::add(uint64_t micros) {
+    counts[micros < (uint64_t)BUCKETS ? micros : BUCKETS - 1]++;
+    samples++;
+    if (micros > maxMicros) maxMicros = micros;
+}
+
+void TickHistogram::merge(const TickHistogram& other) {
+    for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+    samples += other.samples;
+    if (other.maxMicros > maxMicros) maxMicros = other.maxMicros;
+}
+
+uint64_t TickHistogram::percentile(double p) const {
+    if (samples == 0) return 0;
+    uint64_t rank = (uint64_t)(p * (samples - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) return i == BUCKETS - 1 ? maxMicros : (uint64_t)i;
+    }
+    return maxMicros;
+}
+
+void MatchServerStats::merge(const MatchServerStats& other) {
+    activeMatches += other.activeMatches;
+    matchesStarted += other.matchesStarted;
+    matchesFinished += other.matchesFinished;
+    matchesTimedOut += other.matchesTimedOut;
+    hellosRejected += other.hellosRejected;
+    ticks += other.ticks;
+    lateTicks += other.lateTicks;
+    matchTicks += other.matchTicks;
+    rollbacks += other.rollbacks;
+    packetsIn += other.packetsIn;
+    packetsOut += other.packetsOut;
+    bytesIn += other.bytesIn;
+    bytesOut += other.bytesOut;
+    sendErrors += other.sendErrors;
+    cpuMicros += other.cpuMicros;
+    wakeDelay.merge(other.wakeDelay);
+    tickWork.merge(other.tickWork);
+}
+
+#ifdef __linux__
+
+static const int IO_BATCH = 64;                 // Datagrams per recvmmsg/sendmmsg call
+static const int64_t TICK_NANOS = 1000000000 / 60;
+static const int MAX_CATCH_UP_TICKS = 4;        // Timer periods run back to back after a stall
+static const int STATS_PUBLISH_TICKS = 30;
+
+static int64_t MonotonicNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static int64_t ThreadCpuNanos() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// One match: the session (the server is always the host), the AI playing it and its client
+struct MatchSlot {
+    NetSession session;
+    PongAI ai;
+    NetAddress peer;
+    uint64_t key = 0;
+    uint64_t lastReceiveTick = 0;
+    uint64_t overTick = 0;          // Shard tick the match ended on (0 = still playing)
+    uint32_t rollbacksSeen = 0;
+    bool active = false;
+    vector<uint8_t> welcome;        // Sent again if the client repeats its HELLO
+
+    MatchSlot(const MatchServerSettings& settings)
+        : session(settings.config, true, 0, settings.session), ai(settings.ai, true, 1) {}
+};
+
+struct MatchServer::Shard {
+    int index = 0;
+    int cpu = -1;                   // Core to pin to (-1 = don't)
+    int socketFd = -1;
+    int epollFd = -1;
+    int timerFd = -1;
+    thread worker;
+
+    // Slot pool: grows up to matchesPerShard on demand, then slots are only recycled
+    vector<MatchSlot> slots;
+    vector<uint32_t> freeSlots;
+    unordered_map<uint64_t, uint32_t> slotByAddress;
+    uint32_t rng = 1;
+
+    uint64_t tick = 0;
+    int64_t firstTickNanos = 0;     // Schedule: tick n is due at firstTickNanos + n * TICK_NANOS
+    int64_t lastCpuNanos = 0;
+    MatchServerStats stats;         // Since the last publish, only touched by the shard thread
+
+    mutex statsMutex;
+    MatchServerStats published;     // Since the last takeStats
+    uint64_t activeMatches = 0;
+
+    // Batched I/O buffers
+    mmsghdr recvHeaders[IO_BATCH];
+    iovec recvVectors[IO_BATCH];
+    sockaddr_in recvAddresses[IO_BATCH];
+    uint8_t recvBuffers[IO_BATCH][NET_MAX_PACKET];
+
+    mmsghdr sendHeaders[IO_BATCH];
+    iovec sendVectors[IO_BATCH];
+    sockaddr_in sendAddresses[IO_BATCH];
+    uint8_t sendBuffers[IO_BATCH][NET_MAX_PACKET];
+    int sendCount = 0;
+
+    vector<uint8_t> packet;
+
+    ~Shard() {
+        if (timerFd >= 0) ::close(timerFd);
+        if (epollFd >= 0) ::close(epollFd);
+        if (socketFd >= 0) ::close(socketFd);
+    }
+
+    bool open(uint16_t port);
+    void run(const MatchServerSettings& settings, const atomic<bool>& stopping);
+    void receiveAll(const MatchServerSettings& settings);
+    void handleDatagram(const MatchServerSettings& settings, const NetAddress& from, const uint8_t* data, size_t size);
+    void runTick(const MatchServerSettings& settings);
+    void freeSlot(uint32_t index);
+    void queueSend(const NetAddress& to, const uint8_t* data, size_t size);
+    void flushSends();
+    void publishStats();
+};
+
+bool MatchServer::Shard::open(uint16_t port) {
+    socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    if (socketFd < 0) return false;
+
+    // Every shard binds the same port; the kernel spreads clients over them by address hash
+    int one = 1;
+    setsockopt(socketFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    int bufferBytes = 4 << 20;      // Room for a whole tick of packets from every match
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+    setsockopt(socketFd, SOL_SOCKET, SO_SNDBUF, &bufferBytes, sizeof(bufferBytes));
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(socketFd, (sockaddr*)&local, sizeof(local)) != 0) return false;
+
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    epollFd = epoll_create1(0);
+    if (timerFd < 0 || epollFd < 0) return false;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = socketFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socketFd, &event) != 0) return false;
+    event.data.fd = timerFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event) != 0) return false;
+
+    for (int i = 0; i < IO_BATCH; i++) {
+        recvVectors[i].iov_base = recvBuffers[i];
+        recvVectors[i].iov_len = NET_MAX_PACKET;
+        memset(&recvHeaders[i], 0, sizeof(recvHeaders[i]));
+        recvHeaders[i].msg_hdr.msg_iov = &recvVectors[i];
+        recvHeaders[i].msg_hdr.msg_iovlen = 1;
+        recvHeaders[i].msg_hdr.msg_name = &recvAddresses[i];
+
+        sendVectors[i].iov_base = sendBuffers[i];
+        memset(&sendHeaders[i], 0, sizeof(sendHeaders[i]));
+        sendHeaders[i].msg_hdr.msg_iov = &sendVectors[i];
+        sendHeaders[i].msg_hdr.msg_iovlen = 1;
+        sendHeaders[i].msg_hdr.msg_name = &sendAddresses[i];
+        sendHeaders[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+    return true;
+}
+
+void MatchServer::Shard::run(const MatchServerSettings& settings, const atomic<bool>& stopping) {
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    // All shards of a server tick on the same schedule, starting at the next whole period
+    firstTickNanos = (MonotonicNanos() / TICK_NANOS + 1) * TICK_NANOS;
+    itimerspec schedule;
+    schedule.it_value.tv_sec = firstTickNanos / 1000000000;
+    schedule.it_value.tv_nsec = firstTickNanos % 1000000000;
+    schedule.it_interval.tv_sec = 0;
+    schedule.it_interval.tv_nsec = TICK_NANOS;
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &schedule, nullptr);
+    lastCpuNanos = ThreadCpuNanos();
+
+    uint64_t timerPeriods = 0;
+    uint64_t lastPublishTick = tick;
+    epoll_event events[4];
+    while (!stopping.load(memory_order_relaxed)) {
+        int count = epoll_wait(epollFd, events, 4, 100);
+        bool timerFired = false;
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == socketFd) receiveAll(settings);
+            else timerFired = true;
+        }
+        if (!timerFired) continue;
+
+        uint64_t expirations = 0;
+        if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) continue;
+        timerPeriods += expirations;
+
+        int64_t due = firstTickNanos + (int64_t)(timerPeriods - 1) * TICK_NANOS;
+        int64_t late = MonotonicNanos() - due;
+        stats.wakeDelay.add(late > 0 ? (uint64_t)late / 1000 : 0);
+
+        // Run the periods that were missed too, up to a limit, so matches keep real time
+        uint64_t runs = expirations < (uint64_t)MAX_CATCH_UP_TICKS ? expirations : MAX_CATCH_UP_TICKS;
+        stats.lateTicks += expirations - 1;
+        for (uint64_t i = 0; i < runs; i++) {
+            int64_t start = MonotonicNanos();
+            runTick(settings);
+            stats.tickWork.add((uint64_t)(MonotonicNanos() - start) / 1000);
+        }
+        // Catching up can step over a multiple of the interval, so go by ticks since the last one
+        if (tick - lastPublishTick >= (uint64_t)STATS_PUBLISH_TICKS) {
+            publishStats();
+            lastPublishTick = tick;
+        }
+    }
+    publishStats();
+}
+
+void MatchServer::Shard::receiveAll(const MatchServerSettings& settings) {
+    for (;;) {
+        for (int i = 0; i < IO_BATCH; i++) recvHeaders[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        int count = recvmmsg(socketFd, recvHeaders, IO_BATCH, MSG_DONTWAIT, nullptr);
+        if (count <= 0) return;
+
+        for (int i = 0; i < count; i++) {
+            NetAddress from;
+            from.ip = ntohl(recvAddresses[i].sin_addr.s_addr);
+            from.port = ntohs(recvAddresses[i].sin_port);
+            stats.packetsIn++;
+            stats.bytesIn += recvHeaders[i].msg_len;
+            handleDatagram(settings, from, recvBuffers[i], recvHeaders[i].msg_len);
+        }
+        if (count < IO_BATCH) return;
+    }
+}
+
+void MatchServer::Shard::handleDatagram(const MatchServerSettings& settings, const NetAddress& from, const uint8_t* data, size_t size) {
+    int type = NetPacketTypeOf(data, size);
+    if (type < 0) return;
+
+    uint64_t key = ((uint64_t)from.ip << 16) | from.port;
+    auto found = slotByAddress.find(key);
+    if (found != slotByAddress.end()) {
+        MatchSlot& slot = slots[found->second];
+        slot.lastReceiveTick = tick;
+        // A repeated HELLO means our WELCOME got lost
+        if (type == NET_PACKET_HELLO) queueSend(from, slot.welcome.data(), slot.welcome.size());
+        else slot.session.receive(data, size);
+        return;
+    }
+
+    string playerName;
+    if (!ReadHelloPacket(data, size, playerName)) return;
+
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if (slots.size() < (size_t)settings.matchesPerShard) {
+        index = (uint32_t)slots.size();
+        slots.emplace_back(settings);
+    }
+    else {
+        stats.hellosRejected++;
+        return;
+    }
+
+    PongConfig config = settings.config;
+    config.seed = XorShift32(rng);
+    uint32_t sessionId = XorShift32(rng) & 0x7FFFFFFF;
+    if (sessionId == 0) sessionId = 1;
+
+    MatchSlot& slot = slots[index];
+    slot.session.restart(config, sessionId);
+    slot.ai = PongAI(settings.ai, true, XorShift32(rng));
+    slot.peer = from;
+    slot.key = key;
+    slot.lastReceiveTick = tick;
+    slot.overTick = 0;
+    slot.rollbacksSeen = 0;
+    slot.active = true;
+    WriteWelcomePacket(sessionId, config, settings.session, settings.serverName, slot.welcome);
+    queueSend(from, slot.welcome.data(), slot.welcome.size());
+
+    slotByAddress[key] = index;
+    activeMatches++;
+    stats.matchesStarted++;
+}
+
+void MatchServer::Shard::runTick(const MatchServerSettings& settings) {
+    tick++;
+    stats.ticks++;
+    const uint64_t idleTicks = (uint64_t)settings.idleTimeoutMillis * 60 / 1000;
+
+    for (uint32_t i = 0; i < (uint32_t)slots.size(); i++) {
+        MatchSlot& slot = slots[i];
+        if (!slot.active) continue;
+
+        if (tick - slot.lastReceiveTick > idleTicks) {
+            stats.matchesTimedOut++;
+            freeSlot(i);
+            continue;
+        }
+
+        NetSession& session = slot.session;
+        if (!session.isOver()) {
+            session.setLocalInput(slot.ai.decide(session.state(), session.config()));
+            if (!session.takeTimeSyncStall() && session.canAdvance()) {
+                session.advance();
+                stats.matchTicks++;
+            }
+        }
+        else if (slot.overTick == 0) {
+            slot.overTick = tick;
+        }
+
+        session.writeInputPacket(packet);
+        queueSend(slot.peer, packet.data(), packet.size());
+        if (session.writeSnapshotPacket(packet)) queueSend(slot.peer, packet.data(), packet.size());
+
+        uint32_t rollbacks = (uint32_t)session.stats().rollbacks;
+        stats.rollbacks += rollbacks - slot.rollbacksSeen;
+        slot.rollbacksSeen = rollbacks;
+
+        if (slot.overTick != 0 && tick - slot.overTick >= (uint64_t)settings.lingerTicks) {
+            stats.matchesFinished++;
+            freeSlot(i);
+        }
+    }
+    flushSends();
+}
+
+void MatchServer::Shard::freeSlot(uint32_t index) {
+    MatchSlot& slot = slots[index];
+    slotByAddress.erase(slot.key);
+    slot.active = false;
+    freeSlots.push_back(index);
+    activeMatches--;
+}
+
+void MatchServer::Shard::queueSend(const NetAddress& to, const uint8_t* data, size_t size) {
+    if (size > NET_MAX_PACKET) return;
+    if (sendCount == IO_BATCH) flushSends();
+
+    memcpy(sendBuffers[sendCount], data, size);
+    sendVectors[sendCount].iov_len = size;
+    sockaddr_in& address = sendAddresses[sendCount];
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(to.ip);
+    address.sin_port = htons(to.port);
+    sendCount++;
+}
+
+void MatchServer::Shard::flushSends() {
+    int sent = 0;
+    while (sent < sendCount) {
+        int count = sendmmsg(socketFd, sendHeaders + sent, sendCount - sent, MSG_DONTWAIT);
+        if (count <= 0) {
+            if (count < 0 && errno == EINTR) continue;
+            // Socket buffer full (or an error): UDP may drop, the protocol repeats what matters
+            stats.sendErrors += sendCount - sent;
+            break;
+        }
+        for (int i = sent; i < sent + count; i++) stats.bytesOut += sendHeaders[i].msg_len;
+        stats.packetsOut += count;
+        sent += count;
+    }
+    sendCount = 0;
+}
+
+void MatchServer::Shard::publishStats() {
+    int64_t cpuNanos = ThreadCpuNanos();
+    stats.cpuMicros = (uint64_t)(cpuNanos - lastCpuNanos) / 1000;
+    lastCpuNanos = cpuNanos;
+
+    lock_guard<mutex> lock(statsMutex);
+    published.merge(stats);
+    published.activeMatches = activeMatches;
+    stats = MatchServerStats();
+}
+
+MatchServer::MatchServer() : stopping_(false) {
+}
+
+MatchServer::~MatchServer() {
+    stop();
+}
+
+bool MatchServer::start(const MatchServerSettings& settings) {
+    stop();
+    settings_ = settings;
+    if (settings_.matchesPerShard < 1) settings_.matchesPerShard = 1;
+
+    // Shards go on the cores this process may use (respects taskset and cgroup limits)
+    vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+    }
+    int shardCount = settings_.shards;
+    if (shardCount <= 0) shardCount = cpus.empty() ? (int)thread::hardware_concurrency() : (int)cpus.size();
+    if (shardCount <= 0) shardCount = 1;
+
+    stopping_ = false;
+    for (int i = 0; i < shardCount; i++) {
+        unique_ptr<Shard> shard(new Shard());
+        shard->index = i;
+        shard->cpu = settings_.pinThreads && !cpus.empty() ? cpus[i % cpus.size()] : -1;
+        shard->rng = (uint32_t)MonotonicNanos() ^ ((uint32_t)i * 2654435761u) ^ 0x9E3779B9u;
+        if (shard->rng == 0) shard->rng = 1;
+        shard->slots.reserve((size_t)settings_.matchesPerShard);
+        shard->slotByAddress.reserve((size_t)settings_.matchesPerShard * 2);
+        if (!shard->open(settings_.port)) {
+            shards_.clear();
+            return false;
+        }
+        // Port 0 picks a free port for the first shard; the others must join that one
+        if (settings_.port == 0) {
+            sockaddr_in local;
+            socklen_t length = sizeof(local);
+            getsockname(shard->socketFd, (sockaddr*)&local, &length);
+            settings_.port = ntohs(local.sin_port);
+        }
+        shards_.push_back(move(shard));
+    }
+
+    for (auto& shard : shards_) {
+        Shard* self = shard.get();
+        shard->worker = thread([this, self]() { self->run(settings_, stopping_); });
+    }
+    return true;
+}
+
+void MatchServer::stop() {
+    stopping_ = true;
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+    shards_.clear();
+}
+
+MatchServerStats MatchServer::takeStats() {
+    MatchServerStats total;
+    for (auto& shard : shards_) {
+        lock_guard<mutex> lock(shard->statsMutex);
+        total.merge(shard->published);
+        uint64_t active = shard->published.activeMatches;
+        shard->published = MatchServerStats();
+        shard->published.activeMatches = active;
+    }
+    return total;
+}
+
+#else
+
+// No epoll: the server only exists on Linux
+struct MatchServer::Shard {
+};
+
+MatchServer::MatchServer() : stopping_(false) {
+}
+
+MatchServer::~MatchServer() {
+}
+
+bool MatchServer::start(const MatchServerSettings& settings) {
+    settings_ = settings;
+    return false;
+}
+
+void MatchServer::stop() {
+}
+
+MatchServerStats MatchServer::takeStats() {
+    return MatchServerStats();
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "netplay.h"
+#include "pong_ai.h"
+#include "pong_sim.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Headless dedicated server: many independent matches in one process, each a player (joining
+// with the game's --join, or a bot from pong_bots) against the server AI. The server speaks the
+// netplay protocol as the host of every match, so clients need no changes.
+//
+// The work is split into shards, one thread each, optionally pinned to its own core. Every shard
+// has its own UDP socket bound to the same port with SO_REUSEPORT, so the kernel hashes each
+// client to one shard and shards share nothing. A shard waits in epoll on its socket and a 60 Hz
+// timerfd, reads and sends datagrams in batches (recvmmsg/sendmmsg) and keeps its matches in a
+// pool of slots that are reused, never freed. Linux only; start() fails elsewhere.
+
+struct MatchServerSettings {
+    uint16_t port = NET_DEFAULT_PORT;
+    int shards = 0;                 // Shard threads (0 = one per usable core)
+    int matchesPerShard = 1024;     // Slot pool size; HELLOs beyond it are ignored until one frees
+    bool pinThreads = true;         // Pin shard i to the i-th usable core
+    AiDifficulty ai = AI_NORMAL;
+    PongConfig config;              // Rules of every match (the seed is picked per match)
+    NetSessionSettings session;
+    std::string serverName = "Server";
+    int idleTimeoutMillis = 5000;   // Drop a match when its client has been silent this long
+    int lingerTicks = 60;           // Keep sending after the end so the client gets the last inputs
+};
+
+// Histogram of durations in microseconds: 1 us buckets, the last one collects everything longer
+struct TickHistogram {
+    static const int BUCKETS = 4096;
+
+    uint64_t counts[BUCKETS] = {};
+    uint64_t samples = 0;
+    uint64_t maxMicros = 0;
+
+    void add(uint64_t micros);
+    void merge(const TickHistogram& other);
+    // Function to get the duration below which fraction p (0..1) of the samples fall
+    uint64_t percentile(double p) const;
+};
+
+// Counters of all shards since the previous MatchServer::takeStats call
+struct MatchServerStats {
+    uint64_t activeMatches = 0;     // Right now, not since the last call
+    uint64_t matchesStarted = 0;
+    uint64_t matchesFinished = 0;
+    uint64_t matchesTimedOut = 0;
+    uint64_t hellosRejected = 0;    // Pool was full
+    uint64_t ticks = 0;             // Shard ticks
+    uint64_t lateTicks = 0;         // Timer periods that passed while a shard was busy (caught up)
+    uint64_t matchTicks = 0;        // Simulated match ticks, rollbacks not included
+    uint64_t rollbacks = 0;
+    uint64_t packetsIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint64_t sendErrors = 0;
+    uint64_t cpuMicros = 0;         // Thread CPU time of the shards
+    TickHistogram wakeDelay;        // How late each tick started compared to its schedule
+    TickHistogram tickWork;         // Time a shard spent on one tick of all its matches
+
+    void merge(const MatchServerStats& other);
+};
+
+class MatchServer {
+public:
+    MatchServer();
+    ~MatchServer();
+
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+
+    // Function to open the sockets and start the shard threads. Returns false if the port
+    // can't be bound or the platform has no epoll.
+    bool start(const MatchServerSettings& settings);
+    // Function to stop the shard threads and close the sockets (matches in progress are dropped)
+    void stop();
+
+    bool running() const { return !shards_.empty(); }
+    int shardCount() const { return (int)shards_.size(); }
+    const MatchServerSettings& settings() const { return settings_; }
+
+    // Function to collect the counters of all shards since the previous call
+    MatchServerStats takeStats();
+
+private:
+    struct Shard;
+
+    MatchServerSettings settings_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> stopping_;
+};
@@ -0,0 +1,171 @@
+#include "match_snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static void CopyName(char* out, const string& name) {
+    size_t length = name.size() < (size_t)SNAPSHOT_NAME_SIZE - 1 ? name.size() : SNAPSHOT_NAME_SIZE - 1;
+    memcpy(out, name.data(), length);
+    out[length] = '\0';
+}
+
+static uint32_t SnapshotChecksum(const MatchSnapshot& snapshot) {
+    const uint8_t* bytes = (const uint8_t*)&snapshot + offsetof(MatchSnapshot, config);
+    size_t size = sizeof(MatchSnapshot) - offsetof(MatchSnapshot, config);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+MatchSnapshot CaptureMatch(const PongConfig& config, const PongState& state, const PongAIState* ai, bool vsAI,
+    const string& player1Name, const string& player2Name) {
+    MatchSnapshot snapshot;
+    memset((void*)&snapshot, 0, sizeof(snapshot));    // Padding too, so the checksum is reproducible
+    snapshot.config = config;
+    snapshot.state = state;
+    if (ai) snapshot.ai = *ai;
+    snapshot.hasAI = ai ? 1 : 0;
+    snapshot.vsAI = vsAI ? 1 : 0;
+    snapshot.savedAt = (int64_t)time(nullptr);
+    CopyName(snapshot.player1Name, player1Name);
+    CopyName(snapshot.player2Name, player2Name);
+    SealSnapshot(snapshot);
+    return snapshot;
+}
+
+void SealSnapshot(MatchSnapshot& snapshot) {
+    snapshot.magic = SNAPSHOT_MAGIC;
+    snapshot.version = SNAPSHOT_VERSION;
+    snapshot.size = (uint32_t)sizeof(MatchSnapshot);
+    snapshot.checksum = SnapshotChecksum(snapshot);
+}
+
+bool SnapshotValid(const MatchSnapshot& snapshot) {
+    return snapshot.magic == SNAPSHOT_MAGIC && snapshot.version == SNAPSHOT_VERSION &&
+        snapshot.size == sizeof(MatchSnapshot) && snapshot.checksum == SnapshotChecksum(snapshot) &&
+        memchr(snapshot.player1Name, '\0', SNAPSHOT_NAME_SIZE) && memchr(snapshot.player2Name, '\0', SNAPSHOT_NAME_SIZE);
+}
+
+bool SaveCheckpoint(const char* path, const MatchSnapshot& snapshot) {
+    string tempPath = string(path) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(&snapshot, sizeof(snapshot), 1, file) == 1 && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        remove(tempPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path);   // rename() doesn't replace an existing file on Windows
+#endif
+    return rename(tempPath.c_str(), path) == 0;
+}
+
+bool LoadCheckpoint(const char* path, MatchSnapshot& snapshot) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    bool ok = fread(&snapshot, sizeof(snapshot), 1, file) == 1;
+    fclose(file);
+    return ok && SnapshotValid(snapshot);
+}
+
+MatchBranch::MatchBranch(const MatchSnapshot& snapshot)
+    : sim_(snapshot.config), ai_(snapshot.ai), hasAI_(snapshot.hasAI != 0) {
+    sim_.restore(snapshot.state);
+}
+
+MatchBranch::MatchBranch(const PongSim& sim, const PongAI* ai)
+    : sim_(sim), ai_(ai ? *ai : PongAI(AI_NORMAL, false, 1)), hasAI_(ai != nullptr) {}
+
+uint32_t MatchBranch::step(PongInputs inputs) {
+    if (hasAI_) {
+        int8_t move = ai_.decide(sim_.state(), sim_.config());
+        if (ai_.controlsPlayer()) inputs.player = move;
+        else inputs.opponent = move;
+    }
+    return sim_.step(inputs);
+}
+
+MatchSnapshot MatchBranch::snapshot(bool vsAI, const string& player1Name, const string& player2Name) const {
+    PongAIState ai = ai_.save();
+    return CaptureMatch(sim_.config(), sim_.state(), hasAI_ ? &ai : nullptr, vsAI, player1Name, player2Name);
+}
+
+CheckpointWriter::CheckpointWriter(const string& path) : path_(path) {
+    thread_ = thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();     // Writes what is pending first
+}
+
+void CheckpointWriter::submit(const MatchSnapshot& snapshot) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        pending_ = snapshot;
+        hasPending_ = true;
+    }
+    wake_.notify_one();
+}
+
+void CheckpointWriter::flush() {
+    unique_lock<mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return !hasPending_ && !writing_; });
+}
+
+void CheckpointWriter::discard() {
+    flush();
+    remove(path_.c_str());
+}
+
+uint64_t CheckpointWriter::written() const {
+    lock_guard<mutex> lock(mutex_);
+    return written_;
+}
+
+uint64_t CheckpointWriter::failed() const {
+    lock_guard<mutex> lock(mutex_);
+    return failed_;
+}
+
+void CheckpointWriter::run() {
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this]() { return hasPending_ || stopping_; });
+        if (!hasPending_) return;   // Stopping with nothing left to write
+
+        MatchSnapshot snapshot = pending_;
+        hasPending_ = false;
+        writing_ = true;
+        lock.unlock();
+        bool ok = SaveCheckpoint(path_.c_str(), snapshot);
+        lock.lock();
+        writing_ = false;
+        if (ok) written_++;
+        else failed_++;
+        idle_.notify_all();
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "pong_ai.h"
+#include "pong_sim.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// Snapshots of a whole match (rules, state, the AI's memory and who plays) as one block of
+// plain data: taking one or putting it back is a memcpy, and a checkpoint file is a single
+// write of it. The game checkpoints running matches, so one cut short by a crash or a closed
+// window can be resumed; MatchBranch forks a match to look ahead ("what if I move up now?").
+
+const uint32_t SNAPSHOT_MAGIC = 0x4E534250;    // "PBSN"
+const uint32_t SNAPSHOT_VERSION = 2;
+const int SNAPSHOT_NAME_SIZE = 56;              // Same as RESULT_NAME_SIZE and REPLAY_NAME_SIZE
+
+struct MatchSnapshot {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // sizeof(MatchSnapshot), catches builds with a different layout
+    uint32_t checksum;              // FNV-1a of everything after this field
+    PongConfig config;
+    PongState state;
+    PongAIState ai;                 // Opponent AI, if hasAI
+    uint8_t hasAI;
+    uint8_t vsAI;                   // Result log mode of the match
+    uint8_t reserved[6];
+    int64_t savedAt;                // Unix time
+    char player1Name[SNAPSHOT_NAME_SIZE];   // As the match shows them, null terminated
+    char player2Name[SNAPSHOT_NAME_SIZE];
+};
+
+static_assert(std::is_trivially_copyable<MatchSnapshot>::value, "snapshots are copied with memcpy");
+
+// Function to take a snapshot of a match; ai is null in a two-player match
+MatchSnapshot CaptureMatch(const PongConfig& config, const PongState& state, const PongAIState* ai, bool vsAI,
+    const std::string& player1Name, const std::string& player2Name);
+// Function to fill in the header and checksum (CaptureMatch does; call again after changing one)
+void SealSnapshot(MatchSnapshot& snapshot);
+// Function to check the header and checksum of a snapshot read from somewhere else
+bool SnapshotValid(const MatchSnapshot& snapshot);
+
+// Function to write a checkpoint file: a temporary file, flushed to disk, then renamed over
+// path, so a crash at any point leaves either the old checkpoint or the new one
+bool SaveCheckpoint(const char* path, const MatchSnapshot& snapshot);
+// Function to read a checkpoint file; false if it is missing, cut short or from another build
+bool LoadCheckpoint(const char* path, MatchSnapshot& snapshot);
+
+// A match that can be stepped on its own, the AI included. Copying one forks the match: the
+// copy is a few hundred bytes and shares nothing with the original.
+class MatchBranch {
+public:
+    explicit MatchBranch(const MatchSnapshot& snapshot);
+    MatchBranch(const PongSim& sim, const PongAI* ai);
+
+    // Function to advance one tick; the AI (if there is one) moves its own paddle, the inputs
+    // move the other one. Returns PongEvent flags.
+    uint32_t step(PongInputs inputs);
+
+    MatchBranch fork() const { return *this; }
+    MatchSnapshot snapshot(bool vsAI, const std::string& player1Name, const std::string& player2Name) const;
+
+    const PongSim& sim() const { return sim_; }
+    const PongState& state() const { return sim_.state(); }
+    bool hasAI() const { return hasAI_; }
+
+private:
+    PongSim sim_;
+    PongAI ai_;
+    bool hasAI_;
+};
+
+// Writes checkpoints on a background thread, so the frame that takes one never waits for the
+// disk. Only the newest snapshot matters: one handed over while the previous is still being
+// written replaces any that is waiting.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(const MatchSnapshot& snapshot);
+    // Function to wait for the pending checkpoint, then delete the file (the match is over)
+    void discard();
+    // Function to wait until everything submitted is on disk
+    void flush();
+
+    uint64_t written() const;
+    uint64_t failed() const;
+    const std::string& path() const { return path_; }
+
+private:
+    void run();
+
+    std::string path_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    MatchSnapshot pending_;
+    bool hasPending_ = false;
+    bool writing_ = false;
+    bool stopping_ = false;
+    uint64_t written_ = 0;
+    uint64_t failed_ = 0;
+};
@@ -0,0 +1,268 @@
+#include "mcts_ai.h"
+#include "xorshift.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+// Moves of a node's children, in order: up, stay, down
+static const int MCTS_MOVES = 3;
+static const int64_t MCTS_VALUE_SCALE = 1 << 16;
+// Deepest path through a tree (horizonSeconds / actionSeconds levels are used)
+static const int MCTS_MAX_DEPTH = 64;
+
+// Node::children before the node has children
+static const int32_t NODE_LEAF = -1;
+static const int32_t NODE_EXPANDING = -2;   // Another thread is adding them
+static const int32_t NODE_FULL = -3;        // The tree had no room for them
+
+MctsAI::MctsAI(const MctsSettings& settings, bool controlsPlayer, uint32_t seed)
+    : settings_(settings), controlsPlayer_(controlsPlayer), rng_(XorShiftSeed(seed)),
+      modelSettings_(AiSettingsFor(settings.model)), root_(PongSim(), nullptr) {
+    int threadCount = settings.threads > 0 ? settings.threads : (int)thread::hardware_concurrency();
+    threadCount = max(threadCount, 1);
+    if (settings_.maxNodes < MCTS_MOVES + 1) settings_.maxNodes = MCTS_MOVES + 1;
+
+    int treeCount = settings.parallelism == MCTS_ROOT ? threadCount : 1;
+    for (int i = 0; i < treeCount; i++) {
+        trees_.emplace_back(new Tree());
+        trees_.back()->nodes.reset(new Node[settings_.maxNodes]);
+    }
+    workers_.resize(threadCount);
+    for (int i = 0; i < threadCount; i++) {
+        workers_[i].rollouts = 0;
+        workers_[i].rng = XorShift32(rng_) | 1;
+    }
+    pool_.reset(new WorkerPool(threadCount));
+}
+
+int8_t MctsAI::decide(const PongState& state, const PongConfig& config) {
+    if (holdTicks_ > 0) {
+        holdTicks_--;
+        return move_;
+    }
+    move_ = search(state, config);
+    holdTicks_ = max(1, (int)lround(settings_.actionSeconds / config.dt)) - 1;
+    return move_;
+}
+
+int8_t MctsAI::search(const PongState& state, const PongConfig& config) {
+    auto start = chrono::steady_clock::now();
+
+    // Rollouts tick at searchDt; the swept collision keeps the ball's path the same
+    PongConfig searchConfig = config;
+    if (settings_.searchDt > config.dt) searchConfig.dt = settings_.searchDt;
+    PongSim sim(searchConfig);
+    sim.restore(state);
+    AiSettings model = modelSettings_;
+    model.reactionTicks = (int)lround(model.reactionTicks / 60.0f / searchConfig.dt);
+    PongAI opponent(model, !controlsPlayer_, XorShift32(rng_));
+    root_ = MatchBranch(sim, &opponent);
+
+    actionTicks_ = max(1, (int)lround(settings_.actionSeconds / searchConfig.dt));
+    horizonTicks_ = max(actionTicks_, (int)lround(settings_.horizonSeconds / searchConfig.dt));
+    deadline_ = start + chrono::nanoseconds((int64_t)(settings_.budgetMicros * 1000.0f));
+    started_.store(0, memory_order_relaxed);
+    for (unique_ptr<Tree>& tree : trees_) resetTree(*tree);
+    for (Worker& worker : workers_) worker.rollouts = 0;
+
+    pool_->run([this](int self) { searchLoop(self); });
+
+    // The move whose subtree was visited most, over every tree
+    int64_t visits[MCTS_MOVES] = {};
+    uint32_t nodes = 0;
+    for (unique_ptr<Tree>& tree : trees_) {
+        int32_t children = tree->nodes[0].children.load(memory_order_acquire);
+        for (int i = 0; i < MCTS_MOVES; i++) visits[i] += tree->nodes[children + i].visits.load(memory_order_relaxed);
+        nodes += min(tree->used.load(memory_order_relaxed), settings_.maxNodes);
+    }
+    uint32_t rollouts = 0;
+    for (const Worker& worker : workers_) rollouts += (uint32_t)worker.rollouts;
+
+    int8_t move;
+    if (rollouts == 0) {
+        move = FollowBallInput(state, controlsPlayer_ ? state.playerPaddle : state.opponentPaddle);
+    }
+    else {
+        int best = 1;   // Stay, unless a move was visited more
+        for (int i = 0; i < MCTS_MOVES; i++) {
+            if (visits[i] > visits[best]) best = i;
+        }
+        move = (int8_t)(best - 1);
+    }
+
+    uint64_t nanos = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    stats_.decisions++;
+    stats_.rollouts += rollouts;
+    stats_.totalNanos += nanos;
+    stats_.maxNanos = max(stats_.maxNanos, nanos);
+    stats_.lastRollouts = rollouts;
+    stats_.lastNodes = nodes;
+    return move;
+}
+
+void MctsAI::searchLoop(int self) {
+    Tree& tree = *trees_[settings_.parallelism == MCTS_ROOT ? self : 0];
+    Worker& worker = workers_[self];
+    const bool timed = settings_.budgetMicros > 0.0f;
+    for (;;) {
+        if (settings_.maxRollouts > 0 && started_.fetch_add(1, memory_order_relaxed) >= settings_.maxRollouts) return;
+        if (timed && chrono::steady_clock::now() >= deadline_) return;
+        if (!timed && settings_.maxRollouts == 0) return;
+        playout(tree, worker);
+        worker.rollouts++;
+    }
+}
+
+void MctsAI::resetTree(Tree& tree) {
+    Node& root = tree.nodes[0];
+    root.visits.store(0, memory_order_relaxed);
+    root.value.store(0, memory_order_relaxed);
+    root.children.store(NODE_LEAF, memory_order_relaxed);
+    tree.used.store(1, memory_order_relaxed);
+    expand(tree, 0);    // So the threads spread over the first moves right away
+}
+
+// Function to give node its children; returns the first one, or a NODE_* state if it has none
+// (yet). Only the thread that wins the exchange adds them.
+int32_t MctsAI::expand(Tree& tree, int32_t node) {
+    int32_t expected = NODE_LEAF;
+    if (!tree.nodes[node].children.compare_exchange_strong(expected, NODE_EXPANDING, memory_order_acq_rel)) {
+        return expected;
+    }
+    uint32_t first = tree.used.fetch_add(MCTS_MOVES, memory_order_relaxed);
+    if (first + MCTS_MOVES > settings_.maxNodes) {
+        tree.nodes[node].children.store(NODE_FULL, memory_order_release);
+        return NODE_FULL;
+    }
+    for (int i = 0; i < MCTS_MOVES; i++) {
+        Node& child = tree.nodes[first + i];
+        child.visits.store(0, memory_order_relaxed);
+        child.value.store(0, memory_order_relaxed);
+        child.children.store(NODE_LEAF, memory_order_relaxed);
+    }
+    tree.nodes[node].children.store((int32_t)first, memory_order_release);
+    return (int32_t)first;
+}
+
+// Function to pick a child by UCT. Children nobody is in yet come first, in random order;
+// virtual losses make the ones other threads are in look worse.
+int32_t MctsAI::select(Tree& tree, int32_t node, int32_t children, Worker& worker) const {
+    int32_t parentVisits = tree.nodes[node].visits.load(memory_order_relaxed);
+    float logParent = logf((float)max(parentVisits, 1));
+    int offset = (int)(XorShift32(worker.rng) % MCTS_MOVES);
+    int32_t best = children + offset;
+    float bestScore = -1e30f;
+    for (int k = 0; k < MCTS_MOVES; k++) {
+        int32_t child = children + (offset + k) % MCTS_MOVES;
+        int32_t visits = tree.nodes[child].visits.load(memory_order_relaxed);
+        if (visits <= 0) return child;
+        float mean = (float)tree.nodes[child].value.load(memory_order_relaxed) / (float)(MCTS_VALUE_SCALE * visits);
+        float score = mean + settings_.exploration * sqrtf(logParent / (float)visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+// Function to run one rollout: down the tree to a leaf, add its children, then play the rest of
+// the horizon with the rollout policy and back the result up the path
+void MctsAI::playout(Tree& tree, Worker& worker) {
+    const int virtualLoss = settings_.parallelism == MCTS_TREE ? settings_.virtualLoss : 0;
+    MatchBranch branch = root_.fork();
+    int32_t path[MCTS_MAX_DEPTH];
+    int depth = 0;
+    int ticks = 0;
+    float value = 0.0f;
+    bool ended = false;
+    bool expanded = false;
+
+    int32_t node = 0;
+    for (;;) {
+        Node& current = tree.nodes[node];
+        current.visits.fetch_add(1 + virtualLoss, memory_order_relaxed);
+        current.value.fetch_sub(virtualLoss * MCTS_VALUE_SCALE, memory_order_relaxed);
+        path[depth++] = node;
+        if (ended || expanded || depth == MCTS_MAX_DEPTH || ticks + actionTicks_ > horizonTicks_) break;
+
+        int32_t children = current.children.load(memory_order_acquire);
+        if (children == NODE_LEAF) {
+            children = expand(tree, node);
+            expanded = true;    // Descend into one of the new children, then roll out
+        }
+        if (children < 0) break;
+
+        node = select(tree, node, children, worker);
+        ended = play(branch, (int8_t)(node - children - 1), ticks, value);
+    }
+    if (!ended) value = rollout(branch, ticks, worker);
+
+    // The visit was counted on the way down; take the virtual loss back and add the result
+    int64_t scaled = (int64_t)(value * MCTS_VALUE_SCALE);
+    for (int i = 0; i < depth; i++) {
+        Node& visited = tree.nodes[path[i]];
+        if (virtualLoss > 0) visited.visits.fetch_sub(virtualLoss, memory_order_relaxed);
+        visited.value.fetch_add(scaled + virtualLoss * MCTS_VALUE_SCALE, memory_order_relaxed);
+    }
+}
+
+float MctsAI::pointValue(uint32_t events, int ticks) const {
+    uint32_t scored = controlsPlayer_ ? PONG_EVENT_PLAYER_SCORED : PONG_EVENT_OPPONENT_SCORED;
+    uint32_t conceded = controlsPlayer_ ? PONG_EVENT_OPPONENT_SCORED : PONG_EVENT_PLAYER_SCORED;
+    // A point sooner is worth more when it's ours, later is better when it isn't
+    float weight = 1.0f - 0.5f * (float)ticks / (float)horizonTicks_;
+    if (events & scored) return weight;
+    if (events & conceded) return -weight;
+    return 0.0f;
+}
+
+bool MctsAI::play(MatchBranch& branch, int8_t move, int& ticks, float& value) const {
+    PongInputs inputs = { 0, 0 };
+    if (controlsPlayer_) inputs.player = move;
+    else inputs.opponent = move;
+    for (int t = 0; t < actionTicks_; t++) {
+        uint32_t events = branch.step(inputs);
+        ticks++;
+        if (events & (PONG_EVENT_PLAYER_SCORED | PONG_EVENT_OPPONENT_SCORED)) {
+            value = pointValue(events, ticks);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to play on from branch until a point or the horizon. Our paddle heads for where the
+// ball will reach it, off center by a random amount so rollouts try different hits.
+float MctsAI::rollout(MatchBranch& branch, int ticks, Worker& worker) const {
+    const PongConfig& config = branch.sim().config();
+    const float screenHeight = (float)config.screenHeight;
+    float target = 0.0f;
+    bool planned = false;
+    while (ticks < horizonTicks_) {
+        const PongState& state = branch.state();
+        const SimRect& paddle = controlsPlayer_ ? state.playerPaddle : state.opponentPaddle;
+        if (!planned) {
+            float faceX = controlsPlayer_ ? paddle.x - config.ballRadius : paddle.x + paddle.width + config.ballRadius;
+            float y, time;
+            float offset = (XorShiftUnit(worker.rng) - 0.5f) * paddle.height;
+            target = PredictBallY(state.ballPosition, state.ballSpeedVector, faceX, screenHeight, y, time)
+                ? y + offset : screenHeight / 2.0f;
+            planned = true;
+        }
+        float center = paddle.y + paddle.height / 2.0f;
+        int8_t move = target < center - 4.0f ? -1 : (target > center + 4.0f ? 1 : 0);
+
+        PongInputs inputs = { 0, 0 };
+        if (controlsPlayer_) inputs.player = move;
+        else inputs.opponent = move;
+        uint32_t events = branch.step(inputs);
+        ticks++;
+        if (events & (PONG_EVENT_PLAYER_SCORED | PONG_EVENT_OPPONENT_SCORED)) return pointValue(events, ticks);
+        if (events & (PONG_EVENT_PLAYER_HIT | PONG_EVENT_OPPONENT_HIT)) planned = false;    // Plan again
+    }
+    return 0.0f;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "match_snapshot.h"
+#include "pong_ai.h"
+#include "pong_sim.h"
+#include "worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// The "hard" opponent: instead of predicting the ball once per bounce like PongAI, it searches.
+// Every few ticks it runs a Monte Carlo tree search over its paddle moves (up, stay, down, each
+// held for actionSeconds) within a time budget. Each rollout forks the match (MatchBranch),
+// plays the moves down the tree, then finishes the rally with a cheap policy for both paddles:
+// its own steers to the predicted intercept, the other one is a PongAI. Scoring is +1, losing
+// a heart -1, counted less the later it happens.
+//
+// The search runs on a WorkerPool, the caller included. With MCTS_TREE they
+// share one tree and a thread descending through a node adds a virtual loss to it, so the
+// others try different moves meanwhile; with MCTS_ROOT each thread grows its own tree and the
+// visits at the root are added up.
+
+enum MctsParallelism {
+    MCTS_TREE,      // One shared tree, virtual loss
+    MCTS_ROOT       // A tree per thread, merged at the root
+};
+
+struct MctsSettings {
+    float budgetMicros = 2000.0f;       // Search time per decision; 0 = only maxRollouts
+    uint32_t maxRollouts = 0;           // Per decision, 0 = only the time budget (benchmarks)
+    float actionSeconds = 1.0f / 15.0f; // How long a chosen move is held, one level of the tree
+    float horizonSeconds = 2.0f;        // How far ahead a rollout plays
+    float exploration = 0.5f;           // UCT constant; values are in [-1, 1]
+    int virtualLoss = 1;                // Lost rollouts a thread adds to the nodes it's in (MCTS_TREE)
+    float searchDt = 1.0f / 60.0f;      // Tick length of the rollouts, if coarser than the match's
+    AiDifficulty model = AI_HARD;       // How the other paddle is assumed to play
+    MctsParallelism parallelism = MCTS_TREE;
+    int threads = 0;                    // Search threads including the caller (0 = all cores)
+    uint32_t maxNodes = 1 << 16;        // Per tree; a full tree stops growing, rollouts go on
+};
+
+struct MctsStats {
+    uint64_t decisions = 0;
+    uint64_t rollouts = 0;
+    uint64_t totalNanos = 0;            // Time spent searching
+    uint64_t maxNanos = 0;              // Longest decision
+    uint32_t lastRollouts = 0;
+    uint32_t lastNodes = 0;
+};
+
+class MctsAI {
+public:
+    // controlsPlayer picks the right (player) paddle instead of the left (opponent) one
+    MctsAI(const MctsSettings& settings, bool controlsPlayer, uint32_t seed);
+
+    MctsAI(const MctsAI&) = delete;
+    MctsAI& operator=(const MctsAI&) = delete;
+
+    // Function to pick this tick's paddle move: searches every actionSeconds, holds the move
+    // in between. Same interface as PongAI::decide.
+    int8_t decide(const PongState& state, const PongConfig& config);
+
+    // Function to search from state right away and return the best move
+    int8_t search(const PongState& state, const PongConfig& config);
+
+    const MctsSettings& settings() const { return settings_; }
+    const MctsStats& stats() const { return stats_; }
+    int threadCount() const { return pool_->threadCount(); }
+
+private:
+    struct Node {
+        std::atomic<int32_t> visits;    // Virtual losses in flight included
+        std::atomic<int32_t> children;  // First of MCTS_MOVES children, or a NODE_* state
+        std::atomic<int64_t> value;     // Sum of rollout values in 1/MCTS_VALUE_SCALE
+    };
+
+    struct Tree {
+        std::unique_ptr<Node[]> nodes;
+        std::atomic<uint32_t> used{ 0 };
+    };
+
+    // Per-thread state padded so threads never share a cache line
+    struct Worker {
+        uint64_t rollouts;
+        uint32_t rng;
+        char padding[64];
+    };
+
+    void searchLoop(int self);
+    void playout(Tree& tree, Worker& worker);
+    int32_t expand(Tree& tree, int32_t node);
+    int32_t select(Tree& tree, int32_t node, int32_t children, Worker& worker) const;
+    float rollout(MatchBranch& branch, int ticks, Worker& worker) const;
+    // Function to step branch with our paddle on move; true (and value set) if a point ended it
+    bool play(MatchBranch& branch, int8_t move, int& ticks, float& value) const;
+    float pointValue(uint32_t events, int ticks) const;
+    void resetTree(Tree& tree);
+
+    MctsSettings settings_;
+    bool controlsPlayer_;
+    uint32_t rng_;
+    AiSettings modelSettings_;
+    int8_t move_ = 0;
+    int holdTicks_ = 0;
+    MctsStats stats_;
+
+    // The search now running: the root position and when to stop
+    MatchBranch root_;
+    int actionTicks_ = 1;               // Rollout ticks per tree level
+    int horizonTicks_ = 1;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<uint32_t> started_{ 0 };
+
+    std::vector<std::unique_ptr<Tree>> trees_;
+    std::vector<Worker> workers_;
+
+    // Searches the caller and the pool's other threads, each with its own Worker
+    std::unique_ptr<WorkerPool> pool_;
+};
@@ -0,0 +1,286 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+void MetricGauge::set(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits_.store(bits, memory_order_relaxed);
+}
+
+double MetricGauge::value() const {
+    uint64_t bits = bits_.load(memory_order_relaxed);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+MetricHistogram::MetricHistogram(const vector<double>& bounds) {
+    for (double bound : bounds) {
+        if (boundCount_ == MAX_BOUNDS) break;
+        bounds_[boundCount_++] = bound;
+    }
+    for (atomic<uint64_t>& bucket : buckets_) bucket.store(0, memory_order_relaxed);
+}
+
+void MetricHistogram::observe(double value) {
+    // A handful of bounds: a straight scan beats a binary search
+    int index = 0;
+    while (index < boundCount_ && value > bounds_[index]) index++;
+    buckets_[index].fetch_add(1, memory_order_relaxed);
+    if (value > 0.0) sumNanos_.fetch_add((uint64_t)llround(value * 1e9), memory_order_relaxed);
+}
+
+uint64_t MetricHistogram::count() const {
+    uint64_t total = 0;
+    for (int i = 0; i <= boundCount_; i++) total += bucket(i);
+    return total;
+}
+
+MetricsRegistry::MetricsRegistry() : start_(chrono::steady_clock::now()) {
+}
+
+MetricsRegistry::Entry& MetricsRegistry::find(const string& name, const string& help, MetricType type,
+    const string& labelName, const string& labelValue) {
+    for (unique_ptr<Entry>& entry : entries_) {
+        if (entry->type == type && entry->name == name && entry->labelName == labelName && entry->labelValue == labelValue) {
+            return *entry;
+        }
+    }
+    entries_.emplace_back(new Entry());
+    Entry& entry = *entries_.back();
+    entry.name = name;
+    entry.help = help;
+    entry.labelName = labelName;
+    entry.labelValue = labelValue;
+    entry.type = type;
+    return entry;
+}
+
+MetricCounter& MetricsRegistry::counter(const string& name, const string& help, const string& labelName, const string& labelValue) {
+    lock_guard<mutex> lock(mutex_);
+    Entry& entry = find(name, help, METRIC_COUNTER, labelName, labelValue);
+    if (!entry.counter) entry.counter.reset(new MetricCounter());
+    return *entry.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const string& name, const string& help, const string& labelName, const string& labelValue) {
+    lock_guard<mutex> lock(mutex_);
+    Entry& entry = find(name, help, METRIC_GAUGE, labelName, labelValue);
+    if (!entry.gauge) entry.gauge.reset(new MetricGauge());
+    return *entry.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const string& name, const string& help, const vector<double>& bounds,
+    const string& labelName, const string& labelValue) {
+    lock_guard<mutex> lock(mutex_);
+    Entry& entry = find(name, help, METRIC_HISTOGRAM, labelName, labelValue);
+    if (!entry.histogram) entry.histogram.reset(new MetricHistogram(bounds));
+    return *entry.histogram;
+}
+
+double MetricsRegistry::uptimeSeconds() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+}
+
+// Function to escape a help text or label value (Prometheus: backslash, quote and newline)
+static string Escape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (c == '\n') escaped += "\\n";
+        else if ((unsigned char)c >= 0x20) escaped += c;
+    }
+    return escaped;
+}
+
+static void AppendNumber(string& out, double value) {
+    char text[32];
+    if (std::isinf(value)) snprintf(text, sizeof(text), value > 0 ? "+Inf" : "-Inf");
+    else snprintf(text, sizeof(text), "%.9g", value);
+    out += text;
+}
+
+static void AppendNumber(string& out, uint64_t value) {
+    char text[24];
+    snprintf(text, sizeof(text), "%llu", (unsigned long long)value);
+    out += text;
+}
+
+// Function to append "name{label="value",extra}" (the braces only if there is a label)
+static void AppendSeries(string& out, const string& name, const string& labelName, const string& labelValue,
+    const char* extra = nullptr) {
+    out += name;
+    if (labelName.empty() && !extra) return;
+    out += '{';
+    if (!labelName.empty()) {
+        out += labelName + "=\"" + Escape(labelValue) + "\"";
+        if (extra) out += ',';
+    }
+    if (extra) out += extra;
+    out += '}';
+}
+
+string MetricsRegistry::prometheusText() const {
+    static const char* typeNames[] = { "counter", "gauge", "histogram" };
+    lock_guard<mutex> lock(mutex_);
+    string out;
+    out.reserve(entries_.size() * 256);
+
+    out += "# HELP pb_uptime_seconds Seconds since the game started\n# TYPE pb_uptime_seconds gauge\npb_uptime_seconds ";
+    AppendNumber(out, uptimeSeconds());
+    out += '\n';
+
+    // Series of one name have to be together, under one HELP and TYPE
+    vector<bool> done(entries_.size(), false);
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (done[i]) continue;
+        const Entry& family = *entries_[i];
+        out += "# HELP " + family.name + " " + Escape(family.help) + "\n";
+        out += "# TYPE " + family.name + " " + typeNames[family.type] + "\n";
+
+        for (size_t j = i; j < entries_.size(); j++) {
+            const Entry& entry = *entries_[j];
+            if (done[j] || entry.name != family.name || entry.type != family.type) continue;
+            done[j] = true;
+
+            if (entry.type == METRIC_COUNTER) {
+                AppendSeries(out, entry.name, entry.labelName, entry.labelValue);
+                out += ' ';
+                AppendNumber(out, entry.counter->value());
+                out += '\n';
+            }
+            else if (entry.type == METRIC_GAUGE) {
+                AppendSeries(out, entry.name, entry.labelName, entry.labelValue);
+                out += ' ';
+                AppendNumber(out, entry.gauge->value());
+                out += '\n';
+            }
+            else {
+                const MetricHistogram& histogram = *entry.histogram;
+                uint64_t cumulative = 0;
+                for (int b = 0; b <= histogram.boundCount(); b++) {
+                    cumulative += histogram.bucket(b);
+                    string le = "le=\"";
+                    if (b == histogram.boundCount()) le += "+Inf";
+                    else AppendNumber(le, histogram.bound(b));
+                    le += '"';
+                    AppendSeries(out, entry.name + "_bucket", entry.labelName, entry.labelValue, le.c_str());
+                    out += ' ';
+                    AppendNumber(out, cumulative);
+                    out += '\n';
+                }
+                AppendSeries(out, entry.name + "_sum", entry.labelName, entry.labelValue);
+                out += ' ';
+                AppendNumber(out, histogram.sum());
+                out += '\n';
+                AppendSeries(out, entry.name + "_count", entry.labelName, entry.labelValue);
+                out += ' ';
+                AppendNumber(out, cumulative);
+                out += '\n';
+            }
+        }
+    }
+    return out;
+}
+
+// Function to quote a string for JSON
+static string JsonString(const string& text) {
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+            quoted += escaped;
+        }
+        else quoted += c;
+    }
+    return quoted + "\"";
+}
+
+string MetricsRegistry::json() const {
+    lock_guard<mutex> lock(mutex_);
+    string out = "{\"time\":";
+    AppendNumber(out, (uint64_t)time(nullptr));
+    out += ",\"uptime_seconds\":";
+    AppendNumber(out, uptimeSeconds());
+    out += ",\"metrics\":[";
+
+    for (size_t i = 0; i < entries_.size(); i++) {
+        const Entry& entry = *entries_[i];
+        if (i > 0) out += ',';
+        out += "\n{\"name\":" + JsonString(entry.name);
+        if (!entry.labelName.empty()) out += ",\"labels\":{" + JsonString(entry.labelName) + ":" + JsonString(entry.labelValue) + "}";
+
+        if (entry.type == METRIC_COUNTER) {
+            out += ",\"type\":\"counter\",\"value\":";
+            AppendNumber(out, entry.counter->value());
+        }
+        else if (entry.type == METRIC_GAUGE) {
+            out += ",\"type\":\"gauge\",\"value\":";
+            double value = entry.gauge->value();
+            if (std::isfinite(value)) AppendNumber(out, value);
+            else out += "null";     // JSON has no infinity
+        }
+        else {
+            const MetricHistogram& histogram = *entry.histogram;
+            out += ",\"type\":\"histogram\",\"buckets\":[";
+            uint64_t cumulative = 0;
+            for (int b = 0; b <= histogram.boundCount(); b++) {
+                cumulative += histogram.bucket(b);
+                if (b > 0) out += ',';
+                out += "{\"le\":";
+                if (b == histogram.boundCount()) out += "null";     // +Inf
+                else AppendNumber(out, histogram.bound(b));
+                out += ",\"count\":";
+                AppendNumber(out, cumulative);
+                out += '}';
+            }
+            out += "],\"sum\":";
+            AppendNumber(out, histogram.sum());
+            out += ",\"count\":";
+            AppendNumber(out, cumulative);
+        }
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+MetricsRegistry& Metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+vector<double> MetricSecondsBuckets() {
+    return { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.0167, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0 };
+}
+
+bool WriteMetricsJson(const MetricsRegistry& registry, const char* path) {
+    string text = registry.json();
+    string tempPath = string(path) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        remove(tempPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path);   // rename() doesn't replace an existing file on Windows
+#endif
+    return rename(tempPath.c_str(), path) == 0;
+}
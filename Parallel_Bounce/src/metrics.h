@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Counters, gauges and histograms for watching an install run (frame time, tick time, matches,
+// asset loads, log writes). Updating one is a relaxed atomic add or two, from any thread, so
+// they can sit in the frame loop and the simulation tick. Registering one takes a lock; do it
+// once (e.g. into a static reference) and keep the reference.
+//
+// metrics_server.h serves the registry as Prometheus text and writes it out as JSON.
+
+class MetricCounter {
+public:
+    void add(uint64_t count = 1) { value_.fetch_add(count, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{ 0 };
+};
+
+class MetricGauge {
+public:
+    void set(double value);
+    double value() const;
+
+private:
+    std::atomic<uint64_t> bits_{ 0 };   // The double's bits (0 is 0.0)
+};
+
+// Counts of observed values per bucket (upper bounds set at registration) and their sum
+class MetricHistogram {
+public:
+    static const int MAX_BOUNDS = 16;
+
+    explicit MetricHistogram(const std::vector<double>& bounds);
+
+    void observe(double value);
+
+    int boundCount() const { return boundCount_; }
+    double bound(int index) const { return bounds_[index]; }
+    // Values in bucket index alone (not cumulative); index boundCount() is above the last bound
+    uint64_t bucket(int index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    uint64_t count() const;
+    double sum() const { return sumNanos_.load(std::memory_order_relaxed) / 1e9; }
+
+private:
+    double bounds_[MAX_BOUNDS];
+    int boundCount_ = 0;
+    std::atomic<uint64_t> buckets_[MAX_BOUNDS + 1];
+    std::atomic<uint64_t> sumNanos_{ 0 };   // Sum in billionths, so it can be added atomically
+};
+
+enum MetricType {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    // Functions to get the metric called name (Prometheus naming: pb_..._total, ..._seconds)
+    // with an optional label, registering it on first use. Asking again for the same name and
+    // label returns the same metric.
+    MetricCounter& counter(const std::string& name, const std::string& help,
+        const std::string& labelName = "", const std::string& labelValue = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help,
+        const std::string& labelName = "", const std::string& labelValue = "");
+    MetricHistogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+        const std::string& labelName = "", const std::string& labelValue = "");
+
+    // Function to format every metric in the Prometheus text format (version 0.0.4)
+    std::string prometheusText() const;
+    // Function to format every metric as one JSON object, with the time and uptime
+    std::string json() const;
+
+    double uptimeSeconds() const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labelName;
+        std::string labelValue;
+        MetricType type;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    Entry& find(const std::string& name, const std::string& help, MetricType type,
+        const std::string& labelName, const std::string& labelValue);
+
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;   // In registration order
+};
+
+// The process-wide registry the game's metrics are in
+MetricsRegistry& Metrics();
+
+// Bucket bounds for durations in seconds, 100 us to 1 s
+std::vector<double> MetricSecondsBuckets();
+
+// Function to write registry.json() to path: a temporary file, then renamed over the old one
+bool WriteMetricsJson(const MetricsRegistry& registry, const char* path);
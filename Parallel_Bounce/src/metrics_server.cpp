@@ -0,0 +1,189 @@
+#include "metrics_server.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0      // Only Linux would raise SIGPIPE when a scraper hangs up early
+#endif
+
+// How long the thread waits for a connection before checking for stop() and the dump
+static const int METRICS_POLL_MILLIS = 200;
+
+static void CloseSocket(intptr_t handle) {
+#ifdef _WIN32
+    closesocket((SOCKET)handle);
+#else
+    ::close((int)handle);
+#endif
+}
+
+// Function to start Winsock once per process (nothing to do elsewhere)
+static bool MetricsNetInit() {
+#ifdef _WIN32
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return started;
+#else
+    return true;
+#endif
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry) : registry_(registry) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(const MetricsExportSettings& settings) {
+    stop();
+    settings_ = settings;
+    if (settings_.jsonIntervalSeconds < 1) settings_.jsonIntervalSeconds = 1;
+
+    bool ok = true;
+    if (settings_.port != 0) {
+        ok = false;
+        intptr_t handle = MetricsNetInit() ? (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : -1;
+#ifdef _WIN32
+        if ((SOCKET)handle == INVALID_SOCKET) handle = -1;
+#endif
+        if (handle != -1) {
+            int reuse = 1;
+            setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+            sockaddr_in local;
+            memset(&local, 0, sizeof(local));
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(settings_.loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+            local.sin_port = htons(settings_.port);
+            ok = ::bind(handle, (const sockaddr*)&local, sizeof(local)) == 0 && listen(handle, 8) == 0;
+            if (ok) {
+                listener_ = handle;
+                port_ = settings_.port;
+            }
+            else {
+                CloseSocket(handle);
+            }
+        }
+        if (!ok) fprintf(stderr, "Error: Could not open port %u for metrics.\n", (unsigned)settings_.port);
+    }
+
+    if (listener_ != -1 || !settings_.jsonPath.empty()) {
+        stopping_ = false;
+        thread_ = thread(&MetricsExporter::run, this);
+    }
+    return ok;
+}
+
+void MetricsExporter::stop() {
+    stopping_ = true;
+    if (thread_.joinable()) thread_.join();
+    if (listener_ != -1) {
+        CloseSocket(listener_);
+        listener_ = -1;
+        port_ = 0;
+    }
+}
+
+void MetricsExporter::run() {
+    typedef chrono::steady_clock Clock;
+    const chrono::seconds interval(settings_.jsonIntervalSeconds);
+    Clock::time_point nextDump = Clock::now() + interval;
+
+    while (!stopping_.load(memory_order_relaxed)) {
+        if (listener_ != -1) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET((unsigned)listener_, &readable);
+            timeval timeout = { 0, METRICS_POLL_MILLIS * 1000 };
+            if (select((int)listener_ + 1, &readable, nullptr, nullptr, &timeout) > 0) {
+                intptr_t client = (intptr_t)accept(listener_, nullptr, nullptr);
+#ifdef _WIN32
+                if ((SOCKET)client == INVALID_SOCKET) client = -1;
+#endif
+                if (client != -1) serve(client);
+            }
+        }
+        else {
+            this_thread::sleep_for(chrono::milliseconds(METRICS_POLL_MILLIS));
+        }
+
+        if (!settings_.jsonPath.empty() && Clock::now() >= nextDump) {
+            if (WriteMetricsJson(registry_, settings_.jsonPath.c_str())) dumps_.fetch_add(1, memory_order_relaxed);
+            nextDump = Clock::now() + interval;
+        }
+    }
+
+    // The last numbers before the game exits
+    if (!settings_.jsonPath.empty() && WriteMetricsJson(registry_, settings_.jsonPath.c_str())) {
+        dumps_.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+// Function to answer one HTTP request: the metrics for GET / and GET /metrics, 404 otherwise.
+// One connection at a time is plenty for a scraper every few seconds.
+void MetricsExporter::serve(intptr_t client) {
+    // Don't let a client that never sends anything hold up the thread
+#ifdef _WIN32
+    DWORD timeoutMillis = 1000;
+    setsockopt((SOCKET)client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeoutMillis, sizeof(timeoutMillis));
+#else
+    timeval timeout = { 1, 0 };
+    setsockopt((int)client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    char request[2048];
+    size_t size = 0;
+    while (size < sizeof(request) - 1) {
+        int received = (int)recv(client, request + size, (int)(sizeof(request) - 1 - size), 0);
+        if (received <= 0) break;
+        size += (size_t)received;
+        request[size] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[size] = '\0';
+
+    string body;
+    const char* status = "200 OK";
+    if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET / ", 6) == 0) {
+        body = registry_.prometheusText();
+        scrapes_.fetch_add(1, memory_order_relaxed);
+    }
+    else {
+        status = "404 Not Found";
+        body = "Not found; the metrics are at /metrics\n";
+    }
+
+    char header[160];
+    snprintf(header, sizeof(header),
+        "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %llu\r\nConnection: close\r\n\r\n",
+        status, (unsigned long long)body.size());
+    string response = header + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        int count = (int)send(client, response.data() + sent, (int)(response.size() - sent), MSG_NOSIGNAL);
+        if (count <= 0) break;
+        sent += (size_t)count;
+    }
+    CloseSocket(client);
+}
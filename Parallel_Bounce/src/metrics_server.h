@@ -0,0 +1,52 @@
+#pragma once
+
+#include "metrics.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Publishes a MetricsRegistry from a background thread: as Prometheus text over HTTP (GET
+// /metrics) and as a JSON file rewritten every few seconds, for installs without a scraper.
+// Nothing runs on the caller's threads. The header stays free of system headers, like
+// net_socket.h.
+
+struct MetricsExportSettings {
+    uint16_t port = 0;                  // HTTP endpoint, 0 = none
+    bool loopbackOnly = true;           // Listen on 127.0.0.1 only; false = every interface
+    std::string jsonPath;               // JSON dump, empty = none
+    int jsonIntervalSeconds = 60;
+};
+
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const MetricsRegistry& registry);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Function to open the port and start the thread. Returns false if the port can't be
+    // opened (the JSON dump runs anyway).
+    bool start(const MetricsExportSettings& settings);
+    // Function to stop the thread; writes one last JSON dump
+    void stop();
+
+    uint16_t port() const { return port_; }
+    uint64_t scrapes() const { return scrapes_.load(std::memory_order_relaxed); }
+    uint64_t dumps() const { return dumps_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void serve(intptr_t client);
+
+    const MetricsRegistry& registry_;
+    MetricsExportSettings settings_;
+    intptr_t listener_ = -1;            // SOCKET on Windows, file descriptor elsewhere
+    uint16_t port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> stopping_{ false };
+    std::atomic<uint64_t> scrapes_{ 0 };
+    std::atomic<uint64_t> dumps_{ 0 };
+};
@@ -0,0 +1,50 @@
+#include "net_impairment.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Heap order: the packet that arrives first ends up at the front
+bool NetImpairment::arrivesLater(const Packet& a, const Packet& b) {
+    if (a.arrival != b.arrival) return a.arrival > b.arrival;
+    return a.order > b.order;
+}
+
+NetImpairment::NetImpairment(const NetImpairmentSettings& settings)
+    : settings_(settings), rng_(settings.seed ? settings.seed : 1) {
+}
+
+double NetImpairment::nextRandom() {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return (double)(rng_ >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void NetImpairment::send(double nowMillis, const uint8_t* data, size_t size) {
+    sent_++;
+    if (settings_.lossRate > 0 && nextRandom() < settings_.lossRate) {
+        dropped_++;
+        return;
+    }
+
+    int copies = settings_.duplicateRate > 0 && nextRandom() < settings_.duplicateRate ? 2 : 1;
+    for (int i = 0; i < copies; i++) {
+        double delay = settings_.latencyMillis + (nextRandom() * 2.0 - 1.0) * settings_.jitterMillis;
+        Packet packet;
+        packet.arrival = nowMillis + (delay > 0 ? delay : 0);
+        packet.order = order_++;
+        packet.data.assign(data, data + size);
+        packets_.push_back(move(packet));
+        push_heap(packets_.begin(), packets_.end(), arrivesLater);
+    }
+}
+
+bool NetImpairment::receive(double nowMillis, vector<uint8_t>& packet) {
+    if (packets_.empty() || packets_.front().arrival > nowMillis) return false;
+
+    pop_heap(packets_.begin(), packets_.end(), arrivesLater);
+    packet.swap(packets_.back().data);
+    packets_.pop_back();
+    return true;
+}
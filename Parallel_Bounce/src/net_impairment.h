@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Delay line that makes a perfect link (loopback, or two sessions in one process) behave like
+// the internet: every packet is held back by latency +- jitter and some are dropped. Jitter
+// reorders packets the way real networks do. Time is passed in by the caller, so benchmarks
+// can run it on a simulated clock.
+
+struct NetImpairmentSettings {
+    double latencyMillis = 0.0;     // One way
+    double jitterMillis = 0.0;      // Uniform in [-jitter, +jitter], never below zero delay
+    double lossRate = 0.0;          // 0..1
+    double duplicateRate = 0.0;     // 0..1
+    uint32_t seed = 1;
+
+    bool active() const { return latencyMillis > 0 || jitterMillis > 0 || lossRate > 0 || duplicateRate > 0; }
+};
+
+class NetImpairment {
+public:
+    explicit NetImpairment(const NetImpairmentSettings& settings = NetImpairmentSettings());
+
+    void setSettings(const NetImpairmentSettings& settings) { settings_ = settings; }
+    const NetImpairmentSettings& settings() const { return settings_; }
+
+    // Function to hand a packet to the link at time nowMillis
+    void send(double nowMillis, const uint8_t* data, size_t size);
+
+    // Function to take the next packet that has arrived by nowMillis. Returns false if none has.
+    bool receive(double nowMillis, std::vector<uint8_t>& packet);
+
+    size_t inFlight() const { return packets_.size(); }
+    uint64_t sent() const { return sent_; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Packet {
+        double arrival;
+        uint64_t order;             // Keeps packets with the same arrival time in send order
+        std::vector<uint8_t> data;
+    };
+
+    static bool arrivesLater(const Packet& a, const Packet& b);
+    double nextRandom();            // Uniform in [0, 1)
+
+    NetImpairmentSettings settings_;
+    std::vector<Packet> packets_;   // Min-heap on arrival
+    uint64_t rng_;
+    uint64_t order_ = 0;
+    uint64_t sent_ = 0;
+    uint64_t dropped_ = 0;
+};
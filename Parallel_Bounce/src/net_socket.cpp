@@ -0,0 +1,158 @@
+#include "net_socket.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Function to start Winsock once per process (nothing to do elsewhere)
+static bool NetInit() {
+#ifdef _WIN32
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return started;
+#else
+    return true;
+#endif
+}
+
+bool ParseNetAddress(const string& text, uint16_t defaultPort, NetAddress& address) {
+    if (!NetInit()) return false;
+
+    string host = text;
+    uint16_t port = defaultPort;
+    size_t colon = text.rfind(':');
+    if (colon != string::npos) {
+        host = text.substr(0, colon);
+        int value = atoi(text.c_str() + colon + 1);
+        if (value <= 0 || value > 65535) return false;
+        port = (uint16_t)value;
+    }
+    if (host.empty()) host = "127.0.0.1";
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+
+    address.ip = ntohl(((sockaddr_in*)result->ai_addr)->sin_addr.s_addr);
+    address.port = port;
+    freeaddrinfo(result);
+    return true;
+}
+
+string NetAddressToString(const NetAddress& address) {
+    char text[32];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u:%u", (address.ip >> 24) & 255, (address.ip >> 16) & 255,
+        (address.ip >> 8) & 255, address.ip & 255, address.port);
+    return text;
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint16_t port) {
+    close();
+    if (!NetInit()) return false;
+
+#ifdef _WIN32
+    SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET) return false;
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0) return false;
+#endif
+    handle_ = (intptr_t)handle;
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+
+    bool ok = bind(handle, (sockaddr*)&local, sizeof(local)) == 0;
+
+    // Non-blocking, so the game loop can poll every frame
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ok = ok && ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+    ok = ok && fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+
+    socklen_t length = sizeof(local);
+    ok = ok && getsockname(handle, (sockaddr*)&local, &length) == 0;
+    if (!ok) {
+        close();
+        return false;
+    }
+    localPort_ = ntohs(local.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (handle_ == INVALID_HANDLE) return;
+#ifdef _WIN32
+    closesocket((SOCKET)handle_);
+#else
+    ::close((int)handle_);
+#endif
+    handle_ = INVALID_HANDLE;
+    localPort_ = 0;
+}
+
+bool UdpSocket::send(const NetAddress& to, const void* data, size_t size) {
+    if (handle_ == INVALID_HANDLE) return false;
+
+    sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = htonl(to.ip);
+    remote.sin_port = htons(to.port);
+    return sendto(handle_, (const char*)data, (int)size, 0, (sockaddr*)&remote, sizeof(remote)) == (int)size;
+}
+
+int UdpSocket::receive(void* buffer, size_t capacity, NetAddress& from) {
+    if (handle_ == INVALID_HANDLE) return -1;
+
+    sockaddr_in remote;
+    socklen_t length = sizeof(remote);
+    int received = (int)recvfrom(handle_, (char*)buffer, (int)capacity, 0, (sockaddr*)&remote, &length);
+    if (received < 0) {
+#ifdef _WIN32
+        int error = WSAGetLastError();
+        // A port unreachable reply to an earlier send shows up as WSAECONNRESET; not an error for UDP
+        if (error == WSAEWOULDBLOCK || error == WSAECONNRESET) return 0;
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED) return 0;
+#endif
+        return -1;
+    }
+
+    from.ip = ntohl(remote.sin_addr.s_addr);
+    from.port = ntohs(remote.sin_port);
+    return received;
+}
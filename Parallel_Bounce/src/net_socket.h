@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Minimal non-blocking UDP socket (BSD sockets / Winsock). The header stays free of system
+// headers, since windows.h clashes with raylib.h.
+
+struct NetAddress {
+    uint32_t ip = 0;        // IPv4, host byte order
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+};
+
+// Function to resolve "host:port" (or "host" with defaultPort). Returns false if it can't.
+bool ParseNetAddress(const std::string& text, uint16_t defaultPort, NetAddress& address);
+std::string NetAddressToString(const NetAddress& address);
+
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // Function to bind to port on all interfaces (0 = any free port)
+    bool open(uint16_t port = 0);
+    void close();
+    bool isOpen() const { return handle_ != INVALID_HANDLE; }
+    uint16_t localPort() const { return localPort_; }
+    // The OS handle, for waiting on many sockets at once (epoll, select)
+    intptr_t handle() const { return handle_; }
+
+    bool send(const NetAddress& to, const void* data, size_t size);
+    // Function to read one waiting datagram. Returns its size, 0 if none is waiting, -1 on error.
+    int receive(void* buffer, size_t capacity, NetAddress& from);
+
+private:
+    static const intptr_t INVALID_HANDLE = -1;
+
+    intptr_t handle_ = INVALID_HANDLE;   // SOCKET on Windows, file descriptor elsewhere
+    uint16_t localPort_ = 0;
+};
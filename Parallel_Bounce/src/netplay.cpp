@@ -0,0 +1,480 @@
+#include "netplay.h"
+
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+// Packet header: magic (2), version (1), type (1), session id (4); all values little endian
+static const size_t NET_HEADER_SIZE = 8;
+static const size_t NET_MAX_NAME = 55;
+static const int NET_MAX_INPUT_DELAY = 8;
+
+static void Put8(vector<uint8_t>& out, uint8_t value) {
+    out.push_back(value);
+}
+
+static void Put32(vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+static void PutFloat(vector<uint8_t>& out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    Put32(out, bits);
+}
+
+static void PutVarint(vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static void PutName(vector<uint8_t>& out, const string& name) {
+    size_t length = name.size() < NET_MAX_NAME ? name.size() : NET_MAX_NAME;
+    Put8(out, (uint8_t)length);
+    out.insert(out.end(), name.begin(), name.begin() + length);
+}
+
+static void PutHeader(vector<uint8_t>& out, NetPacketType type, uint32_t sessionId) {
+    out.clear();
+    Put8(out, (uint8_t)(NET_MAGIC & 0xFF));
+    Put8(out, (uint8_t)(NET_MAGIC >> 8));
+    Put8(out, NET_PROTOCOL_VERSION);
+    Put8(out, (uint8_t)type);
+    Put32(out, sessionId);
+}
+
+// Bounds-checked reader; any read past the end clears ok
+struct NetReader {
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+    bool ok;
+
+    NetReader(const uint8_t* packet, size_t packetSize) : data(packet), size(packetSize), offset(NET_HEADER_SIZE), ok(packetSize >= NET_HEADER_SIZE) {}
+
+    uint8_t u8() {
+        if (offset >= size) { ok = false; return 0; }
+        return data[offset++];
+    }
+    uint32_t u32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= (uint32_t)u8() << (8 * i);
+        return value;
+    }
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    uint32_t varint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t byte = u8();
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+    string name() {
+        size_t length = u8();
+        if (length > NET_MAX_NAME || offset + length > size) { ok = false; return string(); }
+        string value((const char*)data + offset, length);
+        offset += length;
+        return value;
+    }
+};
+
+static uint32_t SessionIdOf(const uint8_t* data) {
+    return (uint32_t)data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+}
+
+int NetPacketTypeOf(const uint8_t* data, size_t size) {
+    if (size < NET_HEADER_SIZE) return -1;
+    if (data[0] != (NET_MAGIC & 0xFF) || data[1] != (NET_MAGIC >> 8) || data[2] != NET_PROTOCOL_VERSION) return -1;
+    return data[3];
+}
+
+void WriteHelloPacket(const string& playerName, vector<uint8_t>& out) {
+    PutHeader(out, NET_PACKET_HELLO, 0);
+    PutName(out, playerName);
+}
+
+bool ReadHelloPacket(const uint8_t* data, size_t size, string& playerName) {
+    if (NetPacketTypeOf(data, size) != NET_PACKET_HELLO) return false;
+    NetReader reader(data, size);
+    playerName = reader.name();
+    return reader.ok;
+}
+
+void WriteWelcomePacket(uint32_t sessionId, const PongConfig& config, const NetSessionSettings& settings,
+    const string& hostName, vector<uint8_t>& out) {
+    PutHeader(out, NET_PACKET_WELCOME, sessionId);
+    Put32(out, (uint32_t)config.screenWidth);
+    Put32(out, (uint32_t)config.screenHeight);
+    PutFloat(out, config.paddleSpeed);
+    PutFloat(out, config.ballSpeed);
+    PutFloat(out, config.ballRadius);
+    Put32(out, (uint32_t)config.maxHearts);
+    PutFloat(out, config.dt);
+    PutFloat(out, config.serveJitter);
+    Put32(out, config.seed);
+    Put8(out, config.continuousCollision ? 1 : 0);
+    Put8(out, (uint8_t)settings.inputDelay);
+    Put8(out, (uint8_t)settings.maxRollback);
+    PutVarint(out, (uint32_t)settings.snapshotInterval);
+    PutName(out, hostName);
+}
+
+bool ReadWelcomePacket(const uint8_t* data, size_t size, uint32_t& sessionId, PongConfig& config,
+    NetSessionSettings& settings, string& hostName) {
+    if (NetPacketTypeOf(data, size) != NET_PACKET_WELCOME) return false;
+    NetReader reader(data, size);
+    sessionId = SessionIdOf(data);
+    config.screenWidth = (int)reader.u32();
+    config.screenHeight = (int)reader.u32();
+    config.paddleSpeed = reader.f32();
+    config.ballSpeed = reader.f32();
+    config.ballRadius = reader.f32();
+    config.maxHearts = (int)reader.u32();
+    config.dt = reader.f32();
+    config.serveJitter = reader.f32();
+    config.seed = reader.u32();
+    config.continuousCollision = reader.u8() != 0;
+    settings.inputDelay = reader.u8();
+    settings.maxRollback = reader.u8();
+    settings.snapshotInterval = (int)reader.varint();
+    hostName = reader.name();
+    return reader.ok;
+}
+
+// Delta format: pairs of (zero run length, literal length) varints, each followed by the
+// literal bytes of the XOR, until the whole state is covered
+void EncodeStateDelta(const PongState& base, const PongState& state, vector<uint8_t>& out) {
+    uint8_t diff[sizeof(PongState)];
+    const uint8_t* a = (const uint8_t*)&base;
+    const uint8_t* b = (const uint8_t*)&state;
+    for (size_t i = 0; i < sizeof(PongState); i++) diff[i] = a[i] ^ b[i];
+
+    size_t i = 0;
+    while (i < sizeof(PongState)) {
+        size_t zeros = 0;
+        while (i + zeros < sizeof(PongState) && diff[i + zeros] == 0) zeros++;
+        size_t literals = 0;
+        while (i + zeros + literals < sizeof(PongState) && diff[i + zeros + literals] != 0) literals++;
+
+        PutVarint(out, (uint32_t)zeros);
+        PutVarint(out, (uint32_t)literals);
+        out.insert(out.end(), diff + i + zeros, diff + i + zeros + literals);
+        i += zeros + literals;
+    }
+}
+
+bool DecodeStateDelta(const PongState& base, const uint8_t* data, size_t size, PongState& state) {
+    uint8_t bytes[sizeof(PongState)];
+    memcpy(bytes, &base, sizeof(bytes));
+
+    // Reuse the packet reader on the delta bytes (it skips a header, so start it at 0)
+    NetReader reader(data, size);
+    reader.offset = 0;
+    reader.ok = true;
+
+    size_t i = 0;
+    while (i < sizeof(PongState) && reader.ok) {
+        size_t zeros = reader.varint();
+        size_t literals = reader.varint();
+        if (!reader.ok || i + zeros + literals > sizeof(PongState) || reader.offset + literals > size) return false;
+        i += zeros;
+        for (size_t j = 0; j < literals; j++) bytes[i++] ^= data[reader.offset++];
+    }
+    if (!reader.ok || i != sizeof(PongState)) return false;
+
+    memcpy(&state, bytes, sizeof(bytes));
+    return true;
+}
+
+NetSession::NetSession(const PongConfig& config, bool host, uint32_t sessionId, const NetSessionSettings& settings)
+    : sim_(config), host_(host), sessionId_(sessionId), settings_(settings) {
+    if (settings_.inputDelay < 0) settings_.inputDelay = 0;
+    if (settings_.inputDelay > NET_MAX_INPUT_DELAY) settings_.inputDelay = NET_MAX_INPUT_DELAY;
+    if (settings_.maxRollback < 1) settings_.maxRollback = 1;
+    if (settings_.maxRollback > NET_MAX_ROLLBACK) settings_.maxRollback = NET_MAX_ROLLBACK;
+
+    memset(states_, 0, sizeof(states_));
+    restart(config, sessionId);
+}
+
+void NetSession::restart(const PongConfig& config, uint32_t sessionId) {
+    sim_ = PongSim(config);
+    sessionId_ = sessionId;
+
+    // The first inputDelay ticks have no key presses on either side
+    tick_ = 0;
+    localEnd_ = (uint32_t)settings_.inputDelay;
+    remoteEnd_ = 0;
+    remoteAck_ = 0;
+    remoteTick_ = 0;
+    remoteAdvantage_ = 0;
+    lastStallTick_ = 0;
+    memset(localInputs_, 0, sizeof(localInputs_));
+    memset(remoteInputs_, 0, sizeof(remoteInputs_));
+    memset(predicted_, 0, sizeof(predicted_));
+
+    snapshots_.clear();
+    snapshotAck_ = 0;
+    lastSnapshotSent_ = 0;
+    snapshotPending_ = false;
+    memset(&pendingSnapshot_, 0, sizeof(pendingSnapshot_));
+    stats_ = NetSessionStats();
+}
+
+void NetSession::setLocalInput(int8_t input) {
+    // One input per tick: once the slot inputDelay ticks ahead is filled, wait for advance()
+    if (localEnd_ > tick_ + (uint32_t)settings_.inputDelay) return;
+    localInputs_[localEnd_ % RING] = input;
+    localEnd_++;
+}
+
+bool NetSession::canAdvance() const {
+    return tick_ < localEnd_ && tick_ < remoteEnd_ + (uint32_t)settings_.maxRollback;
+}
+
+int8_t NetSession::remoteInputFor(uint32_t tick) const {
+    if (tick < remoteEnd_) return remoteInputs_[tick % RING];
+    // Prediction: the remote paddle keeps doing what it did last
+    return remoteEnd_ > 0 ? remoteInputs_[(remoteEnd_ - 1) % RING] : 0;
+}
+
+PongInputs NetSession::inputsFor(uint32_t tick, int8_t remote) const {
+    int8_t local = localInputs_[tick % RING];
+    PongInputs inputs;
+    inputs.player = host_ ? local : remote;     // The host plays the right paddle
+    inputs.opponent = host_ ? remote : local;
+    return inputs;
+}
+
+void NetSession::advance() {
+    if (!canAdvance()) return;
+
+    states_[tick_ % RING] = sim_.state();
+    int8_t remote = remoteInputFor(tick_);
+    predicted_[tick_ % RING] = remote;
+    sim_.step(inputsFor(tick_, remote));
+    tick_++;
+
+    if (snapshotPending_) checkSnapshot();
+}
+
+bool NetSession::takeTimeSyncStall() {
+    // Both advantages include the one-way latency, so half their difference is how far
+    // this side really is ahead
+    int32_t localAdvantage = (int32_t)tick_ - (int32_t)remoteTick_;
+    int32_t ahead = (localAdvantage - remoteAdvantage_) / 2;
+    if (ahead < 1 || tick_ - lastStallTick_ < 10) return false;
+
+    lastStallTick_ = tick_;
+    stats_.timeSyncStalls++;
+    return true;
+}
+
+void NetSession::rollback(uint32_t fromTick) {
+    auto start = chrono::steady_clock::now();
+
+    sim_.restore(states_[fromTick % RING]);
+    for (uint32_t t = fromTick; t < tick_; t++) {
+        states_[t % RING] = sim_.state();
+        int8_t remote = remoteInputFor(t);
+        predicted_[t % RING] = remote;
+        sim_.step(inputsFor(t, remote));
+    }
+
+    uint32_t ticks = tick_ - fromTick;
+    stats_.rollbacks++;
+    stats_.resimulatedTicks += ticks;
+    if (ticks > stats_.maxRollbackTicks) stats_.maxRollbackTicks = ticks;
+    stats_.rollbackNanos += (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+
+bool NetSession::isOver() const {
+    // Game over is final, so the predicted state can't undo it once a confirmed state has it
+    PongState confirmed;
+    if (!stateAt(confirmedTick(), confirmed)) return false;
+    return confirmed.playerHearts <= 0 || confirmed.opponentHearts <= 0;
+}
+
+bool NetSession::stateAt(uint32_t tick, PongState& state) const {
+    if (tick == tick_) {
+        state = sim_.state();
+        return true;
+    }
+    if (tick > tick_ || tick_ - tick >= RING) return false;
+    state = states_[tick % RING];
+    return true;
+}
+
+void NetSession::writeInputPacket(vector<uint8_t>& out) {
+    PutHeader(out, NET_PACKET_INPUT, sessionId_);
+    PutVarint(out, tick_);
+    PutVarint(out, remoteEnd_);
+    PutVarint(out, host_ ? 0 : snapshotAck_);
+
+    int32_t advantage = (int32_t)tick_ - (int32_t)remoteTick_;
+    PutVarint(out, ((uint32_t)advantage << 1) ^ (uint32_t)(advantage >> 31));   // Zigzag, small either way
+
+    // Every input the remote side hasn't acknowledged yet, so a lost packet costs nothing
+    uint32_t first = remoteAck_;
+    uint32_t count = localEnd_ - first;
+    if (count > 255) count = 255;
+    PutVarint(out, first);
+    Put8(out, (uint8_t)count);
+    for (uint32_t i = 0; i < count; i += 4) {
+        uint8_t packed = 0;
+        for (uint32_t j = 0; j < 4 && i + j < count; j++) {
+            int8_t input = localInputs_[(first + i + j) % RING];
+            packed |= (uint8_t)((input > 0 ? 1 : (input < 0 ? 2 : 0)) << (2 * j));
+        }
+        Put8(out, packed);
+    }
+
+    stats_.packetsSent++;
+    stats_.bytesSent += out.size();
+}
+
+bool NetSession::writeSnapshotPacket(vector<uint8_t>& out) {
+    if (!host_ || settings_.snapshotInterval <= 0) return false;
+
+    uint32_t interval = (uint32_t)settings_.snapshotInterval;
+    uint32_t snapshotTick = confirmedTick() / interval * interval;
+    PongState state;
+    if (snapshotTick == 0 || snapshotTick <= lastSnapshotSent_ || !stateAt(snapshotTick, state)) return false;
+
+    // Delta against the newest snapshot the client has confirmed, or against zeros
+    PongState base;
+    memset(&base, 0, sizeof(base));
+    uint32_t baseTick = 0;
+    for (const Snapshot& snapshot : snapshots_) {
+        if (snapshot.tick == snapshotAck_) {
+            base = snapshot.state;
+            baseTick = snapshot.tick;
+        }
+    }
+
+    PutHeader(out, NET_PACKET_SNAPSHOT, sessionId_);
+    PutVarint(out, snapshotTick);
+    PutVarint(out, baseTick);
+    EncodeStateDelta(base, state, out);
+
+    // Keep what was sent until the client acknowledges something newer
+    Snapshot sent = { snapshotTick, state };
+    snapshots_.push_back(sent);
+    for (size_t i = 0; i < snapshots_.size();) {
+        if (snapshots_[i].tick < snapshotAck_ || snapshots_.size() > 16) snapshots_.erase(snapshots_.begin() + i);
+        else i++;
+    }
+
+    lastSnapshotSent_ = snapshotTick;
+    stats_.snapshotsSent++;
+    stats_.snapshotBytes += out.size();
+    stats_.packetsSent++;
+    stats_.bytesSent += out.size();
+    return true;
+}
+
+void NetSession::checkSnapshot() {
+    uint32_t snapshotTick = pendingSnapshot_.tick;
+    if (snapshotTick > tick_ || snapshotTick > remoteEnd_) return;   // Not confirmed here yet
+
+    snapshotPending_ = false;
+    PongState local;
+    if (!stateAt(snapshotTick, local)) return;  // Too old to compare
+    if (memcmp(&local, &pendingSnapshot_.state, sizeof(local)) == 0) return;
+
+    // Desync: take the host's state and re-simulate everything after it
+    stats_.desyncs++;
+    if (snapshotTick == tick_) {
+        sim_.restore(pendingSnapshot_.state);
+    }
+    else {
+        states_[snapshotTick % RING] = pendingSnapshot_.state;
+        rollback(snapshotTick);
+    }
+}
+
+void NetSession::receive(const uint8_t* data, size_t size) {
+    int type = NetPacketTypeOf(data, size);
+    if ((type != NET_PACKET_INPUT && type != NET_PACKET_SNAPSHOT) || SessionIdOf(data) != sessionId_) return;
+
+    stats_.packetsReceived++;
+    stats_.bytesReceived += size;
+    NetReader reader(data, size);
+
+    if (type == NET_PACKET_SNAPSHOT) {
+        if (host_) return;
+        uint32_t snapshotTick = reader.varint();
+        uint32_t baseTick = reader.varint();
+        if (!reader.ok || snapshotTick <= snapshotAck_) return;     // Old or duplicate
+
+        PongState base;
+        memset(&base, 0, sizeof(base));
+        if (baseTick != 0) {
+            bool found = false;
+            for (const Snapshot& snapshot : snapshots_) {
+                if (snapshot.tick == baseTick) {
+                    base = snapshot.state;
+                    found = true;
+                }
+            }
+            if (!found) return;
+        }
+
+        Snapshot received;
+        received.tick = snapshotTick;
+        if (!DecodeStateDelta(base, data + reader.offset, size - reader.offset, received.state)) return;
+
+        snapshots_.push_back(received);
+        if (snapshots_.size() > 8) snapshots_.erase(snapshots_.begin());
+        snapshotAck_ = snapshotTick;
+        pendingSnapshot_ = received;
+        snapshotPending_ = true;
+        checkSnapshot();
+        return;
+    }
+
+    uint32_t senderTick = reader.varint();
+    uint32_t ack = reader.varint();
+    uint32_t snapshotAck = reader.varint();
+    uint32_t zigzag = reader.varint();
+    uint32_t first = reader.varint();
+    uint32_t count = reader.u8();
+    if (!reader.ok || reader.offset + (count + 3) / 4 > size) return;
+
+    if (senderTick >= remoteTick_) {
+        remoteTick_ = senderTick;
+        remoteAdvantage_ = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    }
+    if (ack > remoteAck_ && ack <= localEnd_) remoteAck_ = ack;
+    if (host_ && snapshotAck > snapshotAck_ && snapshotAck <= lastSnapshotSent_) snapshotAck_ = snapshotAck;
+
+    // Take the inputs that extend what we know; the first one that differs from what was
+    // predicted is where the simulation has to go back to
+    static const int8_t moves[4] = { 0, 1, -1, 0 };
+    uint32_t rollbackFrom = UINT32_MAX;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t t = first + i;
+        if (t < remoteEnd_) continue;
+        if (t > remoteEnd_ || t >= tick_ + RING / 2) break;   // Gap, or too far ahead for the ring
+
+        int8_t input = moves[(data[reader.offset + i / 4] >> (2 * (i % 4))) & 3];
+        remoteInputs_[t % RING] = input;
+        if (t < tick_ && input != predicted_[t % RING] && rollbackFrom == UINT32_MAX) rollbackFrom = t;
+        remoteEnd_++;
+    }
+
+    if (rollbackFrom != UINT32_MAX) rollback(rollbackFrom);
+    if (snapshotPending_) checkSnapshot();
+}
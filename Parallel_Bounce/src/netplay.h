@@ -0,0 +1,144 @@
+#pragma once
+
+#include "pong_sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Two-machine play over UDP with rollback. Both peers run the same deterministic PongSim and
+// exchange only paddle inputs. Each side simulates ahead using a prediction of the remote
+// paddle (its last known input); when the real input arrives and differs, the session goes
+// back to the saved state of that tick and re-simulates, so the local paddle never waits for
+// the network. The host (right paddle) also sends a snapshot of a confirmed state every
+// snapshotInterval ticks, delta-compressed against the last one the client acknowledged,
+// which the client uses to detect and repair a desync.
+//
+// The session only builds and parses packets; the caller moves them (UdpSocket in the game,
+// NetImpairment in bench_netplay).
+
+const uint16_t NET_MAGIC = 0x4250;              // "PB"
+const uint8_t NET_PROTOCOL_VERSION = 1;
+const uint16_t NET_DEFAULT_PORT = 7777;
+const size_t NET_MAX_PACKET = 512;
+const int NET_MAX_ROLLBACK = 60;                // One second at 60 ticks per second
+
+enum NetPacketType : uint8_t {
+    NET_PACKET_HELLO = 1,       // Client -> host: join request with the player name
+    NET_PACKET_WELCOME = 2,     // Host -> client: session id, config and host name
+    NET_PACKET_INPUT = 3,       // Both ways: unacknowledged inputs, acks and time sync
+    NET_PACKET_SNAPSHOT = 4     // Host -> client: delta-compressed confirmed state
+};
+
+struct NetSessionSettings {
+    int inputDelay = 1;         // Ticks between reading a key and applying it (hides some latency)
+    int maxRollback = 12;       // How far the simulation may run ahead of the remote inputs
+    int snapshotInterval = 60;  // Ticks between host snapshots (0 = none)
+};
+
+struct NetSessionStats {
+    uint64_t packetsSent = 0;
+    uint64_t packetsReceived = 0;
+    uint64_t bytesSent = 0;             // UDP payload only
+    uint64_t bytesReceived = 0;
+    uint64_t snapshotsSent = 0;
+    uint64_t snapshotBytes = 0;
+    uint64_t rollbacks = 0;             // Mispredictions that needed a re-simulation
+    uint64_t resimulatedTicks = 0;
+    uint32_t maxRollbackTicks = 0;
+    uint64_t rollbackNanos = 0;         // Time spent restoring and re-simulating
+    uint64_t timeSyncStalls = 0;        // Ticks skipped because this side ran ahead
+    uint64_t desyncs = 0;               // Snapshots that didn't match the client state (repaired)
+};
+
+// Function to read the packet type (or -1 if the packet isn't ours)
+int NetPacketTypeOf(const uint8_t* data, size_t size);
+
+void WriteHelloPacket(const std::string& playerName, std::vector<uint8_t>& out);
+bool ReadHelloPacket(const uint8_t* data, size_t size, std::string& playerName);
+void WriteWelcomePacket(uint32_t sessionId, const PongConfig& config, const NetSessionSettings& settings,
+    const std::string& hostName, std::vector<uint8_t>& out);
+bool ReadWelcomePacket(const uint8_t* data, size_t size, uint32_t& sessionId, PongConfig& config,
+    NetSessionSettings& settings, std::string& hostName);
+
+// Function to delta-encode a state against base: XOR of the bytes, zero runs skipped
+void EncodeStateDelta(const PongState& base, const PongState& state, std::vector<uint8_t>& out);
+bool DecodeStateDelta(const PongState& base, const uint8_t* data, size_t size, PongState& state);
+
+class NetSession {
+public:
+    NetSession(const PongConfig& config, bool host, uint32_t sessionId, const NetSessionSettings& settings = NetSessionSettings());
+
+    // Function to start a new match in this session, keeping its buffers (pools of sessions
+    // in the match server reuse one object per slot)
+    void restart(const PongConfig& config, uint32_t sessionId);
+
+    // Function to set this side's input for the next tick (it applies inputDelay ticks later)
+    void setLocalInput(int8_t input);
+    // True if the next tick can be simulated without running too far ahead of the remote side
+    bool canAdvance() const;
+    void advance();
+
+    // Function to ask whether to skip a tick to let the remote side catch up (time sync).
+    // Returns true at most once every 10 ticks.
+    bool takeTimeSyncStall();
+
+    // Function to handle an INPUT or SNAPSHOT packet from the remote side
+    void receive(const uint8_t* data, size_t size);
+    // Function to build this tick's INPUT packet
+    void writeInputPacket(std::vector<uint8_t>& out);
+    // Function to build a SNAPSHOT packet if one is due (host only). Returns false if none is.
+    bool writeSnapshotPacket(std::vector<uint8_t>& out);
+
+    const PongState& state() const { return sim_.state(); }
+    const PongConfig& config() const { return sim_.config(); }
+    bool isHost() const { return host_; }
+    uint32_t tick() const { return tick_; }
+    // Ticks whose inputs from both sides are known
+    uint32_t confirmedTick() const { return remoteEnd_ < tick_ ? remoteEnd_ : tick_; }
+    // The match is over in a state both sides agree on (the confirmed state)
+    bool isOver() const;
+    bool playerWon() const { return sim_.playerWon(); }
+    const NetSessionStats& stats() const { return stats_; }
+
+private:
+    static const uint32_t RING = 256;
+
+    PongInputs inputsFor(uint32_t tick, int8_t remote) const;
+    int8_t remoteInputFor(uint32_t tick) const;
+    void rollback(uint32_t fromTick);
+    void checkSnapshot();
+    bool stateAt(uint32_t tick, PongState& state) const;
+
+    PongSim sim_;
+    bool host_;
+    uint32_t sessionId_;
+    NetSessionSettings settings_;
+
+    uint32_t tick_ = 0;             // Next tick to simulate
+    uint32_t localEnd_ = 0;         // Local inputs are known for ticks < localEnd_
+    uint32_t remoteEnd_ = 0;        // Remote inputs are known for ticks < remoteEnd_
+    uint32_t remoteAck_ = 0;        // The remote side has our inputs for ticks < remoteAck_
+    uint32_t remoteTick_ = 0;       // Newest tick the remote side reported
+    int32_t remoteAdvantage_ = 0;   // How far the remote side thinks it is ahead of us
+    uint32_t lastStallTick_ = 0;
+
+    int8_t localInputs_[RING] = {};
+    int8_t remoteInputs_[RING] = {};
+    int8_t predicted_[RING] = {};   // Remote input used when the tick was simulated
+    PongState states_[RING];        // State before each tick
+
+    // Snapshots: the host remembers what it sent, the client what it received
+    struct Snapshot {
+        uint32_t tick;
+        PongState state;
+    };
+    std::vector<Snapshot> snapshots_;
+    uint32_t snapshotAck_ = 0;      // Host: newest snapshot tick the client has. Client: newest received.
+    uint32_t lastSnapshotSent_ = 0;
+    bool snapshotPending_ = false;  // Client: received snapshot not yet compared
+    Snapshot pendingSnapshot_;
+
+    NetSessionStats stats_;
+};
@@ -0,0 +1,38 @@
+#include "particle_draw.h"
+
+#include "quad_batch.h"
+
+using namespace std;
+
+static uint64_t particleSubmissions = 0;
+
+void DrawParticles(const ParticlePool& pool) {
+    const size_t count = pool.size();
+    if (count == 0) return;
+    const float* x = pool.x();
+    const float* y = pool.y();
+    const float* sizes = pool.sizes();
+    const float* life = pool.life();
+    const float* invMaxLife = pool.invMaxLife();
+    const ParticleColor* colors = pool.colors();
+
+    // The default texture is one white pixel, so the whole 0..1 range samples white
+    particleSubmissions += SubmitQuads(rlGetTextureIdDefault(), count, [&](size_t i, BatchQuad& q) {
+        float left = life[i] * invMaxLife[i];  // 1 at birth, 0 when it dies
+        float half = sizes[i] * left * 0.5f + 0.5f;
+        const ParticleColor& c = colors[i];
+        q.x0 = x[i] - half;
+        q.y0 = y[i] - half;
+        q.x1 = x[i] + half;
+        q.y1 = y[i] + half;
+        q.u0 = 0.0f;
+        q.v0 = 0.0f;
+        q.u1 = 1.0f;
+        q.v1 = 1.0f;
+        q.color = { c.r, c.g, c.b, (unsigned char)(c.a * left) };
+    });
+}
+
+uint64_t ParticleSubmissionCount() {
+    return particleSubmissions;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "particles.h"
+
+// Function to draw every live particle of pool as a square that shrinks and fades out over
+// its life (between BeginDrawing and EndDrawing). All of them go through rlgl's vertex batch
+// with the default white texture, a few thousand quads per submission, so 100k particles are
+// a few dozen draw calls and no per-particle state changes.
+void DrawParticles(const ParticlePool& pool);
+
+// Draw calls submitted by DrawParticles since the start
+uint64_t ParticleSubmissionCount();
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Particle effects (ball trail, hit sparks, the burst when a heart is lost). A fixed number
+// of particles is allocated up front and stored as structure-of-arrays, so the update is a
+// few straight loops over float arrays the compiler turns into SIMD code, and a full pool
+// drops new particles instead of allocating. No raylib; particle_draw.h draws a pool.
+
+// Color of a particle, 0-255 per channel like raylib's Color
+struct ParticleColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+// A burst of particles thrown out from one point
+struct ParticleBurst {
+    float x = 0.0f;
+    float y = 0.0f;
+    int count = 16;
+    float angle = 0.0f;             // Center direction in radians (0 = right, pi/2 = down)
+    float spread = 6.2831853f;      // Full width of the cone in radians (2 pi = all around)
+    float minSpeed = 60.0f;         // Pixels per second
+    float maxSpeed = 240.0f;
+    float minLife = 0.3f;           // Seconds
+    float maxLife = 0.7f;
+    float size = 3.0f;              // Pixels, shrinks to nothing over the particle's life
+    ParticleColor color = { 255, 255, 255, 255 };
+};
+
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity, uint32_t seed = 1);
+
+    // Function to add a burst; particles that don't fit are dropped (and counted). Returns
+    // how many were added.
+    int emit(const ParticleBurst& burst);
+
+    // Function to advance every particle by dt seconds and remove the ones that died.
+    // gravity pulls down in pixels/s^2, drag slows them by that fraction per second.
+    void update(float dt, float gravity = 0.0f, float drag = 0.0f);
+
+    void clear() { count_ = 0; }
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return x_.size(); }
+    uint64_t dropped() const { return dropped_; }
+
+    // Live particles are [0, size()); the arrays are capacity() long
+    const float* x() const { return x_.data(); }
+    const float* y() const { return y_.data(); }
+    const float* sizes() const { return sizes_.data(); }
+    const float* life() const { return life_.data(); }          // Seconds left
+    const float* invMaxLife() const { return invMaxLife_.data(); }  // 1 / seconds at birth
+    const ParticleColor* colors() const { return colors_.data(); }
+
+private:
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> vx_;
+    std::vector<float> vy_;
+    std::vector<float> life_;
+    std::vector<float> invMaxLife_;
+    std::vector<float> sizes_;
+    std::vector<ParticleColor> colors_;
+    size_t count_ = 0;
+    uint64_t dropped_ = 0;
+    uint32_t rng_;          // xorshift.h
+};
@@ -0,0 +1,223 @@
+#include "player_stats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// player_stats.bin: header, then one fixed size entry per player
+struct StatsFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    uint32_t playerCount;
+    uint32_t reserved;
+    uint64_t recordsApplied;
+    uint64_t lastRecordHash;        // Hash of the last applied record, to notice a replaced result file
+};
+
+struct StatsFileEntry {
+    int64_t lastPlayed;
+    char name[RESULT_NAME_SIZE];
+    uint8_t nameLength;
+    uint8_t reserved[3];
+    int32_t streak;
+    uint32_t wins;
+    uint32_t losses;
+    uint32_t bestStreak;
+    uint32_t modeWins[RESULT_MODE_COUNT];
+    uint32_t modeLosses[RESULT_MODE_COUNT];
+    uint32_t padding;
+};
+
+static_assert(sizeof(StatsFileHeader) == 32, "header layout is part of the file format");
+static_assert(sizeof(StatsFileEntry) == 104, "entry layout is part of the file format");
+
+// Function to hash a whole record (FNV-1a)
+static uint64_t HashRecord(const ResultRecord& record) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < sizeof(record); i++) hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+uint32_t PlayerStatsIndex::playerId(const char* name, uint8_t length) {
+    lookup_.assign(name, length);
+    auto found = ids_.find(lookup_);
+    if (found != ids_.end()) return found->second;
+
+    uint32_t id = (uint32_t)players_.size();
+    players_.emplace_back();
+    players_.back().name = lookup_;
+    ids_.emplace(lookup_, id);
+    if (rankingLive_) ranking_.insert({ 0, 0, id });
+    return id;
+}
+
+void PlayerStatsIndex::record(uint32_t id, bool won, uint8_t mode, int64_t timestamp) {
+    PlayerStats& player = players_[id];
+
+    // Move the player to its new place in the ranking
+    if (rankingLive_) ranking_.erase({ player.wins, player.losses, id });
+    if (won) {
+        player.wins++;
+        player.streak = player.streak > 0 ? player.streak + 1 : 1;
+        if ((uint32_t)player.streak > player.bestStreak) player.bestStreak = (uint32_t)player.streak;
+        if (mode < RESULT_MODE_COUNT) player.modeWins[mode]++;
+    }
+    else {
+        player.losses++;
+        player.streak = player.streak < 0 ? player.streak - 1 : -1;
+        if (mode < RESULT_MODE_COUNT) player.modeLosses[mode]++;
+    }
+    if (rankingLive_) ranking_.insert({ player.wins, player.losses, id });
+
+    if (timestamp > player.lastPlayed) player.lastPlayed = timestamp;
+}
+
+void PlayerStatsIndex::apply(const ResultRecord& result) {
+    applyRecord(result);
+}
+
+void PlayerStatsIndex::applyRecord(const ResultRecord& result) {
+    recordsApplied_++;
+    lastRecord_ = result;
+    if (result.winnerLength == 0) return;
+
+    record(playerId(result.winner, result.winnerLength), true, result.mode, result.timestamp);
+    if (result.loserLength > 0) {
+        record(playerId(result.loser, result.loserLength), false, result.mode, result.timestamp);
+    }
+}
+
+void PlayerStatsIndex::apply(const ResultRecord* records, size_t count) {
+    // Keeping the ranking sorted costs more than the rest of an update; for large batches
+    // sort it once afterwards instead
+    if (count < 1024) {
+        for (size_t i = 0; i < count; i++) applyRecord(records[i]);
+        return;
+    }
+    rankingLive_ = false;
+    for (size_t i = 0; i < count; i++) applyRecord(records[i]);
+    rankingLive_ = true;
+    rebuildRanking();
+}
+
+void PlayerStatsIndex::rebuildRanking() {
+    vector<RankKey> keys(players_.size());
+    for (size_t i = 0; i < players_.size(); i++) keys[i] = { players_[i].wins, players_[i].losses, (uint32_t)i };
+    sort(keys.begin(), keys.end());
+    ranking_.clear();
+    ranking_.insert(keys.begin(), keys.end());  // Sorted input makes this linear
+}
+
+void PlayerStatsIndex::clear() {
+    players_.clear();
+    ids_.clear();
+    ranking_.clear();
+    recordsApplied_ = 0;
+}
+
+void PlayerStatsIndex::top(size_t count, vector<const PlayerStats*>& out) const {
+    out.clear();
+    for (auto it = ranking_.begin(); it != ranking_.end() && out.size() < count; ++it) {
+        out.push_back(&players_[it->id]);
+    }
+}
+
+const PlayerStats* PlayerStatsIndex::find(const string& name) const {
+    auto found = ids_.find(name);
+    return found != ids_.end() ? &players_[found->second] : nullptr;
+}
+
+bool PlayerStatsIndex::save(const char* path) const {
+    StatsFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PLAYER_STATS_MAGIC;
+    header.version = PLAYER_STATS_VERSION;
+    header.entrySize = sizeof(StatsFileEntry);
+    header.playerCount = (uint32_t)players_.size();
+    header.recordsApplied = recordsApplied_;
+    header.lastRecordHash = recordsApplied_ > 0 ? HashRecord(lastRecord_) : 0;
+
+    vector<StatsFileEntry> entries(players_.size());
+    for (size_t i = 0; i < players_.size(); i++) {
+        const PlayerStats& player = players_[i];
+        StatsFileEntry& entry = entries[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.lastPlayed = player.lastPlayed;
+        entry.nameLength = (uint8_t)(player.name.size() < (size_t)RESULT_NAME_SIZE ? player.name.size() : RESULT_NAME_SIZE);
+        memcpy(entry.name, player.name.data(), entry.nameLength);
+        entry.streak = player.streak;
+        entry.wins = player.wins;
+        entry.losses = player.losses;
+        entry.bestStreak = player.bestStreak;
+        memcpy(entry.modeWins, player.modeWins, sizeof(entry.modeWins));
+        memcpy(entry.modeLosses, player.modeLosses, sizeof(entry.modeLosses));
+    }
+
+    // Write a temporary file and swap it in, so a crash never leaves half an index behind
+    string tempPath = string(path) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (entries.empty() || fwrite(entries.data(), sizeof(StatsFileEntry), entries.size(), file) == entries.size());
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    remove(path);   // rename() doesn't replace an existing file on Windows
+    return rename(tempPath.c_str(), path) == 0;
+}
+
+bool PlayerStatsIndex::load(const char* indexPath, const char* resultPath) {
+    clear();
+
+    ResultReader results;
+    bool haveResults = results.open(resultPath);
+    size_t resultCount = haveResults ? results.count() : 0;
+
+    // Take the saved index only if the result file still holds every record it has seen
+    bool haveIndex = false;
+    MappedFile file;
+    if (file.open(indexPath) && file.size() >= sizeof(StatsFileHeader)) {
+        const StatsFileHeader* header = (const StatsFileHeader*)file.data();
+        const StatsFileEntry* entries = (const StatsFileEntry*)(file.data() + sizeof(StatsFileHeader));
+        bool valid = header->magic == PLAYER_STATS_MAGIC && header->version == PLAYER_STATS_VERSION &&
+            header->entrySize == sizeof(StatsFileEntry) &&
+            file.size() >= sizeof(StatsFileHeader) + (size_t)header->playerCount * sizeof(StatsFileEntry) &&
+            header->recordsApplied <= resultCount &&
+            (header->recordsApplied == 0 || HashRecord(results[header->recordsApplied - 1]) == header->lastRecordHash);
+
+        if (valid) {
+            players_.resize(header->playerCount);
+            ids_.reserve(header->playerCount);
+            for (uint32_t i = 0; i < header->playerCount; i++) {
+                const StatsFileEntry& entry = entries[i];
+                PlayerStats& player = players_[i];
+                player.name.assign(entry.name, entry.nameLength < RESULT_NAME_SIZE ? entry.nameLength : RESULT_NAME_SIZE);
+                player.wins = entry.wins;
+                player.losses = entry.losses;
+                player.streak = entry.streak;
+                player.bestStreak = entry.bestStreak;
+                memcpy(player.modeWins, entry.modeWins, sizeof(player.modeWins));
+                memcpy(player.modeLosses, entry.modeLosses, sizeof(player.modeLosses));
+                player.lastPlayed = entry.lastPlayed;
+                ids_.emplace(player.name, i);
+            }
+            recordsApplied_ = header->recordsApplied;
+            if (recordsApplied_ > 0) lastRecord_ = results[recordsApplied_ - 1];
+            rebuildRanking();
+            haveIndex = true;
+        }
+    }
+    file.close();
+
+    // Catch up on the records logged since the index was saved
+    if (haveResults && recordsApplied_ < resultCount) {
+        apply(results.records() + recordsApplied_, resultCount - (size_t)recordsApplied_);
+    }
+    return haveResults || haveIndex;
+}
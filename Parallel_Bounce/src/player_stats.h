@@ -0,0 +1,77 @@
+#pragma once
+
+#include "result_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-player statistics over the match history, kept up to date as results are logged and
+// saved to player_stats.bin so startup only has to apply the records logged since.
+
+const uint32_t PLAYER_STATS_MAGIC = 0x53504250; // "PBPS" in little endian
+const uint16_t PLAYER_STATS_VERSION = 1;
+
+struct PlayerStats {
+    std::string name;
+    uint32_t wins = 0;
+    uint32_t losses = 0;
+    int32_t streak = 0;             // > 0: current win streak, < 0: current losing streak
+    uint32_t bestStreak = 0;        // Longest win streak
+    uint32_t modeWins[RESULT_MODE_COUNT] = {};
+    uint32_t modeLosses[RESULT_MODE_COUNT] = {};
+    int64_t lastPlayed = 0;         // Unix time of the last match
+
+    uint32_t matches() const { return wins + losses; }
+};
+
+class PlayerStatsIndex {
+public:
+    // Function to update the players of one match. Records without a loser (converted from
+    // the text log) only count the win.
+    void apply(const ResultRecord& record);
+    void apply(const ResultRecord* records, size_t count);
+
+    // Function to load the saved index and apply the records of the result file it hasn't
+    // seen yet. Rebuilds from scratch if the saved index is missing or doesn't match the file.
+    // Returns false only if neither file can be read.
+    bool load(const char* indexPath, const char* resultPath);
+    bool save(const char* path) const;
+    void clear();
+
+    // Function to copy the best count players (most wins, then fewest losses) into out
+    void top(size_t count, std::vector<const PlayerStats*>& out) const;
+    const PlayerStats* find(const std::string& name) const;
+
+    size_t playerCount() const { return players_.size(); }
+    // Number of result records applied so far, i.e. the result file position the index is at
+    uint64_t recordsApplied() const { return recordsApplied_; }
+
+private:
+    struct RankKey {
+        uint32_t wins;
+        uint32_t losses;
+        uint32_t id;
+        bool operator<(const RankKey& other) const {
+            if (wins != other.wins) return wins > other.wins;
+            if (losses != other.losses) return losses < other.losses;
+            return id < other.id;
+        }
+    };
+
+    uint32_t playerId(const char* name, uint8_t length);
+    void record(uint32_t id, bool won, uint8_t mode, int64_t timestamp);
+    void applyRecord(const ResultRecord& record);
+    void rebuildRanking();
+
+    std::vector<PlayerStats> players_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::set<RankKey> ranking_;
+    uint64_t recordsApplied_ = 0;
+    bool rankingLive_ = true;       // Bulk applies skip the ranking and rebuild it once at the end
+    ResultRecord lastRecord_;       // Saved as a hash, to notice a replaced result file
+    std::string lookup_;            // Reused for name lookups so apply() doesn't allocate
+};
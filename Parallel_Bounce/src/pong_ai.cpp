@@ -0,0 +1,171 @@
+#include "pong_ai.h"
+#include "xorshift.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+AiSettings AiSettingsFor(AiDifficulty difficulty) {
+    switch (difficulty) {
+    case AI_EASY:
+        return { 110.0f, 16, 12.0f, false, 0.0f };
+    case AI_HARD:
+        return { 35.0f, 3, 4.0f, true, 0.0f };
+    case AI_NORMAL:
+    default:
+        return { 85.0f, 8, 8.0f, false, 0.0f };
+    }
+}
+
+const char* AiDifficultyName(AiDifficulty difficulty) {
+    switch (difficulty) {
+    case AI_EASY: return "easy";
+    case AI_NORMAL: return "normal";
+    case AI_HARD: return "hard";
+    }
+    return "unknown";
+}
+
+bool ParseAiDifficulty(const char* name, AiDifficulty& difficulty) {
+    const AiDifficulty all[] = { AI_EASY, AI_NORMAL, AI_HARD };
+    for (AiDifficulty candidate : all) {
+        if (strcmp(name, AiDifficultyName(candidate)) == 0) {
+            difficulty = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PredictBallY(SimVec2 position, SimVec2 velocity, float targetX, float screenHeight,
+    float& y, float& time, float* arrivalVy) {
+    float dx = targetX - position.x;
+    if (velocity.x == 0.0f || dx * velocity.x < 0.0f) return false;
+
+    time = dx / velocity.x;
+
+    // The ball's center bounces between y = 0 and y = screenHeight, so its path is the
+    // straight line folded into that band: period 2 * screenHeight
+    float period = 2.0f * screenHeight;
+    float unfolded = fmodf(position.y + velocity.y * time, period);
+    if (unfolded < 0.0f) unfolded += period;
+    bool mirrored = unfolded > screenHeight; // Odd number of wall bounces on the way
+    y = mirrored ? period - unfolded : unfolded;
+    if (arrivalVy) *arrivalVy = mirrored ? -velocity.y : velocity.y;
+    return true;
+}
+
+PongAI::PongAI(AiDifficulty difficulty, bool controlsPlayer, uint32_t seed)
+    : PongAI(AiSettingsFor(difficulty), controlsPlayer, seed) {
+}
+
+PongAI::PongAI(const AiSettings& settings, bool controlsPlayer, uint32_t seed)
+    : settings_(settings), controlsPlayer_(controlsPlayer), rng_(XorShiftSeed(seed)),
+      lastVelocity_{ 0.0f, 0.0f }, targetY_(0.0f), pendingTargetY_(0.0f),
+      hasTarget_(false), hasPendingTarget_(false), waitTicks_(0), cheapPlans_(0) {
+}
+
+PongAI::PongAI(const PongAIState& state) {
+    restore(state);
+}
+
+PongAIState PongAI::save() const {
+    PongAIState state;
+    memset(&state, 0, sizeof(state));   // Padding too, so saved bytes are reproducible
+    state.settings = settings_;
+    state.controlsPlayer = controlsPlayer_ ? 1 : 0;
+    state.hasTarget = hasTarget_ ? 1 : 0;
+    state.hasPendingTarget = hasPendingTarget_ ? 1 : 0;
+    state.rng = rng_;
+    state.lastVelocity = lastVelocity_;
+    state.targetY = targetY_;
+    state.pendingTargetY = pendingTargetY_;
+    state.waitTicks = waitTicks_;
+    state.cheapPlans = cheapPlans_;
+    return state;
+}
+
+void PongAI::restore(const PongAIState& state) {
+    settings_ = state.settings;
+    controlsPlayer_ = state.controlsPlayer != 0;
+    hasTarget_ = state.hasTarget != 0;
+    hasPendingTarget_ = state.hasPendingTarget != 0;
+    rng_ = state.rng;
+    lastVelocity_ = state.lastVelocity;
+    targetY_ = state.targetY;
+    pendingTargetY_ = state.pendingTargetY;
+    waitTicks_ = state.waitTicks;
+    cheapPlans_ = state.cheapPlans;
+}
+
+// Function to get a uniform random number in [-1, 1) from the xorshift32 state
+float PongAI::nextError() {
+    return XorShiftUnit(rng_) * 2.0f - 1.0f;
+}
+
+void PongAI::plan(const PongState& state, const PongConfig& config) {
+    const bool timed = settings_.budgetMicros > 0.0f;
+    chrono::steady_clock::time_point start;
+    if (timed) start = chrono::steady_clock::now();
+
+    const SimRect& paddle = controlsPlayer_ ? state.playerPaddle : state.opponentPaddle;
+    const SimRect& other = controlsPlayer_ ? state.opponentPaddle : state.playerPaddle;
+    const float radius = config.ballRadius;
+    const float screenHeight = (float)config.screenHeight;
+
+    // Where the ball's center is when it touches each paddle's face
+    const float faceX = controlsPlayer_ ? paddle.x - radius : paddle.x + paddle.width + radius;
+    const float otherFaceX = controlsPlayer_ ? other.x + other.width + radius : other.x - radius;
+
+    float y, time, arrivalVy;
+    float target = screenHeight / 2.0f;
+    if (PredictBallY(state.ballPosition, state.ballSpeedVector, faceX, screenHeight, y, time)) {
+        target = y + nextError() * settings_.aimError;
+    }
+    else if (settings_.anticipate && cheapPlans_ == 0 &&
+        PredictBallY(state.ballPosition, state.ballSpeedVector, otherFaceX, screenHeight, y, time, &arrivalVy)) {
+        // Assume the other paddle returns it: flip vx at its face and predict the way back
+        SimVec2 bounce = { otherFaceX, y };
+        SimVec2 returning = { -state.ballSpeedVector.x, arrivalVy };
+        if (PredictBallY(bounce, returning, faceX, screenHeight, y, time)) target = y + nextError() * settings_.aimError;
+    }
+
+    if (cheapPlans_ > 0) cheapPlans_--;
+    pendingTargetY_ = target;
+    hasPendingTarget_ = true;
+    waitTicks_ = settings_.reactionTicks;
+    plans++;
+
+    if (timed) {
+        uint64_t nanos = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        if (nanos > maxPlanNanos) maxPlanNanos = nanos;
+        if (nanos > (uint64_t)(settings_.budgetMicros * 1000.0f)) {
+            overBudget++;
+            cheapPlans_ = 8; // Skip the look-ahead for the next few plans
+        }
+    }
+}
+
+int8_t PongAI::decide(const PongState& state, const PongConfig& config) {
+    const SimVec2 velocity = state.ballSpeedVector;
+    if (velocity.x != lastVelocity_.x || velocity.y != lastVelocity_.y) {
+        lastVelocity_ = velocity;
+        plan(state, config);
+    }
+
+    // React to the newest plan only after the reaction delay
+    if (waitTicks_ > 0) waitTicks_--;
+    else if (hasPendingTarget_) {
+        targetY_ = pendingTargetY_;
+        hasTarget_ = true;
+    }
+    if (!hasTarget_) return 0;
+
+    const SimRect& paddle = controlsPlayer_ ? state.playerPaddle : state.opponentPaddle;
+    float center = paddle.y + paddle.height / 2.0f;
+    if (center < targetY_ - settings_.deadZone) return 1;
+    if (center > targetY_ + settings_.deadZone) return -1;
+    return 0;
+}
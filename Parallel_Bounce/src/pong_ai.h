@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pong_sim.h"
+
+#include <cstdint>
+
+enum AiDifficulty {
+    AI_EASY,
+    AI_NORMAL,
+    AI_HARD
+};
+
+// Tuning of the predictive AI
+struct AiSettings {
+    float aimError;         // Max random error of the planned intercept in px (paddle half height is 60)
+    int reactionTicks;      // Ticks between seeing a bounce and acting on the new plan
+    float deadZone;         // Stop when the paddle center is this close to the target, in px
+    bool anticipate;        // While the ball moves away, predict its return instead of centering
+    float budgetMicros;     // Planning time allowed per decision; 0 = don't measure
+};
+
+AiSettings AiSettingsFor(AiDifficulty difficulty);
+const char* AiDifficultyName(AiDifficulty difficulty);
+bool ParseAiDifficulty(const char* name, AiDifficulty& difficulty);
+
+// Function to predict where the ball center crosses x = targetX, unfolding bounces off the top
+// and bottom walls. arrivalVy (optional) receives the vertical velocity at that point.
+// Returns false if the ball is not moving towards targetX.
+bool PredictBallY(SimVec2 position, SimVec2 velocity, float targetX, float screenHeight,
+    float& y, float& time, float* arrivalVy = nullptr);
+
+// Everything a PongAI remembers between ticks, as plain data (see match_snapshot.h)
+struct PongAIState {
+    AiSettings settings;
+    uint8_t controlsPlayer;
+    uint8_t hasTarget;
+    uint8_t hasPendingTarget;
+    uint32_t rng;
+    SimVec2 lastVelocity;
+    float targetY;
+    float pendingTargetY;
+    int32_t waitTicks;
+    int32_t cheapPlans;
+};
+
+// AI that plans an intercept once per ball bounce and then only steers the paddle towards it
+class PongAI {
+public:
+    // controlsPlayer picks the right (player) paddle instead of the left (opponent) one
+    PongAI(AiDifficulty difficulty, bool controlsPlayer, uint32_t seed);
+    PongAI(const AiSettings& settings, bool controlsPlayer, uint32_t seed);
+    explicit PongAI(const PongAIState& state);
+
+    // Function to copy out what the AI remembers, to continue it later with restore() or the
+    // PongAIState constructor. The counters below are not part of it.
+    PongAIState save() const;
+    void restore(const PongAIState& state);
+
+    // Function to pick this tick's paddle move. Replans only when the ball's velocity changed.
+    int8_t decide(const PongState& state, const PongConfig& config);
+
+    // Function to plan a new target from the current ball (decide calls this after each bounce)
+    void plan(const PongState& state, const PongConfig& config);
+
+    const AiSettings& settings() const { return settings_; }
+    bool controlsPlayer() const { return controlsPlayer_; }
+    // Where the paddle is steering to; only meaningful once hasTarget()
+    bool hasTarget() const { return hasTarget_; }
+    float targetY() const { return targetY_; }
+
+    // Counters for tuning and benchmarks
+    uint64_t plans = 0;
+    uint64_t overBudget = 0;        // Plans that took longer than settings().budgetMicros
+    uint64_t maxPlanNanos = 0;
+
+private:
+    float nextError();
+
+    AiSettings settings_;
+    bool controlsPlayer_;
+    uint32_t rng_;
+    SimVec2 lastVelocity_;
+    float targetY_;
+    float pendingTargetY_;  // Newest plan, taken over after the reaction delay
+    bool hasTarget_;        // A target can be anywhere, even above the screen, so no marker value
+    bool hasPendingTarget_;
+    int waitTicks_;
+    int cheapPlans_;        // Plans left without look-ahead after one went over budget
+};
@@ -0,0 +1,168 @@
+#include "pong_env.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+// Matches per worker range are a multiple of this, so no two workers write the same cache
+// line of the rewards (16 floats) or observations
+static const size_t ENV_RANGE_GRAIN = 16;
+
+// Function to mix the environment seed, match index and episode number into a match seed
+static uint32_t EpisodeSeed(uint64_t seed, size_t index, uint32_t episode) {
+    uint64_t x = seed + 0x9E3779B97F4A7C15ULL * (index + 1) + 0xBF58476D1CE4E5B9ULL * episode;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return (uint32_t)x;
+}
+
+// Function to get the AI of the settings' difficulty. It reacts a number of ticks after a
+// bounce, tuned at 60 Hz; keep that the same time at other tick rates.
+static AiSettings EnvAiSettings(const PongEnvSettings& settings) {
+    AiSettings ai = AiSettingsFor(settings.opponent);
+    ai.reactionTicks = (int)lround(ai.reactionTicks / 60.0f / settings.config.dt);
+    return ai;
+}
+
+PongVecEnv::PongVecEnv(size_t count, const PongEnvSettings& settings)
+    : settings_(settings), sims_(count, PongSim(settings.config)), episodes_(count, 0),
+      observations_(count * PONG_OBS_SIZE), rewards_(count), dones_(count) {
+    AiSettings ai = EnvAiSettings(settings);
+    opponents_.reserve(count);
+    baselines_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        opponents_.emplace_back(ai, false, EpisodeSeed(settings.seed, i, 0xFFFFFFFFu));
+        baselines_.emplace_back(ai, true, EpisodeSeed(settings.seed ^ 0x5851F42D4C957F2DULL, i, 0xFFFFFFFFu));
+    }
+
+    threadCount_ = settings.threads > 0 ? settings.threads : (int)thread::hardware_concurrency();
+    // No more workers than there are ranges to give them
+    threadCount_ = (int)min<size_t>((size_t)max(threadCount_, 1), max<size_t>(1, (count + ENV_RANGE_GRAIN - 1) / ENV_RANGE_GRAIN));
+    workerStats_.resize(threadCount_);
+    pool_.reset(new WorkerPool(threadCount_));
+
+    reset();
+}
+
+void PongVecEnv::reset() {
+    run(ENV_JOB_RESET, nullptr, nullptr);
+}
+
+void PongVecEnv::step(const int8_t* actions) {
+    run(ENV_JOB_STEP, actions, nullptr);
+}
+
+void PongVecEnv::baselineActions(int8_t* actions) {
+    run(ENV_JOB_BASELINE, nullptr, actions);
+}
+
+PongEnvStats PongVecEnv::stats() const {
+    PongEnvStats total;
+    for (const WorkerStats& worker : workerStats_) {
+        total.steps += worker.stats.steps;
+        total.episodes += worker.stats.episodes;
+        total.agentWins += worker.stats.agentWins;
+        total.opponentWins += worker.stats.opponentWins;
+        total.truncated += worker.stats.truncated;
+        total.totalReward += worker.stats.totalReward;
+    }
+    return total;
+}
+
+void PongVecEnv::run(EnvJob job, const int8_t* actions, int8_t* baseline) {
+    job_ = job;
+    actions_ = actions;
+    baseline_ = baseline;
+
+    // Thread self steps its share of the grains, the caller (0) the first
+    const size_t count = sims_.size();
+    const size_t grains = (count + ENV_RANGE_GRAIN - 1) / ENV_RANGE_GRAIN;
+    pool_->run([&](int self) {
+        size_t begin = min(count, grains * self / threadCount_ * ENV_RANGE_GRAIN);
+        size_t end = min(count, grains * (self + 1) / threadCount_ * ENV_RANGE_GRAIN);
+        runRange(self, begin, end);
+    });
+}
+
+void PongVecEnv::runRange(int worker, size_t begin, size_t end) {
+    if (job_ == ENV_JOB_RESET) {
+        for (size_t i = begin; i < end; i++) {
+            startEpisode(i);
+            rewards_[i] = 0.0f;
+            dones_[i] = PONG_ENV_RUNNING;
+        }
+        return;
+    }
+
+    if (job_ == ENV_JOB_BASELINE) {
+        for (size_t i = begin; i < end; i++) baseline_[i] = baselines_[i].decide(sims_[i].state(), sims_[i].config());
+        return;
+    }
+
+    PongEnvStats& stats = workerStats_[worker].stats;
+    const PongConfig& config = settings_.config;
+    for (size_t i = begin; i < end; i++) {
+        PongSim& sim = sims_[i];
+        PongInputs inputs;
+        inputs.player = actions_[i] < 0 ? -1 : (actions_[i] > 0 ? 1 : 0);
+        inputs.opponent = opponents_[i].decide(sim.state(), config);
+        uint32_t events = sim.step(inputs);
+
+        float reward = 0.0f;
+        if (events & PONG_EVENT_PLAYER_SCORED) reward += settings_.scoreReward;
+        if (events & PONG_EVENT_OPPONENT_SCORED) reward -= settings_.scoreReward;
+        if (events & PONG_EVENT_PLAYER_HIT) reward += settings_.hitReward;
+        rewards_[i] = reward;
+        stats.totalReward += reward;
+
+        uint8_t done = PONG_ENV_RUNNING;
+        if (events & PONG_EVENT_GAME_OVER) {
+            done = PONG_ENV_TERMINAL;
+            if (sim.playerWon()) stats.agentWins++;
+            else stats.opponentWins++;
+        }
+        else if (sim.state().tick >= settings_.maxTicks) {
+            done = PONG_ENV_TRUNCATED;
+            stats.truncated++;
+        }
+        dones_[i] = done;
+
+        if (done != PONG_ENV_RUNNING) {
+            stats.episodes++;
+            startEpisode(i);
+        }
+        else {
+            observe(i);
+        }
+    }
+    stats.steps += end - begin;
+}
+
+// Function to start the next episode of match index with a fresh seed
+void PongVecEnv::startEpisode(size_t index) {
+    sims_[index].reset(EpisodeSeed(settings_.seed, index, episodes_[index]++));
+    observe(index);
+}
+
+// Function to write the observation of match index
+void PongVecEnv::observe(size_t index) {
+    const PongState& state = sims_[index].state();
+    const PongConfig& config = settings_.config;
+    const float toX = 2.0f / config.screenWidth;
+    const float toY = 2.0f / config.screenHeight;
+    const float toSpeed = 1.0f / config.ballSpeed;
+    const float toHearts = 1.0f / config.maxHearts;
+
+    float* obs = &observations_[index * PONG_OBS_SIZE];
+    obs[PONG_OBS_BALL_X] = state.ballPosition.x * toX - 1.0f;
+    obs[PONG_OBS_BALL_Y] = state.ballPosition.y * toY - 1.0f;
+    obs[PONG_OBS_BALL_VX] = state.ballSpeedVector.x * toSpeed;
+    obs[PONG_OBS_BALL_VY] = state.ballSpeedVector.y * toSpeed;
+    obs[PONG_OBS_PADDLE_Y] = (state.playerPaddle.y + state.playerPaddle.height * 0.5f) * toY - 1.0f;
+    obs[PONG_OBS_OPPONENT_Y] = (state.opponentPaddle.y + state.opponentPaddle.height * 0.5f) * toY - 1.0f;
+    obs[PONG_OBS_HEARTS] = state.playerHearts * toHearts;
+    obs[PONG_OBS_OPPONENT_HEARTS] = state.opponentHearts * toHearts;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "pong_ai.h"
+#include "pong_sim.h"
+#include "worker_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Training environment for AI opponents: many independent matches stepped together, with the
+// same rules as a local match (PongSim). The agent steers the player (right) paddle against
+// the game's AI; every step takes one action per match and writes all observations into one
+// contiguous float buffer, with rewards and done flags in parallel arrays. Finished matches
+// start over right away, so the observation after a done is the first of the next episode.
+//
+// No raylib. pong_env_c.h wraps this class in a C ABI for other languages.
+
+// Observation of one match, from the agent's side, scaled to about [-1, 1]
+enum PongEnvObservation {
+    PONG_OBS_BALL_X,
+    PONG_OBS_BALL_Y,
+    PONG_OBS_BALL_VX,           // In units of config.ballSpeed
+    PONG_OBS_BALL_VY,
+    PONG_OBS_PADDLE_Y,          // Center of the agent's paddle
+    PONG_OBS_OPPONENT_Y,        // Center of the AI's paddle
+    PONG_OBS_HEARTS,            // Hearts left, in units of config.maxHearts
+    PONG_OBS_OPPONENT_HEARTS,
+    PONG_OBS_SIZE
+};
+
+// Values in dones()
+enum PongEnvDone : uint8_t {
+    PONG_ENV_RUNNING = 0,
+    PONG_ENV_TERMINAL = 1,      // Someone ran out of hearts
+    PONG_ENV_TRUNCATED = 2      // Hit maxTicks
+};
+
+struct PongEnvSettings {
+    PongConfig config;                  // Rules; dt stays 1/60 unless changed, like the headless tools
+    AiDifficulty opponent = AI_NORMAL;  // The AI of a match against the computer
+    uint32_t maxTicks = 60 * 60 * 5;    // Episode length limit (five simulated minutes at 60 Hz)
+    float scoreReward = 1.0f;           // +scoreReward when the agent scores, -scoreReward when the AI does
+    float hitReward = 0.0f;             // Added when the agent's paddle hits the ball (shaping, off by default)
+    uint64_t seed = 1;
+    int threads = 0;                    // Worker threads including the caller (0 = all cores)
+};
+
+// Totals since construction
+struct PongEnvStats {
+    uint64_t steps = 0;                 // Env-steps (matches * calls to step)
+    uint64_t episodes = 0;
+    uint64_t agentWins = 0;
+    uint64_t opponentWins = 0;
+    uint64_t truncated = 0;
+    double totalReward = 0.0;
+};
+
+class PongVecEnv {
+public:
+    PongVecEnv(size_t count, const PongEnvSettings& settings = PongEnvSettings());
+
+    PongVecEnv(const PongVecEnv&) = delete;
+    PongVecEnv& operator=(const PongVecEnv&) = delete;
+
+    // Function to start a new episode in every match and write their first observations
+    void reset();
+    // Function to advance every match by one tick. actions holds one paddle move per match
+    // (-1 up, 0 stay, +1 down); rewards and dones are those of this step.
+    void step(const int8_t* actions);
+    // Function to get what the game's AI would do with the agent's paddle in every match (the
+    // baseline policy to compare a trained one against)
+    void baselineActions(int8_t* actions);
+
+    size_t size() const { return sims_.size(); }
+    int threadCount() const { return threadCount_; }
+    const PongEnvSettings& settings() const { return settings_; }
+
+    // size() * PONG_OBS_SIZE floats, match after match
+    const float* observations() const { return observations_.data(); }
+    const float* rewards() const { return rewards_.data(); }
+    const uint8_t* dones() const { return dones_.data(); }
+
+    // Function to get the totals of all workers
+    PongEnvStats stats() const;
+    // State of one match, e.g. to draw it
+    const PongState& state(size_t index) const { return sims_[index].state(); }
+
+private:
+    enum EnvJob { ENV_JOB_RESET, ENV_JOB_STEP, ENV_JOB_BASELINE };
+
+    // Per-worker totals padded so workers never share a cache line
+    struct WorkerStats {
+        PongEnvStats stats;
+        char padding[64];
+    };
+
+    void run(EnvJob job, const int8_t* actions, int8_t* baseline);
+    void runRange(int worker, size_t begin, size_t end);
+    void startEpisode(size_t index);
+    void observe(size_t index);
+
+    PongEnvSettings settings_;
+    std::vector<PongSim> sims_;
+    std::vector<PongAI> opponents_;
+    std::vector<PongAI> baselines_;     // The same AI on the agent's paddle
+    std::vector<uint32_t> episodes_;    // Per match, for the episode seeds
+    std::vector<float> observations_;
+    std::vector<float> rewards_;
+    std::vector<uint8_t> dones_;
+    std::vector<WorkerStats> workerStats_;
+
+    // The job the pool's threads run now; each takes its own range of matches, the caller the first
+    int threadCount_ = 1;
+    EnvJob job_ = ENV_JOB_RESET;
+    const int8_t* actions_ = nullptr;
+    int8_t* baseline_ = nullptr;
+    std::unique_ptr<WorkerPool> pool_;
+};
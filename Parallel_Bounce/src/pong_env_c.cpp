@@ -0,0 +1,62 @@
+#include "pong_env_c.h"
+#include "pong_env.h"
+
+using namespace std;
+
+struct PongEnvHandle {
+    PongVecEnv env;
+
+    PongEnvHandle(size_t count, const PongEnvSettings& settings) : env(count, settings) {}
+};
+
+int PongEnvObservationSize(void) {
+    return PONG_OBS_SIZE;
+}
+
+// No exception may leave through the C ABI: anything that fails here is reported as NULL
+PongEnvHandle* PongEnvCreate(size_t count, int difficulty, uint64_t seed, int threads) {
+    if (count == 0 || difficulty < AI_EASY || difficulty > AI_HARD) return nullptr;
+
+    PongEnvSettings settings;
+    settings.opponent = (AiDifficulty)difficulty;
+    settings.seed = seed;
+    settings.threads = threads;
+    try {
+        return new PongEnvHandle(count, settings);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void PongEnvDestroy(PongEnvHandle* env) {
+    delete env;
+}
+
+size_t PongEnvCount(const PongEnvHandle* env) {
+    return env->env.size();
+}
+
+void PongEnvReset(PongEnvHandle* env) {
+    env->env.reset();
+}
+
+void PongEnvStep(PongEnvHandle* env, const int8_t* actions) {
+    env->env.step(actions);
+}
+
+void PongEnvBaselineActions(PongEnvHandle* env, int8_t* actions) {
+    env->env.baselineActions(actions);
+}
+
+const float* PongEnvObservations(const PongEnvHandle* env) {
+    return env->env.observations();
+}
+
+const float* PongEnvRewards(const PongEnvHandle* env) {
+    return env->env.rewards();
+}
+
+const uint8_t* PongEnvDones(const PongEnvHandle* env) {
+    return env->env.dones();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/* C ABI of the training environment (pong_env.h), for loading the game's rules from Python
+ * (ctypes, cffi) or any other language with a C FFI. Build it with 'make libpong_env'.
+ *
+ * The buffers returned by PongEnvObservations, PongEnvRewards and PongEnvDones belong to the
+ * environment and are rewritten in place by every reset and step, so they can be wrapped once
+ * (e.g. as numpy arrays) and read after each call. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The DLL build defines PONG_ENV_BUILDING, programs that link the sources in directly define
+ * PONG_ENV_STATIC; anything else is loading the DLL. */
+#if defined(_WIN32) && defined(PONG_ENV_BUILDING)
+#define PONG_ENV_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(PONG_ENV_STATIC)
+#define PONG_ENV_API
+#elif defined(_WIN32)
+#define PONG_ENV_API __declspec(dllimport)
+#else
+#define PONG_ENV_API __attribute__((visibility("default")))
+#endif
+
+typedef struct PongEnvHandle PongEnvHandle;
+
+/* Floats per match in the observation buffer */
+PONG_ENV_API int PongEnvObservationSize(void);
+
+/* count matches against the AI (difficulty 0 = easy, 1 = normal, 2 = hard), on threads
+ * threads including the caller (0 = all cores). Returns NULL if it can't be created. */
+PONG_ENV_API PongEnvHandle* PongEnvCreate(size_t count, int difficulty, uint64_t seed, int threads);
+PONG_ENV_API void PongEnvDestroy(PongEnvHandle* env);
+
+PONG_ENV_API size_t PongEnvCount(const PongEnvHandle* env);
+PONG_ENV_API void PongEnvReset(PongEnvHandle* env);
+/* One action per match: -1 up, 0 stay, +1 down */
+PONG_ENV_API void PongEnvStep(PongEnvHandle* env, const int8_t* actions);
+/* What the game's AI would do with the agent's paddle; call it every step for it to keep up */
+PONG_ENV_API void PongEnvBaselineActions(PongEnvHandle* env, int8_t* actions);
+
+PONG_ENV_API const float* PongEnvObservations(const PongEnvHandle* env);
+PONG_ENV_API const float* PongEnvRewards(const PongEnvHandle* env);
+/* 0 running, 1 match over, 2 episode length limit; the match has already started over */
+PONG_ENV_API const uint8_t* PongEnvDones(const PongEnvHandle* env);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,219 @@
+#include "pong_sim.h"
+#include "swept_collision.h"
+#include "xorshift.h"
+
+#include <cmath>
+
+using namespace std;
+
+PongSim::PongSim(const PongConfig& config) : config_(config) {
+    reset();
+}
+
+void PongSim::reset() {
+    reset(config_.seed);
+}
+
+void PongSim::reset(uint32_t seed) {
+    const float screenWidth = (float)config_.screenWidth;
+    const float screenHeight = (float)config_.screenHeight;
+
+    state_.playerPaddle = { screenWidth - 70, screenHeight / 2 - 60, 20, 120 };
+    state_.opponentPaddle = { 50, screenHeight / 2 - 60, 20, 120 };
+    state_.ballPosition = { screenWidth / 2, screenHeight / 2 };
+    state_.ballSpeedVector = { -config_.ballSpeed, config_.ballSpeed };
+
+    state_.playerScore = 0;
+    state_.opponentScore = 0;
+    state_.playerHearts = config_.maxHearts;
+    state_.opponentHearts = config_.maxHearts;
+    state_.tick = 0;
+    state_.rally = 0;
+    state_.rng = XorShiftSeed(seed);
+
+    if (config_.serveJitter > 0.0f) serve(-1.0f);
+}
+
+// Function to get a uniform random number in [-1, 1) from the xorshift32 state
+float PongSim::nextRandom() {
+    return XorShiftUnit(state_.rng) * 2.0f - 1.0f;
+}
+
+// Function to put the ball back in the center, heading towards directionX
+void PongSim::serve(float directionX) {
+    state_.ballPosition = { config_.screenWidth / 2.0f, config_.screenHeight / 2.0f };
+    state_.rally = 0;
+
+    if (config_.serveJitter <= 0.0f) {
+        // Classic serve: keep the vertical direction, only flip horizontally
+        state_.ballSpeedVector.x = directionX * config_.ballSpeed;
+        return;
+    }
+
+    const float speed = config_.ballSpeed * 1.41421356f;
+    const float angle = 0.78539816f + nextRandom() * config_.serveJitter;
+    const float directionY = state_.ballSpeedVector.y < 0 ? -1.0f : 1.0f;
+    state_.ballSpeedVector = { directionX * speed * cosf(angle), directionY * speed * sinf(angle) };
+}
+
+uint32_t PongSim::step(const PongInputs& inputs) {
+    if (isOver()) return PONG_EVENT_GAME_OVER;
+
+    const float screenWidth = (float)config_.screenWidth;
+    const float screenHeight = (float)config_.screenHeight;
+    const float paddleStep = config_.paddleSpeed * config_.dt;
+    uint32_t events = PONG_EVENT_NONE;
+
+    // Move paddles and keep them on screen. Written without branches: inputs from a policy or
+    // a player change unpredictably, and y + step * -1 is exactly y - step, so the result is
+    // the same as moving with if/else.
+    SimRect* paddles[2] = { &state_.playerPaddle, &state_.opponentPaddle };
+    const int8_t moves[2] = { inputs.player, inputs.opponent };
+    for (int i = 0; i < 2; i++) {
+        SimRect& paddle = *paddles[i];
+        float direction = (float)((moves[i] > 0) - (moves[i] < 0));
+        float y = paddle.y + paddleStep * direction;
+        y = y < 0 ? 0 : y;
+        float lowest = screenHeight - paddle.height;
+        paddle.y = y > lowest ? lowest : y;
+    }
+
+    events |= config_.continuousCollision ? moveBallSwept(config_.dt) : moveBallDiscrete(config_.dt);
+
+    // Scoring
+    SimVec2& ball = state_.ballPosition;
+    if (ball.x <= 0) {
+        state_.playerScore++;
+        state_.opponentHearts--;
+        events |= PONG_EVENT_PLAYER_SCORED;
+        serve(1.0f);
+    }
+    else if (ball.x >= screenWidth) {
+        state_.opponentScore++;
+        state_.playerHearts--;
+        events |= PONG_EVENT_OPPONENT_SCORED;
+        serve(-1.0f);
+    }
+
+    state_.tick++;
+    if (isOver()) events |= PONG_EVENT_GAME_OVER;
+    return events;
+}
+
+// Function to move the ball a whole tick, then test for overlaps (the original StartGame rule).
+// A fast ball can jump over a paddle in one tick.
+uint32_t PongSim::moveBallDiscrete(float dt) {
+    const float screenHeight = (float)config_.screenHeight;
+    SimVec2& ball = state_.ballPosition;
+    SimVec2& velocity = state_.ballSpeedVector;
+    uint32_t events = PONG_EVENT_NONE;
+
+    ball.x += velocity.x * dt;
+    ball.y += velocity.y * dt;
+
+    // Only reflect when moving into the wall/paddle so the ball can't get stuck inside
+    if ((ball.y <= 0 && velocity.y < 0) || (ball.y >= screenHeight && velocity.y > 0)) {
+        velocity.y = -velocity.y;
+        events |= PONG_EVENT_WALL_BOUNCE;
+    }
+    if (velocity.x > 0 && CircleOverlapsRect(ball, config_.ballRadius, state_.playerPaddle)) {
+        velocity.x = -velocity.x;
+        state_.rally++;
+        events |= PONG_EVENT_PLAYER_HIT;
+    }
+    if (velocity.x < 0 && CircleOverlapsRect(ball, config_.ballRadius, state_.opponentPaddle)) {
+        velocity.x = -velocity.x;
+        state_.rally++;
+        events |= PONG_EVENT_OPPONENT_HIT;
+    }
+    return events;
+}
+
+// Function to move the ball a whole tick in sub-steps: find the earliest contact with a wall
+// or paddle, move to it, reflect, and continue with the time that is left
+uint32_t PongSim::moveBallSwept(float dt) {
+    const float screenHeight = (float)config_.screenHeight;
+    const float radius = config_.ballRadius;
+    SimVec2& ball = state_.ballPosition;
+    SimVec2& velocity = state_.ballSpeedVector;
+    uint32_t events = PONG_EVENT_NONE;
+
+    // A paddle that moved into the ball this tick knocks it back like the discrete rule does
+    if (velocity.x > 0 && CircleOverlapsRect(ball, radius, state_.playerPaddle)) {
+        velocity.x = -velocity.x;
+        state_.rally++;
+        events |= PONG_EVENT_PLAYER_HIT;
+    }
+    if (velocity.x < 0 && CircleOverlapsRect(ball, radius, state_.opponentPaddle)) {
+        velocity.x = -velocity.x;
+        state_.rally++;
+        events |= PONG_EVENT_OPPONENT_HIT;
+    }
+
+    enum { HIT_NONE, HIT_WALL, HIT_PLAYER, HIT_OPPONENT };
+    float remaining = dt;
+
+    for (int subStep = 0; subStep < 8 && remaining > 0; subStep++) {
+        SimVec2 motion = { velocity.x * remaining, velocity.y * remaining };
+        float hitTime = 1.0f;
+        int hitKind = HIT_NONE;
+        SimVec2 normal = { 0.0f, 0.0f };
+
+        // Walls: the ball's center bounces at y = 0 and y = screenHeight, as in the discrete rule
+        if (motion.y < 0 && ball.y + motion.y <= 0) {
+            hitTime = ball.y <= 0 ? 0.0f : -ball.y / motion.y;
+            hitKind = HIT_WALL;
+            normal = { 0.0f, 1.0f };
+        }
+        else if (motion.y > 0 && ball.y + motion.y >= screenHeight) {
+            hitTime = ball.y >= screenHeight ? 0.0f : (screenHeight - ball.y) / motion.y;
+            hitKind = HIT_WALL;
+            normal = { 0.0f, -1.0f };
+        }
+
+        SweepHit hit;
+        if (SweepCircleRect(ball, motion, radius, state_.playerPaddle, hit) && hit.time < hitTime) {
+            hitTime = hit.time;
+            hitKind = HIT_PLAYER;
+            normal = hit.normal;
+        }
+        if (SweepCircleRect(ball, motion, radius, state_.opponentPaddle, hit) && hit.time < hitTime) {
+            hitTime = hit.time;
+            hitKind = HIT_OPPONENT;
+            normal = hit.normal;
+        }
+
+        ball.x += motion.x * hitTime;
+        ball.y += motion.y * hitTime;
+        if (hitKind == HIT_NONE) break;
+        remaining *= 1.0f - hitTime;
+
+        // Reflect the velocity about the contact normal
+        float along = velocity.x * normal.x + velocity.y * normal.y;
+        velocity.x -= 2.0f * along * normal.x;
+        velocity.y -= 2.0f * along * normal.y;
+
+        if (hitKind == HIT_WALL) {
+            events |= PONG_EVENT_WALL_BOUNCE;
+        }
+        else {
+            state_.rally++;
+            events |= hitKind == HIT_PLAYER ? PONG_EVENT_PLAYER_HIT : PONG_EVENT_OPPONENT_HIT;
+        }
+    }
+    return events;
+}
+
+bool CircleOverlapsRect(SimVec2 center, float radius, const SimRect& rect) {
+    float closestX = center.x < rect.x ? rect.x : (center.x > rect.x + rect.width ? rect.x + rect.width : center.x);
+    float closestY = center.y < rect.y ? rect.y : (center.y > rect.y + rect.height ? rect.y + rect.height : center.y);
+    float dx = center.x - closestX;
+    float dy = center.y - closestY;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+int8_t FollowBallInput(const PongState& state, const SimRect& paddle) {
+    if (state.ballPosition.y < paddle.y) return -1;
+    if (state.ballPosition.y > paddle.y + paddle.height) return 1;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+
+// Plain vector/rectangle types so the simulation does not depend on raylib
+struct SimVec2 {
+    float x;
+    float y;
+};
+
+struct SimRect {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+// Rules of a match (defaults are the values StartGame always used)
+struct PongConfig {
+    int screenWidth = 792;
+    int screenHeight = 534;
+    float paddleSpeed = 400.0f;
+    float ballSpeed = 350.0f;
+    float ballRadius = 10.0f;
+    int maxHearts = 5;
+    float dt = 1.0f / 60.0f;     // Fixed simulation timestep in seconds
+    float serveJitter = 0.0f;    // Max random change of the serve angle in radians (0 = classic 45 degree serve)
+    uint32_t seed = 1;           // Seed for the serve randomisation
+    bool continuousCollision = true; // Sweep the ball each tick so fast balls can't pass through paddles
+};
+
+// Paddle movement requested for one tick: -1 = up, 0 = stay, +1 = down
+struct PongInputs {
+    int8_t player;      // Right paddle (W/S)
+    int8_t opponent;    // Left paddle (UP/DOWN or AI)
+};
+
+// Bit flags returned by PongSim::step describing what happened during the tick
+enum PongEvent : uint32_t {
+    PONG_EVENT_NONE = 0,
+    PONG_EVENT_WALL_BOUNCE = 1u << 0,
+    PONG_EVENT_PLAYER_HIT = 1u << 1,        // Ball bounced off the player paddle
+    PONG_EVENT_OPPONENT_HIT = 1u << 2,      // Ball bounced off the opponent paddle
+    PONG_EVENT_PLAYER_SCORED = 1u << 3,     // Ball left through x <= 0, opponent lost a heart
+    PONG_EVENT_OPPONENT_SCORED = 1u << 4,   // Ball left through x >= screenWidth, player lost a heart
+    PONG_EVENT_GAME_OVER = 1u << 5
+};
+
+// Complete state of a match. Plain data, safe to copy with memcpy.
+struct PongState {
+    SimRect playerPaddle;
+    SimRect opponentPaddle;
+    SimVec2 ballPosition;
+    SimVec2 ballSpeedVector;
+    int playerScore;
+    int opponentScore;
+    int playerHearts;
+    int opponentHearts;
+    uint32_t tick;      // Ticks simulated since reset
+    uint32_t rally;     // Paddle hits since the last serve
+    uint32_t rng;       // Serve randomisation state
+};
+
+// Deterministic fixed-timestep Pong simulation (no raylib, no wall clock)
+class PongSim {
+public:
+    explicit PongSim(const PongConfig& config = PongConfig());
+
+    // Start a new match using the configured seed
+    void reset();
+    // Start a new match with a different seed
+    void reset(uint32_t seed);
+
+    // Advance the match by one config().dt tick. Returns PongEvent flags.
+    uint32_t step(const PongInputs& inputs);
+
+    // Replace the whole match state (e.g. to set up a situation or go back in time)
+    void restore(const PongState& state) { state_ = state; }
+
+    bool isOver() const { return state_.playerHearts <= 0 || state_.opponentHearts <= 0; }
+    bool playerWon() const { return state_.playerHearts > 0; }
+
+    const PongState& state() const { return state_; }
+    const PongConfig& config() const { return config_; }
+
+private:
+    uint32_t moveBallDiscrete(float dt);
+    uint32_t moveBallSwept(float dt);
+    void serve(float directionX);
+    float nextRandom();
+
+    PongConfig config_;
+    PongState state_;
+};
+
+// Circle vs axis-aligned rectangle overlap (same test as raylib's CheckCollisionCircleRec)
+bool CircleOverlapsRect(SimVec2 center, float radius, const SimRect& rect);
+
+// The original reactive AI: move towards the ball only when it is outside the paddle
+int8_t FollowBallInput(const PongState& state, const SimRect& paddle);
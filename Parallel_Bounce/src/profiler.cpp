@@ -0,0 +1,221 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+static const uint64_t PROFILE_RING_SIZE = 1 << 15;     // Scopes kept per thread (power of two)
+static const int PROFILE_HISTORY = 240;                 // Frames in the overlay's percentiles
+static const int PROFILE_MAX_PHASES = 24;               // Scope names tracked per frame
+static const int PROFILE_NAME_SIZE = 32;
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNanos;
+    uint64_t endNanos;
+};
+
+// Written only by its thread. Readers on other threads copy it and then drop whatever the
+// writer may have overwritten meanwhile (the write count tells).
+struct ProfileRing {
+    ProfileEvent events[PROFILE_RING_SIZE];
+    atomic<uint64_t> written{ 0 };
+    int threadId = 0;
+    char name[PROFILE_NAME_SIZE] = {};
+};
+
+// Scope totals of one name in the marked frames
+struct PhaseHistory {
+    const char* name;
+    float micros[PROFILE_HISTORY];
+    uint64_t frameNanos;
+};
+
+atomic<bool> profilerRecording(false);
+
+// Rings are created on a thread's first recorded scope and never freed, so the scopes of
+// threads that have finished can still be exported
+static mutex ringsMutex;
+static vector<ProfileRing*> rings;
+static thread_local ProfileRing* threadRing = nullptr;
+static thread_local char threadName[PROFILE_NAME_SIZE] = {};
+
+// Frame statistics, only touched by the thread that calls ProfilerFrameMark
+static PhaseHistory phases[PROFILE_MAX_PHASES];
+static int phaseCount = 0;
+static uint64_t markedFrames = 0;
+static uint64_t lastMarkNanos = 0;
+static uint64_t lastMarkIndex = 0;
+static ProfileRing* markRing = nullptr;
+
+uint64_t ProfilerNow() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ProfileRing* ThreadRing() {
+    if (threadRing) return threadRing;
+
+    ProfileRing* ring = new ProfileRing();
+    lock_guard<mutex> lock(ringsMutex);
+    ring->threadId = (int)rings.size() + 1;
+    if (threadName[0]) snprintf(ring->name, sizeof(ring->name), "%s", threadName);
+    else snprintf(ring->name, sizeof(ring->name), "thread %d", ring->threadId);
+    rings.push_back(ring);
+    threadRing = ring;
+    return ring;
+}
+
+void ProfilerRecord(const char* name, uint64_t startNanos, uint64_t endNanos) {
+    ProfileRing* ring = ThreadRing();
+    uint64_t index = ring->written.load(memory_order_relaxed);
+    ProfileEvent& event = ring->events[index & (PROFILE_RING_SIZE - 1)];
+    event.name = name;
+    event.startNanos = startNanos;
+    event.endNanos = endNanos;
+    ring->written.store(index + 1, memory_order_release);
+}
+
+void SetProfilerEnabled(bool enabled) {
+    profilerRecording.store(enabled, memory_order_relaxed);
+}
+
+void SetProfilerThreadName(const char* name) {
+    snprintf(threadName, sizeof(threadName), "%s", name);
+    if (threadRing) {
+        lock_guard<mutex> lock(ringsMutex);
+        snprintf(threadRing->name, sizeof(threadRing->name), "%s", name);
+    }
+}
+
+static PhaseHistory* FindPhase(const char* name) {
+    for (int i = 0; i < phaseCount; i++) {
+        if (phases[i].name == name) return &phases[i];
+    }
+    if (phaseCount == PROFILE_MAX_PHASES) return nullptr;
+
+    // Frames before this scope first ran count as 0 for it
+    PhaseHistory& phase = phases[phaseCount++];
+    phase.name = name;
+    fill(phase.micros, phase.micros + PROFILE_HISTORY, 0.0f);
+    phase.frameNanos = 0;
+    return &phase;
+}
+
+void ProfilerFrameMark() {
+    if (!ProfilerEnabled()) {
+        lastMarkNanos = 0;  // The next frame after recording resumes starts fresh
+        return;
+    }
+
+    ProfileRing* ring = ThreadRing();
+    uint64_t now = ProfilerNow();
+    uint64_t written = ring->written.load(memory_order_relaxed);
+
+    if (lastMarkNanos != 0 && markRing == ring) {
+        if (phaseCount == 0) FindPhase("frame");
+        for (int i = 0; i < phaseCount; i++) phases[i].frameNanos = 0;
+        phases[0].frameNanos = now - lastMarkNanos;
+
+        // Scopes that finished this frame; ones that began before the mark (a loop's enclosing
+        // scope) belong to no single frame
+        uint64_t first = max(lastMarkIndex, written > PROFILE_RING_SIZE ? written - PROFILE_RING_SIZE : 0);
+        for (uint64_t i = first; i < written; i++) {
+            const ProfileEvent& event = ring->events[i & (PROFILE_RING_SIZE - 1)];
+            if (event.startNanos < lastMarkNanos) continue;
+            PhaseHistory* phase = FindPhase(event.name);
+            if (phase) phase->frameNanos += event.endNanos - event.startNanos;
+        }
+
+        int slot = (int)(markedFrames % PROFILE_HISTORY);
+        for (int i = 0; i < phaseCount; i++) phases[i].micros[slot] = phases[i].frameNanos / 1000.0f;
+        markedFrames++;
+    }
+
+    markRing = ring;
+    lastMarkNanos = now;
+    lastMarkIndex = written;
+}
+
+int ProfilerPhaseStats(ProfilePhaseStats* stats, int maxCount) {
+    int frames = (int)min<uint64_t>(markedFrames, PROFILE_HISTORY);
+    if (frames == 0) return 0;
+
+    float sorted[PROFILE_HISTORY];
+    int count = min(phaseCount, maxCount);
+    for (int i = 0; i < count; i++) {
+        copy(phases[i].micros, phases[i].micros + frames, sorted);
+        sort(sorted, sorted + frames);
+        stats[i].name = phases[i].name;
+        stats[i].p50Micros = sorted[frames / 2];
+        stats[i].p99Micros = sorted[min(frames - 1, frames * 99 / 100)];
+        stats[i].maxMicros = sorted[frames - 1];
+    }
+    return count;
+}
+
+// Function to write a string as a JSON string literal
+static void WriteJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char)*c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool ExportChromeTrace(const char* path) {
+    vector<ProfileRing*> snapshot;
+    {
+        lock_guard<mutex> lock(ringsMutex);
+        snapshot = rings;
+    }
+
+    // Copy each ring, then keep only what the writer can't have overwritten during the copy
+    vector<vector<ProfileEvent>> events(snapshot.size());
+    uint64_t origin = UINT64_MAX;
+    for (size_t r = 0; r < snapshot.size(); r++) {
+        ProfileRing* ring = snapshot[r];
+        uint64_t written = ring->written.load(memory_order_acquire);
+        uint64_t first = written > PROFILE_RING_SIZE ? written - PROFILE_RING_SIZE : 0;
+        vector<ProfileEvent> copied;
+        copied.reserve((size_t)(written - first));
+        for (uint64_t i = first; i < written; i++) copied.push_back(ring->events[i & (PROFILE_RING_SIZE - 1)]);
+
+        // The writer may be in the middle of event after, whose slot is also event
+        // after - PROFILE_RING_SIZE's, so that one goes too
+        uint64_t after = ring->written.load(memory_order_acquire);
+        uint64_t safeFirst = after >= PROFILE_RING_SIZE ? after - PROFILE_RING_SIZE + 1 : 0;
+        size_t skip = safeFirst > first ? (size_t)min<uint64_t>(safeFirst - first, copied.size()) : 0;
+        events[r].assign(copied.begin() + skip, copied.end());
+        for (const ProfileEvent& event : events[r]) origin = min(origin, event.startNanos);
+    }
+
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool firstEntry = true;
+    for (size_t r = 0; r < snapshot.size(); r++) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+            firstEntry ? "" : ",\n", snapshot[r]->threadId);
+        {
+            lock_guard<mutex> lock(ringsMutex);
+            WriteJsonString(file, snapshot[r]->name);
+        }
+        fprintf(file, "}}");
+        firstEntry = false;
+
+        for (const ProfileEvent& event : events[r]) {
+            fprintf(file, ",\n{\"name\":");
+            WriteJsonString(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", snapshot[r]->threadId,
+                (event.startNanos - origin) / 1000.0, (event.endNanos - event.startNanos) / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Scoped CPU timers for finding where frame time goes. PROFILE_SCOPE("name") times the rest of
+// the enclosing block into a ring buffer of the calling thread (the newest 32768 scopes are
+// kept, about half a minute of the game loop). Names must be string literals.
+//
+// Recording is off until SetProfilerEnabled(true). While off, a scope is one relaxed load and a
+// branch, so the macros stay in release builds; building with -DPB_NO_PROFILER removes them.
+//
+// The thread that calls ProfilerFrameMark() once per frame also gets per-frame totals of each
+// scope name, for the p50/p99 overlay. ExportChromeTrace writes every thread's ring as a
+// Chrome trace (chrome://tracing or ui.perfetto.dev).
+
+struct ProfilePhaseStats {
+    const char* name;           // "frame" for the time between two frame marks
+    double p50Micros;
+    double p99Micros;
+    double maxMicros;
+};
+
+// Set by SetProfilerEnabled; read by every scope
+extern std::atomic<bool> profilerRecording;
+
+inline bool ProfilerEnabled() {
+    return profilerRecording.load(std::memory_order_relaxed);
+}
+
+// Nanoseconds on the steady clock (never 0)
+uint64_t ProfilerNow();
+// Function to store one finished scope in the calling thread's ring
+void ProfilerRecord(const char* name, uint64_t startNanos, uint64_t endNanos);
+
+void SetProfilerEnabled(bool enabled);
+// Function to name the calling thread in exported traces
+void SetProfilerThreadName(const char* name);
+
+// Function to end the current frame of the calling thread and start the next
+void ProfilerFrameMark();
+// Function to get the frame and per-scope statistics over the last 240 marked frames. Fills at
+// most maxCount entries (the frame first, then scopes by first appearance) and returns how many.
+int ProfilerPhaseStats(ProfilePhaseStats* stats, int maxCount);
+
+// Function to write the recorded scopes of all threads as Chrome trace JSON
+bool ExportChromeTrace(const char* path);
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name_(name), start_(ProfilerEnabled() ? ProfilerNow() : 0) {}
+    ~ProfileScope() {
+        if (start_ != 0) ProfilerRecord(name_, start_, ProfilerNow());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PB_NO_PROFILER
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include <cstddef>
+
+// Many textured quads through rlgl's vertex batch: the texture is bound once and a few thousand
+// quads go into each rlBegin/rlEnd, instead of a draw call per quad. HudBatch (text) and
+// DrawParticles both draw this way.
+
+// rlgl's default batch holds 8192 quads; stay well below so one submission never splits
+const size_t QUAD_BATCH_MAX_QUADS = 4096;
+
+// One quad: screen corners (top left, bottom right), texture coordinates (0..1) and color
+struct BatchQuad {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+    Color color;
+};
+
+// Function to submit count quads with textureId bound (between BeginDrawing and EndDrawing).
+// quadAt(i, quad) fills in quad i; it is a template parameter so that call inlines. Returns the
+// number of submissions, one per QUAD_BATCH_MAX_QUADS quads.
+template <typename QuadAt>
+size_t SubmitQuads(unsigned int textureId, size_t count, QuadAt quadAt) {
+    size_t submissions = 0;
+    BatchQuad q;
+    for (size_t first = 0; first < count; first += QUAD_BATCH_MAX_QUADS) {
+        size_t last = first + QUAD_BATCH_MAX_QUADS < count ? first + QUAD_BATCH_MAX_QUADS : count;
+
+        // Flush whatever rlgl has queued now rather than in the middle of these quads
+        rlCheckRenderBatchLimit((int)(4 * (last - first)));
+        rlSetTexture(textureId);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (size_t i = first; i < last; i++) {
+            quadAt(i, q);
+            rlColor4ub(q.color.r, q.color.g, q.color.b, q.color.a);
+            // Same corner order as DrawTexturePro: top left, bottom left, bottom right, top right
+            rlTexCoord2f(q.u0, q.v0);
+            rlVertex2f(q.x0, q.y0);
+            rlTexCoord2f(q.u0, q.v1);
+            rlVertex2f(q.x0, q.y1);
+            rlTexCoord2f(q.u1, q.v1);
+            rlVertex2f(q.x1, q.y1);
+            rlTexCoord2f(q.u1, q.v0);
+            rlVertex2f(q.x1, q.y0);
+        }
+        rlEnd();
+        rlSetTexture(0);
+        submissions++;
+    }
+    return submissions;
+}
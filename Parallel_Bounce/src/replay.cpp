@@ -0,0 +1,232 @@
+#include "replay.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+uint32_t HashPongState(const PongState& state) {
+    const uint8_t* bytes = (const uint8_t*)&state;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(state); i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+// Function to pack one tick's inputs: bits 0-1 player, bits 2-3 opponent (1 = down, 2 = up)
+static uint8_t PackInputs(const PongInputs& inputs) {
+    uint8_t player = inputs.player > 0 ? 1 : (inputs.player < 0 ? 2 : 0);
+    uint8_t opponent = inputs.opponent > 0 ? 1 : (inputs.opponent < 0 ? 2 : 0);
+    return (uint8_t)(player | (opponent << 2));
+}
+
+static PongInputs UnpackInputs(uint8_t mask) {
+    static const int8_t moves[4] = { 0, 1, -1, 0 };
+    PongInputs inputs = { moves[mask & 3], moves[(mask >> 2) & 3] };
+    return inputs;
+}
+
+static void WriteVarint(vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool ReadVarint(const vector<uint8_t>& in, size_t& offset, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && offset < in.size(); shift += 7) {
+        uint8_t byte = in[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void ReplayRecorder::begin(const PongConfig& config, bool vsAI, const string& playerName, const string& opponentName) {
+    memset(&header_, 0, sizeof(header_));
+    header_.magic = REPLAY_MAGIC;
+    header_.version = REPLAY_VERSION;
+    header_.flags = vsAI ? REPLAY_FLAG_VS_AI : 0;
+    header_.screenWidth = config.screenWidth;
+    header_.screenHeight = config.screenHeight;
+    header_.paddleSpeed = config.paddleSpeed;
+    header_.ballSpeed = config.ballSpeed;
+    header_.ballRadius = config.ballRadius;
+    header_.maxHearts = config.maxHearts;
+    header_.dt = config.dt;
+    header_.serveJitter = config.serveJitter;
+    header_.seed = config.seed;
+    header_.continuousCollision = config.continuousCollision ? 1 : 0;
+    header_.timestamp = (int64_t)time(nullptr);
+    header_.checkpointInterval = REPLAY_CHECKPOINT_INTERVAL;
+    snprintf(header_.playerName, sizeof(header_.playerName), "%s", playerName.c_str());
+    snprintf(header_.opponentName, sizeof(header_.opponentName), "%s", opponentName.c_str());
+
+    // Room for a long match up front, so recording doesn't allocate during play
+    checkpoints_.clear();
+    checkpoints_.reserve(64);
+    runs_.clear();
+    runs_.reserve(4096);
+    previousMask_ = 0;
+    runMask_ = 0;
+    runLength_ = 0;
+}
+
+void ReplayRecorder::flushRun(vector<uint8_t>& out) const {
+    if (runLength_ == 0) return;
+
+    // Runs longer than the varint can describe are split (2^28 ticks is over 50 days at 60 Hz)
+    uint32_t length = runLength_;
+    uint8_t previous = previousMask_;
+    while (length > 0) {
+        uint32_t chunk = length < (1u << 28) ? length : (1u << 28);
+        WriteVarint(out, ((chunk - 1) << 4) | (uint32_t)(runMask_ ^ previous));
+        previous = runMask_;
+        length -= chunk;
+    }
+}
+
+void ReplayRecorder::record(const PongInputs& inputs, const PongState& state) {
+    uint8_t mask = PackInputs(inputs);
+    if (runLength_ > 0 && mask != runMask_) {
+        flushRun(runs_);
+        previousMask_ = runMask_;
+        runLength_ = 0;
+    }
+    runMask_ = mask;
+    runLength_++;
+
+    header_.tickCount++;
+    header_.finalHash = HashPongState(state);
+    if (header_.tickCount % header_.checkpointInterval == 0) checkpoints_.push_back(header_.finalHash);
+}
+
+size_t ReplayRecorder::byteSize() const {
+    vector<uint8_t> openRun;
+    flushRun(openRun);
+    return sizeof(ReplayHeader) + checkpoints_.size() * sizeof(uint32_t) + runs_.size() + openRun.size();
+}
+
+bool ReplayRecorder::save(const char* path) const {
+    vector<uint8_t> runs = runs_;
+    flushRun(runs);
+
+    ReplayHeader header = header_;
+    header.checkpointCount = (uint32_t)checkpoints_.size();
+    header.runBytes = (uint32_t)runs.size();
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (checkpoints_.empty() || fwrite(checkpoints_.data(), sizeof(uint32_t), checkpoints_.size(), file) == checkpoints_.size()) &&
+        (runs.empty() || fwrite(runs.data(), 1, runs.size(), file) == runs.size());
+    return fclose(file) == 0 && ok;
+}
+
+bool Replay::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+
+    vector<uint8_t> data;
+    uint8_t buffer[16384];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + got);
+    fclose(file);
+
+    return load(data.data(), data.size());
+}
+
+bool Replay::load(const uint8_t* data, size_t size) {
+    if (size < sizeof(ReplayHeader)) return false;
+
+    ReplayHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION || header.checkpointInterval == 0) return false;
+
+    size_t checkpointBytes = (size_t)header.checkpointCount * sizeof(uint32_t);
+    if (size != sizeof(ReplayHeader) + checkpointBytes + header.runBytes) return false;
+
+    header.playerName[REPLAY_NAME_SIZE - 1] = '\0';
+    header.opponentName[REPLAY_NAME_SIZE - 1] = '\0';
+    header_ = header;
+
+    const uint8_t* checkpoints = data + sizeof(ReplayHeader);
+    checkpoints_.resize(header.checkpointCount);
+    if (checkpointBytes > 0) memcpy(checkpoints_.data(), checkpoints, checkpointBytes);
+    runs_.assign(checkpoints + checkpointBytes, checkpoints + checkpointBytes + header.runBytes);
+    return true;
+}
+
+PongConfig Replay::config() const {
+    PongConfig config;
+    config.screenWidth = header_.screenWidth;
+    config.screenHeight = header_.screenHeight;
+    config.paddleSpeed = header_.paddleSpeed;
+    config.ballSpeed = header_.ballSpeed;
+    config.ballRadius = header_.ballRadius;
+    config.maxHearts = header_.maxHearts;
+    config.dt = header_.dt;
+    config.serveJitter = header_.serveJitter;
+    config.seed = header_.seed;
+    config.continuousCollision = header_.continuousCollision != 0;
+    return config;
+}
+
+bool Replay::decode(vector<PongInputs>& inputs) const {
+    inputs.clear();
+    inputs.reserve(header_.tickCount);
+
+    ReplayCursor cursor(*this);
+    PongInputs tickInputs;
+    while (cursor.next(tickInputs)) inputs.push_back(tickInputs);
+    return inputs.size() == header_.tickCount;
+}
+
+ReplayCursor::ReplayCursor(const Replay& replay) : replay_(replay) {
+}
+
+bool ReplayCursor::next(PongInputs& inputs) {
+    if (tick_ >= replay_.header_.tickCount) return false;
+
+    if (remaining_ == 0) {
+        uint32_t value;
+        if (!ReadVarint(replay_.runs_, offset_, value)) return false;
+        mask_ ^= (uint8_t)(value & 0x0F);
+        remaining_ = (value >> 4) + 1;
+    }
+
+    inputs = UnpackInputs(mask_);
+    remaining_--;
+    tick_++;
+    return true;
+}
+
+ReplayCheck VerifyReplay(const Replay& replay) {
+    ReplayCheck check;
+    PongSim sim(replay.config());
+    ReplayCursor cursor(replay);
+
+    const uint32_t interval = replay.header().checkpointInterval;
+    const vector<uint32_t>& checkpoints = replay.checkpoints();
+
+    PongInputs inputs;
+    while (cursor.next(inputs)) {
+        sim.step(inputs);
+        uint32_t tick = cursor.tick();
+        if (tick % interval == 0 && check.firstMismatch < 0) {
+            size_t index = tick / interval - 1;
+            if (index >= checkpoints.size() || checkpoints[index] != HashPongState(sim.state())) check.firstMismatch = tick;
+        }
+    }
+
+    check.ticks = cursor.tick();
+    check.finalHash = HashPongState(sim.state());
+    check.playerWon = sim.playerWon();
+    if (check.firstMismatch < 0 && (check.ticks != replay.tickCount() || check.finalHash != replay.header().finalHash)) {
+        check.firstMismatch = check.ticks;
+    }
+    check.ok = check.firstMismatch < 0;
+    return check;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "pong_sim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Match replays (.pbr). PongSim is deterministic, so a replay is only the config (which holds
+// the serve seed) plus the paddle inputs of every tick. Inputs are packed into a 4 bit mask
+// per tick and stored as runs: each run is a varint of (length - 1) << 4 | (mask XOR previous
+// mask), so a run of up to 8 ticks costs one byte. State hashes every checkpointInterval ticks
+// and at the end let a re-simulation find the first tick where physics changed.
+
+const uint32_t REPLAY_MAGIC = 0x50524250;   // "PBRP" in little endian
+const uint16_t REPLAY_VERSION = 1;
+const int REPLAY_NAME_SIZE = 56;
+const uint32_t REPLAY_CHECKPOINT_INTERVAL = 600;    // Ten seconds at 60 ticks per second
+
+enum ReplayFlags : uint16_t {
+    REPLAY_FLAG_VS_AI = 1u << 0
+};
+
+struct ReplayHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;                 // ReplayFlags
+
+    // PongConfig, field by field so the file doesn't depend on struct layout
+    int32_t screenWidth;
+    int32_t screenHeight;
+    float paddleSpeed;
+    float ballSpeed;
+    float ballRadius;
+    int32_t maxHearts;
+    float dt;
+    float serveJitter;
+    uint32_t seed;
+    uint8_t continuousCollision;
+    uint8_t reserved[3];
+
+    int64_t timestamp;              // Unix time the match was recorded
+    uint32_t tickCount;
+    uint32_t finalHash;             // HashPongState after the last tick
+    uint32_t checkpointInterval;
+    uint32_t checkpointCount;
+    uint32_t runBytes;              // Size of the encoded input runs
+    uint32_t padding;
+    char playerName[REPLAY_NAME_SIZE];      // Right paddle, null terminated
+    char opponentName[REPLAY_NAME_SIZE];    // Left paddle
+};
+
+static_assert(sizeof(ReplayHeader) == 192, "header layout is part of the file format");
+
+// Function to hash a match state (FNV-1a over its bytes)
+uint32_t HashPongState(const PongState& state);
+
+// Collects the inputs of a match while it is played
+class ReplayRecorder {
+public:
+    // Function to start recording a match that begins from PongSim(config).reset()
+    void begin(const PongConfig& config, bool vsAI, const std::string& playerName, const std::string& opponentName);
+
+    // Function to record the inputs of one tick; call after sim.step(inputs) with the new state
+    void record(const PongInputs& inputs, const PongState& state);
+
+    // Function to write the replay; the recorder can keep recording afterwards
+    bool save(const char* path) const;
+
+    uint32_t tickCount() const { return header_.tickCount; }
+    // Encoded size so far, header included
+    size_t byteSize() const;
+
+private:
+    void flushRun(std::vector<uint8_t>& out) const;
+
+    ReplayHeader header_ = {};
+    std::vector<uint32_t> checkpoints_;
+    std::vector<uint8_t> runs_;     // Finished runs
+    uint8_t previousMask_ = 0;      // Mask of the last finished run
+    uint8_t runMask_ = 0;
+    uint32_t runLength_ = 0;        // Ticks in the open run
+};
+
+// A loaded replay
+class Replay {
+public:
+    bool load(const char* path);
+    bool load(const uint8_t* data, size_t size);
+
+    PongConfig config() const;
+    bool vsAI() const { return (header_.flags & REPLAY_FLAG_VS_AI) != 0; }
+    std::string playerName() const { return header_.playerName; }
+    std::string opponentName() const { return header_.opponentName; }
+    uint32_t tickCount() const { return header_.tickCount; }
+    const ReplayHeader& header() const { return header_; }
+    const std::vector<uint32_t>& checkpoints() const { return checkpoints_; }
+
+    // Function to decode every tick's inputs. Returns false if the runs are corrupt.
+    bool decode(std::vector<PongInputs>& inputs) const;
+
+private:
+    friend class ReplayCursor;
+
+    ReplayHeader header_ = {};
+    std::vector<uint32_t> checkpoints_;
+    std::vector<uint8_t> runs_;
+};
+
+// Streams the inputs of a replay one tick at a time
+class ReplayCursor {
+public:
+    explicit ReplayCursor(const Replay& replay);
+
+    // Function to get the next tick's inputs; false at the end (or on corrupt data)
+    bool next(PongInputs& inputs);
+    uint32_t tick() const { return tick_; }
+
+private:
+    const Replay& replay_;
+    size_t offset_ = 0;
+    uint8_t mask_ = 0;
+    uint32_t remaining_ = 0;        // Ticks left in the current run
+    uint32_t tick_ = 0;
+};
+
+struct ReplayCheck {
+    bool ok = false;
+    uint32_t ticks = 0;             // Ticks simulated
+    int64_t firstMismatch = -1;     // Tick of the first checkpoint (or end) that differed, -1 if none
+    uint32_t finalHash = 0;
+    bool playerWon = false;
+};
+
+// Function to re-simulate a replay as fast as possible and compare it with the recorded hashes
+ReplayCheck VerifyReplay(const Replay& replay);
@@ -0,0 +1,212 @@
+#include "result_logger.h"
+
+#include "metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+static MetricHistogram& writeSeconds = Metrics().histogram("pb_result_log_write_seconds",
+    "Time to write (and fsync, when due) one batch of match results", MetricSecondsBuckets());
+static MetricCounter& droppedResults = Metrics().counter("pb_result_log_dropped_total",
+    "Match results dropped because the log queue was full");
+
+static size_t RoundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+static void UpdateMax(atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, memory_order_relaxed)) {}
+}
+
+static bool FileMissing(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return true;
+    fclose(file);
+    return false;
+}
+
+AsyncResultLog::~AsyncResultLog() {
+    shutdown();
+}
+
+void AsyncResultLog::start(const ResultLogSettings& settings) {
+    if (running_) return;
+
+    settings_ = settings;
+    if (settings_.maxBatch == 0) settings_.maxBatch = 1;
+    path_ = settings.path ? settings.path : "";
+    importTextPath_ = settings.importTextPath ? settings.importTextPath : "";
+
+    size_t capacity = RoundUpPowerOfTwo(settings.queueCapacity > 2 ? settings.queueCapacity : 2);
+    ring_.reset(new ResultRecord[capacity]);
+    mask_ = capacity - 1;
+    head_.store(0, memory_order_relaxed);
+    tail_.store(0, memory_order_relaxed);
+    stop_.store(false, memory_order_relaxed);
+    openDone_ = false;
+    openOk_ = false;
+
+    running_ = true;
+    thread_ = thread(&AsyncResultLog::writerLoop, this);
+}
+
+bool AsyncResultLog::push(const ResultRecord& record) {
+    if (!running_) {
+        dropped_.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    size_t head = head_.load(memory_order_relaxed);
+    size_t tail = tail_.load(memory_order_acquire);
+    if (head - tail > mask_) {
+        dropped_.fetch_add(1, memory_order_relaxed);
+        droppedResults.add();
+        return false;
+    }
+
+    ring_[head & mask_] = record;
+    head_.store(head + 1, memory_order_release);
+    queued_.fetch_add(1, memory_order_relaxed);
+
+    size_t depth = head + 1 - tail;
+    if (depth > maxDepth_.load(memory_order_relaxed)) maxDepth_.store(depth, memory_order_relaxed);
+
+    // The writer wakes up on its own every batchDelayMillis; only hurry it when a batch is full
+    if (depth >= settings_.maxBatch) wake_.notify_one();
+    return true;
+}
+
+bool AsyncResultLog::waitUntilOpen() {
+    if (!running_) return false;
+    unique_lock<mutex> lock(wakeMutex_);
+    wake_.wait(lock, [this] { return openDone_; });
+    return openOk_;
+}
+
+void AsyncResultLog::shutdown() {
+    if (!running_) return;
+    {
+        lock_guard<mutex> lock(wakeMutex_);
+        stop_.store(true, memory_order_release);
+    }
+    wake_.notify_one();
+    thread_.join();
+    running_ = false;
+}
+
+ResultLogStats AsyncResultLog::stats() const {
+    ResultLogStats stats;
+    stats.queued = queued_.load(memory_order_relaxed);
+    stats.dropped = dropped_.load(memory_order_relaxed);
+    stats.written = written_.load(memory_order_relaxed);
+    stats.batches = batches_.load(memory_order_relaxed);
+    stats.syncs = syncs_.load(memory_order_relaxed);
+    stats.failedWrites = failedWrites_.load(memory_order_relaxed);
+    stats.depth = head_.load(memory_order_relaxed) - tail_.load(memory_order_relaxed);
+    stats.maxDepth = maxDepth_.load(memory_order_relaxed);
+    stats.lastWriteMicros = lastWriteMicros_.load(memory_order_relaxed);
+    stats.maxWriteMicros = maxWriteMicros_.load(memory_order_relaxed);
+    stats.totalWriteMicros = totalWriteMicros_.load(memory_order_relaxed);
+    return stats;
+}
+
+// Function to move up to maxBatch queued records into batch. Returns how many were taken.
+size_t AsyncResultLog::drain(ResultWriter& writer, ResultRecord* batch) {
+    size_t tail = tail_.load(memory_order_relaxed);
+    size_t head = head_.load(memory_order_acquire);
+    size_t count = head - tail;
+    if (count > settings_.maxBatch) count = settings_.maxBatch;
+
+    for (size_t i = 0; i < count; i++) batch[i] = ring_[(tail + i) & mask_];
+    tail_.store(tail + count, memory_order_release);
+
+    if (count > 0 && writer.isOpen()) writer.append(batch, count);
+    return count;
+}
+
+void AsyncResultLog::writerLoop() {
+    typedef chrono::steady_clock Clock;
+
+    // All file work, including the first open and the text log import, stays on this thread
+    ResultWriter writer(settings_.maxBatch);
+    bool newFile = FileMissing(path_.c_str());
+    bool opened = writer.open(path_.c_str());
+    if (opened) {
+        if (newFile && !importTextPath_.empty()) ImportTextResults(importTextPath_.c_str(), writer);
+        writer.flush();
+    }
+    else {
+        fprintf(stderr, "Error: Could not open %s to log results.\n", path_.c_str());
+    }
+    {
+        lock_guard<mutex> lock(wakeMutex_);
+        openDone_ = true;
+        openOk_ = opened;
+    }
+    wake_.notify_all();
+
+    vector<ResultRecord> batch(settings_.maxBatch);
+    Clock::time_point lastSync = Clock::now();
+    bool unsynced = false;
+
+    for (;;) {
+        bool stopping = stop_.load(memory_order_acquire);
+
+        // Write everything that is queued, one batch at a time
+        size_t count;
+        while ((count = drain(writer, batch.data())) > 0) {
+            Clock::time_point start = Clock::now();
+            bool ok = writer.flush();
+            unsynced = true;
+
+            bool syncNow = settings_.fsyncPolicy == FSYNC_EVERY_BATCH ||
+                (settings_.fsyncPolicy == FSYNC_INTERVAL &&
+                 start - lastSync >= chrono::milliseconds(settings_.fsyncIntervalMillis));
+            if (ok && syncNow) {
+                ok = writer.sync();
+                syncs_.fetch_add(1, memory_order_relaxed);
+                lastSync = Clock::now();
+                unsynced = false;
+            }
+
+            uint64_t micros = (uint64_t)chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+            lastWriteMicros_.store(micros, memory_order_relaxed);
+            UpdateMax(maxWriteMicros_, micros);
+            totalWriteMicros_.fetch_add(micros, memory_order_relaxed);
+            writeSeconds.observe(micros / 1e6);
+            batches_.fetch_add(1, memory_order_relaxed);
+            if (ok) written_.fetch_add(count, memory_order_relaxed);
+            else failedWrites_.fetch_add(1, memory_order_relaxed);
+        }
+
+        // An interval sync that came due while the queue was idle
+        if (unsynced && settings_.fsyncPolicy == FSYNC_INTERVAL && writer.isOpen() &&
+            Clock::now() - lastSync >= chrono::milliseconds(settings_.fsyncIntervalMillis)) {
+            if (!writer.sync()) failedWrites_.fetch_add(1, memory_order_relaxed);
+            syncs_.fetch_add(1, memory_order_relaxed);
+            lastSync = Clock::now();
+            unsynced = false;
+        }
+
+        // stop_ was read before the last drain, so nothing pushed before shutdown() is lost
+        if (stopping) break;
+
+        unique_lock<mutex> lock(wakeMutex_);
+        wake_.wait_for(lock, chrono::milliseconds(settings_.batchDelayMillis), [this] {
+            return stop_.load(memory_order_acquire) ||
+                head_.load(memory_order_acquire) - tail_.load(memory_order_relaxed) >= settings_.maxBatch;
+        });
+    }
+
+    if (unsynced && settings_.fsyncPolicy != FSYNC_NEVER && writer.isOpen()) {
+        writer.sync();
+        syncs_.fetch_add(1, memory_order_relaxed);
+    }
+    writer.close();
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "result_store.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// When the background writer asks the OS to put the result file on disk
+enum FsyncPolicy {
+    FSYNC_NEVER,        // Leave it to the OS
+    FSYNC_EVERY_BATCH,  // After every batch that was written
+    FSYNC_INTERVAL      // At most once per fsyncInterval, if something was written since
+};
+
+struct ResultLogSettings {
+    const char* path = "game_results.bin";
+    const char* importTextPath = nullptr;   // Old text log imported when path doesn't exist yet
+    size_t queueCapacity = 1024;            // Rounded up to a power of two
+    size_t maxBatch = 256;                  // Records written per batch
+    int batchDelayMillis = 50;              // How long the writer waits for more records
+    FsyncPolicy fsyncPolicy = FSYNC_INTERVAL;
+    int fsyncIntervalMillis = 1000;
+};
+
+// Snapshot of the logger counters. Latencies are per batch (write + flush + fsync).
+struct ResultLogStats {
+    uint64_t queued = 0;
+    uint64_t dropped = 0;           // Records pushed while the queue was full
+    uint64_t written = 0;
+    uint64_t batches = 0;
+    uint64_t syncs = 0;
+    uint64_t failedWrites = 0;      // Batch writes and idle syncs that failed (calls, not records)
+    size_t depth = 0;               // Records waiting right now
+    size_t maxDepth = 0;
+    uint64_t lastWriteMicros = 0;
+    uint64_t maxWriteMicros = 0;
+    uint64_t totalWriteMicros = 0;
+};
+
+// Logs match results from one producer thread (the game loop) without touching the disk on
+// that thread. Records go into a lock-free single-producer/single-consumer ring; a background
+// thread opens the file, writes them in batches and fsyncs according to the policy.
+class AsyncResultLog {
+public:
+    AsyncResultLog() = default;
+    ~AsyncResultLog();
+
+    AsyncResultLog(const AsyncResultLog&) = delete;
+    AsyncResultLog& operator=(const AsyncResultLog&) = delete;
+
+    // Function to start the writer thread. Opening the file happens on that thread; if it fails
+    // every record counts as a write error.
+    void start(const ResultLogSettings& settings = ResultLogSettings());
+
+    // Function to block until the writer thread has opened the file (and imported the text
+    // log), so the file can be read back. Returns false if the file couldn't be opened.
+    bool waitUntilOpen();
+
+    // Function to queue a record. Never blocks; returns false (and counts a drop) if the
+    // queue is full or the logger isn't running.
+    bool push(const ResultRecord& record);
+
+    // Function to write out everything queued, fsync and stop the writer thread
+    void shutdown();
+
+    bool running() const { return running_; }
+    ResultLogStats stats() const;
+
+private:
+    void writerLoop();
+    size_t drain(ResultWriter& writer, ResultRecord* batch);
+
+    ResultLogSettings settings_;
+    std::string path_;
+    std::string importTextPath_;
+    std::unique_ptr<ResultRecord[]> ring_;
+    size_t mask_ = 0;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<size_t> head_{0};   // Next slot to write, owned by the producer
+    alignas(64) std::atomic<size_t> tail_{0};   // Next slot to read, owned by the writer thread
+    alignas(64) std::atomic<bool> stop_{false};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool running_ = false;
+    bool openDone_ = false;         // Guarded by wakeMutex_
+    bool openOk_ = false;
+
+    std::atomic<uint64_t> queued_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> failedWrites_{0};
+    std::atomic<size_t> maxDepth_{0};
+    std::atomic<uint64_t> lastWriteMicros_{0};
+    std::atomic<uint64_t> maxWriteMicros_{0};
+    std::atomic<uint64_t> totalWriteMicros_{0};
+};
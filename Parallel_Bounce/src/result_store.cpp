@@ -0,0 +1,253 @@
+#include "result_store.h"
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char* modeNames[RESULT_MODE_COUNT] = { "AI vs Player", "Multiplayer" };
+
+const char* ResultModeName(uint8_t mode) {
+    return mode < RESULT_MODE_COUNT ? modeNames[mode] : "Unknown";
+}
+
+bool ParseResultMode(const string& name, uint8_t& mode) {
+    for (uint8_t i = 0; i < RESULT_MODE_COUNT; i++) {
+        if (name == modeNames[i]) {
+            mode = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+ResultRecord MakeResultRecord(uint8_t mode, const string& winner, const string& loser, int64_t timestamp) {
+    ResultRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = timestamp;
+    record.mode = mode;
+    record.winnerLength = (uint8_t)(winner.size() < (size_t)RESULT_NAME_SIZE ? winner.size() : RESULT_NAME_SIZE);
+    record.loserLength = (uint8_t)(loser.size() < (size_t)RESULT_NAME_SIZE ? loser.size() : RESULT_NAME_SIZE);
+    memcpy(record.winner, winner.data(), record.winnerLength);
+    memcpy(record.loser, loser.data(), record.loserLength);
+    return record;
+}
+
+string ResultWinner(const ResultRecord& record) {
+    return string(record.winner, record.winnerLength);
+}
+
+string ResultLoser(const ResultRecord& record) {
+    return string(record.loser, record.loserLength);
+}
+
+bool ParseTextResultLine(const string& line, ResultRecord& record) {
+    const string modeTag = "Mode: ";
+    const string timeTag = " | Date & Time: ";
+    const string winnerTag = " | Winner: ";
+
+    size_t timePos = line.find(timeTag);
+    size_t winnerPos = line.find(winnerTag);
+    if (line.compare(0, modeTag.size(), modeTag) != 0 || timePos == string::npos ||
+        winnerPos == string::npos || winnerPos < timePos) {
+        return false;
+    }
+
+    uint8_t mode;
+    if (!ParseResultMode(line.substr(modeTag.size(), timePos - modeTag.size()), mode)) return false;
+
+    struct tm timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    string timeText = line.substr(timePos + timeTag.size(), winnerPos - timePos - timeTag.size());
+    if (sscanf(timeText.c_str(), "%d-%d-%d %d:%d:%d", &timeInfo.tm_year, &timeInfo.tm_mon, &timeInfo.tm_mday,
+        &timeInfo.tm_hour, &timeInfo.tm_min, &timeInfo.tm_sec) != 6) {
+        return false;
+    }
+    timeInfo.tm_year -= 1900;
+    timeInfo.tm_mon -= 1;
+    timeInfo.tm_isdst = -1;
+
+    string winner = line.substr(winnerPos + winnerTag.size());
+    while (!winner.empty() && (winner.back() == '\r' || winner.back() == '\n')) winner.pop_back();
+    if (winner.empty()) return false;
+
+    record = MakeResultRecord(mode, winner, "", (int64_t)mktime(&timeInfo));
+    return true;
+}
+
+// Function to get the size of an open file (64-bit, result files can pass 2 GB)
+static int64_t FileSize(FILE* file) {
+    fflush(file);
+#ifdef _WIN32
+    struct _stat64 info;
+    return _fstat64(_fileno(file), &info) == 0 ? (int64_t)info.st_size : -1;
+#else
+    struct stat info;
+    return fstat(fileno(file), &info) == 0 ? (int64_t)info.st_size : -1;
+#endif
+}
+
+static bool TruncateFile(FILE* file, int64_t size) {
+    fflush(file);
+#ifdef _WIN32
+    return _chsize_s(_fileno(file), size) == 0;
+#else
+    return ftruncate(fileno(file), (off_t)size) == 0;
+#endif
+}
+
+ResultWriter::ResultWriter(size_t groupSize) : groupSize_(groupSize > 0 ? groupSize : 1) {
+    buffer_.reserve(groupSize_);
+}
+
+ResultWriter::~ResultWriter() {
+    close();
+}
+
+bool ResultWriter::open(const char* path) {
+    close();
+
+    FILE* file = fopen(path, "ab+");
+    if (!file) return false;
+
+    // Check the header of an existing file, or write one to a new file. A header cut short by a
+    // crash during the first write holds no records yet, so that file starts over.
+    int64_t size = FileSize(file);
+    if (size > 0 && size < (int64_t)sizeof(ResultFileHeader)) {
+        if (!TruncateFile(file, 0)) {
+            fclose(file);
+            return false;
+        }
+        size = 0;
+    }
+    if (size > 0) {
+        ResultFileHeader header;
+        fseek(file, 0, SEEK_SET);
+        bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == RESULT_FILE_MAGIC &&
+            header.version == RESULT_FILE_VERSION && header.recordSize == sizeof(ResultRecord) &&
+            header.headerSize == sizeof(ResultFileHeader);
+
+        // Drop the tail of a record cut short by a crash, so new records stay aligned
+        if (valid) {
+            int64_t records = (size - (int64_t)header.headerSize) / (int64_t)sizeof(ResultRecord);
+            int64_t aligned = (int64_t)header.headerSize + records * (int64_t)sizeof(ResultRecord);
+            if (aligned != size) valid = TruncateFile(file, aligned);
+        }
+        if (!valid) {
+            fclose(file);
+            return false;
+        }
+    }
+    else {
+        ResultFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = RESULT_FILE_MAGIC;
+        header.version = RESULT_FILE_VERSION;
+        header.recordSize = sizeof(ResultRecord);
+        header.headerSize = sizeof(ResultFileHeader);
+        if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+            fclose(file);
+            return false;
+        }
+    }
+
+    file_ = file;
+    return true;
+}
+
+void ResultWriter::close() {
+    if (!file_) return;
+    flush();
+    fclose(file_);
+    file_ = nullptr;
+}
+
+void ResultWriter::append(const ResultRecord& record) {
+    buffer_.push_back(record);
+    if (buffer_.size() >= groupSize_) flush();
+}
+
+void ResultWriter::append(const ResultRecord* records, size_t count) {
+    // Large batches skip the buffer and go straight to the file
+    if (count >= groupSize_) {
+        flush();
+        if (file_ && fwrite(records, sizeof(ResultRecord), count, file_) != count) writeError_ = true;
+        return;
+    }
+    for (size_t i = 0; i < count; i++) append(records[i]);
+}
+
+bool ResultWriter::flush() {
+    if (!file_) return false;
+    bool ok = !writeError_;
+    writeError_ = false;
+    if (!buffer_.empty()) {
+        ok = fwrite(buffer_.data(), sizeof(ResultRecord), buffer_.size(), file_) == buffer_.size();
+        buffer_.clear();
+    }
+    return fflush(file_) == 0 && ok;
+}
+
+bool ResultWriter::sync() {
+    if (!flush()) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file_)) == 0;
+#else
+    return fsync(fileno(file_)) == 0;
+#endif
+}
+
+int ImportTextResults(const char* textPath, ResultWriter& writer, int* skipped) {
+    ifstream inFile(textPath);
+    if (!inFile.is_open()) return -1;
+
+    string line;
+    int imported = 0;
+    int bad = 0;
+    while (getline(inFile, line)) {
+        if (line.empty() || line == "\r") continue;
+
+        ResultRecord record;
+        if (ParseTextResultLine(line, record)) {
+            writer.append(record);
+            imported++;
+        }
+        else {
+            bad++;
+        }
+    }
+
+    if (skipped) *skipped = bad;
+    return imported;
+}
+
+bool ResultReader::open(const char* path) {
+    close();
+    if (!file_.open(path)) return false;
+
+    if (file_.size() < sizeof(ResultFileHeader)) {
+        close();
+        return false;
+    }
+
+    ResultFileHeader header;
+    memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != RESULT_FILE_MAGIC || header.version != RESULT_FILE_VERSION ||
+        header.recordSize != sizeof(ResultRecord) || header.headerSize != sizeof(ResultFileHeader)) {
+        close();
+        return false;
+    }
+
+    records_ = (const ResultRecord*)(file_.data() + header.headerSize);
+    count_ = (file_.size() - header.headerSize) / sizeof(ResultRecord);
+    return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Match history file (game_results.bin): a 32 byte header followed by fixed 128 byte records,
+// appended in groups. Replaces the text log game_results.txt.
+
+const uint32_t RESULT_FILE_MAGIC = 0x53524250; // "PBRS" in little endian
+const uint16_t RESULT_FILE_VERSION = 1;
+const int RESULT_NAME_SIZE = 56;               // Player names are limited to 49 bytes of UTF-8
+
+enum ResultMode : uint8_t {
+    RESULT_MODE_AI = 0,             // "AI vs Player"
+    RESULT_MODE_MULTIPLAYER = 1,    // "Multiplayer"
+    RESULT_MODE_COUNT
+};
+
+struct ResultFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t headerSize;
+    uint32_t reserved[5];
+};
+
+struct ResultRecord {
+    int64_t timestamp;              // Unix time in seconds
+    uint8_t mode;                   // ResultMode
+    uint8_t winnerLength;
+    uint8_t loserLength;            // 0 when unknown (records converted from the text log)
+    uint8_t flags;                  // Reserved, 0
+    uint32_t reserved;
+    char winner[RESULT_NAME_SIZE];  // Not null terminated, see winnerLength
+    char loser[RESULT_NAME_SIZE];
+};
+
+static_assert(sizeof(ResultFileHeader) == 32, "header layout is part of the file format");
+static_assert(sizeof(ResultRecord) == 128, "record layout is part of the file format");
+
+const char* ResultModeName(uint8_t mode);
+bool ParseResultMode(const std::string& name, uint8_t& mode);
+
+// Function to fill a record; names longer than RESULT_NAME_SIZE are cut
+ResultRecord MakeResultRecord(uint8_t mode, const std::string& winner, const std::string& loser, int64_t timestamp);
+std::string ResultWinner(const ResultRecord& record);
+std::string ResultLoser(const ResultRecord& record);
+
+// Function to parse one line of the old text log:
+// "Mode: AI vs Player | Date & Time: 2025-01-13 12:53:40 | Winner: AI" (date is local time)
+bool ParseTextResultLine(const std::string& line, ResultRecord& record);
+
+// Appends records to a result file, buffering them and writing groupSize records at a time
+class ResultWriter {
+public:
+    explicit ResultWriter(size_t groupSize = 64);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // Function to open (or create) a result file for appending. Fails if the file exists but
+    // isn't a result file of this version.
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    void append(const ResultRecord& record);
+    void append(const ResultRecord* records, size_t count);
+
+    // Function to write out buffered records. Returns false on a write error.
+    bool flush();
+    // Function to flush and ask the OS to put the file on disk (fsync)
+    bool sync();
+
+    size_t buffered() const { return buffer_.size(); }
+
+private:
+    FILE* file_ = nullptr;
+    size_t groupSize_;
+    std::vector<ResultRecord> buffer_;
+    bool writeError_ = false;       // A direct batch write failed; reported by the next flush
+};
+
+// Function to append every line of an old text log to writer. Returns the number of records
+// imported (-1 if the text file can't be opened); skipped lines are counted in skipped.
+int ImportTextResults(const char* textPath, ResultWriter& writer, int* skipped = nullptr);
+
+// Memory-mapped read access to a result file
+class ResultReader {
+public:
+    // Function to map a result file and check its header
+    bool open(const char* path);
+    void close() { file_.close(); records_ = nullptr; count_ = 0; }
+
+    // A record cut short by a crash at the end of the file is not counted
+    size_t count() const { return count_; }
+    const ResultRecord* records() const { return records_; }
+    const ResultRecord& operator[](size_t i) const { return records_[i]; }
+
+private:
+    MappedFile file_;
+    const ResultRecord* records_ = nullptr;
+    size_t count_ = 0;
+};
@@ -0,0 +1,94 @@
+#include "scene.h"
+
+#include "profiler.h"
+
+#include <utility>
+
+using namespace std;
+
+void SceneStack::push(unique_ptr<Scene> scene) {
+    changes_.push_back({ CHANGE_PUSH, move(scene) });
+}
+
+void SceneStack::pop() {
+    changes_.push_back({ CHANGE_POP, nullptr });
+}
+
+void SceneStack::replace(unique_ptr<Scene> scene) {
+    pop();
+    push(move(scene));
+}
+
+void SceneStack::clear() {
+    changes_.push_back({ CHANGE_CLEAR, nullptr });
+}
+
+void SceneStack::closeAll() {
+    if (top()) top()->leave();
+    changes_.clear();
+    prepared_.clear();
+    while (!scenes_.empty()) scenes_.pop_back();    // Top first, the way they were opened
+}
+
+void SceneStack::prepare(const string& name, unique_ptr<Scene> scene) {
+    for (PreparedScene& prepared : prepared_) {
+        if (prepared.name == name) {
+            prepared.scene = move(scene);
+            prepared.warm = false;
+            return;
+        }
+    }
+    prepared_.push_back({ name, move(scene), false });
+}
+
+unique_ptr<Scene> SceneStack::takePrepared(const string& name) {
+    for (size_t i = 0; i < prepared_.size(); i++) {
+        if (prepared_[i].name == name) {
+            unique_ptr<Scene> scene = move(prepared_[i].scene);
+            prepared_.erase(prepared_.begin() + i);
+            return scene;
+        }
+    }
+    return nullptr;
+}
+
+bool SceneStack::isPrepared(const string& name) const {
+    for (const PreparedScene& prepared : prepared_) {
+        if (prepared.name == name) return true;
+    }
+    return false;
+}
+
+void SceneStack::update(float dt) {
+    applyChanges();
+    if (!scenes_.empty()) scenes_.back()->update(dt);
+}
+
+void SceneStack::draw() {
+    if (!scenes_.empty()) scenes_.back()->draw();
+}
+
+void SceneStack::applyChanges() {
+    // The top scene leaves once and whatever is on top after all of this frame's changes is
+    // entered once, so a replace (pop + push) doesn't briefly enter the scene underneath
+    if (!changes_.empty()) {
+        if (top()) top()->leave();
+        for (Change& change : changes_) {
+            if (change.type == CHANGE_PUSH) scenes_.push_back(move(change.scene));
+            else if (change.type == CHANGE_POP && !scenes_.empty()) scenes_.pop_back();
+            else if (change.type == CHANGE_CLEAR) scenes_.clear();
+        }
+        changes_.clear();
+        if (top()) top()->enter();
+    }
+}
+
+void SceneStack::warmUpPrepared() {
+    // One slice per frame for the first prepared scene that still has work
+    for (PreparedScene& prepared : prepared_) {
+        if (prepared.warm) continue;
+        PROFILE_SCOPE("scene warm-up");
+        prepared.warm = prepared.scene->warmUp();
+        break;
+    }
+}
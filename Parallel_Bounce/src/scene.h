@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Screens of the game (menu, name entry, match, game over, ...) as scenes on a stack. One main
+// loop updates and draws the top scene every frame; a scene opens the next one by pushing it
+// (the menu stays underneath with everything it loaded) or replacing itself with it. Changes
+// requested during a frame take effect at the start of the next one, so a scene is never
+// deleted during its own update or draw.
+//
+// A scene can also be prepared ahead of time: the stack gives it a warmUp() slice after each
+// frame while another scene is shown, and whoever opens it later takes it ready to go.
+
+class Scene {
+public:
+    virtual ~Scene() {}
+
+    // Function to read input and advance the scene by dt seconds (before BeginDrawing)
+    virtual void update(float dt) = 0;
+    // Function to draw the scene (between BeginDrawing and EndDrawing)
+    virtual void draw() = 0;
+
+    // Called when the scene becomes the top one: when pushed, and when the scene above it is popped
+    virtual void enter() {}
+    // Called when another scene goes on top of it or it is removed
+    virtual void leave() {}
+
+    // Function to do a small part of the scene's setup while it is prepared but not shown.
+    // Returns true when there is nothing left to do.
+    virtual bool warmUp() { return true; }
+};
+
+class SceneStack {
+public:
+    // Transitions, applied before the next update in the order they were requested
+    void push(std::unique_ptr<Scene> scene);
+    void pop();
+    void replace(std::unique_ptr<Scene> scene);     // pop() then push()
+    void clear();
+    // Function to remove every scene, prepared ones too, right away (at shutdown, while the
+    // window and the assets they hold are still there)
+    void closeAll();
+
+    // Function to keep a scene warming up under a name until takePrepared(name). Replaces a
+    // scene prepared under the same name.
+    void prepare(const std::string& name, std::unique_ptr<Scene> scene);
+    // Function to take a prepared scene, warm or not; null if there is none by that name
+    std::unique_ptr<Scene> takePrepared(const std::string& name);
+    bool isPrepared(const std::string& name) const;
+
+    // Function to apply the requested transitions, then update the top scene
+    void update(float dt);
+    // Function to draw the top scene
+    void draw();
+    // Function to give the first prepared scene that isn't warm yet its slice. Called after
+    // draw() and before EndDrawing, so the slice counts in the frame's work time.
+    void warmUpPrepared();
+
+    bool empty() const { return scenes_.empty() && changes_.empty(); }
+    Scene* top() const { return scenes_.empty() ? nullptr : scenes_.back().get(); }
+    size_t depth() const { return scenes_.size(); }
+
+private:
+    void applyChanges();
+
+    enum ChangeType { CHANGE_PUSH, CHANGE_POP, CHANGE_CLEAR };
+
+    struct Change {
+        ChangeType type;
+        std::unique_ptr<Scene> scene;
+    };
+
+    struct PreparedScene {
+        std::string name;
+        std::unique_ptr<Scene> scene;
+        bool warm;
+    };
+
+    std::vector<std::unique_ptr<Scene>> scenes_;
+    std::vector<Change> changes_;
+    std::vector<PreparedScene> prepared_;
+};
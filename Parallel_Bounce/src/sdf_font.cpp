@@ -0,0 +1,68 @@
+#include "sdf_font.h"
+
+#include <cstdio>
+
+using namespace std;
+
+bool SdfFontFile::open(const char* path) {
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(SdfFontHeader)) {
+        file_.close();
+        return false;
+    }
+
+    const unsigned char* data = file_.data();
+    const size_t size = file_.size();
+    const SdfFontHeader* header = (const SdfFontHeader*)data;
+
+    bool valid = header->magic == SDF_FONT_MAGIC && header->version == SDF_FONT_VERSION &&
+        header->headerSize == sizeof(SdfFontHeader) && header->glyphCount > 0 && header->glyphOffset % 4 == 0 &&
+        header->glyphOffset >= sizeof(SdfFontHeader) &&
+        (uint64_t)header->glyphOffset + (uint64_t)header->glyphCount * sizeof(SdfGlyphRecord) <= header->pixelOffset &&
+        (uint64_t)header->pixelOffset + (uint64_t)header->atlasWidth * header->atlasHeight <= size &&
+        header->baseSize > 0;
+    if (!valid) {
+        file_.close();
+        return false;
+    }
+
+    // Glyph rectangles must lie inside the atlas, or drawing would sample outside it
+    const SdfGlyphRecord* glyphs = (const SdfGlyphRecord*)(data + header->glyphOffset);
+    for (uint32_t i = 0; i < header->glyphCount; i++) {
+        const SdfGlyphRecord& glyph = glyphs[i];
+        if (glyph.x + glyph.width > header->atlasWidth || glyph.y + glyph.height > header->atlasHeight) {
+            file_.close();
+            return false;
+        }
+    }
+
+    header_ = header;
+    glyphs_ = glyphs;
+    pixels_ = data + header->pixelOffset;
+    return true;
+}
+
+void SdfFontFile::close() {
+    file_.close();
+    header_ = nullptr;
+    glyphs_ = nullptr;
+    pixels_ = nullptr;
+}
+
+bool WriteSdfFont(const char* path, SdfFontHeader header, const vector<SdfGlyphRecord>& glyphs, const unsigned char* pixels) {
+    header.magic = SDF_FONT_MAGIC;
+    header.version = SDF_FONT_VERSION;
+    header.headerSize = sizeof(SdfFontHeader);
+    header.glyphCount = (uint32_t)glyphs.size();
+    header.glyphOffset = sizeof(SdfFontHeader);
+    header.pixelOffset = header.glyphOffset + header.glyphCount * sizeof(SdfGlyphRecord);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    size_t pixelBytes = (size_t)header.atlasWidth * header.atlasHeight;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(glyphs.data(), sizeof(SdfGlyphRecord), glyphs.size(), file) == glyphs.size() &&
+        fwrite(pixels, 1, pixelBytes, file) == pixelBytes;
+    return fclose(file) == 0 && written;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Baked font file (.sdff), written by tools/font_bake from a TTF: a 48 byte header, the glyph
+// table sorted by codepoint, then the atlas as one byte per pixel. Each pixel is a signed
+// distance to the glyph outline (onEdgeValue on the outline, higher inside), so one atlas
+// renders sharp text at any size with a small shader. The layout can be used straight from a
+// memory mapping: no parsing, and the pixels go to the GPU without a copy.
+
+const uint32_t SDF_FONT_MAGIC = 0x46534250;  // "PBSF" in little endian
+const uint16_t SDF_FONT_VERSION = 1;
+
+struct SdfFontHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t glyphCount;
+    uint32_t glyphOffset;           // Byte offset of the glyph table (4 byte aligned)
+    uint32_t pixelOffset;           // Byte offset of the atlas pixels
+    uint16_t baseSize;              // Pixel size the glyphs were rendered at
+    uint16_t glyphPadding;          // Free pixels around each glyph rectangle in the atlas
+    uint16_t atlasWidth;
+    uint16_t atlasHeight;
+    uint8_t onEdgeValue;            // Distance value on the outline
+    uint8_t reserved8[3];
+    float pixelDistScale;           // Distance values per pixel
+    uint32_t reserved[3];
+};
+
+struct SdfGlyphRecord {
+    int32_t codepoint;
+    uint16_t x, y;                  // Rectangle in the atlas
+    uint16_t width, height;
+    int16_t offsetX, offsetY;       // Rectangle's offset from the pen position, at baseSize
+    int16_t advanceX;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(SdfFontHeader) == 48, "header layout is part of the file format");
+static_assert(sizeof(SdfGlyphRecord) == 20, "glyph layout is part of the file format");
+
+// Read-only view of a baked font file
+class SdfFontFile {
+public:
+    // Function to map a font file and check it. Fails if it isn't a font file of this version
+    // or a table points outside the file.
+    bool open(const char* path);
+    void close();
+
+    const SdfFontHeader& header() const { return *header_; }
+    const SdfGlyphRecord* glyphs() const { return glyphs_; }
+    const unsigned char* pixels() const { return pixels_; }
+    bool isOpen() const { return header_ != nullptr; }
+
+private:
+    MappedFile file_;
+    const SdfFontHeader* header_ = nullptr;
+    const SdfGlyphRecord* glyphs_ = nullptr;
+    const unsigned char* pixels_ = nullptr;
+};
+
+// Function to write a font file. Fills in magic, version, sizes and offsets of the header;
+// glyphs must be sorted by codepoint and pixels hold atlasWidth * atlasHeight bytes.
+bool WriteSdfFont(const char* path, SdfFontHeader header, const std::vector<SdfGlyphRecord>& glyphs, const unsigned char* pixels);
@@ -0,0 +1,224 @@
+#include "sim_thread.h"
+
+#include "metrics.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+// Ticks the thread runs back to back to catch up after a stall; beyond that it skips ahead
+static const int SIM_MAX_CATCH_UP_TICKS = 8;
+
+// Tick times, 1 us to 10 ms (a tick of the search AI takes a couple of milliseconds)
+static MetricHistogram& tickSeconds = Metrics().histogram("pb_sim_tick_seconds", "Time to simulate one tick, AI included",
+    { 0.000001, 0.0000025, 0.000005, 0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01 });
+static MetricHistogram& rallyLength = Metrics().histogram("pb_rally_length", "Paddle hits before each point",
+    { 0, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89 });
+
+void RecordSimTickMetrics(uint64_t nanos, uint32_t events, const PongState& before) {
+    tickSeconds.observe(nanos / 1e9);
+    if (events & (PONG_EVENT_PLAYER_SCORED | PONG_EVENT_OPPONENT_SCORED)) rallyLength.observe(before.rally);
+}
+
+uint64_t SimClockNanos() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencySamples::add(double micros) {
+    samples_[total_ % CAPACITY] = (float)micros;
+    total_++;
+}
+
+double LatencySamples::percentile(double p) const {
+    size_t n = count();
+    if (n == 0) return 0.0;
+    float sorted[CAPACITY];
+    copy(samples_, samples_ + n, sorted);
+    size_t index = min(n - 1, (size_t)(p / 100.0 * n));
+    nth_element(sorted, sorted + index, sorted + n);
+    return sorted[index];
+}
+
+SimThread::SimThread(const PongConfig& config, PongAI* ai, ReplayRecorder* recorder, MctsAI* search)
+    : sim_(config), ai_(ai), recorder_(recorder), search_(search), tickNanos_((uint64_t)llround(config.dt * 1e9)) {
+    SimSnapshot& first = snapshots_.writeSlot();
+    first.previous = sim_.state();
+    first.current = sim_.state();
+    first.currentNanos = SimClockNanos();
+    first.inputSequence = 0;
+    if (ai_) first.ai = ai_->save();
+    first.over = false;
+    snapshots_.publish();
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::restore(const PongState& state) {
+    sim_.restore(state);
+    SimSnapshot& first = snapshots_.writeSlot();
+    first.previous = state;
+    first.current = state;
+    first.currentNanos = SimClockNanos();
+    first.inputSequence = 0;
+    if (ai_) first.ai = ai_->save();
+    first.over = sim_.isOver();
+    snapshots_.publish();
+}
+
+void SimThread::start() {
+    stopping_ = false;
+    thread_ = thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    {
+        lock_guard<mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+uint32_t SimThread::setInputs(PongInputs inputs) {
+    uint32_t sequence = ++nextSequence_;
+    uint64_t packed = ((uint64_t)sequence << 32) | ((uint64_t)(uint8_t)inputs.player << 8) | (uint8_t)inputs.opponent;
+    inputs_.store(packed, memory_order_release);
+    // No lock, so the frame never waits on the thread. A wakeup that comes just before the thread
+    // goes to sleep is lost, and the tick runs on schedule instead of early.
+    wake_.notify_one();
+    return sequence;
+}
+
+const SimSnapshot& SimThread::latest() {
+    snapshots_.refresh();
+    return snapshots_.readSlot();
+}
+
+void SimThread::run() {
+    SetProfilerThreadName("simulation");
+
+    // Ticks follow an absolute schedule, so sleeping late doesn't make the match run slow
+    uint64_t next = SimClockNanos() + tickNanos_;
+    uint32_t consumed = 0;      // Input sequence the last tick used
+    while (!stopping_.load(memory_order_relaxed) && !sim_.isOver()) {
+        // Sleep until the next tick is due. Once it is at most a tick away, new inputs wake the
+        // thread and it runs early; it keeps its slot, so match time is never more than a tick
+        // ahead of the schedule.
+        this_thread::sleep_until(chrono::steady_clock::time_point(chrono::nanoseconds(next - tickNanos_)));
+        {
+            unique_lock<mutex> lock(wakeMutex_);
+            wake_.wait_until(lock, chrono::steady_clock::time_point(chrono::nanoseconds(next)), [&]() {
+                return stopping_.load(memory_order_relaxed) || (uint32_t)(inputs_.load(memory_order_acquire) >> 32) != consumed;
+            });
+        }
+        if (stopping_.load(memory_order_relaxed)) break;
+
+        uint64_t now = SimClockNanos();
+        if (now > next + tickNanos_ * SIM_MAX_CATCH_UP_TICKS) {
+            // Stalled for longer than it's worth catching up on (e.g. the machine was suspended)
+            uint64_t behind = (now - next) / tickNanos_;
+            stats_.droppedTicks += behind;
+            next += behind * tickNanos_;
+        }
+
+        // Run every tick that is due (or the next one, woken early), then publish only the newest state
+        PongState previous = sim_.state();
+        uint32_t sequence = 0;
+        int ran = 0;
+        bool early = now < next;
+        while ((next <= now || early) && !sim_.isOver()) {
+            early = false;
+            PROFILE_SCOPE("sim tick");
+            uint64_t tickStart = SimClockNanos();
+            uint64_t packed = inputs_.load(memory_order_acquire);
+            sequence = (uint32_t)(packed >> 32);
+            consumed = sequence;
+            PongInputs inputs;
+            inputs.player = (int8_t)(uint8_t)(packed >> 8);
+            inputs.opponent = (int8_t)(uint8_t)packed;
+            if (search_) inputs.opponent = search_->decide(sim_.state(), sim_.config());
+            else if (ai_) inputs.opponent = ai_->decide(sim_.state(), sim_.config());
+
+            previous = sim_.state();
+            uint32_t events = sim_.step(inputs);
+            if (recorder_) recorder_->record(inputs, sim_.state());
+            RecordSimTickMetrics(SimClockNanos() - tickStart, events, previous);
+
+            if (ran > 0) stats_.lateTicks++;
+            uint64_t late = now > next ? now - next : 0;
+            if (late > stats_.maxLateNanos) stats_.maxLateNanos = late;
+            stats_.ticks++;
+            ran++;
+            next += tickNanos_;
+        }
+        if (ran == 0) continue;
+
+        SimSnapshot& snapshot = snapshots_.writeSlot();
+        snapshot.previous = previous;
+        snapshot.current = sim_.state();
+        snapshot.currentNanos = next - tickNanos_;
+        snapshot.inputSequence = sequence;
+        if (ai_) snapshot.ai = ai_->save();
+        snapshot.over = sim_.isOver();
+        snapshots_.publish();
+    }
+}
+
+float SnapshotAlpha(const SimSnapshot& snapshot, uint64_t nanos, uint64_t tickNanos) {
+    double alpha = 1.0 + ((double)nanos - (double)snapshot.currentNanos) / tickNanos;
+    return (float)(alpha < 0.0 ? 0.0 : (alpha > 2.0 ? 2.0 : alpha));
+}
+
+static SimRect LerpRect(const SimRect& a, const SimRect& b, float t) {
+    return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, b.width, b.height };
+}
+
+PongInputs LastPaddleMoves(const PongState& previous, const PongState& current) {
+    PongInputs moves;
+    moves.player = (int8_t)((current.playerPaddle.y > previous.playerPaddle.y) - (current.playerPaddle.y < previous.playerPaddle.y));
+    moves.opponent = (int8_t)((current.opponentPaddle.y > previous.opponentPaddle.y) - (current.opponentPaddle.y < previous.opponentPaddle.y));
+    return moves;
+}
+
+PongState InterpolatePongState(const PongState& previous, const PongState& current, float alpha, const PongConfig& config,
+    PongInputs moves) {
+    PongState blended = current;
+    if (alpha < 0.0f) alpha = 0.0f;
+
+    if (alpha > 1.0f) {
+        // PongSim::step for the part of a tick past current, paddle hits aside (a tick is short
+        // enough that the ball overlaps a paddle by a pixel or two at most)
+        const float screenHeight = (float)config.screenHeight;
+        const float seconds = (alpha > 2.0f ? 1.0f : alpha - 1.0f) * config.dt;
+        SimRect* paddles[2] = { &blended.playerPaddle, &blended.opponentPaddle };
+        const int8_t directions[2] = { moves.player, moves.opponent };
+        for (int i = 0; i < 2; i++) {
+            float y = paddles[i]->y + config.paddleSpeed * seconds * (float)((directions[i] > 0) - (directions[i] < 0));
+            float lowest = screenHeight - paddles[i]->height;
+            paddles[i]->y = y < 0.0f ? 0.0f : (y > lowest ? lowest : y);
+        }
+
+        // The ball's center reflects at y = 0 and y = screenHeight; one reflection is all a tick has room for
+        const SimVec2& velocity = current.ballSpeedVector;
+        SimVec2& ball = blended.ballPosition;
+        ball.x += velocity.x * seconds;
+        ball.y += velocity.y * seconds;
+        if (ball.y < 0.0f && velocity.y < 0.0f) ball.y = -ball.y;
+        else if (ball.y > screenHeight && velocity.y > 0.0f) ball.y = 2.0f * screenHeight - ball.y;
+        return blended;
+    }
+
+    blended.playerPaddle = LerpRect(previous.playerPaddle, current.playerPaddle, alpha);
+    blended.opponentPaddle = LerpRect(previous.opponentPaddle, current.opponentPaddle, alpha);
+    bool served = previous.playerHearts != current.playerHearts || previous.opponentHearts != current.opponentHearts;
+    if (!served) {
+        blended.ballPosition.x = previous.ballPosition.x + (current.ballPosition.x - previous.ballPosition.x) * alpha;
+        blended.ballPosition.y = previous.ballPosition.y + (current.ballPosition.y - previous.ballPosition.y) * alpha;
+    }
+    return blended;
+}
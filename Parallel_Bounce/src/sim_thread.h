@@ -0,0 +1,156 @@
+#pragma once
+
+#include "mcts_ai.h"
+#include "pong_ai.h"
+#include "pong_sim.h"
+#include "replay.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Match simulation on its own thread at a fixed tick rate (240 Hz in the game), decoupled from
+// rendering. The render thread hands over inputs through an atomic, which also lets the next
+// tick run at once instead of on schedule, and takes the newest state from a triple buffer.
+// Neither side ever waits for the other: the frame draws whatever state is newest, interpolated
+// to the moment it draws. A slow frame no longer slows the match down, and a slow tick (the
+// search AI) no longer slows the frame down.
+
+// Nanoseconds on the steady clock, the time base of everything below
+uint64_t SimClockNanos();
+
+// Single producer, single consumer handoff of the newest value. The writer fills its own slot
+// and swaps it with the shared middle one; the reader swaps the middle one for its slot when
+// it holds something new. Neither side ever waits or sees a half-written value.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer: the slot to fill, then publish() it
+    T& writeSlot() { return slots_[writer_]; }
+    void publish() {
+        writer_ = middle_.exchange((uint8_t)(writer_ | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader: take the newest published value if there is one. Returns true if it changed.
+    bool refresh() {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        reader_ = middle_.exchange(reader_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& readSlot() const { return slots_[reader_]; }
+
+private:
+    static const uint8_t INDEX = 3;
+    static const uint8_t FRESH = 4;
+
+    T slots_[3] = {};
+    uint8_t writer_ = 0;
+    std::atomic<uint8_t> middle_{ 1 };
+    uint8_t reader_ = 2;
+};
+
+// What the simulation publishes after every tick
+struct SimSnapshot {
+    PongState previous;         // State one tick earlier, to interpolate from
+    PongState current;
+    uint64_t currentNanos;      // Time the current state belongs to (its tick's slot in the schedule,
+                                // up to a tick ahead of the clock after an early tick)
+    uint32_t inputSequence;     // Newest input the current state includes
+    PongAIState ai;             // The AI as of current (if there is one), for checkpoints
+    bool over;
+};
+
+struct SimThreadStats {
+    uint64_t ticks = 0;
+    uint64_t lateTicks = 0;         // Ticks run more than one tick behind schedule (caught up)
+    uint64_t droppedTicks = 0;      // Ticks skipped after a stall too long to catch up on
+    uint64_t maxLateNanos = 0;
+};
+
+// Latency samples in microseconds, keeping the newest few thousand for percentiles
+class LatencySamples {
+public:
+    void add(double micros);
+    // Function to get a percentile (0..100) of the kept samples; 0 without samples
+    double percentile(double p) const;
+    size_t count() const { return total_ < CAPACITY ? (size_t)total_ : CAPACITY; }
+    void clear() { total_ = 0; }
+
+private:
+    static const size_t CAPACITY = 4096;
+    float samples_[CAPACITY];
+    uint64_t total_ = 0;
+};
+
+class SimThread {
+public:
+    // ai (optional) steers the opponent paddle, recorder (optional) gets every tick; both are
+    // only touched by the simulation thread until stop(). search (optional) steers it instead
+    // of ai, which then only goes into the snapshots.
+    SimThread(const PongConfig& config, PongAI* ai, ReplayRecorder* recorder, MctsAI* search = nullptr);
+    ~SimThread();
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // Function to continue a match from a saved state instead of the start (before start())
+    void restore(const PongState& state);
+    void start();
+    // Function to stop the thread (after the match is over or when the window closes)
+    void stop();
+
+    // Function to hand over the paddle inputs; every tick from now on uses them. Never blocks.
+    // The next tick runs right away if it is due within a tick; the schedule stays as it is, so
+    // the match doesn't speed up. Returns their sequence number, which snapshots report once a
+    // tick has included them. The game calls it at the start of every frame.
+    uint32_t setInputs(PongInputs inputs);
+
+    // Newest snapshot (render thread only). Never blocks; take it as late in the frame as the
+    // drawing allows, so the tick the inputs started has had time to land.
+    const SimSnapshot& latest();
+
+    uint64_t tickNanos() const { return tickNanos_; }
+    // Stats, read after stop()
+    const SimThreadStats& stats() const { return stats_; }
+
+private:
+    void run();
+
+    PongSim sim_;
+    PongAI* ai_;
+    ReplayRecorder* recorder_;
+    MctsAI* search_;
+    uint64_t tickNanos_;
+
+    std::thread thread_;
+    std::atomic<bool> stopping_{ false };
+    std::atomic<uint64_t> inputs_{ 0 };           // Sequence (high 32 bits) and the two inputs (8 bits each)
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;                  // New inputs or stop()
+    uint32_t nextSequence_ = 0;
+    TripleBuffer<SimSnapshot> snapshots_;
+    SimThreadStats stats_;
+};
+
+// Function to add one tick to the metrics (see metrics.h): how long it took, and the rally
+// length when it ended in a point. SimThread calls it; so does anything else stepping a match.
+void RecordSimTickMetrics(uint64_t nanos, uint32_t events, const PongState& before);
+
+// Function to get how far nanos is past a snapshot's previous state, in ticks: 1 at current, more
+// when the simulation is behind the clock, at most 2
+float SnapshotAlpha(const SimSnapshot& snapshot, uint64_t nanos, uint64_t tickNanos);
+
+// Function to get the direction (-1, 0, +1) each paddle moved in from previous to current
+PongInputs LastPaddleMoves(const PongState& previous, const PongState& current);
+
+// Function to get the state alpha ticks after previous, for drawing between ticks. Up to 1 it
+// blends previous and current, snapping to current when a point was scored in between so the
+// ball doesn't streak across the field. Past 1, where the simulation hasn't got to yet, it steps
+// on from current by PongSim's rules for up to a tick: the paddles by moves (the keys just handed
+// over, so a key shows in the frame that read it; the AI's last move), the ball along its
+// velocity with its center reflecting at y = 0 and y = screenHeight.
+PongState InterpolatePongState(const PongState& previous, const PongState& current, float alpha, const PongConfig& config,
+    PongInputs moves);
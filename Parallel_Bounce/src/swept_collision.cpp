@@ -0,0 +1,96 @@
+#include "swept_collision.h"
+
+#include <cmath>
+
+using namespace std;
+
+// Function to test the ray against one flat side of the rounded rectangle.
+// The side lies on axis coordinate planePos and spans [spanMin, spanMax] on the other axis.
+static void SweepSide(float start, float motion, float otherStart, float otherMotion,
+    float planePos, float spanMin, float spanMax, float& bestTime, bool& found) {
+    if (motion == 0.0f) return;
+
+    float t = (planePos - start) / motion;
+    if (t < 0.0f || t > bestTime) return;
+
+    float other = otherStart + otherMotion * t;
+    if (other < spanMin || other > spanMax) return;
+
+    bestTime = t;
+    found = true;
+}
+
+// Function to test the ray against one corner circle of the rounded rectangle
+static bool SweepCorner(SimVec2 start, SimVec2 motion, SimVec2 corner, float radius, float& bestTime) {
+    float mx = start.x - corner.x;
+    float my = start.y - corner.y;
+    float a = motion.x * motion.x + motion.y * motion.y;
+    float b = mx * motion.x + my * motion.y;
+    float c = mx * mx + my * my - radius * radius;
+    if (a == 0.0f || b >= 0.0f) return false; // Not moving towards the corner
+
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+
+    float t = (-b - sqrtf(discriminant)) / a;
+    if (t < 0.0f || t > bestTime) return false;
+
+    bestTime = t;
+    return true;
+}
+
+bool SweepCircleRect(SimVec2 start, SimVec2 motion, float radius, const SimRect& rect, SweepHit& hit) {
+    const float left = rect.x;
+    const float right = rect.x + rect.width;
+    const float top = rect.y;
+    const float bottom = rect.y + rect.height;
+
+    // Quick reject: the box around the whole motion must reach the rectangle grown by the radius
+    float minX = motion.x < 0 ? start.x + motion.x : start.x;
+    float maxX = motion.x < 0 ? start.x : start.x + motion.x;
+    float minY = motion.y < 0 ? start.y + motion.y : start.y;
+    float maxY = motion.y < 0 ? start.y : start.y + motion.y;
+    if (maxX < left - radius || minX > right + radius || maxY < top - radius || minY > bottom + radius) return false;
+
+    if (CircleOverlapsRect(start, radius, rect)) return false;
+
+    float bestTime = 1.0f;
+    bool found = false;
+    SimVec2 normal = { 0.0f, 0.0f };
+
+    // Flat sides, only the ones the ray can enter through
+    if (motion.x > 0.0f) {
+        SweepSide(start.x, motion.x, start.y, motion.y, left - radius, top, bottom, bestTime, found);
+        if (found) normal = { -1.0f, 0.0f };
+    }
+    else if (motion.x < 0.0f) {
+        SweepSide(start.x, motion.x, start.y, motion.y, right + radius, top, bottom, bestTime, found);
+        if (found) normal = { 1.0f, 0.0f };
+    }
+
+    bool sideFound = false;
+    if (motion.y > 0.0f) {
+        SweepSide(start.y, motion.y, start.x, motion.x, top - radius, left, right, bestTime, sideFound);
+        if (sideFound) normal = { 0.0f, -1.0f };
+    }
+    else if (motion.y < 0.0f) {
+        SweepSide(start.y, motion.y, start.x, motion.x, bottom + radius, left, right, bestTime, sideFound);
+        if (sideFound) normal = { 0.0f, 1.0f };
+    }
+    found = found || sideFound;
+
+    // Corner circles
+    const SimVec2 corners[4] = { { left, top }, { right, top }, { left, bottom }, { right, bottom } };
+    for (int i = 0; i < 4; i++) {
+        if (SweepCorner(start, motion, corners[i], radius, bestTime)) {
+            found = true;
+            normal = { (start.x + motion.x * bestTime - corners[i].x) / radius,
+                       (start.y + motion.y * bestTime - corners[i].y) / radius };
+        }
+    }
+
+    if (!found) return false;
+    hit.time = bestTime;
+    hit.normal = normal;
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "pong_sim.h"
+
+// First contact of a moving circle with a rectangle
+struct SweepHit {
+    float time;         // Fraction of the motion travelled before contact, in [0, 1]
+    SimVec2 normal;     // Surface normal at the contact, pointing away from the rectangle
+};
+
+// Function to sweep a circle from start along motion and find where it first touches rect.
+// The rectangle grown by the radius is a rounded rectangle, so the sweep is a ray test against
+// its four flat sides and four corner circles. Returns false when there is no contact in the
+// motion, when the circle already overlaps at the start, or when it is moving away.
+bool SweepCircleRect(SimVec2 start, SimVec2 motion, float radius, const SimRect& rect, SweepHit& hit);
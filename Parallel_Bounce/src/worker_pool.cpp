@@ -0,0 +1,60 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Polls of the job counter before a worker goes to sleep
+static const int POOL_SPIN_POLLS = 4000;
+
+WorkerPool::WorkerPool(int threadCount) : threadCount_(max(threadCount, 1)) {
+    for (int i = 1; i < threadCount_; i++) threads_.emplace_back(&WorkerPool::worker, this, i);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+        generation_.fetch_add(1, memory_order_release);
+    }
+    wake_.notify_all();
+    for (thread& t : threads_) t.join();
+}
+
+void WorkerPool::dispatch(JobFunction function, void* context) {
+    if (threadCount_ == 1) {
+        function(context, 0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(mutex_);
+        function_ = function;
+        context_ = context;
+        pending_.store(threadCount_ - 1, memory_order_relaxed);
+        generation_.fetch_add(1, memory_order_release);
+    }
+    wake_.notify_all();
+
+    // The caller does its share, then waits for the rest
+    function(context, 0);
+    while (pending_.load(memory_order_acquire) != 0) this_thread::yield();
+}
+
+void WorkerPool::worker(int self) {
+    uint64_t seen = 0;
+    for (;;) {
+        // Jobs usually come back to back, so spin a little before sleeping
+        int polls = 0;
+        while (generation_.load(memory_order_acquire) == seen && polls < POOL_SPIN_POLLS) polls++;
+        if (generation_.load(memory_order_acquire) == seen) {
+            unique_lock<mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return generation_.load(memory_order_acquire) != seen; });
+        }
+        seen = generation_.load(memory_order_acquire);
+        if (stopping_) return;
+
+        function_(context_, self);
+        pending_.fetch_sub(1, memory_order_release);
+    }
+}
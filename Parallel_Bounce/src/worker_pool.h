@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Persistent threads for work that comes in short, frequent rounds (environment steps, search
+// decisions), where starting threads or queueing tasks each time would cost more than the work.
+// run() publishes a job by bumping a generation counter and runs it on the calling thread too;
+// the other threads spin briefly on the counter, then sleep until the next job.
+class WorkerPool {
+public:
+    // threadCount includes the caller; 1 runs every job on the caller
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Function to call job(self) once on each thread, the caller being thread 0, and return
+    // when they are all done. job is called through a plain function pointer, so a lambda
+    // with captures doesn't allocate.
+    template <typename Job>
+    void run(Job&& job) {
+        typedef typename std::remove_reference<Job>::type JobType;
+        dispatch([](void* context, int self) { (*static_cast<JobType*>(context))(self); }, &job);
+    }
+
+    int threadCount() const { return threadCount_; }
+
+private:
+    typedef void (*JobFunction)(void* context, int self);
+
+    void dispatch(JobFunction function, void* context);
+    void worker(int self);
+
+    int threadCount_ = 1;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<uint64_t> generation_{ 0 };
+    std::atomic<int> pending_{ 0 };
+    bool stopping_ = false;
+    JobFunction function_ = nullptr;
+    void* context_ = nullptr;
+};
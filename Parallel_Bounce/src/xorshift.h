@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// xorshift32 (Marsaglia, shifts 13/17/5): the small generator behind serve angles, AI errors,
+// particles, search tie-breaks and the like. Fast and deterministic, so replays and rollback
+// resimulate the same numbers; nothing that needs real randomness should use it.
+
+// A state of 0 stays 0 forever; seeds of 0 get this instead
+const uint32_t XORSHIFT_DEFAULT_SEED = 0x9E3779B9u;
+
+inline uint32_t XorShiftSeed(uint32_t seed) {
+    return seed != 0 ? seed : XORSHIFT_DEFAULT_SEED;
+}
+
+// Function to advance the state and return it
+inline uint32_t XorShift32(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Function to get a uniform number in [0, 1) from the top 24 bits of the next state
+inline float XorShiftUnit(uint32_t& state) {
+    return (float)(XorShift32(state) >> 8) * (1.0f / 16777216.0f);
+}
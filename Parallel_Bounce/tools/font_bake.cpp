@@ -0,0 +1,141 @@
+// Bakes TTF fonts into distance field atlas files (.sdff, see src/sdf_font.h) that the game
+// maps at startup instead of parsing and rasterizing the TTF. Each output goes next to its
+// input with the extension replaced. Uses raylib's rasterizer, but opens no window.
+//
+// Usage: font_bake [--size PX] [--padding PX] FONT.ttf...
+
+#include "raylib.h"
+#include "sdf_font.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Values raylib's LoadFontData uses for FONT_SDF glyphs (FONT_SDF_ON_EDGE_VALUE and
+// FONT_SDF_PIXEL_DIST_SCALE in rtext.c), stored in the file for the shader's benefit
+static const int SDF_ON_EDGE_VALUE = 128;
+static const float SDF_PIXEL_DIST_SCALE = 64.0f;
+
+// Function to list the codepoints to bake: printable ASCII and Latin-1, enough for names
+// typed on most European keyboards
+static vector<int> BakedCodepoints() {
+    vector<int> codepoints;
+    for (int c = 32; c < 127; c++) codepoints.push_back(c);
+    for (int c = 160; c < 256; c++) codepoints.push_back(c);
+    return codepoints;
+}
+
+// Function to bake one font. Returns false (and says why) if it can't be read or written.
+static bool BakeFont(const char* ttfPath, int size, int padding) {
+    auto begin = chrono::steady_clock::now();
+
+    int fileSize = 0;
+    unsigned char* fileData = LoadFileData(ttfPath, &fileSize);
+    if (!fileData) {
+        fprintf(stderr, "Error: Could not read %s\n", ttfPath);
+        return false;
+    }
+
+    vector<int> codepoints = BakedCodepoints();
+    GlyphInfo* glyphs = LoadFontData(fileData, fileSize, size, codepoints.data(), (int)codepoints.size(), FONT_SDF);
+    UnloadFileData(fileData);
+    if (!glyphs) {
+        fprintf(stderr, "Error: %s is not a font raylib can read\n", ttfPath);
+        return false;
+    }
+
+    // Skyline packing (method 1), like raylib's distance field example
+    Rectangle* recs = nullptr;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, (int)codepoints.size(), size, padding, 1);
+    bool fits = atlas.data != nullptr && atlas.width <= 65535 && atlas.height <= 65535;
+
+    vector<SdfGlyphRecord> records(codepoints.size());
+    vector<unsigned char> pixels;
+    if (fits) {
+        for (size_t i = 0; i < codepoints.size(); i++) {
+            SdfGlyphRecord& record = records[i];
+            memset(&record, 0, sizeof(record));
+            record.codepoint = glyphs[i].value;
+            record.x = (uint16_t)recs[i].x;
+            record.y = (uint16_t)recs[i].y;
+            record.width = (uint16_t)recs[i].width;
+            record.height = (uint16_t)recs[i].height;
+            record.offsetX = (int16_t)glyphs[i].offsetX;
+            record.offsetY = (int16_t)glyphs[i].offsetY;
+            record.advanceX = (int16_t)glyphs[i].advanceX;
+        }
+
+        // The atlas comes back as gray + alpha with the distance in alpha; keep one byte per pixel
+        ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+        const unsigned char* grayAlpha = (const unsigned char*)atlas.data;
+        pixels.resize((size_t)atlas.width * atlas.height);
+        for (size_t i = 0; i < pixels.size(); i++) pixels[i] = grayAlpha[2 * i + 1];
+    }
+
+    UnloadFontData(glyphs, (int)codepoints.size());
+    MemFree(recs);
+    if (!fits) {
+        UnloadImage(atlas);
+        fprintf(stderr, "Error: Could not build the atlas of %s at %d px\n", ttfPath, size);
+        return false;
+    }
+
+    string outPath = ttfPath;
+    size_t dot = outPath.find_last_of('.');
+    if (dot != string::npos && outPath.find_first_of("/\\", dot) == string::npos) outPath.erase(dot);
+    outPath += ".sdff";
+
+    SdfFontHeader header;
+    memset(&header, 0, sizeof(header));
+    header.baseSize = (uint16_t)size;
+    header.glyphPadding = (uint16_t)padding;
+    header.atlasWidth = (uint16_t)atlas.width;
+    header.atlasHeight = (uint16_t)atlas.height;
+    header.onEdgeValue = (uint8_t)SDF_ON_EDGE_VALUE;
+    header.pixelDistScale = SDF_PIXEL_DIST_SCALE;
+    bool written = WriteSdfFont(outPath.c_str(), header, records, pixels.data());
+    UnloadImage(atlas);
+    if (!written) {
+        fprintf(stderr, "Error: Could not write %s\n", outPath.c_str());
+        return false;
+    }
+
+    double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    printf("%s: %d glyphs at %d px, %dx%d atlas, %.0f KB (%.0f ms)\n", outPath.c_str(), (int)records.size(), size,
+        (int)header.atlasWidth, (int)header.atlasHeight,
+        (sizeof(SdfFontHeader) + records.size() * sizeof(SdfGlyphRecord) + pixels.size()) / 1024.0, millis);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int size = 48;
+    int padding = 2;
+    vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--size") == 0 && hasValue) size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--padding") == 0 && hasValue) padding = atoi(argv[++i]);
+        else if (argv[i][0] != '-') inputs.push_back(argv[i]);
+        else {
+            inputs.clear();
+            break;
+        }
+    }
+    if (inputs.empty() || size < 8 || size > 256 || padding < 0) {
+        fprintf(stderr, "Usage: %s [--size PX] [--padding PX] FONT.ttf...\n", argv[0]);
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    int failed = 0;
+    for (const char* input : inputs) {
+        if (!BakeFont(input, size, padding)) failed++;
+    }
+    return failed == 0 ? 0 : 1;
+}
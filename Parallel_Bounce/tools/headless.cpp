@@ -0,0 +1,57 @@
+// Headless batch runner: plays AI vs AI matches with PongSim on one core, no window or GPU needed.
+//
+// Usage: headless [--matches N] [--seed S] [--jitter RADIANS] [--max-ticks T]
+//                 [--paddle-speed PX] [--ball-speed PX] [--ai easy|normal|hard] [--dt SECONDS]
+
+#include "match_farm.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    MatchSettings settings;
+    int matches = 10000;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--matches") == 0 && hasValue) matches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) settings.seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--jitter") == 0 && hasValue) settings.config.serveJitter = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-ticks") == 0 && hasValue) settings.maxTicks = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--paddle-speed") == 0 && hasValue) settings.config.paddleSpeed = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--ball-speed") == 0 && hasValue) settings.config.ballSpeed = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--dt") == 0 && hasValue) settings.config.dt = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], settings.playerAI)) {
+            settings.opponentAI = settings.playerAI;
+            i++;
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--matches N] [--seed S] [--jitter RADIANS] [--max-ticks T]"
+                " [--paddle-speed PX] [--ball-speed PX] [--ai easy|normal|hard] [--dt SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FarmStats stats;
+    auto start = chrono::steady_clock::now();
+
+    for (int match = 0; match < matches; match++) {
+        PlayMatch(settings, (uint64_t)match, stats);
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    printf("Matches:        %llu\n", (unsigned long long)stats.matches);
+    printf("Player wins:    %llu\n", (unsigned long long)stats.playerWins);
+    printf("Opponent wins:  %llu\n", (unsigned long long)stats.opponentWins);
+    printf("Draws:          %llu (hit the %u tick limit)\n", (unsigned long long)stats.draws, settings.maxTicks);
+    printf("Avg ticks:      %.1f\n", matches > 0 ? (double)stats.totalTicks / matches : 0.0);
+    printf("Time:           %.3f s\n", seconds);
+    printf("Matches/sec:    %.0f\n", matches / seconds);
+    printf("Ticks/sec:      %.0f\n", stats.totalTicks / seconds);
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Match farm: plays millions of AI vs AI matches across all cores with work stealing
+// and prints win rates and a rally length histogram. --scaling repeats the batch with
+// 1, 2, 4, ... threads to show how throughput scales.
+//
+// Usage: match_farm [--matches N] [--threads T] [--seed S] [--paddle-speed PX] [--ball-speed PX]
+//                   [--player-ai easy|normal|hard] [--opponent-ai easy|normal|hard]
+//                   [--max-ticks T] [--dt SECONDS] [--scaling]
+
+#include "match_farm.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+// Function to run one batch and return the elapsed wall time in seconds
+static double TimedRun(const MatchSettings& settings, uint64_t matches, int threads, FarmStats& stats) {
+    auto start = chrono::steady_clock::now();
+    stats = RunMatchFarm(settings, matches, threads);
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void PrintReport(const FarmStats& stats, double seconds, int threads) {
+    double matches = (double)stats.matches;
+    printf("Matches:        %llu on %d threads\n", (unsigned long long)stats.matches, threads);
+    printf("Player wins:    %llu (%.2f%%)\n", (unsigned long long)stats.playerWins, 100.0 * stats.playerWins / matches);
+    printf("Opponent wins:  %llu (%.2f%%)\n", (unsigned long long)stats.opponentWins, 100.0 * stats.opponentWins / matches);
+    printf("Draws:          %llu (%.2f%%)\n", (unsigned long long)stats.draws, 100.0 * stats.draws / matches);
+    printf("Avg ticks:      %.1f\n", stats.totalTicks / matches);
+    printf("Time:           %.3f s\n", seconds);
+    printf("Matches/sec:    %.0f\n", matches / seconds);
+    printf("Ticks/sec:      %.0f\n", stats.totalTicks / seconds);
+
+    // Rally histogram, trimmed after the last non-empty bin
+    int lastBin = 0;
+    uint64_t maxCount = 1;
+    for (int i = 0; i < RALLY_HISTOGRAM_BINS; i++) {
+        if (stats.rallyHistogram[i] > 0) lastBin = i;
+        if (stats.rallyHistogram[i] > maxCount) maxCount = stats.rallyHistogram[i];
+    }
+
+    printf("\nRally length (paddle hits before a point), %llu points:\n", (unsigned long long)stats.points);
+    for (int i = 0; i <= lastBin; i++) {
+        int bar = (int)(50 * stats.rallyHistogram[i] / maxCount);
+        printf("%3d%s %12llu %5.2f%% ", i, i == RALLY_HISTOGRAM_BINS - 1 ? "+" : " ",
+            (unsigned long long)stats.rallyHistogram[i], 100.0 * stats.rallyHistogram[i] / stats.points);
+        for (int b = 0; b < bar; b++) putchar('#');
+        putchar('\n');
+    }
+}
+
+int main(int argc, char** argv) {
+    MatchSettings settings;
+    uint64_t matches = 1000000;
+    int threads = (int)thread::hardware_concurrency();
+    bool scaling = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--matches") == 0 && hasValue) matches = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) settings.seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--paddle-speed") == 0 && hasValue) settings.config.paddleSpeed = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--ball-speed") == 0 && hasValue) settings.config.ballSpeed = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--dt") == 0 && hasValue) settings.config.dt = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--player-ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], settings.playerAI)) i++;
+        else if (strcmp(argv[i], "--opponent-ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], settings.opponentAI)) i++;
+        else if (strcmp(argv[i], "--max-ticks") == 0 && hasValue) settings.maxTicks = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--scaling") == 0) scaling = true;
+        else {
+            fprintf(stderr, "Usage: %s [--matches N] [--threads T] [--seed S] [--paddle-speed PX] [--ball-speed PX]"
+                " [--player-ai easy|normal|hard] [--opponent-ai easy|normal|hard]"
+                " [--max-ticks T] [--dt SECONDS] [--scaling]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads <= 0) threads = 1;
+    if (matches > 0xFFFFFFFFull) {
+        fprintf(stderr, "At most %llu matches per batch\n", 0xFFFFFFFFull);
+        return 1;
+    }
+
+    FarmStats stats;
+
+    if (scaling) {
+        double baseRate = 0.0;
+        printf("%8s %12s %14s %10s %11s\n", "threads", "time (s)", "matches/sec", "speedup", "efficiency");
+        // 1, 2, 4, ... and always finish with the full thread count
+        for (int t = 1; t <= threads; t = (t * 2 > threads && t != threads) ? threads : t * 2) {
+            double seconds = TimedRun(settings, matches, t, stats);
+            double rate = stats.matches / seconds;
+            if (t == 1) baseRate = rate;
+            printf("%8d %12.3f %14.0f %9.2fx %10.1f%%\n", t, seconds, rate, rate / baseRate, 100.0 * rate / baseRate / t);
+        }
+        return 0;
+    }
+
+    double seconds = TimedRun(settings, matches, threads, stats);
+    PrintReport(stats, seconds, threads);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Release build with profile-guided optimization, and the speedup it gives.
+#
+#   1. LTO release build, bench_sim on a corpus of recorded matches (the baseline)
+#   2. Instrumented build (PB_PGO=GENERATE), 'pgo_train' plays the corpus, AI and netplay
+#   3. The same build directory rebuilt with the profiles (PB_PGO=USE), bench_sim again
+#
+# Usage: tools/pgo_build.sh [BUILD_DIR]     (default build-pgo, run from Parallel_Bounce)
+set -e
+
+mkdir -p "${1:-build-pgo}"
+BUILD=$(cd "${1:-build-pgo}" && pwd)
+JOBS=$( (nproc || sysctl -n hw.ncpu) 2>/dev/null || echo 4)
+CORPUS=$BUILD/pgo-corpus
+PROFILES=$BUILD/pgo-profiles
+
+configure() {
+    cmake -S . -B "$BUILD" -DCMAKE_BUILD_TYPE=Release -DPB_LTO=ON -DPB_PGO="$1" \
+        -DPB_PGO_DIR="$PROFILES" -DPB_PGO_CORPUS="$CORPUS" > /dev/null
+    cmake --build "$BUILD" -j"$JOBS" > /dev/null
+}
+
+# Function to print bench_sim's numbers for the corpus, best of three runs
+measure() {
+    for run in 1 2 3; do
+        "$BUILD/bench_sim" --repeat 5 "$CORPUS"/match*.pbr
+    done | awk '
+        /ns\/step/ { name = $1 "_" $2; if (!(name in best) || $3 < best[name]) best[name] = $3 }
+        /matches\/sec/ { if ($5 > matches) matches = $5 }
+        END {
+            for (name in best) printf "%s %.2f\n", name, best[name]
+            printf "match_rate %.0f\n", matches
+        }' | sort
+}
+
+echo "Release build with LTO..."
+rm -rf "$PROFILES"
+configure OFF
+mkdir -p "$CORPUS"
+"$BUILD/replay_verify" --record 100 "$CORPUS/match" > /dev/null
+measure > "$BUILD/pgo-before.txt"
+
+echo "Instrumented build and training run..."
+configure GENERATE
+cmake --build "$BUILD" --target pgo_train > "$BUILD/pgo-train.log"
+# Clang writes raw profiles that have to be merged before the USE pass
+if ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+echo "Release build with LTO and PGO..."
+configure USE
+measure > "$BUILD/pgo-after.txt"
+
+echo
+printf "%-18s %14s %14s %9s\n" "" "LTO" "LTO+PGO" "speedup"
+join "$BUILD/pgo-before.txt" "$BUILD/pgo-after.txt" 2>/dev/null | awk '
+    $1 == "match_rate" { printf "%-18s %10.0f m/s %10.0f m/s %8.2fx\n", "AI vs AI match", $2, $3, $3 / $2; next }
+    { sub("_", " ", $1); printf "%-18s %11.2f ns %11.2f ns %8.2fx\n", $1, $2, $3, $2 / $3 }'
@@ -0,0 +1,411 @@
+// Load generator for pong_server: runs many bot clients, each with its own UDP socket and a
+// PongAI steering a NetSession exactly as the game's --join does, and plays match after match.
+// Bots join gradually (--ramp per second) and report what a player would notice: how evenly
+// the server's packets arrive (a late server tick shows up as arrival jitter), ticks spent
+// waiting for the server, desyncs and lost connections. Linux only.
+//
+// Usage: pong_bots [--server HOST[:PORT]] [--bots N] [--threads T] [--ramp PER_SECOND]
+//                  [--duration SECONDS] [--ai easy|normal|hard] [--interval SECONDS]
+
+#include "match_server.h"
+#include "net_socket.h"
+#include "netplay.h"
+#include "pong_ai.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const int64_t TICK_NANOS = 1000000000 / 60;
+static const uint64_t HELLO_TICKS = 15;         // Repeat HELLO every 250 ms, like the game
+static const uint64_t TIMEOUT_TICKS = 5 * 60;
+static const uint64_t LINGER_TICKS = 60;        // Keep sending after the end, like the game
+static const uint64_t PAUSE_TICKS = 60;         // Between matches, so the server has freed the old slot
+
+static int64_t MonotonicNanos() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static int64_t ThreadCpuNanos() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+struct BotStats {
+    uint64_t connected = 0;         // Right now
+    uint64_t playing = 0;           // Right now
+    uint64_t matchesStarted = 0;
+    uint64_t matchesFinished = 0;
+    uint64_t wins = 0;              // For the bots, so a strong server AI shows as few wins
+    uint64_t connectionsLost = 0;
+    uint64_t ticks = 0;             // Frames of bots in a match
+    uint64_t waitTicks = 0;         // Frames a bot couldn't advance because the server inputs were late
+    uint64_t desyncs = 0;
+    uint64_t packetsIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t cpuMicros = 0;
+    TickHistogram arrivalJitter;    // |gap between server INPUT packets - one tick|, in us
+
+    void merge(const BotStats& other) {
+        connected += other.connected;
+        playing += other.playing;
+        matchesStarted += other.matchesStarted;
+        matchesFinished += other.matchesFinished;
+        wins += other.wins;
+        connectionsLost += other.connectionsLost;
+        ticks += other.ticks;
+        waitTicks += other.waitTicks;
+        desyncs += other.desyncs;
+        packetsIn += other.packetsIn;
+        packetsOut += other.packetsOut;
+        cpuMicros += other.cpuMicros;
+        arrivalJitter.merge(other.arrivalJitter);
+    }
+};
+
+enum BotPhase {
+    BOT_WAITING,        // Not started yet (ramp), or pausing between matches
+    BOT_CONNECTING,     // Sending HELLO
+    BOT_PLAYING,
+    BOT_LINGERING       // Match over, still sending inputs
+};
+
+struct Bot {
+    UdpSocket socket;
+    NetSession session;
+    PongAI ai;
+    BotPhase phase = BOT_WAITING;
+    uint64_t phaseTick = 0;         // Thread tick the phase started, or the tick to start at
+    uint64_t lastReceiveTick = 0;
+    int64_t lastInputNanos = 0;     // Arrival of the previous INPUT packet (0 = none yet)
+    uint64_t desyncsSeen = 0;
+    uint32_t seed;
+
+    explicit Bot(uint32_t botSeed) : session(PongConfig(), false, 0), ai(AI_NORMAL, false, botSeed), seed(botSeed) {}
+};
+
+// A thread driving a share of the bots on a 60 Hz timer
+struct BotThread {
+    vector<unique_ptr<Bot>> bots;
+    int epollFd = -1;
+    int timerFd = -1;
+    thread worker;
+    uint64_t tick = 0;
+    BotStats stats;
+
+    mutex statsMutex;
+    BotStats published;
+
+    ~BotThread() {
+        if (timerFd >= 0) ::close(timerFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+};
+
+struct BotOptions {
+    NetAddress server;
+    AiDifficulty ai = AI_NORMAL;
+    int ramp = 500;
+    const atomic<bool>* stopping = nullptr;
+};
+
+static void PublishStats(BotThread& self, int64_t& lastCpuNanos) {
+    int64_t cpuNanos = ThreadCpuNanos();
+    self.stats.cpuMicros = (uint64_t)(cpuNanos - lastCpuNanos) / 1000;
+    lastCpuNanos = cpuNanos;
+
+    uint64_t connected = 0, playing = 0;
+    for (auto& bot : self.bots) {
+        if (bot->phase == BOT_PLAYING || bot->phase == BOT_LINGERING) {
+            connected++;
+            if (bot->phase == BOT_PLAYING) playing++;
+        }
+    }
+
+    lock_guard<mutex> lock(self.statsMutex);
+    self.published.merge(self.stats);
+    self.published.connected = connected;
+    self.published.playing = playing;
+    self.stats = BotStats();
+}
+
+static void Receive(BotThread& self, Bot& bot) {
+    uint8_t buffer[NET_MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = bot.socket.receive(buffer, sizeof(buffer), from)) > 0) {
+        self.stats.packetsIn++;
+        int type = NetPacketTypeOf(buffer, size);
+
+        if (bot.phase == BOT_CONNECTING) {
+            PongConfig config;
+            NetSessionSettings settings;
+            uint32_t sessionId;
+            string serverName;
+            if (!ReadWelcomePacket(buffer, size, sessionId, config, settings, serverName) || sessionId == 0) continue;
+            bot.session = NetSession(config, false, sessionId, settings);
+            bot.ai = PongAI(bot.ai.settings(), false, bot.seed++);
+            bot.phase = BOT_PLAYING;
+            bot.phaseTick = self.tick;
+            bot.lastReceiveTick = self.tick;
+            bot.lastInputNanos = 0;
+            bot.desyncsSeen = 0;
+            self.stats.matchesStarted++;
+            continue;
+        }
+        if (bot.phase != BOT_PLAYING && bot.phase != BOT_LINGERING) continue;
+
+        bot.lastReceiveTick = self.tick;
+        if (type == NET_PACKET_INPUT) {
+            int64_t now = MonotonicNanos();
+            if (bot.lastInputNanos != 0) {
+                int64_t off = now - bot.lastInputNanos - TICK_NANOS;
+                self.stats.arrivalJitter.add((uint64_t)(off < 0 ? -off : off) / 1000);
+            }
+            bot.lastInputNanos = now;
+        }
+        bot.session.receive(buffer, size);
+    }
+}
+
+static void Frame(BotThread& self, Bot& bot, const BotOptions& options, vector<uint8_t>& packet) {
+    switch (bot.phase) {
+    case BOT_WAITING:
+        if (self.tick < bot.phaseTick) return;
+        bot.phase = BOT_CONNECTING;
+        bot.phaseTick = self.tick;
+        [[fallthrough]];    // Send the first HELLO now
+    case BOT_CONNECTING:
+        if ((self.tick - bot.phaseTick) % HELLO_TICKS == 0) {
+            WriteHelloPacket("Bot", packet);
+            bot.socket.send(options.server, packet.data(), packet.size());
+            self.stats.packetsOut++;
+        }
+        return;
+    case BOT_PLAYING:
+    case BOT_LINGERING:
+        break;
+    }
+
+    if (self.tick - bot.lastReceiveTick > TIMEOUT_TICKS) {
+        self.stats.connectionsLost++;
+        bot.phase = BOT_WAITING;
+        bot.phaseTick = self.tick + PAUSE_TICKS;
+        return;
+    }
+
+    NetSession& session = bot.session;
+    if (bot.phase == BOT_PLAYING) {
+        self.stats.ticks++;
+        session.setLocalInput(bot.ai.decide(session.state(), session.config()));
+        if (session.takeTimeSyncStall()) {
+            // Let the server catch up
+        }
+        else if (session.canAdvance()) {
+            session.advance();
+        }
+        else {
+            self.stats.waitTicks++;
+        }
+        if (session.isOver()) {
+            bot.phase = BOT_LINGERING;
+            bot.phaseTick = self.tick;
+            self.stats.matchesFinished++;
+            // The bot plays the left paddle, so it won if the right one ran out of hearts
+            if (!session.playerWon()) self.stats.wins++;
+        }
+    }
+    else if (self.tick - bot.phaseTick >= LINGER_TICKS) {
+        bot.phase = BOT_WAITING;
+        bot.phaseTick = self.tick + PAUSE_TICKS;
+        return;
+    }
+
+    self.stats.desyncs += session.stats().desyncs - bot.desyncsSeen;
+    bot.desyncsSeen = session.stats().desyncs;
+
+    session.writeInputPacket(packet);
+    bot.socket.send(options.server, packet.data(), packet.size());
+    self.stats.packetsOut++;
+}
+
+static void RunBots(BotThread& self, const BotOptions& options) {
+    int64_t start = (MonotonicNanos() / TICK_NANOS + 1) * TICK_NANOS;
+    itimerspec schedule;
+    schedule.it_value.tv_sec = start / 1000000000;
+    schedule.it_value.tv_nsec = start % 1000000000;
+    schedule.it_interval.tv_sec = 0;
+    schedule.it_interval.tv_nsec = TICK_NANOS;
+    timerfd_settime(self.timerFd, TFD_TIMER_ABSTIME, &schedule, nullptr);
+
+    int64_t lastCpuNanos = ThreadCpuNanos();
+    vector<uint8_t> packet;
+    epoll_event events[256];
+    while (!options.stopping->load(memory_order_relaxed)) {
+        int count = epoll_wait(self.epollFd, events, 256, 100);
+        bool timerFired = false;
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.u64 == UINT64_MAX) timerFired = true;
+            else Receive(self, *self.bots[(size_t)events[i].data.u64]);
+        }
+        if (!timerFired) continue;
+
+        uint64_t expirations = 0;
+        if (read(self.timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+        self.tick++;
+        for (auto& bot : self.bots) Frame(self, *bot, options, packet);
+        if (self.tick % 30 == 0) PublishStats(self, lastCpuNanos);
+    }
+    PublishStats(self, lastCpuNanos);
+}
+
+int main(int argc, char** argv) {
+    string serverText = "127.0.0.1";
+    int botCount = 100;
+    int threadCount = (int)thread::hardware_concurrency() / 2;
+    double duration = 30.0;
+    double interval = 1.0;
+    BotOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--server") == 0 && hasValue) serverText = argv[++i];
+        else if (strcmp(argv[i], "--bots") == 0 && hasValue) botCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ramp") == 0 && hasValue) options.ramp = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) duration = atof(argv[++i]);
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atof(argv[++i]);
+        else if (strcmp(argv[i], "--ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], options.ai)) i++;
+        else {
+            fprintf(stderr, "Usage: %s [--server HOST[:PORT]] [--bots N] [--threads T] [--ramp PER_SECOND]"
+                " [--duration SECONDS] [--ai easy|normal|hard] [--interval SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (botCount < 1) botCount = 1;
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > botCount) threadCount = botCount;
+    if (options.ramp < 1) options.ramp = 1;
+    if (interval < 0.1) interval = 0.1;
+
+    if (!ParseNetAddress(serverText, NET_DEFAULT_PORT, options.server)) {
+        fprintf(stderr, "Could not resolve %s\n", serverText.c_str());
+        return 1;
+    }
+
+    // One socket per bot: raise the open file limit as far as we are allowed
+    rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    atomic<bool> stopping(false);
+    options.stopping = &stopping;
+    vector<unique_ptr<BotThread>> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back(new BotThread());
+        BotThread& self = *threads.back();
+        self.epollFd = epoll_create1(0);
+        self.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (self.epollFd < 0 || self.timerFd < 0) {
+            fprintf(stderr, "Could not create epoll or timer\n");
+            return 1;
+        }
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = UINT64_MAX;
+        epoll_ctl(self.epollFd, EPOLL_CTL_ADD, self.timerFd, &event);
+    }
+
+    // Bots are dealt round-robin, so every thread gets its share of the ramp
+    for (int i = 0; i < botCount; i++) {
+        BotThread& self = *threads[i % threadCount];
+        unique_ptr<Bot> bot(new Bot(0xB0700000u + (uint32_t)i * 7919u));
+        bot->ai = PongAI(options.ai, false, bot->seed);
+        if (!bot->socket.open(0)) {
+            fprintf(stderr, "Could not open socket %d (raise ulimit -n?)\n", i);
+            return 1;
+        }
+        bot->phaseTick = (uint64_t)i * 60 / options.ramp;
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = self.bots.size();
+        epoll_ctl(self.epollFd, EPOLL_CTL_ADD, (int)bot->socket.handle(), &event);
+        self.bots.push_back(move(bot));
+    }
+
+    for (auto& thread : threads) {
+        BotThread* self = thread.get();
+        thread->worker = std::thread([self, &options]() { RunBots(*self, options); });
+    }
+
+    printf("%d bots on %d threads against %s, %d joining per second\n", botCount, threadCount,
+        NetAddressToString(options.server).c_str(), options.ramp);
+    printf("%7s %7s %7s %7s %6s | %20s | %7s %7s %6s | %9s %6s\n", "time", "in game", "started", "ended", "lost",
+        "arrival us p50/99/max", "wait%", "desync", "wins%", "pkt in/s", "cores");
+
+    auto start = chrono::steady_clock::now();
+    auto last = start;
+    BotStats total;
+    for (;;) {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        auto now = chrono::steady_clock::now();
+        double elapsed = chrono::duration<double>(now - start).count();
+        double seconds = chrono::duration<double>(now - last).count();
+        bool finished = elapsed >= duration;
+        if (seconds < interval && !finished) continue;
+        last = now;
+
+        BotStats stats;
+        for (auto& thread : threads) {
+            lock_guard<mutex> lock(thread->statsMutex);
+            stats.merge(thread->published);
+            thread->published = BotStats();
+        }
+        total.merge(stats);
+        printf("%6.0fs %7llu %7llu %7llu %6llu | %6llu %6llu %6llu | %6.2f%% %7llu %5.1f%% | %9.0f %6.2f\n",
+            elapsed, (unsigned long long)stats.connected, (unsigned long long)stats.matchesStarted,
+            (unsigned long long)stats.matchesFinished, (unsigned long long)stats.connectionsLost,
+            (unsigned long long)stats.arrivalJitter.percentile(0.5), (unsigned long long)stats.arrivalJitter.percentile(0.99),
+            (unsigned long long)stats.arrivalJitter.maxMicros,
+            stats.ticks ? 100.0 * stats.waitTicks / stats.ticks : 0.0, (unsigned long long)stats.desyncs,
+            stats.matchesFinished ? 100.0 * stats.wins / stats.matchesFinished : 0.0,
+            stats.packetsIn / seconds, stats.cpuMicros / 1e6 / seconds);
+        fflush(stdout);
+        if (finished) break;
+    }
+
+    stopping = true;
+    for (auto& thread : threads) thread->worker.join();
+
+    printf("\nMatches started %llu, finished %llu, connections lost %llu, desyncs %llu\n",
+        (unsigned long long)total.matchesStarted, (unsigned long long)total.matchesFinished,
+        (unsigned long long)total.connectionsLost, (unsigned long long)total.desyncs);
+    printf("Arrival jitter  p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us\n",
+        (unsigned long long)total.arrivalJitter.percentile(0.5), (unsigned long long)total.arrivalJitter.percentile(0.99),
+        (unsigned long long)total.arrivalJitter.percentile(0.999), (unsigned long long)total.arrivalJitter.maxMicros);
+    printf("Waiting for the server on %.2f%% of bot ticks\n", total.ticks ? 100.0 * total.waitTicks / total.ticks : 0.0);
+    return total.connectionsLost > 0 || total.desyncs > 0 ? 1 : 0;
+}
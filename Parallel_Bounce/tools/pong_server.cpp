@@ -0,0 +1,108 @@
+// Dedicated match server: hosts matches against the server AI for any number of clients (the
+// game with --join HOST[:PORT], or pong_bots) until Ctrl+C. Prints one line of load figures per
+// interval: tick timing, CPU per match and traffic. Linux only.
+//
+// Usage: pong_server [--port P] [--shards N] [--matches-per-shard N] [--ai easy|normal|hard]
+//                    [--hearts N] [--no-pin] [--interval SECONDS] [--duration SECONDS]
+
+#include "match_server.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void OnSignal(int) {
+    stopRequested = 1;
+}
+
+int main(int argc, char** argv) {
+    MatchServerSettings settings;
+    double interval = 1.0;
+    double duration = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue) settings.port = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shards") == 0 && hasValue) settings.shards = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--matches-per-shard") == 0 && hasValue) settings.matchesPerShard = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], settings.ai)) i++;
+        else if (strcmp(argv[i], "--hearts") == 0 && hasValue) settings.config.maxHearts = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-pin") == 0) settings.pinThreads = false;
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atof(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) duration = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--port P] [--shards N] [--matches-per-shard N] [--ai easy|normal|hard]"
+                " [--hearts N] [--no-pin] [--interval SECONDS] [--duration SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (interval < 0.1) interval = 0.1;
+
+    MatchServer server;
+    if (!server.start(settings)) {
+        fprintf(stderr, "Could not start the server on UDP port %d\n", (int)settings.port);
+        return 1;
+    }
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    printf("Serving on UDP port %d: %d shards%s, up to %d matches each, %s AI\n", (int)server.settings().port,
+        server.shardCount(), settings.pinThreads ? " pinned to cores" : "", settings.matchesPerShard, AiDifficultyName(settings.ai));
+    printf("%7s %7s %7s %7s | %17s | %17s %6s | %9s %7s | %9s %9s %8s\n", "time", "active", "started", "ended",
+        "tick us p50/99/max", "wake us p50/99/max", "late", "cpu us/mt", "cores", "pkt in/s", "pkt out/s", "Mbit out");
+
+    auto start = chrono::steady_clock::now();
+    auto last = start;
+    MatchServerStats total;
+    while (!stopRequested) {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        auto now = chrono::steady_clock::now();
+        double elapsed = chrono::duration<double>(now - start).count();
+        double seconds = chrono::duration<double>(now - last).count();
+        bool finished = duration > 0 && elapsed >= duration;
+        if (seconds < interval && !finished) continue;
+        last = now;
+
+        MatchServerStats stats = server.takeStats();
+        total.merge(stats);
+        double cpuPerMatchTick = stats.matchTicks ? (double)stats.cpuMicros / stats.matchTicks : 0.0;
+        printf("%6.0fs %7llu %7llu %7llu | %5llu %5llu %5llu | %5llu %5llu %5llu %6llu | %9.2f %7.2f | %9.0f %9.0f %8.2f\n",
+            elapsed, (unsigned long long)stats.activeMatches, (unsigned long long)stats.matchesStarted,
+            (unsigned long long)(stats.matchesFinished + stats.matchesTimedOut),
+            (unsigned long long)stats.tickWork.percentile(0.5), (unsigned long long)stats.tickWork.percentile(0.99),
+            (unsigned long long)stats.tickWork.maxMicros,
+            (unsigned long long)stats.wakeDelay.percentile(0.5), (unsigned long long)stats.wakeDelay.percentile(0.99),
+            (unsigned long long)stats.wakeDelay.maxMicros, (unsigned long long)stats.lateTicks,
+            cpuPerMatchTick, stats.cpuMicros / 1e6 / seconds,
+            stats.packetsIn / seconds, stats.packetsOut / seconds, stats.bytesOut * 8 / 1e6 / seconds);
+        fflush(stdout);
+        if (finished) break;
+    }
+
+    server.stop();
+    total.merge(server.takeStats());
+
+    // CPU per match-tick is what sizes a box: one core runs 1e6 / 60 / cost matches at 60 Hz
+    double cpuPerMatchTick = total.matchTicks ? (double)total.cpuMicros / total.matchTicks : 0.0;
+    printf("\nMatches started %llu, finished %llu, timed out %llu, rejected (pool full) %llu\n",
+        (unsigned long long)total.matchesStarted, (unsigned long long)total.matchesFinished,
+        (unsigned long long)total.matchesTimedOut, (unsigned long long)total.hellosRejected);
+    printf("Tick work   p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us\n",
+        (unsigned long long)total.tickWork.percentile(0.5), (unsigned long long)total.tickWork.percentile(0.99),
+        (unsigned long long)total.tickWork.percentile(0.999), (unsigned long long)total.tickWork.maxMicros);
+    printf("Wake delay  p50 %llu us  p99 %llu us  p99.9 %llu us  max %llu us, %llu late periods\n",
+        (unsigned long long)total.wakeDelay.percentile(0.5), (unsigned long long)total.wakeDelay.percentile(0.99),
+        (unsigned long long)total.wakeDelay.percentile(0.999), (unsigned long long)total.wakeDelay.maxMicros,
+        (unsigned long long)total.lateTicks);
+    printf("CPU         %.2f us per match tick (%.0f matches per core at 60 Hz), %llu rollbacks, %llu send errors\n",
+        cpuPerMatchTick, cpuPerMatchTick > 0 ? 1e6 / 60 / cpuPerMatchTick : 0.0,
+        (unsigned long long)total.rollbacks, (unsigned long long)total.sendErrors);
+    return 0;
+}
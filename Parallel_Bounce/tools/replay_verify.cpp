@@ -0,0 +1,136 @@
+// Re-simulates stored replays as fast as possible and checks every state hash, so a physics
+// change that alters any match is caught at the first checkpoint that differs.
+// --record writes a corpus of AI vs AI replays to check later changes against.
+//
+// Usage: replay_verify [--threads T] [--verbose] FILE...
+//        replay_verify --record N PREFIX [--seed S] [--ai easy|normal|hard]
+
+#include "pong_ai.h"
+#include "replay.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static int Record(int count, const string& prefix, uint32_t seed, AiDifficulty difficulty) {
+    uint64_t bytes = 0;
+    uint64_t ticks = 0;
+    for (int i = 0; i < count; i++) {
+        PongConfig config;
+        config.seed = seed + (uint32_t)i * 2654435761u;
+        PongSim sim(config);
+        PongAI playerAI(difficulty, true, config.seed ^ 0xA5A5A5A5u);
+        PongAI opponentAI(difficulty, false, config.seed ^ 0x5A5A5A5Au);
+
+        ReplayRecorder recorder;
+        recorder.begin(config, true, "AI " + to_string(i), "AI");
+        while (!sim.isOver() && sim.state().tick < 60 * 60 * 10) {
+            PongInputs inputs = { playerAI.decide(sim.state(), config), opponentAI.decide(sim.state(), config) };
+            sim.step(inputs);
+            recorder.record(inputs, sim.state());
+        }
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s%05d.pbr", prefix.c_str(), i);
+        if (!recorder.save(path)) {
+            fprintf(stderr, "Error: Could not write %s\n", path);
+            return 1;
+        }
+        bytes += recorder.byteSize();
+        ticks += recorder.tickCount();
+    }
+
+    printf("Recorded %d replays, %llu ticks, %.1f bytes/replay (%.3f bytes/tick)\n", count,
+        (unsigned long long)ticks, count ? (double)bytes / count : 0.0, ticks ? (double)bytes / ticks : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    vector<string> paths;
+    int threadCount = (int)thread::hardware_concurrency();
+    bool verbose = false;
+    int recordCount = 0;
+    string recordPrefix;
+    uint32_t seed = 1;
+    AiDifficulty difficulty = AI_NORMAL;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+        else if (strcmp(argv[i], "--record") == 0 && i + 2 < argc) {
+            recordCount = atoi(argv[++i]);
+            recordPrefix = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--ai") == 0 && hasValue && ParseAiDifficulty(argv[i + 1], difficulty)) i++;
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else {
+            fprintf(stderr, "Usage: %s [--threads T] [--verbose] FILE...\n"
+                "       %s --record N PREFIX [--seed S] [--ai easy|normal|hard]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (recordCount > 0) return Record(recordCount, recordPrefix, seed, difficulty);
+    if (paths.empty()) {
+        fprintf(stderr, "No replays given\n");
+        return 1;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if ((size_t)threadCount > paths.size()) threadCount = (int)paths.size();
+
+    atomic<size_t> nextReplay(0);
+    atomic<uint64_t> totalTicks(0);
+    atomic<double> simulatedSeconds(0.0);
+    atomic<int> failures(0);
+    mutex printMutex;
+
+    auto start = chrono::steady_clock::now();
+    auto worker = [&]() {
+        double seconds = 0.0;
+        for (size_t i; (i = nextReplay.fetch_add(1)) < paths.size();) {
+            Replay replay;
+            if (!replay.load(paths[i].c_str())) {
+                lock_guard<mutex> lock(printMutex);
+                printf("BAD   %s: not a replay file\n", paths[i].c_str());
+                failures++;
+                continue;
+            }
+
+            ReplayCheck check = VerifyReplay(replay);
+            totalTicks += check.ticks;
+            seconds += check.ticks * (double)replay.header().dt;
+
+            if (!check.ok || verbose) {
+                lock_guard<mutex> lock(printMutex);
+                if (check.ok) printf("OK    %s: %u ticks, %s won\n", paths[i].c_str(), check.ticks,
+                    check.playerWon ? replay.playerName().c_str() : replay.opponentName().c_str());
+                else printf("DIFF  %s: first mismatch at tick %lld of %u\n", paths[i].c_str(),
+                    (long long)check.firstMismatch, replay.tickCount());
+            }
+            if (!check.ok) failures++;
+        }
+
+        double expected = simulatedSeconds.load();
+        while (!simulatedSeconds.compare_exchange_weak(expected, expected + seconds)) {}
+    };
+
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) threads.emplace_back(worker);
+    for (thread& t : threads) t.join();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("Replays:   %zu (%d failed)\n", paths.size(), failures.load());
+    printf("Ticks:     %llu in %.3f s (%.0f ticks/sec, %.0fx real time)\n", (unsigned long long)totalTicks.load(),
+        seconds, totalTicks / seconds, simulatedSeconds / seconds);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+// Converts the old text match log into the binary result file, appending to it.
+//
+// Usage: results_convert [game_results.txt] [game_results.bin]
+
+#include "result_store.h"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+    const char* textPath = argc > 1 ? argv[1] : "game_results.txt";
+    const char* binaryPath = argc > 2 ? argv[2] : "game_results.bin";
+
+    ResultWriter writer(4096);
+    if (!writer.open(binaryPath)) {
+        fprintf(stderr, "Error: Could not open %s as a result file\n", binaryPath);
+        return 1;
+    }
+
+    int skipped = 0;
+    int converted = ImportTextResults(textPath, writer, &skipped);
+    if (converted < 0) {
+        fprintf(stderr, "Error: Could not open %s\n", textPath);
+        return 1;
+    }
+    if (!writer.flush()) {
+        fprintf(stderr, "Error: Could not write %s\n", binaryPath);
+        return 1;
+    }
+
+    printf("Converted %d records from %s to %s (%d lines skipped)\n", converted, textPath, binaryPath, skipped);
+    return 0;
+}
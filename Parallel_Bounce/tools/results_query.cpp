@@ -0,0 +1,226 @@
+// Scans a binary result file and prints match counts, optionally filtered, plus the top winners.
+// The file is memory mapped and split across threads. --generate appends synthetic records
+// for benchmarking the scan.
+//
+// Usage: results_query [FILE] [--mode "AI vs Player"|Multiplayer] [--winner NAME]
+//                      [--since YYYY-MM-DD] [--until YYYY-MM-DD] [--top N] [--threads T]
+//        results_query [FILE] --generate N
+
+#include "result_store.h"
+#include "xorshift.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+struct QueryFilter {
+    int mode = -1;              // -1 = any
+    string winner;              // Empty = any
+    int64_t since = INT64_MIN;
+    int64_t until = INT64_MAX;
+    bool countWinners = false;
+};
+
+struct WinnerCount {
+    uint64_t wins;
+    size_t example;             // Index of a record with this winner, to print the name
+};
+
+struct ScanResult {
+    uint64_t matched = 0;
+    uint64_t perMode[RESULT_MODE_COUNT] = {};
+    int64_t first = INT64_MAX;
+    int64_t last = INT64_MIN;
+    unordered_map<uint64_t, WinnerCount> winners;   // Keyed by a hash of the name bytes
+};
+
+// Function to hash a name without building a string (FNV-1a)
+static uint64_t HashName(const char* name, uint8_t length) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (uint8_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)name[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+static void Scan(const ResultReader& reader, size_t begin, size_t end, const QueryFilter& filter, ScanResult& result) {
+    const ResultRecord* records = reader.records();
+    const uint8_t winnerLength = (uint8_t)min(filter.winner.size(), (size_t)RESULT_NAME_SIZE);
+
+    for (size_t i = begin; i < end; i++) {
+        const ResultRecord& record = records[i];
+        if (filter.mode >= 0 && record.mode != filter.mode) continue;
+        if (record.timestamp < filter.since || record.timestamp >= filter.until) continue;
+        if (!filter.winner.empty() &&
+            (record.winnerLength != winnerLength || memcmp(record.winner, filter.winner.data(), winnerLength) != 0)) {
+            continue;
+        }
+
+        result.matched++;
+        if (record.mode < RESULT_MODE_COUNT) result.perMode[record.mode]++;
+        if (record.timestamp < result.first) result.first = record.timestamp;
+        if (record.timestamp > result.last) result.last = record.timestamp;
+
+        if (filter.countWinners) {
+            WinnerCount& count = result.winners[HashName(record.winner, record.winnerLength)];
+            if (count.wins++ == 0) count.example = i;
+        }
+    }
+}
+
+// Function to turn YYYY-MM-DD into a Unix time at local midnight
+static bool ParseDate(const char* text, int64_t& timestamp) {
+    struct tm timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    if (sscanf(text, "%d-%d-%d", &timeInfo.tm_year, &timeInfo.tm_mon, &timeInfo.tm_mday) != 3) return false;
+    timeInfo.tm_year -= 1900;
+    timeInfo.tm_mon -= 1;
+    timeInfo.tm_isdst = -1;
+    timestamp = (int64_t)mktime(&timeInfo);
+    return true;
+}
+
+static string FormatTime(int64_t timestamp) {
+    time_t seconds = (time_t)timestamp;
+    struct tm* timeInfo = localtime(&seconds);
+    char buffer[32] = "?";
+    if (timeInfo) strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeInfo);
+    return buffer;
+}
+
+// Function to append count synthetic records spread over the last year
+static int Generate(const char* path, uint64_t count) {
+    ResultWriter writer(1 << 16);
+    if (!writer.open(path)) {
+        fprintf(stderr, "Error: Could not open %s as a result file\n", path);
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    int64_t now = (int64_t)time(nullptr);
+    uint32_t rng = 12345;
+    char winner[16];
+    char loser[16];
+    for (uint64_t i = 0; i < count; i++) {
+        XorShift32(rng);
+        uint8_t mode = (uint8_t)(rng & 1);
+        snprintf(winner, sizeof(winner), "Player %u", (rng >> 1) % 10000);
+        snprintf(loser, sizeof(loser), "Player %u", (rng >> 15) % 10000);
+        writer.append(MakeResultRecord(mode, mode == RESULT_MODE_AI && (rng & 2) ? "AI" : winner,
+            mode == RESULT_MODE_AI && !(rng & 2) ? "AI" : loser, now - (int64_t)(i % (365 * 86400))));
+    }
+    if (!writer.flush()) {
+        fprintf(stderr, "Error: Could not write %s\n", path);
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("Appended %llu records in %.3f s (%.0f records/sec)\n", (unsigned long long)count, seconds, count / seconds);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* path = "game_results.bin";
+    QueryFilter filter;
+    int top = 0;
+    int threadCount = (int)thread::hardware_concurrency();
+    uint64_t generate = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            uint8_t mode;
+            if (!ParseResultMode(argv[++i], mode)) {
+                fprintf(stderr, "Unknown mode: %s\n", argv[i]);
+                return 1;
+            }
+            filter.mode = mode;
+        }
+        else if (strcmp(argv[i], "--winner") == 0 && hasValue) filter.winner = argv[++i];
+        else if (strcmp(argv[i], "--since") == 0 && hasValue && ParseDate(argv[i + 1], filter.since)) i++;
+        else if (strcmp(argv[i], "--until") == 0 && hasValue && ParseDate(argv[i + 1], filter.until)) i++;
+        else if (strcmp(argv[i], "--top") == 0 && hasValue) top = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--generate") == 0 && hasValue) generate = strtoull(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-') path = argv[i];
+        else {
+            fprintf(stderr, "Usage: %s [FILE] [--mode NAME] [--winner NAME] [--since YYYY-MM-DD] [--until YYYY-MM-DD]"
+                " [--top N] [--threads T]\n       %s [FILE] --generate N\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (generate > 0) return Generate(path, generate);
+
+    auto start = chrono::steady_clock::now();
+
+    ResultReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "Error: %s is missing or not a result file\n", path);
+        return 1;
+    }
+
+    filter.countWinners = top > 0;
+    const size_t count = reader.count();
+    if (threadCount <= 0) threadCount = 1;
+    if ((size_t)threadCount > count / 100000 + 1) threadCount = (int)(count / 100000 + 1); // Not worth it for small files
+
+    vector<ScanResult> partial(threadCount);
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        size_t begin = count * t / threadCount;
+        size_t end = count * (t + 1) / threadCount;
+        threads.emplace_back(Scan, cref(reader), begin, end, cref(filter), ref(partial[t]));
+    }
+    for (thread& t : threads) t.join();
+
+    ScanResult total;
+    for (ScanResult& part : partial) {
+        total.matched += part.matched;
+        for (int m = 0; m < RESULT_MODE_COUNT; m++) total.perMode[m] += part.perMode[m];
+        total.first = min(total.first, part.first);
+        total.last = max(total.last, part.last);
+        for (auto& entry : part.winners) {
+            auto inserted = total.winners.insert(entry);
+            if (!inserted.second) inserted.first->second.wins += entry.second.wins;
+        }
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    printf("Records:   %zu\n", count);
+    printf("Matched:   %llu\n", (unsigned long long)total.matched);
+    for (int m = 0; m < RESULT_MODE_COUNT; m++) {
+        printf("  %-14s %llu\n", ResultModeName((uint8_t)m), (unsigned long long)total.perMode[m]);
+    }
+    if (total.matched > 0) {
+        printf("First:     %s\n", FormatTime(total.first).c_str());
+        printf("Last:      %s\n", FormatTime(total.last).c_str());
+    }
+
+    if (top > 0) {
+        vector<WinnerCount> ranking;
+        ranking.reserve(total.winners.size());
+        for (auto& entry : total.winners) ranking.push_back(entry.second);
+        size_t shown = min((size_t)top, ranking.size());
+        partial_sort(ranking.begin(), ranking.begin() + shown, ranking.end(),
+            [](const WinnerCount& a, const WinnerCount& b) { return a.wins > b.wins; });
+
+        printf("\nTop winners:\n");
+        for (size_t i = 0; i < shown; i++) {
+            printf("%4zu. %-50s %llu\n", i + 1, ResultWinner(reader[ranking[i].example]).c_str(),
+                (unsigned long long)ranking[i].wins);
+        }
+    }
+
+    printf("\nScanned %zu records in %.3f s (%.0f records/sec, %d threads)\n", count, seconds,
+        seconds > 0 ? count / seconds : 0.0, threadCount);
+    return 0;
+}
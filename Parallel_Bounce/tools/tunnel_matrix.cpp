@@ -0,0 +1,105 @@
+// Tunnelling matrix: fires the ball at the player paddle over a grid of ball speeds and
+// timesteps, with continuous collision on and off, and counts shots that pass through.
+// Exits with status 1 if any shot tunnels with continuous collision enabled.
+//
+// Usage: tunnel_matrix
+
+#include "pong_sim.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+// Function to place the ball in the middle of the field, aimed so its path crosses the
+// paddle's front face plane at targetY. angle is the vy / vx slope.
+static PongState AimedState(const PongConfig& config, float speed, float angle, float targetY) {
+    PongSim sim(config);
+    PongState state = sim.state();
+    const float startX = config.screenWidth / 2.0f;
+    const float faceX = state.playerPaddle.x - config.ballRadius;
+    state.ballPosition = { startX, targetY - angle * (faceX - startX) };
+    state.ballSpeedVector = { speed, speed * angle };
+    return state;
+}
+
+// Function to check whether the straight path really touches the paddle, by walking it in
+// steps much smaller than the ball. Shots that only pass near a corner are left out.
+static bool PathTouchesPaddle(const PongConfig& config, float angle, float targetY) {
+    PongState state = AimedState(config, 1.0f, angle, targetY);
+    const SimRect& paddle = state.playerPaddle;
+    for (float x = state.ballPosition.x; x < paddle.x + paddle.width + config.ballRadius; x += 0.01f) {
+        SimVec2 center = { x, state.ballPosition.y + angle * (x - state.ballPosition.x) };
+        if (CircleOverlapsRect(center, config.ballRadius, paddle)) return true;
+    }
+    return false;
+}
+
+// Function to fire one shot and report whether the ball passed through the paddle
+static bool Tunnels(PongConfig config, float speed, float angle, float targetY) {
+    config.ballSpeed = speed;
+    PongSim sim(config);
+    sim.restore(AimedState(config, speed, angle, targetY));
+
+    const PongInputs still = { 0, 0 };
+    for (int tick = 0; tick < 100000; tick++) {
+        uint32_t events = sim.step(still);
+        if (events & PONG_EVENT_PLAYER_HIT) return false;
+        if (events & PONG_EVENT_OPPONENT_SCORED) return true; // Went out behind the paddle
+        if (sim.state().ballSpeedVector.x < 0) return false;
+    }
+    return true;
+}
+
+int main() {
+    const float speeds[] = { 350, 700, 1400, 2800, 5600, 11200, 22400 };
+    const float dts[] = { 1.0f / 480, 1.0f / 240, 1.0f / 120, 1.0f / 60, 1.0f / 30, 1.0f / 15, 1.0f / 8 };
+    const float angles[] = { -0.4f, -0.2f, 0.0f, 0.2f, 0.4f };
+
+    PongConfig config;
+    PongSim reference(config);
+    const SimRect paddle = reference.state().playerPaddle;
+
+    // Targets across the whole face and past its ends, where the ball only grazes a corner.
+    // Keep the shots whose path really touches the paddle.
+    struct Shot {
+        float angle;
+        float target;
+    };
+    vector<Shot> shots;
+    const int targetCount = 25;
+    for (float angle : angles) {
+        for (int i = 0; i < targetCount; i++) {
+            float target = paddle.y - 1.5f * config.ballRadius + (paddle.height + 3.0f * config.ballRadius) * i / (targetCount - 1);
+            if (PathTouchesPaddle(config, angle, target)) shots.push_back({ angle, target });
+        }
+    }
+
+    printf("Tunnelled shots out of %zu per cell (continuous / discrete)\n\n", shots.size());
+    printf("%12s", "speed \\ dt");
+    for (float dt : dts) printf("   1/%-6.0f", 1.0f / dt);
+    printf("\n");
+
+    int continuousFailures = 0;
+    for (float speed : speeds) {
+        printf("%10.0f  ", speed);
+        for (float dt : dts) {
+            int tunnelled[2] = { 0, 0 };
+            for (int mode = 0; mode < 2; mode++) {
+                PongConfig shotConfig = config;
+                shotConfig.dt = dt;
+                shotConfig.continuousCollision = mode == 0;
+                for (const Shot& shot : shots) {
+                    if (Tunnels(shotConfig, speed, shot.angle, shot.target)) tunnelled[mode]++;
+                }
+            }
+            continuousFailures += tunnelled[0];
+            printf("  %3d / %-3d ", tunnelled[0], tunnelled[1]);
+        }
+        printf("\n");
+    }
+
+    printf("\n%s\n", continuousFailures == 0 ? "No tunnelling with continuous collision."
+        : "FAIL: balls tunnelled with continuous collision.");
+    return continuousFailures == 0 ? 0 : 1;
+}